@@ -0,0 +1,4 @@
+# ZLIB
+
+hunter_add_package(ZLIB)
+find_package(ZLIB CONFIG REQUIRED)
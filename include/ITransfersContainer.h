@@ -107,6 +107,16 @@ public:
     virtual void getOutputs(
         std::vector<TransactionOutputInformation> &transfers,
         uint32_t flags = IncludeDefault) const = 0;
+    // How many unspent key outputs getRandomOutputs() would draw from for this amount range.
+    // Locked ones and some just outside the range count as well, so it is an upper bound.
+    virtual size_t getRandomOutputsPoolSize(uint64_t minAmount, uint64_t maxAmount) const = 0;
+    // Appends up to count unlocked key outputs with amounts in [minAmount, maxAmount] picked at
+    // random, skipping those already in outputs. Fewer are appended only if no more qualify.
+    virtual size_t getRandomOutputs(
+        size_t count,
+        uint64_t minAmount,
+        uint64_t maxAmount,
+        std::vector<TransactionOutputInformation> &outputs) const = 0;
     virtual bool getTransactionInformation(
         const Crypto::Hash &transactionHash,
         TransactionInformation &info,
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <random>
+#include <stdexcept>
 #include <unordered_map>
 
 template <typename T, typename Gen>
@@ -0,0 +1,111 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <CryptoNoteCore/BlockEntryCache.h>
+
+namespace CryptoNote {
+
+BlockEntryCache::BlockEntryCache(size_t maxSize)
+    : m_maxSize(maxSize),
+      m_size(0)
+{
+}
+
+std::shared_ptr<const BlockEntryCache::Entry> BlockEntryCache::get(
+    uint32_t height,
+    const Crypto::Hash &blockId)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_items.find(height);
+    if (it == m_items.end()) {
+        return nullptr;
+    }
+
+    if (it->second.entry->blockId != blockId) {
+        erase(it);
+        return nullptr;
+    }
+
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lruPosition);
+
+    return it->second.entry;
+}
+
+void BlockEntryCache::put(uint32_t height, std::shared_ptr<const Entry> entry)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (entry->size > m_maxSize) {
+        return;
+    }
+
+    auto it = m_items.find(height);
+    if (it != m_items.end()) {
+        erase(it);
+    }
+
+    while (!m_lru.empty() && m_size + entry->size > m_maxSize) {
+        erase(m_items.find(m_lru.back()));
+    }
+
+    m_lru.push_front(height);
+    m_size += entry->size;
+    m_items.emplace(height, Item{ std::move(entry), m_lru.begin() });
+}
+
+void BlockEntryCache::removeFrom(uint32_t height)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_items.lower_bound(height);
+    while (it != m_items.end()) {
+        erase(it++);
+    }
+}
+
+void BlockEntryCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_items.clear();
+    m_lru.clear();
+    m_size = 0;
+}
+
+size_t BlockEntryCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_size;
+}
+
+size_t BlockEntryCache::count() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_items.size();
+}
+
+void BlockEntryCache::erase(std::map<uint32_t, Item>::iterator it)
+{
+    m_size -= it->second.entry->size;
+    m_lru.erase(it->second.lruPosition);
+    m_items.erase(it);
+}
+
+} // namespace CryptoNote
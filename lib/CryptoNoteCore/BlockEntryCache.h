@@ -0,0 +1,80 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <CryptoNoteProtocol/CryptoNoteProtocolDefinitions.h>
+
+namespace CryptoNote {
+
+/*!
+    Keeps the blocks served to syncing wallets in the form they are sent, so the same
+    range is not serialized and hashed again for every wallet asking for it.
+
+    Entries are keyed by height and checked against the block hash on lookup, a stale
+    entry left by a chain switch is never returned. Least recently used entries are
+    dropped once the total size exceeds the limit. Thread safe.
+*/
+class BlockEntryCache
+{
+public:
+    struct Entry
+    {
+        Crypto::Hash blockId;
+        uint64_t timestamp;
+        std::string block;
+        std::vector<std::string> txs;                   // filled by queryBlocks
+        std::vector<TransactionPrefixInfo> txPrefixes;  // filled by queryBlocksLite
+        size_t size;                                    // approximate memory taken
+    };
+
+    explicit BlockEntryCache(size_t maxSize);
+
+    std::shared_ptr<const Entry> get(uint32_t height, const Crypto::Hash &blockId);
+    void put(uint32_t height, std::shared_ptr<const Entry> entry);
+
+    // drops the entries at height and above
+    void removeFrom(uint32_t height);
+    void clear();
+
+    size_t size() const;
+    size_t count() const;
+
+private:
+    struct Item
+    {
+        std::shared_ptr<const Entry> entry;
+        std::list<uint32_t>::iterator lruPosition;
+    };
+
+    void erase(std::map<uint32_t, Item>::iterator it);
+
+    const size_t m_maxSize;
+    size_t m_size;
+    std::map<uint32_t, Item> m_items;
+    std::list<uint32_t> m_lru; // most recently used first
+    mutable std::mutex m_mutex;
+};
+
+} // namespace CryptoNote
@@ -3294,6 +3294,8 @@ void Blockchain::removeLastBlock()
     m_blockIndex.pop();
 
     assert(m_blockIndex.size() == m_blocks.size());
+
+    m_observerManager.notify(&IBlockchainStorageObserver::blockRemoved, static_cast<uint32_t>(m_blocks.size()));
 }
 
 bool Blockchain::checkUpgradeHeight(const UpgradeDetector &upgradeDetector)
@@ -83,7 +83,9 @@ core::core(
       m_mempool(currency, m_blockchain, *this, m_timeProvider, logger, blockchainIndexesEnabled),
       m_blockchain(currency, m_mempool, logger, blockchainIndexesEnabled),
       m_miner(new miner(currency, *this, logger)),
-      m_starter_message_showed(false)
+      m_starter_message_showed(false),
+      m_fullBlockCache(BLOCK_ENTRY_CACHE_MAX_SIZE),
+      m_liteBlockCache(BLOCK_ENTRY_CACHE_MAX_SIZE)
 {
     set_cryptonote_protocol(pprotocol);
     m_blockchain.addObserver(this);
@@ -1208,6 +1210,13 @@ void core::blockchainUpdated()
     m_observerManager.notify(&ICoreObserver::blockchainUpdated);
 }
 
+void core::blockRemoved(uint32_t height)
+{
+    m_fullBlockCache.removeFrom(height);
+    m_liteBlockCache.removeFrom(height);
+    m_observerManager.notify(&ICoreObserver::blockRemoved, height);
+}
+
 void core::txDeletedFromPool()
 {
     poolUpdated();
@@ -1257,26 +1266,17 @@ bool core::queryBlocks(
         return true;
     }
 
-    std::list<Block> blocks;
-    lbs->getBlocks(startFullOffset, blocksLeft, blocks);
+    uint32_t endHeight = std::min(currentHeight, startFullOffset + blocksLeft);
+    for (uint32_t height = startFullOffset; height < endHeight; ++height) {
+        std::shared_ptr<const BlockEntryCache::Entry> entry = getFullBlockEntry(height);
 
-    for (auto &b : blocks) {
         BlockFullInfo item;
 
-        item.block_id = getBlockHash(b);
-
-        if (b.timestamp >= timestamp) {
-            // query transactions
-            std::list<Transaction> txs;
-            std::list<Crypto::Hash> missedTxs;
-            lbs->getTransactions(b.transactionHashes, txs, missedTxs);
+        item.block_id = entry->blockId;
 
-            // fill data
-            BlockCompleteEntry & completeEntry = item;
-            completeEntry.block = asString(toBinaryArray(b));
-            for (auto &tx : txs) {
-                completeEntry.txs.push_back(asString(toBinaryArray(tx)));
-            }
+        if (entry->timestamp >= timestamp) {
+            item.block = entry->block;
+            item.txs = entry->txs;
         }
 
         entries.push_back(std::move(item));
@@ -1313,6 +1313,77 @@ bool core::findStartAndFullOffsets(
     return true;
 }
 
+std::shared_ptr<const BlockEntryCache::Entry> core::getFullBlockEntry(uint32_t height)
+{
+    Crypto::Hash blockId = m_blockchain.getBlockIdByHeight(height);
+
+    std::shared_ptr<const BlockEntryCache::Entry> cached = m_fullBlockCache.get(height, blockId);
+    if (cached) {
+        return cached;
+    }
+
+    std::list<Block> blocks;
+    m_blockchain.getBlocks(height, 1, blocks);
+    const Block &b = blocks.front();
+
+    std::list<Transaction> txs;
+    std::list<Crypto::Hash> missedTxs;
+    m_blockchain.getTransactions(b.transactionHashes, txs, missedTxs);
+
+    auto entry = std::make_shared<BlockEntryCache::Entry>();
+    entry->blockId = blockId;
+    entry->timestamp = b.timestamp;
+    entry->block = asString(toBinaryArray(b));
+    entry->size = sizeof(BlockEntryCache::Entry) + entry->block.size();
+    for (auto &tx : txs) {
+        entry->txs.push_back(asString(toBinaryArray(tx)));
+        entry->size += sizeof(std::string) + entry->txs.back().size();
+    }
+
+    m_fullBlockCache.put(height, entry);
+
+    return entry;
+}
+
+std::shared_ptr<const BlockEntryCache::Entry> core::getLiteBlockEntry(uint32_t height)
+{
+    Crypto::Hash blockId = m_blockchain.getBlockIdByHeight(height);
+
+    std::shared_ptr<const BlockEntryCache::Entry> cached = m_liteBlockCache.get(height, blockId);
+    if (cached) {
+        return cached;
+    }
+
+    std::list<Block> blocks;
+    m_blockchain.getBlocks(height, 1, blocks);
+    const Block &b = blocks.front();
+
+    std::list<Transaction> txs;
+    std::list<Crypto::Hash> missedTxs;
+    m_blockchain.getTransactions(b.transactionHashes, txs, missedTxs);
+
+    auto entry = std::make_shared<BlockEntryCache::Entry>();
+    entry->blockId = blockId;
+    entry->timestamp = b.timestamp;
+    entry->block = asString(toBinaryArray(b));
+    entry->size = sizeof(BlockEntryCache::Entry) + entry->block.size();
+    for (const auto &tx : txs) {
+        TransactionPrefixInfo info;
+        info.txPrefix = tx; // TODO: Slicing object from type loses 24 bytes.
+
+        // the parsed prefix takes roughly as much memory as its blob
+        size_t blobSize = 0;
+        getObjectHash(tx, info.txHash, blobSize);
+        entry->size += sizeof(TransactionPrefixInfo) + blobSize;
+
+        entry->txPrefixes.push_back(std::move(info));
+    }
+
+    m_liteBlockCache.put(height, entry);
+
+    return entry;
+}
+
 std::vector<Crypto::Hash> core::findIdsForShortBlocks(uint32_t startOffset,uint32_t startFullOffset)
 {
     assert(startOffset <= startFullOffset);
@@ -1368,28 +1439,17 @@ bool core::queryBlocksLite(
         return true;
     }
 
-    std::list<Block> blocks;
-    lbs->getBlocks(resFullOffset, blocksLeft, blocks);
+    uint32_t endHeight = std::min(resCurrentHeight, resFullOffset + blocksLeft);
+    for (uint32_t height = resFullOffset; height < endHeight; ++height) {
+        std::shared_ptr<const BlockEntryCache::Entry> entry = getLiteBlockEntry(height);
 
-    for (auto &b : blocks) {
         BlockShortInfo item;
 
-        item.blockId = getBlockHash(b);
-
-        if (b.timestamp >= timestamp) {
-            std::list<Transaction> txs;
-            std::list<Crypto::Hash> missedTxs;
-            lbs->getTransactions(b.transactionHashes, txs, missedTxs);
-
-            item.block = asString(toBinaryArray(b));
-
-            for (const auto &tx : txs) {
-                TransactionPrefixInfo info;
-                info.txPrefix = tx; // TODO: Slicing object from type loses 24 bytes.
-                info.txHash = getObjectHash(tx);
+        item.blockId = entry->blockId;
 
-                item.txPrefixes.push_back(std::move(info));
-            }
+        if (entry->timestamp >= timestamp) {
+            item.block = entry->block;
+            item.txPrefixes = entry->txPrefixes;
         }
 
         entries.push_back(std::move(item));
@@ -1433,26 +1493,17 @@ bool core::queryBlocksDetailed(
         return true;
     }
 
-    std::list<Block> blocks;
-    lbs->getBlocks(startFullOffset, blocksLeft, blocks);
+    uint32_t endHeight = std::min(currentHeight, startFullOffset + blocksLeft);
+    for (uint32_t height = startFullOffset; height < endHeight; ++height) {
+        std::shared_ptr<const BlockEntryCache::Entry> entry = getFullBlockEntry(height);
 
-    for (auto &b : blocks) {
         BlockFullInfo item;
 
-        item.block_id = getBlockHash(b);
-
-        if (b.timestamp >= timestamp) {
-            // query transactions
-            std::list<Transaction> txs;
-            std::list<Crypto::Hash> missedTxs;
-            lbs->getTransactions(b.transactionHashes, txs, missedTxs);
+        item.block_id = entry->blockId;
 
-            // fill data
-            BlockCompleteEntry &completeEntry = item;
-            completeEntry.block = asString(toBinaryArray(b));
-            for (auto &tx : txs) {
-                completeEntry.txs.push_back(asString(toBinaryArray(tx)));
-            }
+        if (entry->timestamp >= timestamp) {
+            item.block = entry->block;
+            item.txs = entry->txs;
         }
 
         entries.push_back(std::move(item));
@@ -23,6 +23,7 @@
 #include <boost/program_options/variables_map.hpp>
 #include <BlockchainExplorer/BlockchainExplorerData.h>
 #include <Common/ObserverManager.h>
+#include <CryptoNoteCore/BlockEntryCache.h>
 #include <CryptoNoteCore/Blockchain.h>
 #include <CryptoNoteCore/BlockchainMessages.h>
 #include <CryptoNoteCore/Currency.h>
@@ -342,6 +343,7 @@ private:
     bool handle_command_line(const boost::program_options::variables_map &vm);
     bool check_tx_inputs_keyimages_diff(const Transaction &tx);
     void blockchainUpdated() override;
+    void blockRemoved(uint32_t height) override;
     void txDeletedFromPool() override;
     void poolUpdated();
 
@@ -353,6 +355,10 @@ private:
 
     std::vector<Crypto::Hash> findIdsForShortBlocks(uint32_t startOffset, uint32_t startFullOffset);
 
+    // the blockchain must be locked by the caller
+    std::shared_ptr<const BlockEntryCache::Entry> getFullBlockEntry(uint32_t height);
+    std::shared_ptr<const BlockEntryCache::Entry> getLiteBlockEntry(uint32_t height);
+
     const Currency &m_currency;
     Logging::LoggerRef logger;
     CryptoNote::RealTimeProvider m_timeProvider;
@@ -366,6 +372,9 @@ private:
     Tools::ObserverManager<ICoreObserver> m_observerManager;
     time_t start_time;
 
+    BlockEntryCache m_fullBlockCache;
+    BlockEntryCache m_liteBlockCache;
+
     std::atomic<uint64_t> m_blocksFound;
     std::atomic<uint64_t> m_blocksToFind;
 
@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 namespace CryptoNote {
 
 class IBlockchainStorageObserver
@@ -26,6 +28,7 @@ public:
     virtual ~IBlockchainStorageObserver() = default;
 
     virtual void blockchainUpdated() = 0;
+    virtual void blockRemoved(uint32_t height) = 0;
 };
 
 } // namespace CryptoNote
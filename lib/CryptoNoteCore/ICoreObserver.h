@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 namespace CryptoNote {
 
 class ICoreObserver
@@ -27,6 +29,8 @@ public:
 
     virtual void blockchainUpdated() {};
     virtual void poolUpdated() {};
+    // the block at height left the main chain, the ones above it did before
+    virtual void blockRemoved(uint32_t height) {};
 };
 
 } // namespace CryptoNote
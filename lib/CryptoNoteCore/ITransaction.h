@@ -20,6 +20,7 @@
 
 #include <array>
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 #include <CryptoNote.h>
@@ -151,6 +152,14 @@ public:
         size_t input,
         const TransactionTypes::InputKeyInfo &info,
         const KeyPair &ephKeys) = 0;
+    // Signs key inputs firstInput, firstInput + 1, ... against one hash of the prefix.
+    // forEach calls its task once for every index below its count, it may do so
+    // from several threads at once.
+    virtual void signInputKeys(
+        size_t firstInput,
+        const std::vector<TransactionTypes::InputKeyInfo> &infos,
+        const std::vector<KeyPair> &ephKeys,
+        const std::function<void(size_t, const std::function<void(size_t)> &)> &forEach) = 0;
     virtual void signInputMultisignature(
         size_t input,
         const Crypto::PublicKey &sourceTransactionKey,
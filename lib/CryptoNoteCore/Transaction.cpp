@@ -16,6 +16,7 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <cassert>
 #include <numeric>
 #include <unordered_set>
 #include <boost/optional.hpp>
@@ -45,6 +46,24 @@ void derivePublicKey(
     derivePublicKey(derivation, outputIndex, to.spendPublicKey, ephemeralKey);
 }
 
+std::vector<Signature> signKeyInput(
+    const Hash &prefixHash,
+    const KeyInput &input,
+    const TransactionTypes::InputKeyInfo &info,
+    const KeyPair &ephKeys)
+{
+    std::vector<const PublicKey *> keysPtrs;
+    for (const auto &o : info.outputs) {
+        keysPtrs.push_back(&o.targetKey);
+    }
+
+    std::vector<Signature> signatures(keysPtrs.size());
+    generateRingSignature(prefixHash, input.keyImage, keysPtrs, ephKeys.secretKey,
+                          info.realOutput.transactionIndex, signatures.data());
+
+    return signatures;
+}
+
 } // namespace
 
 namespace CryptoNote {
@@ -122,6 +141,11 @@ public:
         size_t input,
         const TransactionTypes::InputKeyInfo &info,
         const KeyPair &ephKeys) override;
+    void signInputKeys(
+        size_t firstInput,
+        const std::vector<TransactionTypes::InputKeyInfo> &infos,
+        const std::vector<KeyPair> &ephKeys,
+        const std::function<void(size_t, const std::function<void(size_t)> &)> &forEach) override;
     void signInputMultisignature(
         size_t input,
         const PublicKey &sourceTransactionKey,
@@ -289,25 +313,8 @@ size_t TransactionImpl::addInput(
     KeyPair &ephKeys)
 {
     checkIfSigning();
-    KeyInput input;
-    input.amount = info.amount;
-
-    generate_key_image_helper(
-        senderKeys,
-        info.realOutput.transactionPublicKey,
-        info.realOutput.outputInTransaction,
-        ephKeys,
-        input.keyImage
-    );
-
-    // fill outputs array and use relative offsets
-    for (const auto &out : info.outputs) {
-        input.outputIndexes.push_back(out.outputIndex);
-    }
-
-    input.outputIndexes = absolute_output_offsets_to_relative(input.outputIndexes);
 
-    return addInput(input);
+    return addInput(makeKeyInput(senderKeys, info, ephKeys));
 }
 
 size_t TransactionImpl::addInput(const MultiSignatureInput &input)
@@ -383,23 +390,35 @@ void TransactionImpl::signInputKey(
     const auto &input = boost::get<KeyInput>(
         getInputChecked(transaction, index, TransactionTypes::InputType::Key)
     );
-    Hash prefixHash = getTransactionPrefixHash();
 
-    std::vector<Signature> signatures;
-    std::vector<const PublicKey *> keysPtrs;
+    getSignatures(index) = signKeyInput(getTransactionPrefixHash(), input, info, ephKeys);
+    invalidateHash();
+}
 
-    for (const auto &o : info.outputs) {
-        keysPtrs.push_back(reinterpret_cast<const PublicKey *>(&o.targetKey));
-    }
+void TransactionImpl::signInputKeys(
+    size_t firstInput,
+    const std::vector<TransactionTypes::InputKeyInfo> &infos,
+    const std::vector<KeyPair> &ephKeys,
+    const std::function<void(size_t, const std::function<void(size_t)> &)> &forEach)
+{
+    assert(infos.size() == ephKeys.size());
 
-    signatures.resize(keysPtrs.size());
+    std::vector<const KeyInput *> inputs;
+    for (size_t i = 0; i < infos.size(); ++i) {
+        inputs.push_back(&boost::get<KeyInput>(
+            getInputChecked(transaction, firstInput + i, TransactionTypes::InputType::Key)
+        ));
+    }
 
-    generateRingSignature(reinterpret_cast<const Hash &>(prefixHash),
-                          reinterpret_cast<const KeyImage &>(input.keyImage), keysPtrs,
-                          reinterpret_cast<const SecretKey &>(ephKeys.secretKey),
-                          info.realOutput.transactionIndex, signatures.data());
+    Hash prefixHash = getTransactionPrefixHash();
+    std::vector<std::vector<Signature>> signatures(infos.size());
+    forEach(infos.size(), [&](size_t i) {
+        signatures[i] = signKeyInput(prefixHash, *inputs[i], infos[i], ephKeys[i]);
+    });
 
-    getSignatures(index) = signatures;
+    for (size_t i = 0; i < signatures.size(); ++i) {
+        getSignatures(firstInput + i) = std::move(signatures[i]);
+    }
     invalidateHash();
 }
 
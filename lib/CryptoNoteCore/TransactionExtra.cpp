@@ -35,9 +35,13 @@ using namespace Common;
 
 namespace CryptoNote {
 
+namespace {
+
+// view tags are only read when asked for, nodes skip their tag byte as an unknown one
 bool parseTransactionExtra(
     const std::vector<uint8_t> &transactionExtra,
-    std::vector<TransactionExtraField> &transactionExtraFields)
+    std::vector<TransactionExtraField> &transactionExtraFields,
+    TransactionExtraViewTags *viewTags)
 {
     transactionExtraFields.clear();
 
@@ -111,6 +115,23 @@ bool parseTransactionExtra(
                 ar(sender.data, "sender");
                 transactionExtraFields.push_back(sender);
                 break;
+            }
+            case TX_EXTRA_VIEW_TAGS: {
+                if (viewTags == nullptr) {
+                    break;
+                }
+
+                uint64_t size;
+                readVarint(iss, size);
+                if (size > transactionExtra.size()) {
+                    return false;
+                }
+
+                viewTags->tags.resize(static_cast<size_t>(size));
+                if (size > 0) {
+                    read(iss, viewTags->tags.data(), viewTags->tags.size());
+                }
+                break;
             }}
         }
     } catch (std::exception &) {
@@ -120,6 +141,15 @@ bool parseTransactionExtra(
     return true;
 }
 
+} // namespace
+
+bool parseTransactionExtra(
+    const std::vector<uint8_t> &transactionExtra,
+    std::vector<TransactionExtraField> &transactionExtraFields)
+{
+    return parseTransactionExtra(transactionExtra, transactionExtraFields, nullptr);
+}
+
 struct ExtraSerializerVisitor : public boost::static_visitor<bool>
 {
     ExtraSerializerVisitor(std::vector<uint8_t> &tx_extra)
@@ -289,6 +319,29 @@ void appendTTLToExtra(std::vector<uint8_t> &tx_extra, uint64_t ttl)
     std::copy(ttlData.begin(), ttlData.end(), std::back_inserter(tx_extra));
 }
 
+void appendViewTagsToExtra(std::vector<uint8_t> &tx_extra, const TransactionExtraViewTags &viewTags)
+{
+    std::string size = Tools::get_varint_data(viewTags.tags.size());
+
+    tx_extra.reserve(tx_extra.size() + 1 + size.size() + viewTags.tags.size());
+    tx_extra.push_back(TX_EXTRA_VIEW_TAGS);
+    std::copy(size.begin(), size.end(), std::back_inserter(tx_extra));
+    std::copy(viewTags.tags.begin(), viewTags.tags.end(), std::back_inserter(tx_extra));
+}
+
+bool getViewTagsFromExtra(const std::vector<uint8_t> &tx_extra, TransactionExtraViewTags &viewTags)
+{
+    std::vector<TransactionExtraField> tx_extra_fields;
+    TransactionExtraViewTags found;
+    if (!parseTransactionExtra(tx_extra, tx_extra_fields, &found) || found.tags.empty()) {
+        return false;
+    }
+
+    viewTags.tags.swap(found.tags);
+
+    return true;
+}
+
 bool appendSenderToExtra(std::vector<uint8_t> &tx_extra, const tx_extra_sender &sender)
 {
     BinaryArray blob;
@@ -33,6 +33,7 @@
 #define TX_EXTRA_MESSAGE_TAG 0x04
 #define TX_EXTRA_TTL 0x05
 #define TX_EXTRA_SENDER_TAG 0x06
+#define TX_EXTRA_VIEW_TAGS 0x07
 
 #define TX_EXTRA_NONCE_PAYMENT_ID 0x00
 
@@ -106,6 +107,15 @@ struct TransactionExtraTTL
     uint64_t ttl;
 };
 
+// One Crypto::deriveViewTag() byte per output, lets the receiver skip most outputs that
+// are not addressed to it without underiving their keys. Tags of non key outputs are ignored.
+// Not a TransactionExtraField, nodes parse the extra as before and skip the tag byte, only
+// getViewTagsFromExtra() reads the field.
+struct TransactionExtraViewTags
+{
+    std::vector<uint8_t> tags;
+};
+
 /*!
     tx_extra_field format, except tx_extra_padding and tx_extra_pub_key:
     - varint tag;
@@ -160,6 +170,8 @@ bool getMergeMiningTagFromExtra(const std::vector<uint8_t> &tx_extra, Transactio
 bool appendMessageToExtra(std::vector<uint8_t> &tx_extra, const tx_extra_message &message);
 bool appendSenderToExtra(std::vector<uint8_t> &tx_extra, const tx_extra_sender &sender);
 void appendTTLToExtra(std::vector<uint8_t> &tx_extra, uint64_t ttl);
+void appendViewTagsToExtra(std::vector<uint8_t> &tx_extra, const TransactionExtraViewTags &viewTags);
+bool getViewTagsFromExtra(const std::vector<uint8_t> &tx_extra, TransactionExtraViewTags &viewTags);
 std::vector<std::string> getMessagesFromExtra(
     const std::vector<uint8_t> &extra,
     const Crypto::PublicKey &txkey,
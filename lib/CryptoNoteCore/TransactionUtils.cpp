@@ -140,6 +140,32 @@ bool isOutToKey(
     return pk == outKey;
 }
 
+KeyInput makeKeyInput(
+    const AccountKeys &senderKeys,
+    const TransactionTypes::InputKeyInfo &info,
+    KeyPair &ephKeys)
+{
+    KeyInput input;
+    input.amount = info.amount;
+
+    generate_key_image_helper(
+        senderKeys,
+        info.realOutput.transactionPublicKey,
+        info.realOutput.outputInTransaction,
+        ephKeys,
+        input.keyImage
+    );
+
+    // fill outputs array and use relative offsets
+    for (const auto &out : info.outputs) {
+        input.outputIndexes.push_back(out.outputIndex);
+    }
+
+    input.outputIndexes = absolute_output_offsets_to_relative(input.outputIndexes);
+
+    return input;
+}
+
 bool findOutputsToAccount(
     const CryptoNote::TransactionPrefix &transaction,
     const AccountPublicAddress &addr,
@@ -39,6 +39,13 @@ bool isOutToKey(
     const Crypto::KeyDerivation &derivation,
     size_t keyIndex);
 
+// Derives the key image and the relative output offsets of an input spending info.realOutput.
+// Thread safe, so the inputs of one transaction can be made in parallel.
+KeyInput makeKeyInput(
+    const AccountKeys &senderKeys,
+    const TransactionTypes::InputKeyInfo &info,
+    KeyPair &ephKeys);
+
 // TransactionOutput helper functions
 TransactionTypes::OutputType getTransactionOutputType(const TransactionOutputTarget &out);
 const TransactionOutput &getOutputChecked(const TransactionPrefix &transaction, size_t index);
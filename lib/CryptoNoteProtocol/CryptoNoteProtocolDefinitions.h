@@ -181,4 +181,26 @@ struct NOTIFY_REQUEST_TX_POOL {
     typedef NOTIFY_REQUEST_TX_POOL_request request;
 };
 
+struct NOTIFY_NEW_TRANSACTION_HASHES_request {
+    void serialize(ISerializer &s) { serializeAsBinary(txs, "txs", s); }
+
+    std::vector<Crypto::Hash> txs;
+};
+
+struct NOTIFY_NEW_TRANSACTION_HASHES {
+    const static int ID = BC_COMMANDS_POOL_BASE + 9;
+    typedef NOTIFY_NEW_TRANSACTION_HASHES_request request;
+};
+
+struct NOTIFY_REQUEST_TRANSACTIONS_request {
+    void serialize(ISerializer &s) { serializeAsBinary(txs, "txs", s); }
+
+    std::vector<Crypto::Hash> txs;
+};
+
+struct NOTIFY_REQUEST_TRANSACTIONS {
+    const static int ID = BC_COMMANDS_POOL_BASE + 10;
+    typedef NOTIFY_REQUEST_TRANSACTIONS_request request;
+};
+
 } // namespace CryptoNote
@@ -296,6 +296,8 @@ int CryptoNoteProtocolHandler::handleCommand(bool is_notify,
     HANDLE_NOTIFY(NOTIFY_REQUEST_CHAIN, &CryptoNoteProtocolHandler::handle_request_chain)
     HANDLE_NOTIFY(NOTIFY_RESPONSE_CHAIN_ENTRY, &CryptoNoteProtocolHandler::handle_response_chain_entry)
     HANDLE_NOTIFY(NOTIFY_REQUEST_TX_POOL, &CryptoNoteProtocolHandler::handleRequestTxPool)
+    HANDLE_NOTIFY(NOTIFY_NEW_TRANSACTION_HASHES, &CryptoNoteProtocolHandler::handleNewTransactionHashes)
+    HANDLE_NOTIFY(NOTIFY_REQUEST_TRANSACTIONS, &CryptoNoteProtocolHandler::handleRequestTransactions)
     default:
         handled = false;
     }
@@ -385,6 +387,9 @@ int CryptoNoteProtocolHandler::handle_notify_new_transactions(
             << transactionHash
             << " came in NOTIFY_NEW_TRANSACTIONS";
 
+        context.m_known_transactions.insert(transactionHash);
+        m_requestedTransactions.erase(transactionHash);
+
         CryptoNote::tx_verification_context tvc = boost::value_initialized<decltype(tvc)>();
         m_core.handle_incoming_tx(transactionBinary, tvc, false, false);
         if (tvc.m_verification_failed) {
@@ -398,8 +403,7 @@ int CryptoNoteProtocolHandler::handle_notify_new_transactions(
     }
 
     if (!arg.txs.empty()) {
-        //TODO: add announce usage here
-        relay_post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, arg, &context.m_connection_id);
+        relayTransactions(arg.txs);
     }
 
     return true;
@@ -456,6 +460,22 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(
 {
     logger(Logging::TRACE) << context << "NOTIFY_RESPONSE_GET_OBJECTS";
 
+    if (context.m_sync.discardResponse()) {
+        logger(Logging::DEBUGGING) << context << "Dropping response to a cancelled request";
+        return 1;
+    }
+
+    size_t responseSize = 0;
+    for (const BlockCompleteEntry &block_entry : arg.blocks) {
+        responseSize += block_entry.block.size();
+        for (const auto &tx_blob : block_entry.txs) {
+            responseSize += tx_blob.size();
+        }
+    }
+
+    size_t expectedBlocks = context.m_sync.expectedBlocks();
+    context.m_sync.onResponseReceived(arg.blocks.size(), responseSize);
+
     if (context.m_last_response_height > arg.current_blockchain_height) {
         logger(Logging::ERROR)
             << context
@@ -482,6 +502,7 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(
                 << "sent wrong block: failed to parse and validate block: \r\n"
                 << toHex(asBinaryArray(block_entry.block))
                 << "\r\n dropping connection";
+            ++context.m_invalid_objects;
             context.m_state = CryptoNoteConnectionContext::state_shutdown;
             return 1;
         }
@@ -493,6 +514,7 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(
                 context.m_state = CryptoNoteConnectionContext::state_idle;
                 context.m_needed_objects.clear();
                 context.m_requested_objects.clear();
+                context.m_sync.cancelRequests();
                 logger(Logging::DEBUGGING) << context << "Connection set to idle state.";
                 return 1;
             }
@@ -524,11 +546,13 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(
         context.m_requested_objects.erase(req_it);
     }
 
-    if (context.m_requested_objects.size()) {
+    if (arg.blocks.size() != expectedBlocks) {
         logger(Logging::ERROR, Logging::BRIGHT_RED)
             << context
-            << "returned not all requested objects (context.m_requested_objects.size()="
-            << context.m_requested_objects.size()
+            << "returned not all requested objects (blocks.size()="
+            << arg.blocks.size()
+            << ", requested "
+            << expectedBlocks
             << "), "
             << "dropping connection";
         context.m_state = CryptoNoteConnectionContext::state_shutdown;
@@ -581,6 +605,7 @@ int CryptoNoteProtocolHandler::processObjects(CryptoNoteConnectionContext &conte
                     << "transaction verification failed on NOTIFY_RESPONSE_GET_OBJECTS,\r\ntx_id = "
                     << Common::podToHex(getBinaryArrayHash(asBinaryArray(tx_blob)))
                     << ", dropping connection";
+                ++context.m_invalid_objects;
                 context.m_state = CryptoNoteConnectionContext::state_shutdown;
                 return 1;
             }
@@ -594,6 +619,7 @@ int CryptoNoteProtocolHandler::processObjects(CryptoNoteConnectionContext &conte
             logger(Logging::DEBUGGING)
                 << context
                 << "Block verification failed, dropping connection";
+            ++context.m_invalid_objects;
             context.m_state = CryptoNoteConnectionContext::state_shutdown;
             return 1;
         } else if (bvc.m_marked_as_orphaned) {
@@ -609,6 +635,7 @@ int CryptoNoteProtocolHandler::processObjects(CryptoNoteConnectionContext &conte
             context.m_state = CryptoNoteConnectionContext::state_idle;
             context.m_needed_objects.clear();
             context.m_requested_objects.clear();
+            context.m_sync.cancelRequests();
             return 1;
         }
 
@@ -670,24 +697,39 @@ bool CryptoNoteProtocolHandler::request_missing_objects(CryptoNoteConnectionCont
                                                         bool check_having_blocks)
 {
     if (context.m_needed_objects.size()) {
-        // we know objects that we need, request this objects
-        NOTIFY_REQUEST_GET_OBJECTS::request req;
-        size_t count = 0;
-        auto it = context.m_needed_objects.begin();
-
-        while (it != context.m_needed_objects.end() && count < BLOCKS_SYNCHRONIZING_DEFAULT_COUNT) {
-            if (!(check_having_blocks && m_core.have_block(*it))) {
-                req.blocks.push_back(*it);
-                ++count;
-                context.m_requested_objects.insert(*it);
+        // we know objects that we need, keep a few batches of them requested
+        while (context.m_needed_objects.size() && context.m_sync.canRequest()) {
+            NOTIFY_REQUEST_GET_OBJECTS::request req;
+            size_t batchSize = context.m_sync.nextBatchSize();
+            auto it = context.m_needed_objects.begin();
+
+            while (it != context.m_needed_objects.end() && req.blocks.size() < batchSize) {
+                if (!(check_having_blocks && m_core.have_block(*it))) {
+                    req.blocks.push_back(*it);
+                    context.m_requested_objects.insert(*it);
+                }
+                it = context.m_needed_objects.erase(it);
+            }
+
+            if (req.blocks.empty()) {
+                break;
             }
-            it = context.m_needed_objects.erase(it);
+
+            logger(Logging::TRACE)
+                << context
+                << "-->>NOTIFY_REQUEST_GET_OBJECTS: blocks.size()=" << req.blocks.size()
+                << ", txs.size()=" << req.txs.size()
+                << ", requests in flight=" << context.m_sync.requestsInFlight() + 1;
+            context.m_sync.onRequestSent(req.blocks.size());
+            post_notify<NOTIFY_REQUEST_GET_OBJECTS>(*m_p2p, req, context);
         }
-        logger(Logging::TRACE)
-            << context
-            << "-->>NOTIFY_REQUEST_GET_OBJECTS: blocks.size()=" << req.blocks.size()
-            << ", txs.size()=" << req.txs.size();
-        post_notify<NOTIFY_REQUEST_GET_OBJECTS>(*m_p2p, req, context);
+
+        if (context.m_sync.requestsInFlight() == 0) {
+            // everything left to download was already here
+            return request_missing_objects(context, check_having_blocks);
+        }
+    } else if (context.m_sync.requestsInFlight()) {
+        // wait for the batches in flight before asking for more ids
     } else if (context.m_last_response_height < context.m_remote_blockchain_height - 1) {
         // we have to fetch more objects ids, request blockchain entry
         NOTIFY_REQUEST_CHAIN::request r = boost::value_initialized<NOTIFY_REQUEST_CHAIN::request>();
@@ -804,6 +846,10 @@ int CryptoNoteProtocolHandler::handleRequestTxPool(int command,
 {
     logger(Logging::TRACE) << context << "NOTIFY_REQUEST_TX_POOL: txs.size() = " << arg.txs.size();
 
+    for (const auto &hash : arg.txs) {
+        context.m_known_transactions.insert(hash);
+    }
+
     std::vector<Transaction> addedTransactions;
     std::vector<Crypto::Hash> deletedTransactions;
     m_core.getPoolChanges(arg.txs, addedTransactions, deletedTransactions);
@@ -812,6 +858,7 @@ int CryptoNoteProtocolHandler::handleRequestTxPool(int command,
         NOTIFY_NEW_TRANSACTIONS::request notification;
         for (auto &tx : addedTransactions) {
             notification.txs.push_back(asString(toBinaryArray(tx)));
+            context.m_known_transactions.insert(getObjectHash(tx));
         }
 
         bool ok = post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, notification, context);
@@ -825,6 +872,141 @@ int CryptoNoteProtocolHandler::handleRequestTxPool(int command,
     return 1;
 }
 
+int CryptoNoteProtocolHandler::handleNewTransactionHashes(
+    int command,
+    NOTIFY_NEW_TRANSACTION_HASHES::request &arg,
+    CryptoNoteConnectionContext &context)
+{
+    logger(Logging::TRACE)
+        << context
+        << "NOTIFY_NEW_TRANSACTION_HASHES: txs.size() = " << arg.txs.size();
+
+    if (context.m_state != CryptoNoteConnectionContext::state_normal) {
+        return 1;
+    }
+
+    if (arg.txs.size() > CURRENCY_PROTOCOL_MAX_OBJECT_REQUEST_COUNT) {
+        logger(Logging::DEBUGGING)
+            << context
+            << "Announced transactions count is too big (" << arg.txs.size()
+            << "), dropping connection";
+        m_p2p->drop_connection(context, true);
+        return 1;
+    }
+
+    for (const auto &hash : arg.txs) {
+        context.m_known_transactions.insert(hash);
+    }
+
+    std::list<Transaction> knownTransactions;
+    std::list<Crypto::Hash> missedTransactions;
+    m_core.getTransactions(arg.txs, knownTransactions, missedTransactions, true);
+
+    auto now = std::chrono::steady_clock::now();
+    auto timeout = std::chrono::seconds(P2P_TX_REQUEST_TIMEOUT);
+    for (auto it = m_requestedTransactions.begin(); it != m_requestedTransactions.end();) {
+        if (now - it->second >= timeout) {
+            it = m_requestedTransactions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    NOTIFY_REQUEST_TRANSACTIONS::request request;
+    for (const auto &hash : missedTransactions) {
+        if (m_requestedTransactions.emplace(hash, now).second) {
+            request.txs.push_back(hash);
+        }
+    }
+
+    if (!request.txs.empty()) {
+        logger(Logging::TRACE)
+            << context
+            << "-->>NOTIFY_REQUEST_TRANSACTIONS: txs.size() = " << request.txs.size();
+        post_notify<NOTIFY_REQUEST_TRANSACTIONS>(*m_p2p, request, context);
+    }
+
+    return 1;
+}
+
+int CryptoNoteProtocolHandler::handleRequestTransactions(
+    int command,
+    NOTIFY_REQUEST_TRANSACTIONS::request &arg,
+    CryptoNoteConnectionContext &context)
+{
+    logger(Logging::TRACE)
+        << context
+        << "NOTIFY_REQUEST_TRANSACTIONS: txs.size() = " << arg.txs.size();
+
+    if (arg.txs.size() > CURRENCY_PROTOCOL_MAX_OBJECT_REQUEST_COUNT) {
+        logger(Logging::DEBUGGING)
+            << context
+            << "Requested transactions count is too big (" << arg.txs.size()
+            << "), dropping connection";
+        m_p2p->drop_connection(context, true);
+        return 1;
+    }
+
+    std::list<Transaction> transactions;
+    std::list<Crypto::Hash> missedTransactions;
+    m_core.getTransactions(arg.txs, transactions, missedTransactions, true);
+
+    if (!transactions.empty()) {
+        NOTIFY_NEW_TRANSACTIONS::request notification;
+        for (const auto &tx : transactions) {
+            notification.txs.push_back(asString(toBinaryArray(tx)));
+        }
+
+        post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, notification, context);
+    }
+
+    return 1;
+}
+
+void CryptoNoteProtocolHandler::relayTransactions(const std::vector<std::string> &txs)
+{
+    std::vector<Crypto::Hash> hashes;
+    hashes.reserve(txs.size());
+    for (const auto &tx : txs) {
+        hashes.push_back(getBinaryArrayHash(asBinaryArray(tx)));
+    }
+
+    m_p2p->for_each_connection([&](CryptoNoteConnectionContext &conn, PeerIdType peerId) {
+        if (peerId == 0
+            || (conn.m_state != CryptoNoteConnectionContext::state_normal
+                && conn.m_state != CryptoNoteConnectionContext::state_synchronizing)) {
+            return;
+        }
+
+        // new peers get hashes only and fetch what they miss, old ones still get full blobs
+        if (conn.version >= P2P_TX_INVENTORY_VERSION) {
+            NOTIFY_NEW_TRANSACTION_HASHES::request announce;
+            for (const auto &hash : hashes) {
+                if (!conn.m_known_transactions.contains(hash)) {
+                    conn.m_known_transactions.insert(hash);
+                    announce.txs.push_back(hash);
+                }
+            }
+
+            if (!announce.txs.empty()) {
+                post_notify<NOTIFY_NEW_TRANSACTION_HASHES>(*m_p2p, announce, conn);
+            }
+        } else {
+            NOTIFY_NEW_TRANSACTIONS::request notification;
+            for (size_t i = 0; i < hashes.size(); ++i) {
+                if (!conn.m_known_transactions.contains(hashes[i])) {
+                    conn.m_known_transactions.insert(hashes[i]);
+                    notification.txs.push_back(txs[i]);
+                }
+            }
+
+            if (!notification.txs.empty()) {
+                post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, notification, conn);
+            }
+        }
+    });
+}
+
 void CryptoNoteProtocolHandler::relay_block(NOTIFY_NEW_BLOCK::request &arg)
 {
     auto buf = LevinProtocol::encode(arg);
@@ -833,8 +1015,11 @@ void CryptoNoteProtocolHandler::relay_block(NOTIFY_NEW_BLOCK::request &arg)
 
 void CryptoNoteProtocolHandler::relay_transactions(NOTIFY_NEW_TRANSACTIONS::request &arg)
 {
-    auto buf = LevinProtocol::encode(arg);
-    m_p2p->externalRelayNotifyToAll(NOTIFY_NEW_TRANSACTIONS::ID, buf, nullptr);
+    // may be called outside of the dispatcher thread, connections are only touched inside it
+    std::vector<std::string> txs = arg.txs;
+    m_dispatcher.remoteSpawn([this, txs] {
+        relayTransactions(txs);
+    });
 }
 
 void CryptoNoteProtocolHandler::requestMissingPoolTransactions(
@@ -19,6 +19,8 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <unordered_map>
 #include <Common/ObserverManager.h>
 #include <CryptoNoteCore/ICore.h>
 #include <CryptoNoteProtocol/CryptoNoteProtocolDefinitions.h>
@@ -102,6 +104,12 @@ private:
     int handleRequestTxPool(int command,
                             NOTIFY_REQUEST_TX_POOL::request &arg,
                             CryptoNoteConnectionContext &context);
+    int handleNewTransactionHashes(int command,
+                                   NOTIFY_NEW_TRANSACTION_HASHES::request &arg,
+                                   CryptoNoteConnectionContext &context);
+    int handleRequestTransactions(int command,
+                                  NOTIFY_REQUEST_TRANSACTIONS::request &arg,
+                                  CryptoNoteConnectionContext &context);
 
     //----------------- i_cryptonote_protocol ----------------------------------
     void relay_block(NOTIFY_NEW_BLOCK::request &arg) override;
@@ -115,6 +123,7 @@ private:
     void recalculateMaxObservedHeight(const CryptoNoteConnectionContext &context);
     int processObjects(CryptoNoteConnectionContext &context,
                        const std::vector<BlockCompleteEntry> &blocks);
+    void relayTransactions(const std::vector<std::string> &txs);
 
     Logging::LoggerRef logger;
 
@@ -133,6 +142,9 @@ private:
 
     std::atomic<size_t> m_peersCount;
     Tools::ObserverManager<ICryptoNoteProtocolObserver> m_observerManager;
+
+    // announced transactions we asked a peer for, so other announcers are not asked as well
+    std::unordered_map<Crypto::Hash, std::chrono::steady_clock::time_point> m_requestedTransactions;
 };
 
 } // namespace CryptoNote
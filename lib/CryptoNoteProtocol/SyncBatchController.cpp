@@ -0,0 +1,135 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cstdint>
+#include <CryptoNoteProtocol/SyncBatchController.h>
+#include <Global/CryptoNoteConfig.h>
+
+namespace CryptoNote {
+
+namespace {
+
+const double MEASUREMENT_WEIGHT = 0.3;
+
+double smooth(double average, double sample)
+{
+    return average == 0 ? sample : average + MEASUREMENT_WEIGHT * (sample - average);
+}
+
+} // namespace
+
+SyncBatchController::SyncBatchController()
+    : m_cancelledRequests(0),
+      m_bytesPerSecond(0),
+      m_bytesPerBlock(0),
+      m_roundTrip(0)
+{
+}
+
+size_t SyncBatchController::nextBatchSize() const
+{
+    if (m_bytesPerSecond == 0 || m_bytesPerBlock == 0) {
+        return BLOCKS_SYNCHRONIZING_DEFAULT_COUNT;
+    }
+
+    double batchBytes = m_bytesPerSecond * BLOCKS_SYNCHRONIZING_BATCH_DURATION / 1000;
+    batchBytes = std::max(batchBytes, static_cast<double>(BLOCKS_SYNCHRONIZING_MIN_BATCH_SIZE));
+    batchBytes = std::min(batchBytes, static_cast<double>(BLOCKS_SYNCHRONIZING_MAX_BATCH_SIZE));
+
+    size_t count = static_cast<size_t>(batchBytes / m_bytesPerBlock);
+
+    return std::min(std::max(count, BLOCKS_SYNCHRONIZING_MIN_COUNT), BLOCKS_SYNCHRONIZING_MAX_COUNT);
+}
+
+bool SyncBatchController::canRequest() const
+{
+    // keep a single request in flight until the first measurement is taken
+    if (m_bytesPerSecond == 0) {
+        return m_requests.empty();
+    }
+
+    // one batch being transferred plus the ones covering the round trip
+    size_t limit = 2 + static_cast<size_t>(m_roundTrip.count() / BLOCKS_SYNCHRONIZING_BATCH_DURATION);
+
+    return m_requests.size() < std::min(limit, BLOCKS_SYNCHRONIZING_MAX_REQUESTS_IN_FLIGHT);
+}
+
+size_t SyncBatchController::requestsInFlight() const
+{
+    return m_requests.size();
+}
+
+size_t SyncBatchController::expectedBlocks() const
+{
+    return m_requests.empty() ? 0 : m_requests.front().blocks;
+}
+
+void SyncBatchController::onRequestSent(size_t blocks, Clock::time_point now)
+{
+    m_requests.push_back({ now, blocks });
+}
+
+void SyncBatchController::onResponseReceived(size_t blocks, size_t bytes, Clock::time_point now)
+{
+    if (m_requests.empty()) {
+        return;
+    }
+
+    // the peer starts sending a pipelined response only after the previous one was sent
+    Clock::time_point sent = m_requests.front().sent;
+    Clock::time_point start = std::max(sent, m_lastResponse);
+    m_requests.pop_front();
+    m_lastResponse = now;
+
+    // a response that waited behind the previous one says nothing about the round trip
+    if (start == sent) {
+        auto roundTrip = std::chrono::duration_cast<std::chrono::milliseconds>(now - sent);
+        m_roundTrip = std::chrono::milliseconds(static_cast<int64_t>(
+            smooth(static_cast<double>(m_roundTrip.count()), static_cast<double>(roundTrip.count()))));
+    }
+
+    if (blocks == 0 || bytes == 0) {
+        return;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - start).count();
+    if (elapsed > 0) {
+        m_bytesPerSecond = smooth(m_bytesPerSecond, bytes * 1000000.0 / elapsed);
+    }
+
+    m_bytesPerBlock = smooth(m_bytesPerBlock, static_cast<double>(bytes) / blocks);
+}
+
+void SyncBatchController::cancelRequests()
+{
+    m_cancelledRequests += m_requests.size();
+    m_requests.clear();
+}
+
+bool SyncBatchController::discardResponse()
+{
+    if (m_cancelledRequests == 0) {
+        return false;
+    }
+
+    --m_cancelledRequests;
+
+    return true;
+}
+
+} // namespace CryptoNote
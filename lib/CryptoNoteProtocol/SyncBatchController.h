@@ -0,0 +1,73 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+
+namespace CryptoNote {
+
+/*!
+    Sizes and paces NOTIFY_REQUEST_GET_OBJECTS batches of a single connection.
+
+    The batch size follows the measured throughput of the peer, so that one batch takes
+    roughly BLOCKS_SYNCHRONIZING_BATCH_DURATION to transfer, and enough batches are kept
+    in flight to cover the round trip. Responses arrive in request order.
+*/
+class SyncBatchController
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    SyncBatchController();
+
+    size_t nextBatchSize() const;
+    bool canRequest() const;
+    size_t requestsInFlight() const;
+    // blocks count the oldest request in flight is waiting for, zero if none
+    size_t expectedBlocks() const;
+
+    void onRequestSent(size_t blocks, Clock::time_point now = Clock::now());
+    void onResponseReceived(size_t blocks, size_t bytes, Clock::time_point now = Clock::now());
+
+    // Forgets the requests in flight, their responses are to be dropped with discardResponse().
+    void cancelRequests();
+    // Returns true if the response belongs to a cancelled request.
+    bool discardResponse();
+
+    double bytesPerSecond() const { return m_bytesPerSecond; }
+    double bytesPerBlock() const { return m_bytesPerBlock; }
+    std::chrono::milliseconds roundTrip() const { return m_roundTrip; }
+
+private:
+    struct Request
+    {
+        Clock::time_point sent;
+        size_t blocks;
+    };
+
+    std::deque<Request> m_requests;
+    size_t m_cancelledRequests;
+    Clock::time_point m_lastResponse;
+    double m_bytesPerSecond;
+    double m_bytesPerBlock;
+    std::chrono::milliseconds m_roundTrip;
+};
+
+} // namespace CryptoNote
@@ -182,7 +182,15 @@ const uint8_t  BLOCK_MINOR_VERSION_1                         =  1;
 
 const size_t   BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT        =  10000; // by default, blocks ids count in synchronizing
 const size_t   BLOCKS_SYNCHRONIZING_DEFAULT_COUNT            =  128; // by default, blocks count in blocks downloading
+const size_t   BLOCKS_SYNCHRONIZING_MIN_COUNT                =  8;   // bounds for the adaptive blocks count in blocks downloading
+const size_t   BLOCKS_SYNCHRONIZING_MAX_COUNT                =  500; // must not exceed what peers accept per request
+const size_t   BLOCKS_SYNCHRONIZING_MIN_BATCH_SIZE           =  256 * 1024;       // bytes
+const size_t   BLOCKS_SYNCHRONIZING_MAX_BATCH_SIZE           =  16 * 1024 * 1024; // bytes
+const uint32_t BLOCKS_SYNCHRONIZING_BATCH_DURATION           =  2000; // milliseconds of transfer one batch should take
+const size_t   BLOCKS_SYNCHRONIZING_MAX_REQUESTS_IN_FLIGHT   =  3;
 const size_t   COMMAND_RPC_GET_BLOCKS_FAST_MAX_COUNT         =  1000;
+const size_t   BLOCK_ENTRY_CACHE_MAX_SIZE                    =  32 * 1024 * 1024; // bytes of serialized blocks kept for wallet sync queries, per query kind
+const size_t   RPC_RESPONSE_CACHE_MAX_SIZE                   =  16 * 1024 * 1024; // bytes of answers kept for requests that only read the main chain
 
 const int      P2P_DEFAULT_PORT                              =  5196;
 const int      RPC_DEFAULT_PORT                              =  5197;
@@ -193,9 +201,14 @@ const size_t   P2P_LOCAL_GRAY_PEERLIST_LIMIT                 =  5000;
 
 // P2P Network Configuration Section - This defines our current P2P network version
 // and the minimum version for communication between nodes
-const uint8_t  P2P_CURRENT_VERSION                           = 1;
+const uint8_t  P2P_CURRENT_VERSION                           = 3;
 const uint8_t  P2P_MINIMUM_VERSION                           = 1;
 
+// Peers at or above this version announce new transactions by hash and fetch the blobs on demand.
+const uint8_t  P2P_TX_INVENTORY_VERSION                      = 2;
+// Peers at or above this version accept compressed Levin message bodies.
+const uint8_t  P2P_COMPRESSION_VERSION                       = 3;
+
 // This defines the number of versions ahead we must see peers before we start displaying
 // warning messages that we need to upgrade our software.
 const uint8_t  P2P_UPGRADE_WINDOW                            = 1;
@@ -203,6 +216,7 @@ const uint8_t  P2P_UPGRADE_WINDOW                            = 1;
 const size_t   P2P_CONNECTION_MAX_WRITE_BUFFER_SIZE          = 64 * 1024 * 1024; // 64 MB
 const uint32_t P2P_DEFAULT_CONNECTIONS_COUNT                 = 8;
 const size_t   P2P_DEFAULT_WHITELIST_CONNECTIONS_PERCENT     = 70;
+const size_t   P2P_DEFAULT_EXPLORATION_CONNECTIONS           = 2;             // outbound slots not chosen by peer score
 const uint32_t P2P_DEFAULT_HANDSHAKE_INTERVAL                = 60;            // seconds
 const uint32_t P2P_DEFAULT_PACKET_MAX_SIZE                   = 50000000;      // 50000000 bytes maximum packet size
 const uint32_t P2P_DEFAULT_PEERS_IN_HANDSHAKE                = 250;
@@ -214,6 +228,8 @@ const uint32_t P2P_FAILED_ADDR_FORGET_SECONDS                = (60 * 60);     //
 const uint32_t P2P_IP_BLOCKTIME                              = (60 * 60 * 24);//24 hour
 const uint32_t P2P_IP_FAILS_BEFORE_BLOCK                     = 10;
 const uint32_t P2P_IDLE_CONNECTION_KILL_INTERVAL             = (5 * 60);      //5 minutes
+const size_t   P2P_KNOWN_TRANSACTIONS_LIMIT                  = 10000;         // per connection
+const uint32_t P2P_TX_REQUEST_TIMEOUT                        = 30;            // seconds
 const char     P2P_STAT_TRUSTED_PUB_KEY[]                    = "07190a04cf6b457c09e39c9c90b1f8da9d263d1101318884a194b47ca6590e43";
 
 const char        LATEST_VERSION_URL[]                       = "https://releases.qwertycoin.org";
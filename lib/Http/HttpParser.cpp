@@ -18,6 +18,7 @@
 // along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <algorithm>
+#include <cstring>
 #include <Http/HttpParser.h>
 #include <Http/HttpParserErrorCodes.h>
 
@@ -38,10 +39,195 @@ void throwIfNotGood(std::istream &stream)
     }
 }
 
+const size_t MAX_HEAD_SIZE = 64 * 1024;
+const size_t MAX_BODY_SIZE = 64 * 1024 * 1024;
+
+void throwError(CryptoNote::error::HttpParserErrorCodes code)
+{
+    throw std::system_error(make_error_code(code));
+}
+
+// position of the "\r\n" ending the line that starts at begin
+const char *findLineEnd(const char *begin, const char *end)
+{
+    for (;;) {
+        auto cr = static_cast<const char *>(std::memchr(begin, '\r', end - begin));
+        if (cr == nullptr || cr + 1 >= end) {
+            return nullptr;
+        }
+
+        if (cr[1] == '\n') {
+            return cr;
+        }
+
+        begin = cr + 1;
+    }
+}
+
+const char *skipBlanks(const char *begin, const char *end)
+{
+    while (begin != end && (*begin == ' ' || *begin == '\t')) {
+        ++begin;
+    }
+
+    return begin;
+}
+
+const char *trimBlanks(const char *begin, const char *end)
+{
+    while (end != begin && (end[-1] == ' ' || end[-1] == '\t')) {
+        --end;
+    }
+
+    return end;
+}
+
+bool equalsIgnoreCase(const std::string &value, const char *expected)
+{
+    size_t length = std::strlen(expected);
+    if (value.size() != length) {
+        return false;
+    }
+
+    for (size_t i = 0; i < length; ++i) {
+        if (::tolower(static_cast<unsigned char>(value[i])) != expected[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t parseContentLength(const std::string &value)
+{
+    if (value.empty()) {
+        throwError(CryptoNote::error::HttpParserErrorCodes::UNEXPECTED_SYMBOL);
+    }
+
+    size_t length = 0;
+    for (char c : value) {
+        if (c < '0' || c > '9') {
+            throwError(CryptoNote::error::HttpParserErrorCodes::UNEXPECTED_SYMBOL);
+        }
+
+        length = length * 10 + (c - '0');
+        if (length > MAX_BODY_SIZE) {
+            throwError(CryptoNote::error::HttpParserErrorCodes::MESSAGE_TOO_LARGE);
+        }
+    }
+
+    return length;
+}
+
 } // namespace
 
 namespace CryptoNote {
 
+size_t HttpParser::parseRequest(const char *data, size_t size, HttpRequest &request)
+{
+    const char *end = data + size;
+
+    // request line: method, target and version separated by single spaces
+    const char *lineEnd = findLineEnd(data, end);
+    if (lineEnd == nullptr) {
+        if (size > MAX_HEAD_SIZE) {
+            throwError(error::HttpParserErrorCodes::MESSAGE_TOO_LARGE);
+        }
+
+        return 0;
+    }
+
+    auto methodEnd = static_cast<const char *>(std::memchr(data, ' ', lineEnd - data));
+    if (methodEnd == nullptr || methodEnd == data) {
+        throwError(error::HttpParserErrorCodes::UNEXPECTED_SYMBOL);
+    }
+
+    const char *urlBegin = methodEnd + 1;
+    auto urlEnd = static_cast<const char *>(std::memchr(urlBegin, ' ', lineEnd - urlBegin));
+    if (urlEnd == nullptr || urlEnd == urlBegin) {
+        throwError(error::HttpParserErrorCodes::UNEXPECTED_SYMBOL);
+    }
+
+    const char *versionBegin = urlEnd + 1;
+    if (lineEnd - versionBegin != 8 || std::memcmp(versionBegin, "HTTP/1.", 7) != 0) {
+        throwError(error::HttpParserErrorCodes::UNEXPECTED_SYMBOL);
+    }
+
+    bool http10 = versionBegin[7] == '0';
+
+    // headers, up to the empty line
+    HttpRequest::Headers headers;
+    const char *line = lineEnd + 2;
+    for (;;) {
+        lineEnd = findLineEnd(line, end);
+        if (lineEnd == nullptr) {
+            if (size > MAX_HEAD_SIZE) {
+                throwError(error::HttpParserErrorCodes::MESSAGE_TOO_LARGE);
+            }
+
+            return 0;
+        }
+
+        if (lineEnd == line) {
+            break;
+        }
+
+        auto colon = static_cast<const char *>(std::memchr(line, ':', lineEnd - line));
+        if (colon == nullptr) {
+            throwError(error::HttpParserErrorCodes::UNEXPECTED_SYMBOL);
+        }
+
+        if (colon == line) {
+            throwError(error::HttpParserErrorCodes::EMPTY_HEADER);
+        }
+
+        std::string name(line, colon);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+        const char *valueBegin = skipBlanks(colon + 1, lineEnd);
+        headers[std::move(name)].assign(valueBegin, trimBlanks(valueBegin, lineEnd));
+
+        line = lineEnd + 2;
+    }
+
+    const char *body = lineEnd + 2;
+    if (static_cast<size_t>(body - data) > MAX_HEAD_SIZE) {
+        throwError(error::HttpParserErrorCodes::MESSAGE_TOO_LARGE);
+    }
+
+    if (headers.count("transfer-encoding") != 0) {
+        throwError(error::HttpParserErrorCodes::UNSUPPORTED_ENCODING);
+    }
+
+    size_t bodyLength = 0;
+    auto it = headers.find("content-length");
+    if (it != headers.end()) {
+        bodyLength = parseContentLength(it->second);
+    }
+
+    if (static_cast<size_t>(end - body) < bodyLength) {
+        return 0;
+    }
+
+    request.method.assign(data, methodEnd);
+    request.url.assign(urlBegin, urlEnd);
+    request.body.assign(body, bodyLength);
+    request.http10 = http10;
+
+    it = headers.find("connection");
+    if (it == headers.end()) {
+        request.keepAlive = !http10;
+    } else if (equalsIgnoreCase(it->second, "close")) {
+        request.keepAlive = false;
+    } else {
+        request.keepAlive = !http10 || equalsIgnoreCase(it->second, "keep-alive");
+    }
+
+    request.headers = std::move(headers);
+
+    return static_cast<size_t>(body - data) + bodyLength;
+}
+
 HttpResponse::HTTP_STATUS HttpParser::parseResponseStatusFromString(const std::string &status)
 {
   if (status == "200 OK" || status == "200 Ok") {
@@ -50,8 +236,12 @@ HttpResponse::HTTP_STATUS HttpParser::parseResponseStatusFromString(const std::s
       return CryptoNote::HttpResponse::STATUS_401;
   } else if (status == "404 Not Found") {
       return CryptoNote::HttpResponse::STATUS_404;
+  } else if (status == "429 Too Many Requests") {
+      return CryptoNote::HttpResponse::STATUS_429;
   } else if (status == "500 Internal Server Error") {
       return CryptoNote::HttpResponse::STATUS_500;
+  } else if (status == "503 Service Unavailable") {
+      return CryptoNote::HttpResponse::STATUS_503;
   } else {
       throw std::system_error(
           make_error_code(CryptoNote::error::HttpParserErrorCodes::UNEXPECTED_SYMBOL),
@@ -120,7 +310,10 @@ void HttpParser::receiveResponse(std::istream &stream, HttpResponse &response)
     }
 
     std::string body;
-    if (length) {
+    it = headers.find("transfer-encoding");
+    if (it != headers.end() && equalsIgnoreCase(it->second, "chunked")) {
+        readChunkedBody(stream, body);
+    } else if (length) {
         readBody(stream, body, length);
     }
 
@@ -235,6 +428,31 @@ void HttpParser::readBody(std::istream& stream, std::string &body, const size_t
     throwIfNotGood(stream);
 }
 
+void HttpParser::readChunkedBody(std::istream &stream, std::string &body)
+{
+    std::string line;
+    for (;;) {
+        std::getline(stream, line);
+        throwIfNotGood(stream);
+
+        // the size stops at chunk extensions or the line end, both are ignored
+        size_t size = std::stoul(line, nullptr, 16);
+        if (size == 0) {
+            break;
+        }
+
+        readBody(stream, body, size);
+        std::getline(stream, line);
+        throwIfNotGood(stream);
+    }
+
+    // trailers, up to the empty line
+    do {
+        std::getline(stream, line);
+        throwIfNotGood(stream);
+    } while (!line.empty() && line != "\r");
+}
+
 size_t HttpParser::getBodyLen(const HttpRequest::Headers &headers)
 {
     auto it = headers.find("content-length");
@@ -32,6 +32,11 @@ public:
     HttpParser() = default;
 
     void receiveRequest(std::istream &stream, HttpRequest &request);
+
+    // Parses the request at the start of data. Returns the number of bytes it takes,
+    // or 0 if data does not hold a complete request yet. Throws on malformed requests.
+    static size_t parseRequest(const char *data, size_t size, HttpRequest &request);
+
     void receiveResponse(std::istream &stream, HttpResponse &response);
     static HttpResponse::HTTP_STATUS parseResponseStatusFromString(const std::string &status);
 
@@ -40,6 +45,7 @@ private:
     static void readHeaders(std::istream &stream, HttpRequest::Headers &headers);
     static bool readHeader(std::istream &stream, std::string &name, std::string &value);
     static void readBody(std::istream &stream, std::string &body, const size_t bodyLen);
+    static void readChunkedBody(std::istream &stream, std::string &body);
     static size_t getBodyLen(const HttpRequest::Headers &headers);
 };
 
@@ -30,7 +30,9 @@ enum HttpParserErrorCodes
     STREAM_NOT_GOOD = 1,
     END_OF_STREAM,
     UNEXPECTED_SYMBOL,
-    EMPTY_HEADER
+    EMPTY_HEADER,
+    MESSAGE_TOO_LARGE,
+    UNSUPPORTED_ENCODING
 };
 
 class HttpParserErrorCategory : public std::error_category
@@ -59,6 +61,10 @@ public:
             return "Unexpected symbol";
         case EMPTY_HEADER:
             return "The header name is empty";
+        case MESSAGE_TOO_LARGE:
+            return "The message is too large";
+        case UNSUPPORTED_ENCODING:
+            return "Unsupported transfer encoding";
         default:
             return "Unknown error";
         }
@@ -40,6 +40,21 @@ const std::string &HttpRequest::getBody() const
     return body;
 }
 
+bool HttpRequest::isKeepAlive() const
+{
+    return keepAlive;
+}
+
+bool HttpRequest::acceptsChunked() const
+{
+    return !http10;
+}
+
+uint32_t HttpRequest::getPeerAddress() const
+{
+    return peerAddress;
+}
+
 void HttpRequest::addHeader(const std::string &name, const std::string &value)
 {
     headers[name] = value;
@@ -60,6 +75,11 @@ void HttpRequest::setUrl(const std::string &u)
     url = u;
 }
 
+void HttpRequest::setPeerAddress(uint32_t address)
+{
+    peerAddress = address;
+}
+
 std::ostream& HttpRequest::printHttpRequest(std::ostream &os) const
 {
     os << "POST " << url << " HTTP/1.1\r\n";
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <iostream>
 #include <map>
 #include <string>
@@ -34,16 +35,26 @@ public:
     const std::string &getUrl() const;
     const Headers &getHeaders() const;
     const std::string &getBody() const;
+    // false when the client asked to close the connection after the response
+    bool isKeepAlive() const;
+    // false for HTTP/1.0 clients, which cannot receive chunked bodies
+    bool acceptsChunked() const;
+    // the IPv4 address of the client as a number, 0 when it is not known
+    uint32_t getPeerAddress() const;
 
     void addHeader(const std::string &name, const std::string &value);
     void setBody(const std::string &b);
     void setUrl(const std::string &uri);
+    void setPeerAddress(uint32_t address);
 
 private:
     std::string method;
     std::string url;
     Headers headers;
     std::string body;
+    bool keepAlive = true;
+    bool http10 = false;
+    uint32_t peerAddress = 0;
 
     std::ostream &printHttpRequest(std::ostream &os) const;
 
@@ -17,6 +17,7 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <cstdio>
 #include <stdexcept>
 #include <Http/HttpResponse.h>
 
@@ -31,8 +32,12 @@ const char *getStatusString(CryptoNote::HttpResponse::HTTP_STATUS status)
         return "401 Unauthorized";
     case CryptoNote::HttpResponse::STATUS_404:
         return "404 Not Found";
+    case CryptoNote::HttpResponse::STATUS_429:
+        return "429 Too Many Requests";
     case CryptoNote::HttpResponse::STATUS_500:
         return "500 Internal Server Error";
+    case CryptoNote::HttpResponse::STATUS_503:
+        return "503 Service Unavailable";
     default:
         throw std::runtime_error("Unknown HTTP status code is given");
     }
@@ -45,8 +50,12 @@ const char *getErrorBody(CryptoNote::HttpResponse::HTTP_STATUS status)
         return "Authorization required\n";
     case CryptoNote::HttpResponse::STATUS_404:
         return "Requested url is not found\n";
+    case CryptoNote::HttpResponse::STATUS_429:
+        return "Too many requests\n";
     case CryptoNote::HttpResponse::STATUS_500:
         return "Internal server error is occurred\n";
+    case CryptoNote::HttpResponse::STATUS_503:
+        return "Server is busy\n";
     default:
         throw std::runtime_error("Error body for given status is not available");
     }
@@ -79,6 +88,8 @@ void HttpResponse::addHeader(const std::string &name, const std::string &value)
 void HttpResponse::setBody(const std::string &b)
 {
     body = b;
+    chunkedBody = nullptr;
+    headers.erase("Transfer-Encoding");
     if (!body.empty()) {
         headers["Content-Length"] = std::to_string(body.size());
     } else {
@@ -86,6 +97,39 @@ void HttpResponse::setBody(const std::string &b)
     }
 }
 
+void HttpResponse::setChunkedBody(ChunkSource source)
+{
+    body.clear();
+    chunkedBody = std::move(source);
+    headers.erase("Content-Length");
+    headers["Transfer-Encoding"] = "chunked";
+}
+
+void HttpResponse::appendHead(std::string &out) const
+{
+    out += "HTTP/1.1 ";
+    out += getStatusString(status);
+    out += "\r\n";
+
+    for (const auto &pair: headers) {
+        out += pair.first;
+        out += ": ";
+        out += pair.second;
+        out += "\r\n";
+    }
+
+    out += "\r\n";
+}
+
+void HttpResponse::appendChunk(std::string &out, const std::string &chunk)
+{
+    char size[20];
+    int length = snprintf(size, sizeof(size), "%zx\r\n", chunk.size());
+    out.append(size, static_cast<size_t>(length));
+    out += chunk;
+    out += "\r\n";
+}
+
 std::ostream &HttpResponse::printHttpResponse(std::ostream &os) const
 {
     os << "HTTP/1.1 " << getStatusString(status) << "\r\n";
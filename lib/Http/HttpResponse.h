@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <functional>
 #include <ostream>
 #include <string>
 #include <map>
@@ -35,23 +36,38 @@ public:
         STATUS_200,
         STATUS_401,
         STATUS_404,
-        STATUS_500
+        STATUS_429,
+        STATUS_500,
+        STATUS_503
     };
 
+    // appends the next part of a streamed body to chunk, returns false once the body is complete
+    typedef std::function<bool(std::string &chunk)> ChunkSource;
+
     HttpResponse();
 
     void setStatus(HTTP_STATUS s);
     void addHeader(const std::string &name, const std::string &value);
     void setBody(const std::string &b);
+    // the body is produced while it is sent, with chunked transfer-encoding
+    void setChunkedBody(ChunkSource source);
 
     const std::map<std::string, std::string> &getHeaders() const { return headers; }
     HTTP_STATUS getStatus() const { return status; }
     const std::string &getBody() const { return body; }
+    const ChunkSource &getChunkedBody() const { return chunkedBody; }
+    bool isChunked() const { return static_cast<bool>(chunkedBody); }
+
+    // appends the status line and the headers, followed by the empty line
+    void appendHead(std::string &out) const;
+    // appends one chunk of a chunked body, an empty one ends the body
+    static void appendChunk(std::string &out, const std::string &chunk);
 
 private:
     HTTP_STATUS status;
     std::map<std::string, std::string> headers;
     std::string body;
+    ChunkSource chunkedBody;
 
     std::ostream &printHttpResponse(std::ostream &os) const;
 
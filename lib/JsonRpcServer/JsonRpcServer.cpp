@@ -79,13 +79,26 @@ void JsonRpcServer::processRequest(const CryptoNote::HttpRequest &req,
                 return;
             }
 
-            processJsonRpcRequest(jsonRpcRequest, jsonRpcResponse);
-
-            std::ostringstream jsonOutputStream;
-            jsonOutputStream << jsonRpcResponse;
+            std::string body;
+            if (!jsonRpcRequest.isArray()) {
+                body = processJsonRpcCall(jsonRpcRequest);
+            } else if (jsonRpcRequest.size() == 0) {
+                makeJsonParsingErrorResponse(jsonRpcResponse);
+                body = jsonRpcResponse.toString();
+            } else {
+                // a batch, the calls are answered in order
+                body = "[";
+                for (size_t i = 0; i < jsonRpcRequest.size(); ++i) {
+                    if (i != 0) {
+                        body += ',';
+                    }
+                    body += processJsonRpcCall(jsonRpcRequest[i]);
+                }
+                body += ']';
+            }
 
             resp.setStatus(CryptoNote::HttpResponse::STATUS_200);
-            resp.setBody(jsonOutputStream.str());
+            resp.setBody(body);
         } else {
             logger(Logging::WARNING) << "Requested url \"" << req.getUrl() << "\" is not found";
             resp.setStatus(CryptoNote::HttpResponse::STATUS_404);
@@ -97,6 +110,23 @@ void JsonRpcServer::processRequest(const CryptoNote::HttpRequest &req,
     }
 }
 
+std::string JsonRpcServer::processJsonRpcCall(const Common::JsonValue &request)
+{
+    Common::JsonValue jsonRpcResponse(Common::JsonValue::OBJECT);
+    std::string result;
+    processJsonRpcRequest(request, jsonRpcResponse, result);
+
+    std::string body = jsonRpcResponse.toString();
+    if (!result.empty() && !jsonRpcResponse.contains("error")) {
+        body.pop_back();
+        body += body.size() > 1 ? ",\"result\":" : "\"result\":";
+        body += result;
+        body += '}';
+    }
+
+    return body;
+}
+
 void JsonRpcServer::prepareJsonResponse(const Common::JsonValue &req, Common::JsonValue &resp)
 {
     using Common::JsonValue;
@@ -65,11 +65,16 @@ protected:
     static void prepareJsonResponse(const Common::JsonValue &req, Common::JsonValue &resp);
     static void makeJsonParsingErrorResponse(Common::JsonValue &resp);
 
-    virtual void processJsonRpcRequest(const Common::JsonValue &req, Common::JsonValue &resp) = 0;
+    // A handler may leave the result already written out as JSON text in result, it is
+    // then appended to resp as its "result" member.
+    virtual void processJsonRpcRequest(const Common::JsonValue &req,
+                                       Common::JsonValue &resp,
+                                       std::string &result) = 0;
 
 private:
     void processRequest(const CryptoNote::HttpRequest &request,
                         CryptoNote::HttpResponse &response) override;
+    std::string processJsonRpcCall(const Common::JsonValue &request);
 
 private:
     System::Dispatcher &system;
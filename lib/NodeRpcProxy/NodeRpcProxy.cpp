@@ -153,6 +153,8 @@ void NodeRpcProxy::resetInternalState()
     lastLocalBlockHeaderInfo.difficulty = 0;
     lastLocalBlockHeaderInfo.reward = 0;
     m_knownTxs.clear();
+    m_binaryMethodsQueried = false;
+    m_binaryMethods.clear();
 }
 
 void NodeRpcProxy::workerThread(const INode::Callback &initialized_callback)
@@ -571,8 +573,14 @@ void NodeRpcProxy::getBlocks(const std::vector<uint32_t> &blockHeights,
         return;
     }
 
-    // TODO: NOT IMPLEMENTED!
-    callback(std::error_code{});
+    scheduleRequest(
+        std::bind(
+            &NodeRpcProxy::doGetBlocksByHeights,
+            this,
+            blockHeights,
+            std::ref(blocks)
+        ),
+        callback);
 }
 
 void NodeRpcProxy::getBlocks(uint64_t timestampBegin,
@@ -616,8 +624,14 @@ void NodeRpcProxy::getTransactions(const std::vector<Crypto::Hash> &transactionH
         return;
     }
 
-    // TODO: NOT IMPLEMENTED!
-    callback(std::error_code{});
+    scheduleRequest(
+        std::bind(
+            &NodeRpcProxy::doGetTransactions,
+            this,
+            transactionHashes,
+            std::ref(transactions)
+        ),
+        callback);
 }
 
 void NodeRpcProxy::getPoolTransactions(uint64_t timestampBegin,
@@ -776,6 +790,56 @@ std::error_code NodeRpcProxy::doQueryBlocksLite(const std::vector<Crypto::Hash>
     return std::error_code{};
 }
 
+std::error_code NodeRpcProxy::doGetBlocksByHeights(
+    const std::vector<uint32_t> &blockHeights,
+    std::vector<std::vector<BlockDetails>> &blocks)
+{
+    CryptoNote::COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS::request req = AUTO_VAL_INIT(req);
+    CryptoNote::COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS::response rsp = AUTO_VAL_INIT(rsp);
+
+    req.blockHeights = blockHeights;
+
+    std::error_code ec;
+    if (hasBinaryMethod("/get_blocks_details_by_heights.bin")) {
+        ec = binaryCommand("/get_blocks_details_by_heights.bin", req, rsp);
+    } else {
+        ec = jsonCommand("/get_blocks_details_by_heights", req, rsp);
+    }
+
+    if (!ec) {
+        blocks.clear();
+        blocks.reserve(rsp.blocks.size());
+        for (auto &block : rsp.blocks) {
+            blocks.emplace_back(1, std::move(block));
+        }
+    }
+
+    return ec;
+}
+
+std::error_code NodeRpcProxy::doGetTransactions(
+    const std::vector<Crypto::Hash> &transactionHashes,
+    std::vector<TransactionDetails> &transactions)
+{
+    CryptoNote::COMMAND_RPC_GET_TRANSACTIONS_DETAILS_BY_HASHES::request req = AUTO_VAL_INIT(req);
+    CryptoNote::COMMAND_RPC_GET_TRANSACTIONS_DETAILS_BY_HASHES::response rsp = AUTO_VAL_INIT(rsp);
+
+    req.transactionHashes = transactionHashes;
+
+    std::error_code ec;
+    if (hasBinaryMethod("/get_transaction_details_by_hashes.bin")) {
+        ec = binaryCommand("/get_transaction_details_by_hashes.bin", req, rsp);
+    } else {
+        ec = jsonCommand("/get_transaction_details_by_hashes", req, rsp);
+    }
+
+    if (!ec) {
+        transactions = std::move(rsp.transactions);
+    }
+
+    return ec;
+}
+
 std::error_code NodeRpcProxy::doGetPoolSymmetricDifference(
     std::vector<Crypto::Hash> &&knownPoolTxIds,
     Crypto::Hash knownBlockId,
@@ -868,6 +932,28 @@ void NodeRpcProxy::scheduleRequest(std::function<std::error_code()> &&procedure,
     }, std::move(procedure), callback));
 }
 
+bool NodeRpcProxy::hasBinaryMethod(const std::string &url)
+{
+    if (!m_binaryMethodsQueried) {
+        CryptoNote::COMMAND_RPC_GET_VERSION::request req = AUTO_VAL_INIT(req);
+        CryptoNote::COMMAND_RPC_GET_VERSION::response rsp = AUTO_VAL_INIT(rsp);
+
+        try {
+            EventLock eventLock(*m_httpEvent);
+            invokeJsonCommand(*m_httpClient, "/getversion", req, rsp);
+        } catch (const std::exception &) {
+            // unknown for now, fall back to json and ask again next time
+            return false;
+        }
+
+        // older nodes do not list any, they are asked only once
+        m_binaryMethods.insert(rsp.binary_methods.begin(), rsp.binary_methods.end());
+        m_binaryMethodsQueried = true;
+    }
+
+    return m_binaryMethods.count(url) != 0;
+}
+
 template <typename Request, typename Response>
 std::error_code NodeRpcProxy::binaryCommand(const std::string &url,
                                             const Request &req,
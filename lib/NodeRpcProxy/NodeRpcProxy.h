@@ -170,6 +170,10 @@ private:
                                       uint64_t timestamp,
                                       std::vector<CryptoNote::BlockShortEntry> &newBlocks,
                                       uint32_t &startHeight);
+    std::error_code doGetBlocksByHeights(const std::vector<uint32_t> &blockHeights,
+                                         std::vector<std::vector<BlockDetails>> &blocks);
+    std::error_code doGetTransactions(const std::vector<Crypto::Hash> &transactionHashes,
+                                      std::vector<TransactionDetails> &transactions);
     std::error_code doGetPoolSymmetricDifference(std::vector<Crypto::Hash> &&knownPoolTxIds,
                                                  Crypto::Hash knownBlockId,
                                                  bool &isBcActual,
@@ -180,6 +184,9 @@ private:
 
     void scheduleRequest(std::function<std::error_code()> &&procedure, const Callback &callback);
 
+    // asks /getversion once which binary endpoints the node serves
+    bool hasBinaryMethod(const std::string &url);
+
     template <typename Request, typename Response>
     std::error_code binaryCommand(const std::string &url, const Request &req, Response &res);
     template <typename Request, typename Response>
@@ -215,6 +222,9 @@ private:
     // protect it with mutex if decided to add worker threads
     std::unordered_set<Crypto::Hash> m_knownTxs;
 
+    bool m_binaryMethodsQueried = false;
+    std::unordered_set<std::string> m_binaryMethods;
+
     bool m_connected;
 };
 
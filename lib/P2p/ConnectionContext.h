@@ -18,15 +18,56 @@
 
 #pragma once
 
+#include <deque>
 #include <list>
 #include <ostream>
 #include <unordered_set>
 #include <boost/uuid/uuid.hpp>
 #include <Common/StringTools.h>
 #include <crypto/hash.h>
+#include <CryptoNoteProtocol/SyncBatchController.h>
+#include <Global/CryptoNoteConfig.h>
 
 namespace CryptoNote {
 
+// Bounded set of object hashes, the oldest entries are forgotten first.
+class RollingHashSet
+{
+public:
+    explicit RollingHashSet(size_t limit)
+        : m_limit(limit)
+    {
+    }
+
+    bool contains(const Crypto::Hash &hash) const
+    {
+        return m_hashes.count(hash) != 0;
+    }
+
+    void insert(const Crypto::Hash &hash)
+    {
+        if (!m_hashes.insert(hash).second) {
+            return;
+        }
+
+        m_order.push_back(hash);
+        if (m_order.size() > m_limit) {
+            m_hashes.erase(m_order.front());
+            m_order.pop_front();
+        }
+    }
+
+    size_t size() const
+    {
+        return m_hashes.size();
+    }
+
+private:
+    size_t m_limit;
+    std::unordered_set<Crypto::Hash> m_hashes;
+    std::deque<Crypto::Hash> m_order;
+};
+
 struct CryptoNoteConnectionContext
 {
     uint8_t version;
@@ -52,6 +93,10 @@ struct CryptoNoteConnectionContext
     std::unordered_set<Crypto::Hash> m_requested_objects;
     uint32_t m_remote_blockchain_height = 0;
     uint32_t m_last_response_height = 0;
+    SyncBatchController m_sync;
+    uint32_t m_invalid_objects = 0;
+    // transactions the peer already has, they are never announced to it again
+    RollingHashSet m_known_transactions{ P2P_KNOWN_TRANSACTIONS_LIMIT };
 };
 
 inline std::string get_protocol_state_string(CryptoNoteConnectionContext::state s)
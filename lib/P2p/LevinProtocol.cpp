@@ -16,6 +16,9 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <cstring>
+#include <zlib.h>
 #include <P2p/LevinProtocol.h>
 #include <System/TcpConnection.h>
 
@@ -26,9 +29,15 @@ namespace {
 const uint64_t LEVIN_SIGNATURE = 0x0101010101012101LL; // Bender's nightmare
 const uint32_t LEVIN_PACKET_REQUEST = 0x00000001;
 const uint32_t LEVIN_PACKET_RESPONSE = 0x00000002;
+const uint32_t LEVIN_PACKET_COMPRESSED = 0x00000100;
 const uint32_t LEVIN_DEFAULT_MAX_PACKET_SIZE = 100000000; // 100MB by default
 const uint32_t LEVIN_PROTOCOL_VER_1 = 1;
 
+const size_t LEVIN_READ_CHUNK_SIZE = 64 * 1024;
+const size_t LEVIN_POOLED_BUFFERS_COUNT = 8;
+const size_t LEVIN_POOLED_BUFFER_MAX_CAPACITY = 1024 * 1024;
+const size_t LEVIN_COMPRESSION_THRESHOLD = 16 * 1024;
+
 #pragma pack(push)
 #pragma pack(1)
 struct bucket_head2
@@ -50,30 +59,145 @@ bool LevinProtocol::Command::needReply() const
     return !(isNotify || isResponse);
 }
 
+LevinReadBuffer::LevinReadBuffer()
+    : m_begin(0),
+      m_end(0)
+{
+}
+
+bool LevinReadBuffer::read(System::TcpConnection &connection, uint8_t *ptr, size_t size)
+{
+    size_t offset = 0;
+    while (offset < size) {
+        if (m_begin == m_end) {
+            // large bodies bypass the chunk and go straight to the destination
+            if (size - offset >= LEVIN_READ_CHUNK_SIZE) {
+                size_t read = connection.read(ptr + offset, size - offset);
+                if (read == 0) {
+                    return false;
+                }
+
+                offset += read;
+                continue;
+            }
+
+            if (m_chunk.empty()) {
+                m_chunk.resize(LEVIN_READ_CHUNK_SIZE);
+            }
+
+            m_begin = 0;
+            m_end = connection.read(m_chunk.data(), m_chunk.size());
+            if (m_end == 0) {
+                return false;
+            }
+        }
+
+        size_t count = std::min(size - offset, m_end - m_begin);
+        std::memcpy(ptr + offset, m_chunk.data() + m_begin, count);
+        m_begin += count;
+        offset += count;
+    }
+
+    return true;
+}
+
+BinaryArray LevinReadBuffer::acquire(size_t size)
+{
+    BinaryArray buffer;
+
+    if (!m_pool.empty()) {
+        buffer = std::move(m_pool.back());
+        m_pool.pop_back();
+    }
+
+    buffer.resize(size);
+
+    return buffer;
+}
+
+void LevinReadBuffer::release(BinaryArray &&buffer)
+{
+    if (buffer.capacity() == 0
+        || buffer.capacity() > LEVIN_POOLED_BUFFER_MAX_CAPACITY
+        || m_pool.size() >= LEVIN_POOLED_BUFFERS_COUNT) {
+        return;
+    }
+
+    buffer.clear();
+    m_pool.push_back(std::move(buffer));
+}
+
 LevinProtocol::LevinProtocol(System::TcpConnection &connection)
-    : m_conn(connection)
+    : m_conn(connection),
+      m_readBuffer(nullptr),
+      m_compressionEnabled(false)
 {
 }
 
-void LevinProtocol::sendMessage(uint32_t command, const BinaryArray &out, bool needResponse)
+LevinProtocol::LevinProtocol(System::TcpConnection &connection, LevinReadBuffer &readBuffer)
+    : m_conn(connection),
+      m_readBuffer(&readBuffer),
+      m_compressionEnabled(false)
 {
-    bucket_head2 head = { 0 };
-    head.m_signature = LEVIN_SIGNATURE;
-    head.m_cb = out.size();
-    head.m_have_to_return_data = needResponse;
-    head.m_command = command;
-    head.m_protocol_version = LEVIN_PROTOCOL_VER_1;
-    head.m_flags = LEVIN_PACKET_REQUEST;
+}
 
-    // write header and body in one operation
-    BinaryArray writeBuffer;
-    writeBuffer.reserve(sizeof(head) + out.size());
+void LevinProtocol::setCompressionEnabled(bool enabled)
+{
+    m_compressionEnabled = enabled;
+}
 
-    Common::VectorOutputStream stream(writeBuffer);
-    stream.writeSome(&head, sizeof(head));
-    stream.writeSome(out.data(), out.size());
+BinaryArray LevinProtocol::compress(const BinaryArray &data)
+{
+    // body layout: uncompressed size (uint32_t), zlib stream
+    uint32_t originalSize = static_cast<uint32_t>(data.size());
+    uLongf compressedSize = compressBound(static_cast<uLong>(data.size()));
 
-    writeStrict(writeBuffer.data(), writeBuffer.size());
+    BinaryArray result(sizeof(originalSize) + compressedSize);
+    std::memcpy(result.data(), &originalSize, sizeof(originalSize));
+
+    int status = compress2(result.data() + sizeof(originalSize),
+                           &compressedSize,
+                           data.data(),
+                           static_cast<uLong>(data.size()),
+                           Z_BEST_SPEED);
+    if (status != Z_OK) {
+        throw std::runtime_error("Levin packet compression failed");
+    }
+
+    result.resize(sizeof(originalSize) + compressedSize);
+
+    return result;
+}
+
+bool LevinProtocol::decompress(const BinaryArray &data, BinaryArray &result)
+{
+    uint32_t originalSize = 0;
+    if (data.size() < sizeof(originalSize)) {
+        return false;
+    }
+
+    std::memcpy(&originalSize, data.data(), sizeof(originalSize));
+    if (originalSize > LEVIN_DEFAULT_MAX_PACKET_SIZE) {
+        return false;
+    }
+
+    result.resize(originalSize);
+    if (originalSize == 0) {
+        return true;
+    }
+
+    uLongf resultSize = originalSize;
+    int status = uncompress(result.data(),
+                            &resultSize,
+                            data.data() + sizeof(originalSize),
+                            static_cast<uLong>(data.size() - sizeof(originalSize)));
+
+    return status == Z_OK && resultSize == originalSize;
+}
+
+void LevinProtocol::sendMessage(uint32_t command, const BinaryArray &out, bool needResponse)
+{
+    writeMessage(command, out, needResponse, LEVIN_PACKET_REQUEST, 0);
 }
 
 bool LevinProtocol::readCommand(Command &cmd)
@@ -94,13 +218,32 @@ bool LevinProtocol::readCommand(Command &cmd)
 
     BinaryArray buf;
 
+    if (m_readBuffer != nullptr) {
+        m_readBuffer->release(std::move(cmd.buf));
+        buf = m_readBuffer->acquire(static_cast<size_t>(head.m_cb));
+    } else {
+        buf.resize(static_cast<size_t>(head.m_cb));
+    }
+
     if (head.m_cb != 0) {
-        buf.resize(head.m_cb);
-        if (!readStrict(&buf[0], head.m_cb)) {
+        if (!readStrict(&buf[0], static_cast<size_t>(head.m_cb))) {
             return false;
         }
     }
 
+    if ((head.m_flags & LEVIN_PACKET_COMPRESSED) == LEVIN_PACKET_COMPRESSED) {
+        BinaryArray body = m_readBuffer != nullptr ? m_readBuffer->acquire(0) : BinaryArray();
+        if (!decompress(buf, body)) {
+            throw std::runtime_error("Levin packet decompression failed");
+        }
+
+        if (m_readBuffer != nullptr) {
+            m_readBuffer->release(std::move(buf));
+        }
+
+        buf = std::move(body);
+    }
+
     cmd.command = head.m_command;
     cmd.buf = std::move(buf);
     cmd.isNotify = !head.m_have_to_return_data;
@@ -111,27 +254,52 @@ bool LevinProtocol::readCommand(Command &cmd)
 
 void LevinProtocol::sendReply(uint32_t command, const BinaryArray &out, int32_t returnCode)
 {
+    writeMessage(command, out, false, LEVIN_PACKET_RESPONSE, returnCode);
+}
+
+void LevinProtocol::writeMessage(uint32_t command,
+                                 const BinaryArray &out,
+                                 bool needResponse,
+                                 uint32_t flags,
+                                 int32_t returnCode)
+{
+    const BinaryArray *body = &out;
+    BinaryArray compressed;
+
+    if (m_compressionEnabled && out.size() >= LEVIN_COMPRESSION_THRESHOLD) {
+        compressed = compress(out);
+        if (compressed.size() < out.size()) {
+            body = &compressed;
+            flags |= LEVIN_PACKET_COMPRESSED;
+        }
+    }
+
     bucket_head2 head = { 0 };
     head.m_signature = LEVIN_SIGNATURE;
-    head.m_cb = out.size();
-    head.m_have_to_return_data = false;
+    head.m_cb = body->size();
+    head.m_have_to_return_data = needResponse;
     head.m_command = command;
     head.m_protocol_version = LEVIN_PROTOCOL_VER_1;
-    head.m_flags = LEVIN_PACKET_RESPONSE;
+    head.m_flags = flags;
     head.m_return_code = returnCode;
 
+    // write header and body in one operation
     BinaryArray writeBuffer;
-    writeBuffer.reserve(sizeof(head) + out.size());
+    writeBuffer.reserve(sizeof(head) + body->size());
 
     Common::VectorOutputStream stream(writeBuffer);
     stream.writeSome(&head, sizeof(head));
-    stream.writeSome(out.data(), out.size());
+    stream.writeSome(body->data(), body->size());
 
     writeStrict(writeBuffer.data(), writeBuffer.size());
 }
 
 bool LevinProtocol::readStrict(uint8_t *ptr, size_t size)
 {
+    if (m_readBuffer != nullptr) {
+        return m_readBuffer->read(m_conn, ptr, size);
+    }
+
     size_t offset = 0;
     while (offset < size) {
         size_t read = m_conn.read(ptr + offset, size - offset);
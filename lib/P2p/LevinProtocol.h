@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <vector>
 #include <Common/MemoryInputStream.h>
 #include <Common/VectorOutputStream.h>
 #include <Serialization/KVBinaryInputStreamSerializer.h>
@@ -46,6 +47,26 @@ enum class LevinError : int32_t
 
 const int32_t LEVIN_PROTOCOL_RETCODE_SUCCESS = 1;
 
+// Per-connection receive state for LevinProtocol. Socket data is pulled in large chunks,
+// so several small frames can be parsed out of one read, and message bodies are recycled
+// through a small pool once the caller is done with them.
+class LevinReadBuffer
+{
+public:
+    LevinReadBuffer();
+
+    bool read(System::TcpConnection &connection, uint8_t *ptr, size_t size);
+
+    BinaryArray acquire(size_t size);
+    void release(BinaryArray &&buffer);
+
+private:
+    BinaryArray m_chunk;
+    size_t m_begin;
+    size_t m_end;
+    std::vector<BinaryArray> m_pool;
+};
+
 class LevinProtocol
 {
 public:
@@ -60,6 +81,7 @@ public:
     };
 
     explicit LevinProtocol(System::TcpConnection &connection);
+    LevinProtocol(System::TcpConnection &connection, LevinReadBuffer &readBuffer);
 
     template <typename Request, typename Response>
     bool invoke(uint32_t command, const Request &request, Response &response)
@@ -82,17 +104,25 @@ public:
         sendMessage(command, encode(request), false);
     }
 
-  bool readCommand(Command& cmd);
+    // When a read buffer is attached, the previous body held by cmd is returned to its pool,
+    // so callers should reuse the same Command object across reads.
+    bool readCommand(Command &cmd);
+
+    void sendMessage(uint32_t command, const BinaryArray &out, bool needResponse);
+    void sendReply(uint32_t command, const BinaryArray &out, int32_t returnCode);
+
+    // Large bodies are sent compressed, only enable it for peers that negotiated support.
+    void setCompressionEnabled(bool enabled);
 
-  void sendMessage(uint32_t command, const BinaryArray& out, bool needResponse);
-  void sendReply(uint32_t command, const BinaryArray& out, int32_t returnCode);
+    static BinaryArray compress(const BinaryArray &data);
+    static bool decompress(const BinaryArray &data, BinaryArray &result);
 
     template <typename T>
     static bool decode(const BinaryArray &buf, T &value)
     {
         try {
-            Common::MemoryInputStream stream(buf.data(), buf.size());
-            KVBinaryInputStreamSerializer serializer(stream);
+            KVBinaryInputStreamSerializer serializer(
+                Common::StringView(reinterpret_cast<const char *>(buf.data()), buf.size()));
             serialize(value, serializer);
         } catch (std::exception &) {
             return false;
@@ -116,11 +146,18 @@ public:
     }
 
 private:
+    void writeMessage(uint32_t command,
+                      const BinaryArray &out,
+                      bool needResponse,
+                      uint32_t flags,
+                      int32_t returnCode);
     bool readStrict(uint8_t *ptr, size_t size);
     void writeStrict(const uint8_t *ptr, size_t size);
 
 private:
     System::TcpConnection &m_conn;
+    LevinReadBuffer *m_readBuffer;
+    bool m_compressionEnabled;
 };
 
 } // namespace CryptoNote
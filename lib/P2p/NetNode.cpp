@@ -298,15 +298,19 @@ NodeServer::NodeServer(System::Dispatcher &dispatcher,
 
 void NodeServer::serialize(ISerializer &s)
 {
-    uint8_t version = 1;
+    uint8_t version = 2;
     s(version, "version");
 
-    if (version != 1) {
+    if (version != 1 && version != 2) {
         throw std::runtime_error("Unsupported version");
     }
 
     s(m_peerlist, "peerlist");
     s(m_config.m_peer_id, "peer_id");
+
+    if (version >= 2) {
+        m_peerlist.serialize_stats(s);
+    }
 }
 
 #define INVOKE_HANDLER(CMD, Handler) case CMD::ID: \
@@ -514,6 +518,7 @@ void NodeServer::drop_connection(CryptoNoteConnectionContext &context, bool add_
 {
     if (add_fail) {
         add_host_fail(context.m_remote_ip);
+        ++context.m_invalid_objects;
     }
 
     context.m_state = CryptoNoteConnectionContext::state_shutdown;
@@ -763,12 +768,16 @@ bool NodeServer::handshake(CryptoNote::LevinProtocol &proto,
     get_local_node_data(arg.node_data);
     m_payload_handler.get_payload_sync_data(arg.payload_data);
 
+    auto invokeStart = std::chrono::steady_clock::now();
     if (!proto.invoke(COMMAND_HANDSHAKE::ID, arg, rsp)) {
         logger(Logging::DEBUGGING)
             << context
             << "Failed to invoke COMMAND_HANDSHAKE, closing connection.";
         return false;
     }
+    auto rtt = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - invokeStart
+    );
 
     context.version = rsp.node_data.version;
 
@@ -829,6 +838,8 @@ bool NodeServer::handshake(CryptoNote::LevinProtocol &proto,
 
     context.peerId = rsp.node_data.peer_id;
     m_peerlist.set_peer_just_seen(rsp.node_data.peer_id, context.m_remote_ip, context.m_remote_port);
+    m_peerlist.on_peer_handshake({ context.m_remote_ip, context.m_remote_port },
+                                 static_cast<uint32_t>(rtt.count()));
 
     if (rsp.node_data.peer_id == m_config.m_peer_id)  {
         logger(Logging::TRACE) << context << "Connection to self detected, dropping connection";
@@ -961,6 +972,7 @@ bool NodeServer::try_to_connect_and_handshake_with_new_peer(const NetworkAddress
             connection = std::move(connectionContext.get());
         } catch (System::InterruptedException &) {
             logger(DEBUGGING) << "Connection timed out";
+            m_peerlist.on_peer_failure(na);
             return false;
         }
 
@@ -974,7 +986,7 @@ bool NodeServer::try_to_connect_and_handshake_with_new_peer(const NetworkAddress
 
         try {
             System::Context<bool> handshakeContext(m_dispatcher, [&] {
-                CryptoNote::LevinProtocol proto(ctx.connection);
+                CryptoNote::LevinProtocol proto(ctx.connection, ctx.readBuffer);
                 return handshake(proto, ctx, just_take_peerlist);
             });
 
@@ -990,10 +1002,12 @@ bool NodeServer::try_to_connect_and_handshake_with_new_peer(const NetworkAddress
 
             if (!handshakeContext.get()) {
                 logger(TRACE) << "Failed to HANDSHAKE with peer " << na;
+                m_peerlist.on_peer_failure(na);
                 return false;
             }
         } catch (System::InterruptedException &) {
             logger(DEBUGGING) << "Handshake timed out";
+            m_peerlist.on_peer_failure(na);
             return false;
         }
 
@@ -1031,6 +1045,34 @@ bool NodeServer::try_to_connect_and_handshake_with_new_peer(const NetworkAddress
         throw;
     } catch (const std::exception &e) {
         logger(DEBUGGING) << "Connection to " << na << " failed: " << e.what();
+        m_peerlist.on_peer_failure(na);
+    }
+
+    return false;
+}
+
+bool NodeServer::make_new_connection_from_best_peers()
+{
+    std::vector<PeerlistEntry> peers;
+    m_peerlist.get_white_peers_by_score(peers, m_config.m_net_config.connections_count * 4);
+
+    size_t try_count = 0;
+    for (const PeerlistEntry &pe : peers) {
+        if (try_count >= 10 || m_stop) {
+            break;
+        }
+
+        if (is_peer_used(pe) || !is_remote_host_allowed(pe.adr.ip)) {
+            continue;
+        }
+
+        ++try_count;
+
+        logger(DEBUGGING) << "Selected best scored peer: " << pe.id << " " << pe.adr;
+
+        if (try_to_connect_and_handshake_with_new_peer(pe.adr, false, pe.last_seen, true)) {
+            return true;
+        }
     }
 
     return false;
@@ -1038,6 +1080,15 @@ bool NodeServer::try_to_connect_and_handshake_with_new_peer(const NetworkAddress
 
 bool NodeServer::make_new_connection_from_peerlist(bool use_white_list)
 {
+    // a few outbound slots are left to random picks so new peers get a chance to be measured
+    size_t scored_connections = m_config.m_net_config.connections_count;
+    scored_connections -= std::min<size_t>(scored_connections, P2P_DEFAULT_EXPLORATION_CONNECTIONS);
+    if (use_white_list
+        && get_outgoing_connections_count() < scored_connections
+        && make_new_connection_from_best_peers()) {
+        return true;
+    }
+
     size_t local_peers_count = use_white_list ? m_peerlist.get_white_peers_count()
                                               : m_peerlist.get_gray_peers_count();
     if(!local_peers_count) {
@@ -1647,6 +1698,15 @@ void NodeServer::on_connection_new(P2pConnectionContext &context)
 void NodeServer::on_connection_close(P2pConnectionContext &context)
 {
     logger(TRACE) << context << "CLOSE CONNECTION";
+
+    // inbound connections come from ephemeral ports, only outbound ones map to a peerlist entry
+    if (!context.m_is_income && context.peerId) {
+        m_peerlist.on_peer_disconnected({ context.m_remote_ip, context.m_remote_port },
+                                        time(nullptr) - context.m_started,
+                                        static_cast<uint64_t>(context.m_sync.bytesPerSecond()),
+                                        context.m_invalid_objects);
+    }
+
     m_payload_handler.onConnectionClosed(context);
 }
 
@@ -1791,7 +1851,7 @@ void NodeServer::connectionHandler(const boost::uuids::uuid &connectionId,
         try {
             on_connection_new(ctx);
 
-            LevinProtocol proto(ctx.connection);
+            LevinProtocol proto(ctx.connection, ctx.readBuffer);
             LevinProtocol::Command cmd;
 
             for (;;) {
@@ -1868,6 +1928,8 @@ void NodeServer::writeHandler(P2pConnectionContext &ctx)
                 break;
             }
 
+            proto.setCompressionEnabled(ctx.version >= P2P_COMPRESSION_VERSION);
+
             for (const auto &msg : msgs) {
               logger(DEBUGGING) << ctx << "msg " << msg.type << ':' << msg.command;
               switch (msg.type) {
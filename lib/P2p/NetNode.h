@@ -99,6 +99,7 @@ public:
     System::Context<void> *context;
     PeerIdType peerId;
     System::TcpConnection connection;
+    LevinReadBuffer readBuffer;
 
     P2pConnectionContext(System::Dispatcher &dispatcher,
                          Logging::ILogger &log,
@@ -117,6 +118,7 @@ public:
           context(ctx.context),
           peerId(ctx.peerId),
           connection(std::move(ctx.connection)),
+          readBuffer(std::move(ctx.readBuffer)),
           logger(ctx.logger.getLogger(), "node_server"),
           queueEvent(std::move(ctx.queueEvent)),
           stopped(std::move(ctx.stopped))
@@ -253,6 +255,7 @@ private:
     bool fix_time_delta(std::list<PeerlistEntry> &localPeerlist, time_t local_time, int64_t &delta);
 
     bool connections_maker();
+    bool make_new_connection_from_best_peers();
     bool make_new_connection_from_peerlist(bool use_white_list);
     bool try_to_connect_and_handshake_with_new_peer(const NetworkAddress &na,
                                                     bool just_take_peerlist = false,
@@ -111,7 +111,7 @@ bool P2pContext::readCommand(LevinProtocol::Command &cmd)
     }
 
     EventLock lk(readEvent);
-    bool result = LevinProtocol(connection).readCommand(cmd);
+    bool result = LevinProtocol(connection, readBuffer).readCommand(cmd);
     lastReadTime = Clock::now();
 
     return result;
@@ -125,6 +125,7 @@ void P2pContext::writeMessage(const Message &msg)
 
     EventLock lk(writeEvent);
     LevinProtocol proto(connection);
+    proto.setCompressionEnabled(version >= P2P_COMPRESSION_VERSION);
 
     switch (msg.messageType) {
     case P2pContext::Message::NOTIFY:
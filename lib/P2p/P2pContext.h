@@ -100,6 +100,7 @@ private:
     System::Event timedSyncFinished;
 
     System::TcpConnection connection;
+    LevinReadBuffer readBuffer;
     System::Event writeEvent;
     System::Event readEvent;
 };
@@ -16,6 +16,8 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <cmath>
 #include <time.h>
 #include <boost/foreach.hpp>
 #include <P2p/PeerListManager.h>
@@ -53,8 +55,47 @@ void serialize(PeerlistEntry &pe, ISerializer &s)
     s(pe.last_seen, "last_seen");
 }
 
+void serialize(PeerStats &ps, ISerializer &s)
+{
+    s(ps.adr, "adr");
+    s(ps.handshake_rtt, "handshake_rtt");
+    s(ps.sync_throughput, "sync_throughput");
+    s(ps.invalid_objects, "invalid_objects");
+    s(ps.failures, "failures");
+    s(ps.uptime, "uptime");
+}
+
 } // namespace CryptoNote
 
+namespace {
+
+const double REFERENCE_RTT = 250;                    // milliseconds
+const double REFERENCE_THROUGHPUT = 1024 * 1024;     // bytes per second
+const double REFERENCE_UPTIME = 60 * 60 * 24;        // seconds
+const uint32_t INVALID_OBJECT_PENALTY = 10;
+
+uint64_t smooth(uint64_t average, uint64_t sample)
+{
+    return average == 0 ? sample : (average * 3 + sample) / 4;
+}
+
+} // namespace
+
+double PeerStats::score() const
+{
+    // every factor is 1 for a peer we know nothing about
+    double result = 1.0;
+
+    if (handshake_rtt) {
+        result *= 2 * REFERENCE_RTT / (REFERENCE_RTT + handshake_rtt);
+    }
+
+    result *= 1 + std::log2(1 + sync_throughput / REFERENCE_THROUGHPUT);
+    result *= 1 + std::min<double>(uptime, REFERENCE_UPTIME) / REFERENCE_UPTIME;
+
+    return result / (1 + failures + INVALID_OBJECT_PENALTY * invalid_objects);
+}
+
 PeerlistManager::Peerlist::Peerlist(peers_indexed &peers, size_t maxSize)
     : m_peers(peers),
       m_maxSize(maxSize)
@@ -76,6 +117,28 @@ void PeerlistManager::serialize(ISerializer &s)
     s(m_peers_gray, "graylist");
 }
 
+void PeerlistManager::serialize_stats(ISerializer &s)
+{
+    std::vector<PeerStats> stats;
+
+    if (s.type() == ISerializer::INPUT) {
+        s(stats, "peer_stats");
+        m_peer_stats.clear();
+        for (const PeerStats &ps : stats) {
+            m_peer_stats[ps.adr] = ps;
+        }
+    } else {
+        // stats of peers we already forgot are not worth keeping
+        for (const auto &kv : m_peer_stats) {
+            if (m_peers_white.get<by_addr>().count(kv.first)
+                || m_peers_gray.get<by_addr>().count(kv.first)) {
+                stats.push_back(kv.second);
+            }
+        }
+        s(stats, "peer_stats");
+    }
+}
+
 size_t PeerlistManager::Peerlist::count() const
 {
     return m_peers.size();
@@ -292,3 +355,93 @@ PeerlistManager::Peerlist& PeerlistManager::getGray()
 {
     return m_grayPeerlist;
 }
+
+PeerStats &PeerlistManager::get_stats(const NetworkAddress &addr)
+{
+    auto it = m_peer_stats.find(addr);
+    if (it != m_peer_stats.end()) {
+        return it->second;
+    }
+
+    if (m_peer_stats.size() >= P2P_LOCAL_WHITE_PEERLIST_LIMIT + P2P_LOCAL_GRAY_PEERLIST_LIMIT) {
+        for (auto i = m_peer_stats.begin(); i != m_peer_stats.end();) {
+            if (m_peers_white.get<by_addr>().count(i->first)
+                || m_peers_gray.get<by_addr>().count(i->first)) {
+                ++i;
+            } else {
+                i = m_peer_stats.erase(i);
+            }
+        }
+    }
+
+    PeerStats &stats = m_peer_stats[addr];
+    stats.adr = addr;
+
+    return stats;
+}
+
+double PeerlistManager::get_score(const NetworkAddress &addr) const
+{
+    auto it = m_peer_stats.find(addr);
+    return it == m_peer_stats.end() ? PeerStats().score() : it->second.score();
+}
+
+void PeerlistManager::on_peer_handshake(const NetworkAddress &addr, uint32_t rtt)
+{
+    PeerStats &stats = get_stats(addr);
+    stats.handshake_rtt = static_cast<uint32_t>(smooth(stats.handshake_rtt, std::max<uint32_t>(rtt, 1)));
+    stats.failures /= 2;
+}
+
+void PeerlistManager::on_peer_failure(const NetworkAddress &addr)
+{
+    ++get_stats(addr).failures;
+}
+
+void PeerlistManager::on_peer_disconnected(const NetworkAddress &addr,
+                                           uint64_t uptime,
+                                           uint64_t sync_throughput,
+                                           uint32_t invalid_objects)
+{
+    PeerStats &stats = get_stats(addr);
+    stats.uptime += uptime;
+    stats.invalid_objects += invalid_objects;
+
+    if (sync_throughput) {
+        stats.sync_throughput = smooth(stats.sync_throughput, sync_throughput);
+    }
+}
+
+bool PeerlistManager::get_peer_stats(const NetworkAddress &addr, PeerStats &stats) const
+{
+    auto it = m_peer_stats.find(addr);
+    if (it == m_peer_stats.end()) {
+        return false;
+    }
+
+    stats = it->second;
+
+    return true;
+}
+
+void PeerlistManager::get_white_peers_by_score(std::vector<PeerlistEntry> &peers,
+                                               size_t count) const
+{
+    std::vector<std::pair<double, const PeerlistEntry *>> scored;
+    scored.reserve(m_peers_white.size());
+    for (const PeerlistEntry &pe : m_peers_white) {
+        scored.emplace_back(get_score(pe.adr), &pe);
+    }
+
+    count = std::min(count, scored.size());
+    std::partial_sort(scored.begin(), scored.begin() + count, scored.end(),
+                      [](const std::pair<double, const PeerlistEntry *> &a,
+                         const std::pair<double, const PeerlistEntry *> &b) {
+                          return a.first > b.first;
+                      });
+
+    peers.clear();
+    for (size_t i = 0; i < count; ++i) {
+        peers.push_back(*scored[i].second);
+    }
+}
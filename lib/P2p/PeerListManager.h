@@ -19,6 +19,8 @@
 #pragma once
 
 #include <list>
+#include <map>
+#include <vector>
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/identity.hpp>
@@ -30,6 +32,19 @@ namespace CryptoNote {
 
 class ISerializer;
 
+// What we learned about a peer from our own outbound connections to it.
+struct PeerStats
+{
+    NetworkAddress adr;
+    uint32_t handshake_rtt = 0;    // milliseconds, smoothed
+    uint64_t sync_throughput = 0;  // bytes per second, smoothed
+    uint32_t invalid_objects = 0;
+    uint32_t failures = 0;
+    uint64_t uptime = 0;           // seconds connected in total
+
+    double score() const;
+};
+
 class PeerlistManager
 {
     struct by_time{};
@@ -83,7 +98,18 @@ public:
     void trim_white_peerlist();
     void trim_gray_peerlist();
 
+    void on_peer_handshake(const NetworkAddress &addr, uint32_t rtt);
+    void on_peer_failure(const NetworkAddress &addr);
+    void on_peer_disconnected(const NetworkAddress &addr,
+                              uint64_t uptime,
+                              uint64_t sync_throughput,
+                              uint32_t invalid_objects);
+    bool get_peer_stats(const NetworkAddress &addr, PeerStats &stats) const;
+    // white peers ordered from the best score down, peers never measured are ranked as neutral
+    void get_white_peers_by_score(std::vector<PeerlistEntry> &peers, size_t count) const;
+
     void serialize(ISerializer &s);
+    void serialize_stats(ISerializer &s);
 
     Peerlist& getWhite();
     Peerlist& getGray();
@@ -96,6 +122,10 @@ private:
     peers_indexed m_peers_white;
     Peerlist m_whitePeerlist;
     Peerlist m_grayPeerlist;
+    std::map<NetworkAddress, PeerStats> m_peer_stats;
+
+    PeerStats &get_stats(const NetworkAddress &addr);
+    double get_score(const NetworkAddress &addr) const;
 };
 
 } // namespace CryptoNote
@@ -22,7 +22,7 @@
 #include <PaymentGate/PaymentServiceJsonRpcServer.h>
 #include <PaymentGate/WalletService.h>
 #include <Serialization/JsonInputValueSerializer.h>
-#include <Serialization/JsonOutputStreamSerializer.h>
+#include <Serialization/JsonStreamingOutputSerializer.h>
 
 namespace PaymentService {
 
@@ -60,7 +60,8 @@ PaymentServiceJsonRpcServer::PaymentServiceJsonRpcServer(System::Dispatcher &sys
 }
 
 void PaymentServiceJsonRpcServer::processJsonRpcRequest(const Common::JsonValue &req,
-                                                        Common::JsonValue &resp)
+                                                        Common::JsonValue &resp,
+                                                        std::string &result)
 {
     try {
         prepareJsonResponse(req, resp);
@@ -93,7 +94,7 @@ void PaymentServiceJsonRpcServer::processJsonRpcRequest(const Common::JsonValue
             params = req("params");
         }
 
-        it->second(params, resp);
+        it->second(params, resp, result);
     } catch (std::exception& e) {
         logger(Logging::WARNING) << "Error occurred while processing JsonRpc request: " << e.what();
         makeGenericErrorReponse(resp, e.what());
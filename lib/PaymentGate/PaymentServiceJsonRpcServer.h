@@ -24,7 +24,7 @@
 #include <JsonRpcServer/JsonRpcServer.h>
 #include <PaymentGate/PaymentServiceJsonRpcMessages.h>
 #include <Serialization/JsonInputValueSerializer.h>
-#include <Serialization/JsonOutputStreamSerializer.h>
+#include <Serialization/JsonStreamingOutputSerializer.h>
 
 namespace PaymentService {
 
@@ -33,7 +33,8 @@ class WalletService;
 class PaymentServiceJsonRpcServer : public CryptoNote::JsonRpcServer
 {
     typedef std::function<void (const Common::JsonValue &jsonRpcParams,
-                                Common::JsonValue &jsonResponse)> HandlerFunction;
+                                Common::JsonValue &jsonResponse,
+                                std::string &result)> HandlerFunction;
 
 public:
     PaymentServiceJsonRpcServer(System::Dispatcher &sys,
@@ -44,7 +45,9 @@ public:
     PaymentServiceJsonRpcServer(const PaymentServiceJsonRpcServer &) = delete;
 
 protected:
-    void processJsonRpcRequest(const Common::JsonValue &req, Common::JsonValue &resp) override;
+    void processJsonRpcRequest(const Common::JsonValue &req,
+                               Common::JsonValue &resp,
+                               std::string &result) override;
 
 private:
     WalletService &service;
@@ -53,7 +56,8 @@ private:
     template <typename RequestType, typename ResponseType, typename RequestHandler>
     HandlerFunction jsonHandler(RequestHandler handler) {
         return [handler] (const Common::JsonValue &jsonRpcParams,
-                          Common::JsonValue &jsonResponse) mutable {
+                          Common::JsonValue &jsonResponse,
+                          std::string &result) mutable {
             RequestType request;
             ResponseType response;
 
@@ -73,9 +77,9 @@ private:
                 return;
             }
 
-            CryptoNote::JsonOutputStreamSerializer outputSerializer;
+            CryptoNote::JsonStreamingOutputSerializer outputSerializer(result);
             serialize(response, outputSerializer);
-            fillJsonResponse(outputSerializer.getValue(), jsonResponse);
+            outputSerializer.finish();
         };
     }
 
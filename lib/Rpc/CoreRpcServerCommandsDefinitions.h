@@ -405,6 +405,8 @@ struct COMMAND_RPC_GET_INFO {
             KV_MEMBER(outgoing_connections_count);
             KV_MEMBER(incoming_connections_count);
             KV_MEMBER(rpc_connections_count);
+            KV_MEMBER(rpc_cache_hits);
+            KV_MEMBER(rpc_cache_misses);
             KV_MEMBER(white_peerlist_size);
             KV_MEMBER(grey_peerlist_size);
             KV_MEMBER(last_known_block_index);
@@ -432,6 +434,8 @@ struct COMMAND_RPC_GET_INFO {
         uint64_t outgoing_connections_count;
         uint64_t incoming_connections_count;
         uint64_t rpc_connections_count;
+        uint64_t rpc_cache_hits;
+        uint64_t rpc_cache_misses;
         uint64_t white_peerlist_size;
         uint64_t grey_peerlist_size;
         uint32_t last_known_block_index;
@@ -451,9 +455,14 @@ struct COMMAND_RPC_GET_VERSION {
     typedef EMPTY_STRUCT request;
 
     struct response {
-        void serialize(ISerializer &s) { KV_MEMBER(version); }
+        void serialize(ISerializer &s)
+        {
+            KV_MEMBER(version);
+            KV_MEMBER(binary_methods);
+        }
 
         std::string version;
+        std::vector<std::string> binary_methods;
     };
 };
 
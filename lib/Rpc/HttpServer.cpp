@@ -23,13 +23,55 @@
 #include <Http/HttpParser.h>
 #include <Rpc/HttpServer.h>
 #include <System/InterruptedException.h>
-#include <System/TcpStream.h>
 #include <System/Ipv4Address.h>
 
 using namespace Logging;
 
 namespace {
 
+const size_t READ_SIZE = 16 * 1024;
+// bodies up to this size are copied next to their head and sent in the same write
+const size_t INLINE_BODY_SIZE = 16 * 1024;
+// connection buffers grown beyond this are released once drained
+const size_t KEPT_BUFFER_SIZE = 1024 * 1024;
+
+void writeAll(System::TcpConnection &connection, const char *data, size_t size)
+{
+    size_t offset = 0;
+    while (offset != size) {
+        offset += connection.write(reinterpret_cast<const uint8_t *>(data) + offset, size - offset);
+    }
+}
+
+// Sends a streamed body as its parts are produced, output holds what is not written yet.
+// Small parts are gathered into chunks of about INLINE_BODY_SIZE.
+void writeChunked(System::TcpConnection &connection,
+                  std::string &output,
+                  const CryptoNote::HttpResponse::ChunkSource &source)
+{
+    std::string chunk;
+    for (;;) {
+        bool more = source(chunk);
+        if (more && chunk.size() < INLINE_BODY_SIZE) {
+            continue;
+        }
+
+        if (!chunk.empty()) {
+            CryptoNote::HttpResponse::appendChunk(output, chunk);
+            chunk.clear();
+        }
+
+        if (!more) {
+            break;
+        }
+
+        writeAll(connection, output.data(), output.size());
+        output.clear();
+    }
+
+    CryptoNote::HttpResponse::appendChunk(output, std::string());
+}
+
 void fillUnauthorizedResponse(CryptoNote::HttpResponse &response)
 {
     response.setStatus(CryptoNote::HttpResponse::STATUS_401);
@@ -105,31 +147,97 @@ void HttpServer::acceptLoop()
             << ":"
             << addr.second;
 
-        System::TcpStreambuf streambuf(connection);
-        std::iostream stream(&streambuf);
-        HttpParser parser;
+        // Requests are parsed straight from the input buffer. All complete requests in
+        // it are answered before the responses go out in a single write, so pipelining
+        // clients get one write per batch.
+        std::string input;
+        std::string output;
+        size_t parsed = 0;
+        bool keepAlive = true;
 
         for (;;) {
-            HttpRequest req;
-            HttpResponse resp;
-            resp.addHeader("Access-Control-Allow-Origin", "*");
-
-            parser.receiveRequest(stream, req);
-            if (authenticate(req)) {
-                processRequest(req, resp);
-            } else {
-                logger(WARNING)
-                    << "Authorization required "
-                    << addr.first.toDottedDecimal()
-                    << ":"
-                    << addr.second;
-                fillUnauthorizedResponse(resp);
+            for (;;) {
+                HttpRequest req;
+                size_t size = HttpParser::parseRequest(input.data() + parsed,
+                                                       input.size() - parsed,
+                                                       req);
+                if (size == 0) {
+                    break;
+                }
+
+                parsed += size;
+
+                req.setPeerAddress(addr.first.getValue());
+
+                HttpResponse resp;
+                resp.addHeader("Access-Control-Allow-Origin", "*");
+
+                if (authenticate(req)) {
+                    processRequest(req, resp);
+                } else {
+                    logger(WARNING)
+                        << "Authorization required "
+                        << addr.first.toDottedDecimal()
+                        << ":"
+                        << addr.second;
+                    fillUnauthorizedResponse(resp);
+                }
+
+                keepAlive = req.isKeepAlive();
+                if (!keepAlive) {
+                    resp.addHeader("Connection", "close");
+                }
+
+                if (resp.isChunked() && !req.acceptsChunked()) {
+                    HttpResponse::ChunkSource source = resp.getChunkedBody();
+                    std::string body;
+                    while (source(body)) {
+                    }
+                    resp.setBody(body);
+                }
+
+                resp.appendHead(output);
+                const std::string &body = resp.getBody();
+                if (resp.isChunked()) {
+                    writeChunked(connection, output, resp.getChunkedBody());
+                } else if (body.size() <= INLINE_BODY_SIZE) {
+                    output += body;
+                } else {
+                    writeAll(connection, output.data(), output.size());
+                    output.clear();
+                    writeAll(connection, body.data(), body.size());
+                }
+
+                if (!keepAlive) {
+                    break;
+                }
+            }
+
+            if (!output.empty()) {
+                writeAll(connection, output.data(), output.size());
+                output.clear();
+            }
+
+            if (output.capacity() > KEPT_BUFFER_SIZE) {
+                std::string().swap(output);
+            }
+
+            if (!keepAlive) {
+                break;
+            }
+
+            input.erase(0, parsed);
+            parsed = 0;
+            if (input.empty() && input.capacity() > KEPT_BUFFER_SIZE) {
+                std::string().swap(input);
             }
 
-            stream << resp;
-            stream.flush();
+            size_t offset = input.size();
+            input.resize(offset + READ_SIZE);
+            size_t read = connection.read(reinterpret_cast<uint8_t *>(&input[offset]), READ_SIZE);
+            input.resize(offset + read);
 
-            if (stream.peek() == std::iostream::traits_type::eof()) {
+            if (read == 0) {
                 break;
             }
         }
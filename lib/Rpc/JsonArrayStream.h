@@ -0,0 +1,104 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <Http/HttpResponse.h>
+#include <Serialization/JsonStreamingOutputSerializer.h>
+#include <Serialization/SerializationOverloads.h>
+
+namespace CryptoNote {
+
+/*!
+    Sends a JSON response whose array member is filled while the response goes out, so
+    neither the items nor their text are ever held all at once.
+
+    render writes the whole body with the array empty. It is called before the first item
+    and again after the last one, only the members following the array may change in
+    between. produce adds the next batch of items to the array, the batch is written and
+    cleared after each call. It returns false once there are no more items.
+*/
+template<typename Response, typename Item>
+HttpResponse::ChunkSource makeJsonArrayStream(std::shared_ptr<Response> response,
+                                              std::vector<Item> Response::*array,
+                                              const std::string &name,
+                                              std::function<std::string(const Response &)> render,
+                                              std::function<bool(Response &)> produce)
+{
+    const std::string marker = "\"" + name + "\":[]";
+
+    auto findArray = [marker](const std::string &text) {
+        // the array is looked for from the end, a JSON-RPC envelope puts the result last
+        size_t position = text.rfind(marker);
+        if (position == std::string::npos) {
+            throw std::logic_error("Streamed member " + marker + " is not in the response");
+        }
+
+        return position + marker.size() - 1;
+    };
+
+    bool started = false;
+    bool finished = false;
+    bool empty = true;
+
+    return [=](std::string &chunk) mutable {
+        if (finished) {
+            return false;
+        }
+
+        if (!started) {
+            started = true;
+            std::string text = render(*response);
+            chunk.append(text, 0, findArray(text));
+            return true;
+        }
+
+        std::vector<Item> &items = (*response).*array;
+        bool more = produce(*response);
+        if (!items.empty()) {
+            // written as {"name":[...]}, only the elements are kept
+            std::string batch;
+            JsonStreamingOutputSerializer serializer(batch);
+            serializer(items, name);
+            serializer.finish();
+            items.clear();
+
+            if (!empty) {
+                chunk += ',';
+            }
+            empty = false;
+
+            chunk.append(batch, marker.size(), batch.size() - marker.size() - 2);
+        }
+
+        if (!more) {
+            finished = true;
+            std::string text = render(*response);
+            chunk.append(text, findArray(text), std::string::npos);
+        }
+
+        return true;
+    };
+}
+
+} // namespace CryptoNote
@@ -61,6 +61,66 @@ JsonRpcError::JsonRpcError(int c, const std::string &msg)
 {
 }
 
+bool splitBatch(const std::string &body, std::vector<std::string> &calls)
+{
+    const char *SPACES = " \t\r\n";
+
+    size_t position = body.find_first_not_of(SPACES);
+    if (position == std::string::npos || body[position] != '[') {
+        return false;
+    }
+
+    calls.clear();
+
+    size_t depth = 0;
+    size_t begin = position + 1;
+    bool inString = false;
+    for (size_t i = begin; i < body.size(); ++i) {
+        char c = body[i];
+        if (inString) {
+            if (c == '\\') {
+                ++i;
+            } else if (c == '"') {
+                inString = false;
+            }
+
+            continue;
+        }
+
+        if (c == '"') {
+            inString = true;
+        } else if (c == '{' || c == '[') {
+            ++depth;
+        } else if (depth != 0 && (c == '}' || c == ']')) {
+            --depth;
+        } else if (depth == 0 && (c == ',' || c == ']')) {
+            size_t first = body.find_first_not_of(SPACES, begin);
+            if (first < i) {
+                size_t last = body.find_last_not_of(SPACES, i - 1);
+                calls.emplace_back(body, first, last - first + 1);
+            } else if (c == ',' || !calls.empty()) {
+                throw JsonRpcError(errParseError);
+            }
+
+            if (c == ']') {
+                if (body.find_first_not_of(SPACES, i + 1) != std::string::npos) {
+                    throw JsonRpcError(errParseError);
+                }
+
+                if (calls.empty()) {
+                    throw JsonRpcError(errInvalidRequest);
+                }
+
+                return true;
+            }
+
+            begin = i + 1;
+        }
+    }
+
+    throw JsonRpcError(errParseError);
+}
+
 void invokeJsonRpcCommand(HttpClient &httpClient,
                           JsonRpcRequest &jsReq,
                           JsonRpcResponse &jsRes,
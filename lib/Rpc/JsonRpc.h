@@ -19,6 +19,8 @@
 #pragma once
 
 #include <functional>
+#include <string>
+#include <vector>
 #include <boost/optional.hpp>
 #include <boost/foreach.hpp>
 #include <Common/JsonValue.h>
@@ -67,6 +69,10 @@ public:
 
 typedef boost::optional<Common::JsonValue> OptionalId;
 
+// Splits a batch into the texts of its calls. Returns false when body is a single call,
+// throws JsonRpcError when the batch is malformed or empty.
+bool splitBatch(const std::string &body, std::vector<std::string> &calls);
+
 class JsonRpcRequest
 {
 public:
@@ -74,22 +80,29 @@ public:
     {
     }
 
+    // The body is kept as text, params are read from it in place by loadParams().
     bool parseRequest(const std::string &requestBody)
     {
+        body = requestBody;
+
+        bool hasMethod;
+        bool hasId;
+        Common::StringView rawId;
+
         try {
-            psReq = Common::JsonValue::fromString(requestBody);
+            JsonStreamingInputSerializer s(body);
+            hasMethod = s(method, "method");
+            hasId = s.getRaw("id", rawId);
         } catch (std::exception &) {
             throw JsonRpcError(errParseError);
         }
 
-        if (!psReq.contains("method")) {
+        if (!hasMethod) {
             throw JsonRpcError(errInvalidRequest);
         }
 
-        method = psReq("method").getString();
-
-        if (psReq.contains("id")) {
-            id = psReq("id");
+        if (hasId) {
+            id = Common::JsonValue::fromString(static_cast<std::string>(rawId));
         }
 
         return true;
@@ -98,11 +111,35 @@ public:
     template <typename T>
     bool loadParams(T &v) const
     {
-        loadFromJsonValue(v, psReq.contains("params") ? psReq("params")
-                                                      : Common::JsonValue(Common::JsonValue::NIL));
+        if (body.empty()) {
+            loadFromJsonValue(v, psReq.contains("params") ? psReq("params")
+                                                          : Common::JsonValue(Common::JsonValue::NIL));
+            return true;
+        }
+
+        JsonStreamingInputSerializer s(body);
+        if (!s(v, "params")) {
+            throw std::runtime_error(
+                "Serializer doesn't support this type of serialization: Object expected."
+            );
+        }
+
         return true;
     }
 
+    // the params as they were sent, empty when there are none
+    std::string getRawParams() const
+    {
+        if (body.empty()) {
+            return psReq.contains("params") ? psReq("params").toString() : std::string();
+        }
+
+        Common::StringView raw;
+        JsonStreamingInputSerializer s(body);
+
+        return s.getRaw("params", raw) ? static_cast<std::string>(raw) : std::string();
+    }
+
     template <typename T>
     bool setParams(const T &v)
     {
@@ -138,6 +175,7 @@ private:
     Common::JsonValue psReq;
     OptionalId id;
     std::string method;
+    std::string body;
 };
 
 class JsonRpcResponse
@@ -150,10 +188,12 @@ public:
     void parse(const std::string &responseBody)
     {
         try {
-            psResp = Common::JsonValue::fromString(responseBody);
+            JsonStreamingInputSerializer s(responseBody);
         } catch (std::exception &) {
             throw JsonRpcError(errParseError);
         }
+
+        body = responseBody;
     }
 
     void setId(const OptionalId &id)
@@ -170,43 +210,66 @@ public:
 
     bool getError(JsonRpcError &err) const
     {
-        if (!psResp.contains("error")) {
-            return false;
-        }
-
-        loadFromJsonValue(err, psResp("error"));
-
-        return true;
+        return getMember(err, "error");
     }
 
     std::string getBody()
     {
         psResp.set("jsonrpc", std::string("2.0"));
 
-        return psResp.toString();
+        std::string text = psResp.toString();
+        if (!result.empty() && !psResp.contains("error")) {
+            // the result was written out on its own, append it as the last member
+            text.pop_back();
+            text += text.size() > 1 ? ",\"result\":" : "\"result\":";
+            text += result;
+            text += '}';
+        }
+
+        return text;
     }
 
     template <typename T>
     bool setResult(const T &v)
     {
-        psResp.set("result", storeToJsonValue(v));
+        result = storeToJson(v);
         return true;
     }
 
+    // the result already written out as JSON
+    void setResultText(const std::string &text)
+    {
+        result = text;
+    }
+
     template <typename T>
     bool getResult(T &v) const
     {
-        if (!psResp.contains("result")) {
-            return false;
+        return getMember(v, "result");
+    }
+
+private:
+    template <typename T>
+    bool getMember(T &v, Common::StringView name) const
+    {
+        if (body.empty()) {
+            if (!psResp.contains(std::string(name))) {
+                return false;
+            }
+
+            loadFromJsonValue(v, psResp(std::string(name)));
+
+            return true;
         }
 
-        loadFromJsonValue(v, psResp("result"));
+        JsonStreamingInputSerializer s(body);
 
-        return true;
+        return s(v, name);
     }
 
-private:
     Common::JsonValue psResp;
+    std::string result;
+    std::string body;
 };
 
 void invokeJsonRpcCommand(HttpClient &httpClient,
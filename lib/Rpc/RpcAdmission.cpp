@@ -0,0 +1,166 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <Rpc/RpcAdmission.h>
+
+namespace CryptoNote {
+
+namespace {
+
+// clients tracked before idle ones are looked for
+const size_t MIN_TRACKED_CLIENTS = 1024;
+
+} // namespace
+
+RpcAdmission::RpcAdmission()
+    : m_maxActive(0),
+      m_rate(0),
+      m_burst(0),
+      m_active(0),
+      m_streams(0),
+      m_removeIdleAt(MIN_TRACKED_CLIENTS)
+{
+}
+
+void RpcAdmission::setLimits(size_t maxActive, double rate, double burst)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_maxActive = maxActive;
+    m_rate = rate;
+    m_burst = burst;
+    m_buckets.clear();
+}
+
+std::shared_ptr<void> RpcAdmission::enter()
+{
+    return enter(m_active);
+}
+
+std::shared_ptr<void> RpcAdmission::enterStream()
+{
+    return enter(m_streams);
+}
+
+bool RpcAdmission::chargesClients() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_rate > 0;
+}
+
+bool RpcAdmission::charge(uint32_t client, uint64_t cost, Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_rate <= 0) {
+        return true;
+    }
+
+    if (static_cast<double>(cost) > m_burst) {
+        return false;
+    }
+
+    auto it = m_buckets.find(client);
+    if (it == m_buckets.end()) {
+        if (m_buckets.size() >= m_removeIdleAt) {
+            removeIdle(now);
+        }
+        it = m_buckets.emplace(client, Bucket{ m_burst, now }).first;
+    }
+
+    Bucket &bucket = it->second;
+    refill(bucket, now);
+    if (static_cast<double>(cost) > bucket.units) {
+        return false;
+    }
+
+    bucket.units -= static_cast<double>(cost);
+
+    return true;
+}
+
+size_t RpcAdmission::activeCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_active;
+}
+
+size_t RpcAdmission::streamCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_streams;
+}
+
+size_t RpcAdmission::clientCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_buckets.size();
+}
+
+std::shared_ptr<void> RpcAdmission::enter(size_t &count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_maxActive != 0 && count >= m_maxActive) {
+        return nullptr;
+    }
+
+    ++count;
+
+    return std::shared_ptr<void>(static_cast<void *>(this),
+                                 [this, &count](void *) { leave(count); });
+}
+
+void RpcAdmission::leave(size_t &count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    --count;
+}
+
+void RpcAdmission::refill(Bucket &bucket, Clock::time_point now) const
+{
+    if (now <= bucket.updated) {
+        return;
+    }
+
+    double elapsed = std::chrono::duration<double>(now - bucket.updated).count();
+    bucket.units = std::min(m_burst, bucket.units + elapsed * m_rate);
+    bucket.updated = now;
+}
+
+void RpcAdmission::removeIdle(Clock::time_point now)
+{
+    for (auto it = m_buckets.begin(); it != m_buckets.end();) {
+        refill(it->second, now);
+        if (it->second.units >= m_burst) {
+            it = m_buckets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // while most clients are busy, look again only once their number has doubled
+    m_removeIdleAt = std::max(MIN_TRACKED_CLIENTS, m_buckets.size() * 2);
+}
+
+} // namespace CryptoNote
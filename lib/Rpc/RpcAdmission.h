@@ -0,0 +1,85 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace CryptoNote {
+
+/*!
+    Decides which requests a public RPC server takes on.
+
+    Each client address has a bucket of work units that refills at a steady rate, a request
+    is admitted while the bucket holds its estimated cost, which is then taken from it. A
+    request costlier than a full bucket is never admitted. Besides, only a limited number of
+    requests are served at once, and as many streamed responses are sent at once, so slow
+    readers of streams do not hold off other requests. A zero limit disables the check.
+    Thread safe.
+*/
+class RpcAdmission
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    RpcAdmission();
+
+    void setLimits(size_t maxActive, double rate, double burst);
+
+    // Takes one of the requests served at once, it is given back when the handle and all
+    // its copies are gone. Empty when none is left.
+    std::shared_ptr<void> enter();
+    // as enter, for the responses being streamed
+    std::shared_ptr<void> enterStream();
+    // whether charge may refuse, the cost need not be estimated otherwise
+    bool chargesClients() const;
+    // takes cost work units from the bucket of client, false and nothing taken when it does
+    // not hold them
+    bool charge(uint32_t client, uint64_t cost, Clock::time_point now = Clock::now());
+
+    size_t activeCount() const;
+    size_t streamCount() const;
+    size_t clientCount() const;
+
+private:
+    struct Bucket
+    {
+        double units;
+        Clock::time_point updated;
+    };
+
+    std::shared_ptr<void> enter(size_t &count);
+    void leave(size_t &count);
+    void refill(Bucket &bucket, Clock::time_point now) const;
+    // forgets the clients whose bucket is full again
+    void removeIdle(Clock::time_point now);
+
+    size_t m_maxActive;
+    double m_rate;  // units per second
+    double m_burst; // units of a full bucket
+    size_t m_active;
+    size_t m_streams;
+    size_t m_removeIdleAt;
+    std::unordered_map<uint32_t, Bucket> m_buckets;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace CryptoNote
@@ -0,0 +1,149 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <Rpc/RpcResponseCache.h>
+
+namespace CryptoNote {
+
+namespace {
+
+// what the containers take beside the key and the body
+const size_t ITEM_OVERHEAD = 128;
+
+} // namespace
+
+RpcResponseCache::RpcResponseCache(size_t maxSize)
+    : m_maxSize(maxSize),
+      m_size(0),
+      m_generation(0),
+      m_hits(0),
+      m_misses(0)
+{
+}
+
+bool RpcResponseCache::get(const std::string &key, std::string &body)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_items.find(key);
+    if (it == m_items.end()) {
+        ++m_misses;
+        return false;
+    }
+
+    ++m_hits;
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lruPosition);
+    body = it->second.body;
+
+    return true;
+}
+
+void RpcResponseCache::put(const std::string &key,
+                           uint32_t height,
+                           const std::string &body,
+                           uint64_t generation)
+{
+    size_t size = key.size() + body.size() + ITEM_OVERHEAD;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (generation != m_generation || size > m_maxSize) {
+        return;
+    }
+
+    auto it = m_items.find(key);
+    if (it != m_items.end()) {
+        erase(it);
+    }
+
+    while (!m_lru.empty() && m_size + size > m_maxSize) {
+        erase(m_items.find(*m_lru.back()));
+    }
+
+    it = m_items.emplace(key, Item{ body, size, {}, {} }).first;
+    m_lru.push_front(&it->first);
+    it->second.lruPosition = m_lru.begin();
+    it->second.heightPosition = m_heights.emplace(height, &it->first);
+    m_size += size;
+}
+
+void RpcResponseCache::removeFrom(uint32_t height)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    ++m_generation;
+    auto it = m_heights.lower_bound(height);
+    while (it != m_heights.end()) {
+        erase(m_items.find(*(it++)->second));
+    }
+}
+
+void RpcResponseCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    ++m_generation;
+    m_items.clear();
+    m_lru.clear();
+    m_heights.clear();
+    m_size = 0;
+}
+
+uint64_t RpcResponseCache::generation() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_generation;
+}
+
+size_t RpcResponseCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_size;
+}
+
+size_t RpcResponseCache::count() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_items.size();
+}
+
+uint64_t RpcResponseCache::hits() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_hits;
+}
+
+uint64_t RpcResponseCache::misses() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_misses;
+}
+
+void RpcResponseCache::erase(Items::iterator it)
+{
+    m_size -= it->second.size;
+    m_lru.erase(it->second.lruPosition);
+    m_heights.erase(it->second.heightPosition);
+    m_items.erase(it);
+}
+
+} // namespace CryptoNote
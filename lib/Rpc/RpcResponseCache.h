@@ -0,0 +1,81 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace CryptoNote {
+
+/*!
+    Keeps the answers of RPC requests that only read the main chain, as the text that was sent.
+
+    Each entry remembers the height of the block it was read from and is dropped when that
+    block leaves the chain. Least recently used entries are dropped once the total size
+    exceeds the limit. Thread safe.
+*/
+class RpcResponseCache
+{
+public:
+    explicit RpcResponseCache(size_t maxSize);
+
+    bool get(const std::string &key, std::string &body);
+    // ignored when blocks were removed since generation was taken
+    void put(const std::string &key, uint32_t height, const std::string &body, uint64_t generation);
+
+    // drops the entries read from height and above
+    void removeFrom(uint32_t height);
+    void clear();
+
+    // changes whenever entries are dropped for a block leaving the chain
+    uint64_t generation() const;
+
+    size_t size() const;
+    size_t count() const;
+    uint64_t hits() const;
+    uint64_t misses() const;
+
+private:
+    struct Item
+    {
+        std::string body;
+        size_t size;
+        std::list<const std::string *>::iterator lruPosition;
+        std::multimap<uint32_t, const std::string *>::iterator heightPosition;
+    };
+
+    typedef std::unordered_map<std::string, Item> Items;
+
+    void erase(Items::iterator it);
+
+    const size_t m_maxSize;
+    size_t m_size;
+    uint64_t m_generation;
+    uint64_t m_hits;
+    uint64_t m_misses;
+    Items m_items;
+    std::list<const std::string *> m_lru; // keys, most recently used first
+    std::multimap<uint32_t, const std::string *> m_heights;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace CryptoNote
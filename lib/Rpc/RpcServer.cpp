@@ -20,9 +20,14 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <atomic>
 #include <string>
 #include <future>
+#include <limits>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <BlockchainExplorer/BlockchainExplorerData.h>
 #include <Common/StringTools.h>
 #include <Common/Base58.h>
@@ -38,14 +43,18 @@
 #include <CryptoNoteProtocol/ICryptoNoteProtocolQuery.h>
 #include <P2p/NetNode.h>
 #include <Rpc/CoreRpcServerErrorCodes.h>
+#include <Rpc/JsonArrayStream.h>
 #include <Rpc/JsonRpc.h>
 #include <Rpc/RpcServer.h>
+#include <System/Event.h>
+#include <System/InterruptedException.h>
 #include <version.h>
 
 #undef ERROR // TODO: WTF!?
 
 const uint32_t MAX_NUMBER_OF_BLOCKS_PER_STATS_REQUEST = 10000;
 const uint64_t BLOCK_LIST_MAX_COUNT = 1000;
+const size_t RESTRICTED_JSON_RPC_BATCH_MAX_COUNT = 100;
 
 using namespace Crypto;
 using namespace Common;
@@ -80,6 +89,34 @@ RpcServer::HandlerFunction binMethod(bool (RpcServer::*handler)(typename Command
     };
 }
 
+// binary variant of a streamed handler, the array is counted up front so it is read in full
+template<typename Command>
+RpcServer::HandlerFunction binStreamMethod(
+        bool (RpcServer::*handler)(typename Command::request const &,
+                                   typename Command::response &,
+                                   RpcServer::StreamProducer<typename Command::response> &))
+{
+    return [handler](RpcServer *obj, const HttpRequest &request, HttpResponse &response) {
+        boost::value_initialized<typename Command::request> req;
+        boost::value_initialized<typename Command::response> res;
+
+        if (!loadFromBinaryKeyValue(static_cast<typename Command::request &>(req),
+                                    request.getBody())) {
+            return false;
+        }
+
+        RpcServer::StreamProducer<typename Command::response> produce;
+        bool result = (obj->*handler)(req, res, produce);
+        if (result && produce) {
+            while (produce(res)) {
+            }
+        }
+        response.setBody(storeToBinaryKeyValue(res.data()));
+
+        return result;
+    };
+}
+
 template<typename Command>
 RpcServer::HandlerFunction jsonMethod(bool (RpcServer::*handler)(typename Command::request const &,
                                                                  typename Command::response &))
@@ -107,6 +144,249 @@ RpcServer::HandlerFunction jsonMethod(bool (RpcServer::*handler)(typename Comman
     };
 }
 
+// the height of the block an answer was read from, false when it is not to be kept
+template<typename Command>
+using CacheHeight = bool (*)(const typename Command::request &,
+                             const typename Command::response &,
+                             uint32_t &);
+
+template<typename Command>
+bool blockHeaderHeight(const typename Command::request &req,
+                       const typename Command::response &res,
+                       uint32_t &height)
+{
+    height = static_cast<uint32_t>(res.block_header.height);
+
+    return true;
+}
+
+template<typename Command>
+bool blockDetailsHeight(const typename Command::request &req,
+                        const typename Command::response &res,
+                        uint32_t &height)
+{
+    height = static_cast<uint32_t>(res.block.height);
+
+    return true;
+}
+
+template<typename Command>
+bool transactionHeight(const typename Command::request &req,
+                       const typename Command::response &res,
+                       uint32_t &height)
+{
+    // a pool transaction is answered without a block
+    height = res.transaction.blockHeight;
+
+    return res.transaction.inBlockchain;
+}
+
+bool blockHashHeight(const COMMAND_RPC_GET_BLOCK_HASH::request &req,
+                     const COMMAND_RPC_GET_BLOCK_HASH::response &res,
+                     uint32_t &height)
+{
+    height = static_cast<uint32_t>(req[0]);
+
+    return true;
+}
+
+// jsonMethod() answering from the response cache, the key is the url and the request body
+template<typename Command>
+RpcServer::HandlerFunction cachedJsonMethod(
+        bool (RpcServer::*handler)(typename Command::request const &,
+                                   typename Command::response &),
+        CacheHeight<Command> cacheHeight,
+        bool tipDependent)
+{
+    return [handler, cacheHeight, tipDependent](RpcServer *obj,
+                                                const HttpRequest &request,
+                                                HttpResponse &response) {
+        bool result = true;
+        std::string body;
+        obj->callCached(
+                request.getUrl() + ' ' + request.getBody(),
+                tipDependent,
+                [&](std::string &answer, uint32_t &height) {
+                    boost::value_initialized<typename Command::request> req;
+                    boost::value_initialized<typename Command::response> res;
+
+                    if (!loadFromJson(static_cast<typename Command::request &>(req),
+                                      request.getBody())) {
+                        result = false;
+                        return false;
+                    }
+
+                    result = (obj->*handler)(req, res);
+                    answer = storeToJson(res.data());
+
+                    return result && cacheHeight(req, res, height);
+                },
+                body);
+
+        if (body.empty()) {
+            return false;
+        }
+
+        std::string cors_domain = obj->getCorsDomain();
+        if (!cors_domain.empty()) {
+            response.addHeader("Access-Control-Allow-Origin", cors_domain);
+            response.addHeader("Access-Control-Allow-Headers",
+                               "Origin, X-Requested-With, Content-Type, Accept");
+            response.addHeader("Access-Control-Allow-Methods", "POST, GET, OPTIONS");
+        }
+        response.addHeader("Content-Type", "application/json");
+        response.setBody(body);
+
+        return result;
+    };
+}
+
+template<typename Command, typename Item>
+RpcServer::HandlerFunction jsonStreamMethod(
+        bool (RpcServer::*handler)(typename Command::request const &,
+                                   typename Command::response &,
+                                   RpcServer::StreamProducer<typename Command::response> &),
+        std::vector<Item> Command::response::*array,
+        const char *name)
+{
+    return [handler, array, name](RpcServer *obj,
+                                  const HttpRequest &request,
+                                  HttpResponse &response) {
+        typedef typename Command::response Response;
+
+        boost::value_initialized<typename Command::request> req;
+        auto res = std::make_shared<Response>();
+
+        if (!loadFromJson(static_cast<typename Command::request &>(req), request.getBody())) {
+            return false;
+        }
+
+        RpcServer::StreamProducer<Response> produce;
+        bool result = (obj->*handler)(req, *res, produce);
+        std::string cors_domain = obj->getCorsDomain();
+        if (!cors_domain.empty()) {
+            response.addHeader("Access-Control-Allow-Origin", cors_domain);
+            response.addHeader("Access-Control-Allow-Headers",
+                               "Origin, X-Requested-With, Content-Type, Accept");
+            response.addHeader("Access-Control-Allow-Methods", "POST, GET, OPTIONS");
+        }
+        response.addHeader("Content-Type", "application/json");
+
+        if (result && produce) {
+            response.setChunkedBody(makeJsonArrayStream<Response, Item>(
+                res,
+                array,
+                name,
+                [](const Response &r) { return storeToJson(r); },
+                produce));
+        } else {
+            response.setBody(storeToJson(*res));
+        }
+
+        return result;
+    };
+}
+
+typedef std::function<bool(RpcServer *,
+                           const JsonRpc::JsonRpcRequest &,
+                           JsonRpc::JsonRpcResponse &,
+                           HttpResponse *)> JsonRpcStreamMethod;
+
+// Returns true when the result is streamed into the HTTP response. Without one, as for
+// calls of a batch, the result is collected first.
+template<typename Command, typename Item>
+JsonRpcStreamMethod jsonRpcStreamMethod(
+        bool (RpcServer::*handler)(typename Command::request const &,
+                                   typename Command::response &,
+                                   RpcServer::StreamProducer<typename Command::response> &),
+        std::vector<Item> Command::response::*array,
+        const char *name)
+{
+    return [handler, array, name](RpcServer *obj,
+                                  const JsonRpc::JsonRpcRequest &jsonRequest,
+                                  JsonRpc::JsonRpcResponse &jsonResponse,
+                                  HttpResponse *response) {
+        typedef typename Command::response Response;
+
+        boost::value_initialized<typename Command::request> req;
+        auto res = std::make_shared<Response>();
+
+        if (!jsonRequest.loadParams(static_cast<typename Command::request &>(req))) {
+            throw JsonRpc::JsonRpcError(JsonRpc::errInvalidParams);
+        }
+
+        RpcServer::StreamProducer<Response> produce;
+        if (!(obj->*handler)(req, *res, produce)) {
+            return false;
+        }
+
+        if (!produce || response == nullptr) {
+            while (produce && produce(*res)) {
+            }
+            jsonResponse.setResult(*res);
+            return false;
+        }
+
+        JsonRpc::OptionalId id = jsonRequest.getId();
+        response->setChunkedBody(makeJsonArrayStream<Response, Item>(
+            res,
+            array,
+            name,
+            [id](const Response &r) {
+                JsonRpc::JsonRpcResponse envelope;
+                envelope.setId(id);
+                envelope.setResult(r);
+                return envelope.getBody();
+            },
+            produce));
+
+        return true;
+    };
+}
+
+// makeMemberMethod() answering from the response cache, the key is the method and its params
+template<typename Command>
+JsonRpc::JsonMemberMethod cachedJsonRpcMethod(
+        bool (RpcServer::*handler)(typename Command::request const &,
+                                   typename Command::response &),
+        CacheHeight<Command> cacheHeight,
+        bool tipDependent)
+{
+    return [handler, cacheHeight, tipDependent](void *obj,
+                                                const JsonRpc::JsonRpcRequest &jsonRequest,
+                                                JsonRpc::JsonRpcResponse &jsonResponse) {
+        RpcServer *server = static_cast<RpcServer *>(obj);
+        bool result = true;
+        std::string body;
+        server->callCached(
+                jsonRequest.getMethod() + ' ' + jsonRequest.getRawParams(),
+                tipDependent,
+                [&](std::string &answer, uint32_t &height) {
+                    boost::value_initialized<typename Command::request> req;
+                    boost::value_initialized<typename Command::response> res;
+
+                    if (!jsonRequest.loadParams(static_cast<typename Command::request &>(req))) {
+                        throw JsonRpc::JsonRpcError(JsonRpc::errInvalidParams);
+                    }
+
+                    result = (server->*handler)(req, res);
+                    if (!result) {
+                        return false;
+                    }
+                    answer = storeToJson(res.data());
+
+                    return cacheHeight(req, res, height);
+                },
+                body);
+
+        if (result) {
+            jsonResponse.setResultText(body);
+        }
+
+        return result;
+    };
+}
+
 template<typename Command>
 RpcServer::HandlerFunction httpMethod(bool (RpcServer::*handler)(typename Command::request const &,
                                                                  typename Command::response &))
@@ -139,6 +419,108 @@ RpcServer::HandlerFunction httpMethod(bool (RpcServer::*handler)(typename Comman
     };
 }
 
+// work units of a block or transaction answered with its details
+const uint64_t DETAILS_COST = 4;
+
+// estimated work of a request in units, about one block, transaction or output read
+typedef std::function<uint64_t(const std::string &body, bool binary)> RequestCost;
+
+template<typename Command>
+RequestCost requestCost(uint64_t (*cost)(const typename Command::request &))
+{
+    return [cost](const std::string &body, bool binary) -> uint64_t {
+        boost::value_initialized<typename Command::request> req;
+        bool loaded = binary
+                ? loadFromBinaryKeyValue(static_cast<typename Command::request &>(req), body)
+                : loadFromJson(static_cast<typename Command::request &>(req), body);
+
+        // a malformed request is refused by its handler
+        return loaded ? std::max<uint64_t>(1, cost(req)) : 1;
+    };
+}
+
+RequestCost fixedCost(uint64_t cost)
+{
+    return [cost](const std::string &, bool) { return cost; };
+}
+
+uint64_t heightsCost(const std::vector<uint32_t> &heights, bool range)
+{
+    if (range && heights.size() == 2) {
+        return heights[1] >= heights[0] ? static_cast<uint64_t>(heights[1]) - heights[0] + 1 : 1;
+    }
+
+    return heights.size();
+}
+
+// by method name, also the url of a route without the leading slash and the .bin suffix
+uint64_t estimateRequestCost(const std::string &name, const std::string &body, bool binary)
+{
+    static const std::unordered_map<std::string, RequestCost> costs = {
+        { "getblocks", fixedCost(COMMAND_RPC_GET_BLOCKS_FAST_MAX_COUNT) },
+        { "queryblocks", fixedCost(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT) },
+        { "queryblockslite", fixedCost(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT) },
+        { "queryblocksdetailed", fixedCost(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT * DETAILS_COST) },
+        { "getrandom_outs",
+          requestCost<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS>(
+                  [](const COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::request &req) -> uint64_t {
+                      // both come from the client, saturate instead of wrapping around
+                      if (!req.amounts.empty()
+                          && req.outs_count > std::numeric_limits<uint64_t>::max() / req.amounts.size()) {
+                          return std::numeric_limits<uint64_t>::max();
+                      }
+
+                      return req.amounts.size() * req.outs_count;
+                  }) },
+        { "getstatsinrange",
+          requestCost<COMMAND_RPC_GET_STATS_BY_HEIGHTS_RANGE>(
+                  [](const COMMAND_RPC_GET_STATS_BY_HEIGHTS_RANGE::request &req) -> uint64_t {
+                      return req.endHeight >= req.startHeight
+                              ? static_cast<uint64_t>(req.endHeight) - req.startHeight + 1
+                              : 1;
+                  }) },
+        { "getstatsbyheights",
+          requestCost<COMMAND_RPC_GET_STATS_BY_HEIGHTS>(
+                  [](const COMMAND_RPC_GET_STATS_BY_HEIGHTS::request &req) -> uint64_t {
+                      return req.heights.size();
+                  }) },
+        { "get_blocks_details_by_heights",
+          requestCost<COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS>(
+                  [](const COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS::request &req) -> uint64_t {
+                      return req.blockHeights.size() * DETAILS_COST;
+                  }) },
+        { "get_blocks_details_by_hashes",
+          requestCost<COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES>(
+                  [](const COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES::request &req) -> uint64_t {
+                      return req.blockHashes.size() * DETAILS_COST;
+                  }) },
+        { "get_transaction_details_by_hashes",
+          requestCost<COMMAND_RPC_GET_TRANSACTIONS_DETAILS_BY_HASHES>(
+                  [](const COMMAND_RPC_GET_TRANSACTIONS_DETAILS_BY_HASHES::request &req) -> uint64_t {
+                      return req.transactionHashes.size() * DETAILS_COST;
+                  }) },
+        { "gettransactions",
+          requestCost<COMMAND_RPC_GET_TRANSACTIONS>(
+                  [](const COMMAND_RPC_GET_TRANSACTIONS::request &req) -> uint64_t {
+                      return req.txs_hashes.size();
+                  }) },
+        { "get_transactions_by_heights",
+          requestCost<COMMAND_RPC_GET_TRANSACTIONS_BY_HEIGHTS>(
+                  [](const COMMAND_RPC_GET_TRANSACTIONS_BY_HEIGHTS::request &req) -> uint64_t {
+                      return heightsCost(req.heights, req.range);
+                  }) },
+        { "get_raw_transactions_by_heights",
+          requestCost<COMMAND_RPC_GET_RAW_TRANSACTIONS_BY_HEIGHTS>(
+                  [](const COMMAND_RPC_GET_RAW_TRANSACTIONS_BY_HEIGHTS::request &req) -> uint64_t {
+                      return heightsCost(req.heights, req.range);
+                  }) }
+    };
+
+    auto it = costs.find(name);
+
+    return it != costs.end() ? it->second(body, binary) : 1;
+}
+
 } // namespace
 
 std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction>>
@@ -163,6 +545,20 @@ std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction
               { binMethod<COMMAND_RPC_GET_POOL_CHANGES_LITE>(&RpcServer::onGetPoolChangesLite),
                 false } },
 
+            // explorer data, hashes and keys are sent as raw bytes instead of hex
+            { "/get_blocks_details_by_heights.bin",
+              { binStreamMethod<COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS>(
+                        &RpcServer::onGetBlocksDetailsByHeights),
+                false } },
+            { "/get_transaction_details_by_hashes.bin",
+              { binMethod<COMMAND_RPC_GET_TRANSACTIONS_DETAILS_BY_HASHES>(
+                        &RpcServer::onGetTransactionsDetailsByHashes),
+                false } },
+            { "/getstatsinrange.bin",
+              { binStreamMethod<COMMAND_RPC_GET_STATS_BY_HEIGHTS_RANGE>(
+                        &RpcServer::onGetStatsByHeightsRange),
+                false } },
+
             // http handlers
             { "/", { httpMethod<COMMAND_HTTP>(&RpcServer::onGetIndex), true } },
             { "/supply", { httpMethod<COMMAND_HTTP>(&RpcServer::onGetSupply), false } },
@@ -174,13 +570,20 @@ std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction
               { jsonMethod<COMMAND_RPC_GET_VERSION>(&RpcServer::onGetVersion), true } },
             { "/gethardwareinfo",
               { jsonMethod<COMMAND_RPC_GET_HARDWARE_INFO>(&RpcServer::onGetHardwareInfo), true } },
-            { "/getheight", { jsonMethod<COMMAND_RPC_GET_HEIGHT>(&RpcServer::onGetHeight), true } },
+            { "/getheight",
+              { [](RpcServer *obj, const HttpRequest &request, HttpResponse &response) {
+                    return obj->sendChainStatus(&ChainStatus::heightBody, response);
+                },
+                true } },
             { "/gettransactions",
               { jsonMethod<COMMAND_RPC_GET_TRANSACTIONS>(&RpcServer::onGetTransactions), false } },
             { "/sendrawtransaction",
               { jsonMethod<COMMAND_RPC_SEND_RAW_TX>(&RpcServer::onSendRawTx), false } },
             { "/feeaddress",
-              { jsonMethod<COMMAND_RPC_GET_FEE_ADDRESS>(&RpcServer::onGetFeeAddress), true } },
+              { [](RpcServer *obj, const HttpRequest &request, HttpResponse &response) {
+                    return obj->sendChainStatus(&ChainStatus::feeAddressBody, response);
+                },
+                true } },
             { "/peers",
               { jsonMethod<COMMAND_RPC_GET_PEER_LIST>(&RpcServer::onGetPeerList), true } },
             { "/get_mempool",
@@ -212,16 +615,22 @@ std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction
               { jsonMethod<COMMAND_RPC_GET_POOL_CHANGES_LITE>(&RpcServer::onGetPoolChangesLite),
                 false } },
             { "/get_block_details_by_height",
-              { jsonMethod<COMMAND_RPC_GET_BLOCK_DETAILS_BY_HEIGHT>(
-                        &RpcServer::onGetBlockDetailsByHeight),
+              { cachedJsonMethod<COMMAND_RPC_GET_BLOCK_DETAILS_BY_HEIGHT>(
+                        &RpcServer::onGetBlockDetailsByHeight,
+                        &blockDetailsHeight<COMMAND_RPC_GET_BLOCK_DETAILS_BY_HEIGHT>,
+                        true),
                 false } },
             { "/get_block_details_by_hash",
-              { jsonMethod<COMMAND_RPC_GET_BLOCK_DETAILS_BY_HASH>(
-                        &RpcServer::onGetBlockDetailsByHash),
+              { cachedJsonMethod<COMMAND_RPC_GET_BLOCK_DETAILS_BY_HASH>(
+                        &RpcServer::onGetBlockDetailsByHash,
+                        &blockDetailsHeight<COMMAND_RPC_GET_BLOCK_DETAILS_BY_HASH>,
+                        true),
                 true } },
             { "/get_blocks_details_by_heights",
-              { jsonMethod<COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS>(
-                        &RpcServer::onGetBlocksDetailsByHeights),
+              { jsonStreamMethod<COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS>(
+                        &RpcServer::onGetBlocksDetailsByHeights,
+                        &COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS::response::blocks,
+                        "blocks"),
                 false } },
             { "/get_blocks_details_by_hashes",
               { jsonMethod<COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES>(
@@ -236,16 +645,22 @@ std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction
                         &RpcServer::onGetTransactionsDetailsByHashes),
                 false } },
             { "/get_transaction_details_by_hash",
-              { jsonMethod<COMMAND_RPC_GET_TRANSACTION_DETAILS_BY_HASH>(
-                        &RpcServer::onGetTransactionDetailsByHash),
+              { cachedJsonMethod<COMMAND_RPC_GET_TRANSACTION_DETAILS_BY_HASH>(
+                        &RpcServer::onGetTransactionDetailsByHash,
+                        &transactionHeight<COMMAND_RPC_GET_TRANSACTION_DETAILS_BY_HASH>,
+                        false),
                 true } },
             { "/get_transactions_by_heights",
-              { jsonMethod<COMMAND_RPC_GET_TRANSACTIONS_BY_HEIGHTS>(
-                        &RpcServer::onGetTransactionsByHeights),
+              { jsonStreamMethod<COMMAND_RPC_GET_TRANSACTIONS_BY_HEIGHTS>(
+                        &RpcServer::onGetTransactionsByHeights,
+                        &COMMAND_RPC_GET_TRANSACTIONS_BY_HEIGHTS::response::txs,
+                        "txs"),
                 false } },
             { "/get_raw_transactions_by_heights",
-              { jsonMethod<COMMAND_RPC_GET_RAW_TRANSACTIONS_BY_HEIGHTS>(
-                        &RpcServer::onGetRawTransactionsByHeights),
+              { jsonStreamMethod<COMMAND_RPC_GET_RAW_TRANSACTIONS_BY_HEIGHTS>(
+                        &RpcServer::onGetRawTransactionsByHeights,
+                        &COMMAND_RPC_GET_RAW_TRANSACTIONS_BY_HEIGHTS::response::transactions,
+                        "transactions"),
                 false } },
             { "/get_raw_transactions_from_pool",
               { jsonMethod<COMMAND_RPC_GET_RAW_TRANSACTIONS_FROM_POOL>(
@@ -281,14 +696,204 @@ RpcServer::RpcServer(System::Dispatcher &dispatcher, Logging::ILogger &log, core
       m_core(core),
       m_p2p(p2p),
       m_protocolQuery(protocolQuery),
-      blockchainExplorerDataBuilder(core, protocolQuery)
+      blockchainExplorerDataBuilder(core, protocolQuery),
+      m_chainGeneration(0),
+      m_responseCache(RPC_RESPONSE_CACHE_MAX_SIZE),
+      m_batchWorkers(std::max(1u, std::thread::hardware_concurrency()))
+{
+    m_core.addObserver(this);
+}
+
+RpcServer::~RpcServer()
+{
+    m_core.removeObserver(this);
+}
+
+void RpcServer::blockchainUpdated()
+{
+    ++m_chainGeneration;
+}
+
+void RpcServer::poolUpdated()
+{
+    ++m_chainGeneration;
+}
+
+void RpcServer::blockRemoved(uint32_t height)
+{
+    m_responseCache.removeFrom(height);
+}
+
+void RpcServer::callCached(std::string key,
+                           bool tipDependent,
+                           const std::function<bool(std::string &body, uint32_t &height)> &call,
+                           std::string &body)
+{
+    uint32_t chainHeight = 0;
+    if (tipDependent) {
+        // such answers tell the depth of the block, it grows with every block added
+        chainHeight = m_core.getCurrentBlockchainHeight();
+        key += " @" + std::to_string(chainHeight);
+    }
+
+    if (m_responseCache.get(key, body)) {
+        return;
+    }
+
+    uint64_t generation = m_responseCache.generation();
+    uint32_t height;
+    if (call(body, height)
+        && (!tipDependent || m_core.getCurrentBlockchainHeight() == chainHeight)) {
+        m_responseCache.put(key, height, body, generation);
+    }
+}
+
+std::shared_ptr<const RpcServer::ChainStatus> RpcServer::getChainStatus()
+{
+    uint32_t lastKnownBlockIndex =
+            std::max(static_cast<uint32_t>(1), m_protocolQuery.getObservedHeight()) - 1;
+
+    // a synced node reports the difficulty for a block found now, that one ages
+    std::shared_ptr<const ChainStatus> status = std::atomic_load(&m_chainStatus);
+    if (status && status->generation == m_chainGeneration
+        && status->info.last_known_block_index == lastKnownBlockIndex
+        && (status->info.height != lastKnownBlockIndex || status->builtAt == time(nullptr))) {
+        return status;
+    }
+
+    auto fresh = std::make_shared<ChainStatus>();
+    // taken first, a change while building makes the next request build again
+    fresh->generation = m_chainGeneration;
+    fresh->builtAt = time(nullptr);
+    fillChainInfo(lastKnownBlockIndex, fresh->info);
+
+    COMMAND_RPC_GET_HEIGHT::response height;
+    onGetHeight(COMMAND_RPC_GET_HEIGHT::request(), height);
+    fresh->heightBody = storeToJson(height);
+
+    boost::value_initialized<COMMAND_RPC_GET_FEE_ADDRESS::response> feeAddress;
+    onGetFeeAddress(COMMAND_RPC_GET_FEE_ADDRESS::request(), feeAddress);
+    fresh->feeAddressBody = storeToJson(feeAddress.data());
+
+    boost::value_initialized<COMMAND_RPC_GET_LAST_BLOCK_HEADER::response> lastBlockHeader;
+    onGetLastBlockHeader(COMMAND_RPC_GET_LAST_BLOCK_HEADER::request(), lastBlockHeader);
+    fresh->lastBlockHeaderResult = storeToJson(lastBlockHeader.data());
+
+    status = fresh;
+    std::atomic_store(&m_chainStatus, status);
+
+    return status;
+}
+
+bool RpcServer::sendChainStatus(std::string ChainStatus::*body, HttpResponse &response)
 {
+    std::shared_ptr<const ChainStatus> status = getChainStatus();
+
+    if (!m_cors_domain.empty()) {
+        response.addHeader("Access-Control-Allow-Origin", m_cors_domain);
+        response.addHeader("Access-Control-Allow-Headers",
+                           "Origin, X-Requested-With, Content-Type, Accept");
+        response.addHeader("Access-Control-Allow-Methods", "POST, GET, OPTIONS");
+    }
+    response.addHeader("Content-Type", "application/json");
+    response.setBody((*status).*body);
+
+    return true;
 }
 
 void RpcServer::processRequest(const HttpRequest &request, HttpResponse &response)
 {
     logger(TRACE) << "RPC request came: \n" << request << std::endl;
 
+    // refused before any work is done, so cheap requests stay quick while a client floods us
+    std::shared_ptr<void> slot = m_admission.enter();
+    if (!slot) {
+        refuseRequest(request, response, HttpResponse::STATUS_503,
+                      CORE_RPC_ERROR_CODE_SERVER_BUSY, "Server is busy");
+        return;
+    }
+
+    if (m_admission.chargesClients()
+        && !m_admission.charge(request.getPeerAddress(), requestCost(request))) {
+        refuseRequest(request, response, HttpResponse::STATUS_429,
+                      CORE_RPC_ERROR_CODE_TOO_MANY_REQUESTS, "Too many requests");
+        return;
+    }
+
+    serveRequest(request, response);
+
+    if (response.isChunked()) {
+        // a streamed body is produced while it is sent, which takes as long as the client
+        // reads, so it holds a stream instead of the request slot given back here
+        std::shared_ptr<void> stream = m_admission.enterStream();
+        if (!stream) {
+            refuseRequest(request, response, HttpResponse::STATUS_503,
+                          CORE_RPC_ERROR_CODE_SERVER_BUSY, "Server is busy");
+            return;
+        }
+
+        HttpResponse::ChunkSource source = response.getChunkedBody();
+        response.setChunkedBody([source, stream](std::string &chunk) { return source(chunk); });
+    }
+}
+
+uint64_t RpcServer::requestCost(const HttpRequest &request) const
+{
+    const std::string &url = request.getUrl();
+    if (url != "/json_rpc") {
+        bool binary = Common::ends_with(url, ".bin");
+        std::string name = url.empty() ? url : url.substr(1, url.size() - (binary ? 5 : 1));
+
+        return estimateRequestCost(name, request.getBody(), binary);
+    }
+
+    // a batch costs what its calls cost
+    std::vector<std::string> calls;
+    try {
+        if (!JsonRpc::splitBatch(request.getBody(), calls)) {
+            calls.assign(1, request.getBody());
+        }
+    } catch (std::exception &) {
+        return 1;
+    }
+
+    uint64_t cost = 0;
+    for (const std::string &call : calls) {
+        try {
+            JsonRpc::JsonRpcRequest jsonRequest;
+            jsonRequest.parseRequest(call);
+            cost += estimateRequestCost(jsonRequest.getMethod(), jsonRequest.getRawParams(), false);
+        } catch (std::exception &) {
+            // answered with the error when called
+            cost += 1;
+        }
+    }
+
+    return std::max<uint64_t>(1, cost);
+}
+
+void RpcServer::refuseRequest(const HttpRequest &request,
+                              HttpResponse &response,
+                              HttpResponse::HTTP_STATUS status,
+                              int code,
+                              const std::string &message)
+{
+    logger(DEBUGGING) << "Refused " << request.getUrl() << ": " << message;
+
+    JsonRpc::JsonRpcError error(code, message);
+    response.setStatus(status);
+    response.addHeader("Content-Type", "application/json");
+    if (request.getUrl() == "/json_rpc") {
+        JsonRpc::JsonRpcResponse jsonResponse;
+        jsonResponse.setError(error);
+        response.setBody(jsonResponse.getBody());
+    } else {
+        response.setBody(storeToJsonValue(error).toString());
+    }
+}
+
+void RpcServer::serveRequest(const HttpRequest &request, HttpResponse &response)
+{
     /*
      * Greetings to Aivve from the Karbowanec project for this idea.
      */
@@ -578,38 +1183,187 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest &request, HttpResponse &
         response.addHeader("Access-Control-Allow-Methods", "POST, GET, OPTIONS");
     }
 
+    logger(TRACE) << "JSON-RPC request: " << request.getBody();
+
+    std::string body;
+    try {
+        std::vector<std::string> calls;
+        if (splitBatch(request.getBody(), calls)) {
+            body = processJsonRpcBatch(calls);
+        } else {
+            body = processJsonRpcCall(request.getBody(), isCoreReady(), &response);
+        }
+    } catch (const JsonRpcError &err) {
+        JsonRpcResponse jsonResponse;
+        jsonResponse.setError(err);
+        body = jsonResponse.getBody();
+    }
+
+    if (response.isChunked()) {
+        logger(TRACE) << "JSON-RPC response: streamed";
+    } else {
+        response.setBody(body);
+        logger(TRACE) << "JSON-RPC response: " << body;
+    }
+
+    return true;
+}
+
+std::string RpcServer::processJsonRpcBatch(const std::vector<std::string> &calls)
+{
+    using namespace JsonRpc;
+
+    // calls that only read the chain, through the locks of the core
+    static const std::unordered_set<std::string> concurrentMethods = {
+        "getblockcount",
+        "on_getblockhash",
+        "getblockheaderbyhash",
+        "getblockheaderbyheight",
+        "getblockbyhash",
+        "get_block_details_by_height",
+        "get_blocks_details_by_hashes",
+        "gettransaction",
+        "get_transaction_details_by_hashes",
+        "f_block_json",
+        "f_transaction_json"
+    };
+
+    if (m_restricted_rpc && calls.size() > RESTRICTED_JSON_RPC_BATCH_MAX_COUNT) {
+        throw JsonRpcError { CORE_RPC_ERROR_CODE_WRONG_PARAM,
+                             "Batch of " + std::to_string(calls.size())
+                                     + " calls exceeded max limit of "
+                                     + std::to_string(RESTRICTED_JSON_RPC_BATCH_MAX_COUNT) };
+    }
+
+    bool coreReady = isCoreReady();
+    std::vector<std::string> bodies(calls.size());
+    std::vector<size_t> concurrentCalls;
+    std::vector<size_t> calledHere;
+
+    for (size_t i = 0; i < calls.size(); ++i) {
+        JsonRpcRequest jsonRequest;
+        bool concurrent = false;
+        try {
+            jsonRequest.parseRequest(calls[i]);
+            concurrent = concurrentMethods.count(jsonRequest.getMethod()) != 0;
+        } catch (std::exception &) {
+            // answered with the error when called
+        }
+
+        (concurrent ? concurrentCalls : calledHere).push_back(i);
+    }
+
+    // the workers take the next call until none is left, meanwhile the rest run here
+    std::atomic<size_t> next(0);
+    size_t workerCount = std::min(concurrentCalls.size(), m_batchWorkers.threadCount());
+    size_t runningWorkers = workerCount; // only changed on the dispatcher
+    System::Event workersDone(m_dispatcher);
+    for (size_t worker = 0; worker < workerCount; ++worker) {
+        m_batchWorkers.post([&]() {
+            for (size_t i = next++; i < concurrentCalls.size(); i = next++) {
+                size_t call = concurrentCalls[i];
+                bodies[call] = processJsonRpcCall(calls[call], coreReady, nullptr);
+            }
+
+            // the last thing done with the batch, it is gone once workersDone is set
+            m_dispatcher.remoteSpawn([&runningWorkers, &workersDone]() {
+                if (--runningWorkers == 0) {
+                    workersDone.set();
+                }
+            });
+        });
+    }
+
+    for (size_t call : calledHere) {
+        bodies[call] = processJsonRpcCall(calls[call], coreReady, nullptr);
+    }
+
+    bool interrupted = false;
+    while (workerCount != 0 && !workersDone.get()) {
+        try {
+            workersDone.wait();
+        } catch (System::InterruptedException &) {
+            interrupted = true;
+        }
+    }
+
+    if (interrupted) {
+        m_dispatcher.interrupt();
+    }
+
+    std::string body = "[";
+    for (const std::string &callBody : bodies) {
+        if (body.size() > 1) {
+            body += ',';
+        }
+        body += callBody;
+    }
+    body += ']';
+
+    return body;
+}
+
+std::string RpcServer::processJsonRpcCall(const std::string &requestBody,
+                                          bool coreReady,
+                                          HttpResponse *response)
+{
+    using namespace JsonRpc;
+
     JsonRpcRequest jsonRequest;
     JsonRpcResponse jsonResponse;
 
     try {
-        logger(TRACE) << "JSON-RPC request: " << request.getBody();
-
-        jsonRequest.parseRequest(request.getBody());
+        jsonRequest.parseRequest(requestBody);
         jsonResponse.setId(jsonRequest.getId()); // copy id
 
         static std::unordered_map<std::string, RpcServer::RpcHandler<JsonMemberMethod>>
                 jsonRpcHandlers = {
                     { "getblockcount", { makeMemberMethod(&RpcServer::onGetBlockCount), true } },
-                    { "on_getblockhash", { makeMemberMethod(&RpcServer::onGetBlockHash), false } },
+                    { "on_getblockhash",
+                      { cachedJsonRpcMethod<COMMAND_RPC_GET_BLOCK_HASH>(
+                                &RpcServer::onGetBlockHash, &blockHashHeight, false),
+                        false } },
                     { "getblocktemplate",
                       { makeMemberMethod(&RpcServer::onGetBlockTemplate), false } },
                     { "getcurrencyid", { makeMemberMethod(&RpcServer::onGetCurrencyId), true } },
                     { "submitblock", { makeMemberMethod(&RpcServer::onSubmitBlock), false } },
                     { "getlastblockheader",
-                      { makeMemberMethod(&RpcServer::onGetLastBlockHeader), false } },
+                      { [](void *obj, const JsonRpcRequest &req, JsonRpcResponse &res) {
+                            auto status = static_cast<RpcServer *>(obj)->getChainStatus();
+                            res.setResultText(status->lastBlockHeaderResult);
+                            return true;
+                        },
+                        false } },
                     { "getblockheaderbyhash",
-                      { makeMemberMethod(&RpcServer::onGetBlockHeaderByHash), false } },
+                      { cachedJsonRpcMethod<COMMAND_RPC_GET_BLOCK_HEADER_BY_HASH>(
+                                &RpcServer::onGetBlockHeaderByHash,
+                                &blockHeaderHeight<COMMAND_RPC_GET_BLOCK_HEADER_BY_HASH>,
+                                true),
+                        false } },
                     { "getblockheaderbyheight",
-                      { makeMemberMethod(&RpcServer::onGetBlockHeaderByHeight), false } },
+                      { cachedJsonRpcMethod<COMMAND_RPC_GET_BLOCK_HEADER_BY_HEIGHT>(
+                                &RpcServer::onGetBlockHeaderByHeight,
+                                &blockHeaderHeight<COMMAND_RPC_GET_BLOCK_HEADER_BY_HEIGHT>,
+                                true),
+                        false } },
                     { "getblockbyhash",
-                      { makeMemberMethod(&RpcServer::onGetBlockDetailsByHash), true } },
+                      { cachedJsonRpcMethod<COMMAND_RPC_GET_BLOCK_DETAILS_BY_HASH>(
+                                &RpcServer::onGetBlockDetailsByHash,
+                                &blockDetailsHeight<COMMAND_RPC_GET_BLOCK_DETAILS_BY_HASH>,
+                                true),
+                        true } },
                     { "f_blocks_list_json",
                       { makeMemberMethod(&RpcServer::onBlocksListJson), false } },
                     { "getblockslist",
                             { makeMemberMethod(&RpcServer::onBlocksListJson), false } },
                     { "getaltblockslist",
                             { makeMemberMethod(&RpcServer::onAltBlocksListJson), false } },
-                    { "f_block_json", { makeMemberMethod(&RpcServer::onBlockJson), false } },
+                    { "f_block_json",
+                      { cachedJsonRpcMethod<COMMAND_RPC_GET_BLOCK_DETAILS>(
+                                &RpcServer::onBlockJson,
+                                &blockDetailsHeight<COMMAND_RPC_GET_BLOCK_DETAILS>,
+                                true),
+                        false } },
                     { "f_transaction_json",
                       { makeMemberMethod(&RpcServer::onTransactionJson), false } },
                     { "get_mempool",
@@ -623,20 +1377,23 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest &request, HttpResponse &
                       { makeMemberMethod(&RpcServer::onGetTransactionHashesByPaymentId), false } },
                     { "get_transaction_details_by_hashes",
                       { makeMemberMethod(&RpcServer::onGetTransactionsDetailsByHashes), false } },
-                    { "get_transactions_by_heights",
-                      { makeMemberMethod(&RpcServer::onGetTransactionsByHeights), false } },
                     { "gettransaction",
-                      { makeMemberMethod(&RpcServer::onGetTransactionDetailsByHash), false } },
-                    { "get_blocks_details_by_heights",
-                      { makeMemberMethod(&RpcServer::onGetBlocksDetailsByHeights), false } },
+                      { cachedJsonRpcMethod<COMMAND_RPC_GET_TRANSACTION_DETAILS_BY_HASH>(
+                                &RpcServer::onGetTransactionDetailsByHash,
+                                &transactionHeight<COMMAND_RPC_GET_TRANSACTION_DETAILS_BY_HASH>,
+                                false),
+                        false } },
                     { "get_block_details_by_height",
-                      { makeMemberMethod(&RpcServer::onGetBlockDetailsByHeight), false } },
+                      { cachedJsonRpcMethod<COMMAND_RPC_GET_BLOCK_DETAILS_BY_HEIGHT>(
+                                &RpcServer::onGetBlockDetailsByHeight,
+                                &blockDetailsHeight<COMMAND_RPC_GET_BLOCK_DETAILS_BY_HEIGHT>,
+                                true),
+                        false } },
                     { "get_blocks_details_by_hashes",
                       { makeMemberMethod(&RpcServer::onGetBlocksDetailsByHashes), false } },
                     { "get_blocks_hashes_by_timestamps",
                       { makeMemberMethod(&RpcServer::onGetBlocksHashesByTimestamps), false } },
                     { "getstatsbyheights", { makeMemberMethod(&RpcServer::onGetStatsByHeights), false } },
-                    { "getstatsinrange", { makeMemberMethod(&RpcServer::onGetStatsByHeightsRange), false } },
                     { "check_tx_key", { makeMemberMethod(&RpcServer::onCheckTxKey), false } },
                     { "check_tx_with_view_key",
                       { makeMemberMethod(&RpcServer::onCheckTxWithViewKey), false } },
@@ -648,24 +1405,54 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest &request, HttpResponse &
                     { "verifymessage", { makeMemberMethod(&RpcServer::onVerifyMessage), false } }
                 };
 
-        auto it = jsonRpcHandlers.find(jsonRequest.getMethod());
-        if (it == jsonRpcHandlers.end()) {
-            throw JsonRpcError(JsonRpc::errMethodNotFound);
-        }
-        if (!it->second.allowBusyCore && !isCoreReady()) {
-            throw JsonRpcError(CORE_RPC_ERROR_CODE_CORE_BUSY, "Core is busy");
+        // these answer large ranges, their results are sent while being read
+        static std::unordered_map<std::string, RpcServer::RpcHandler<JsonRpcStreamMethod>>
+                jsonRpcStreamHandlers = {
+                    { "get_transactions_by_heights",
+                      { jsonRpcStreamMethod<COMMAND_RPC_GET_TRANSACTIONS_BY_HEIGHTS>(
+                                &RpcServer::onGetTransactionsByHeights,
+                                &COMMAND_RPC_GET_TRANSACTIONS_BY_HEIGHTS::response::txs,
+                                "txs"),
+                        false } },
+                    { "get_blocks_details_by_heights",
+                      { jsonRpcStreamMethod<COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS>(
+                                &RpcServer::onGetBlocksDetailsByHeights,
+                                &COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS::response::blocks,
+                                "blocks"),
+                        false } },
+                    { "getstatsinrange",
+                      { jsonRpcStreamMethod<COMMAND_RPC_GET_STATS_BY_HEIGHTS_RANGE>(
+                                &RpcServer::onGetStatsByHeightsRange,
+                                &COMMAND_RPC_GET_STATS_BY_HEIGHTS_RANGE::response::stats,
+                                "stats"),
+                        false } }
+                };
+
+        auto streamIt = jsonRpcStreamHandlers.find(jsonRequest.getMethod());
+        if (streamIt != jsonRpcStreamHandlers.end()) {
+            if (!streamIt->second.allowBusyCore && !coreReady) {
+                throw JsonRpcError(CORE_RPC_ERROR_CODE_CORE_BUSY, "Core is busy");
+            }
+            if (streamIt->second.handler(this, jsonRequest, jsonResponse, response)) {
+                return std::string();
+            }
+        } else {
+            auto it = jsonRpcHandlers.find(jsonRequest.getMethod());
+            if (it == jsonRpcHandlers.end()) {
+                throw JsonRpcError(JsonRpc::errMethodNotFound);
+            }
+            if (!it->second.allowBusyCore && !coreReady) {
+                throw JsonRpcError(CORE_RPC_ERROR_CODE_CORE_BUSY, "Core is busy");
+            }
+            it->second.handler(this, jsonRequest, jsonResponse);
         }
-        it->second.handler(this, jsonRequest, jsonResponse);
     } catch (const JsonRpcError &err) {
         jsonResponse.setError(err);
     } catch (const std::exception &e) {
         jsonResponse.setError(JsonRpcError(JsonRpc::errInternalError, e.what()));
     }
 
-    response.setBody(jsonResponse.getBody());
-    logger(TRACE) << "JSON-RPC response: " << jsonResponse.getBody();
-
-    return true;
+    return jsonResponse.getBody();
 }
 
 bool RpcServer::restrictRPC(const bool is_restricted)
@@ -682,6 +1469,11 @@ bool RpcServer::enableCors(const std::string domain)
     return true;
 }
 
+void RpcServer::setAdmissionLimits(size_t maxActiveRequests, double clientRate, double clientBurst)
+{
+    m_admission.setLimits(maxActiveRequests, clientRate, clientBurst);
+}
+
 std::string RpcServer::getCorsDomain()
 {
     return m_cors_domain;
@@ -951,10 +1743,10 @@ bool RpcServer::onGetPoolChangesLite(const COMMAND_RPC_GET_POOL_CHANGES_LITE::re
 
 bool RpcServer::onGetBlocksDetailsByHeights(
         const COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS::request &req,
-        COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS::response &rsp)
+        COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS::response &rsp,
+        StreamProducer<COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS::response> &produce)
 {
     try {
-        std::vector<BlockDetails> blockDetails;
         for (const uint32_t &height : req.blockHeights) {
             if (m_core.getCurrentBlockchainHeight() <= height) {
                 throw JsonRpc::JsonRpcError {
@@ -964,21 +1756,7 @@ bool RpcServer::onGetBlocksDetailsByHeights(
                             + std::to_string(m_core.getCurrentBlockchainHeight() - 1)
                 };
             }
-            Hash block_hash = m_core.getBlockIdByHeight(height);
-            Block blk;
-            if (!m_core.getBlockByHash(block_hash, blk)) {
-                throw JsonRpc::JsonRpcError { CORE_RPC_ERROR_CODE_INTERNAL_ERROR,
-                                              "Internal error: can't get block by height "
-                                                      + std::to_string(height) + '.' };
-            }
-            BlockDetails detail;
-            if (!blockchainExplorerDataBuilder.fillBlockDetails(blk, detail, false)) {
-                throw JsonRpc::JsonRpcError { CORE_RPC_ERROR_CODE_INTERNAL_ERROR,
-                                              "Internal error: can't fill block details." };
-            }
-            blockDetails.push_back(detail);
         }
-        rsp.blocks = std::move(blockDetails);
     } catch (std::system_error &e) {
         rsp.status = e.what();
         return false;
@@ -989,6 +1767,30 @@ bool RpcServer::onGetBlocksDetailsByHeights(
 
     rsp.status = CORE_RPC_STATUS_OK;
 
+    // the details are read one block at a time while the response is sent
+    std::vector<uint32_t> heights = req.blockHeights;
+    size_t next = 0;
+    produce = [this, heights, next](COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS::response &rsp) mutable {
+        if (next == heights.size()) {
+            return false;
+        }
+
+        uint32_t height = heights[next++];
+        Hash block_hash = m_core.getBlockIdByHeight(height);
+        Block blk;
+        if (!m_core.getBlockByHash(block_hash, blk)) {
+            throw std::runtime_error("Internal error: can't get block by height "
+                                     + std::to_string(height) + '.');
+        }
+        BlockDetails detail;
+        if (!blockchainExplorerDataBuilder.fillBlockDetails(blk, detail, false)) {
+            throw std::runtime_error("Internal error: can't fill block details.");
+        }
+        rsp.blocks.push_back(std::move(detail));
+
+        return next != heights.size();
+    };
+
     return true;
 }
 
@@ -1315,10 +2117,25 @@ bool RpcServer::onGetPaymentId(const COMMAND_HTTP::request &req, COMMAND_HTTP::r
 
 bool RpcServer::onGetInfo(const COMMAND_RPC_GET_INFO::request &req,
                           COMMAND_RPC_GET_INFO::response &res)
+{
+    res = getChainStatus()->info;
+
+    uint64_t total_conn = m_p2p.get_connections_count();
+    res.outgoing_connections_count = m_p2p.get_outgoing_connections_count();
+    res.incoming_connections_count = total_conn - res.outgoing_connections_count;
+    res.rpc_connections_count = get_connections_count();
+    res.rpc_cache_hits = m_responseCache.hits();
+    res.rpc_cache_misses = m_responseCache.misses();
+    res.white_peerlist_size = m_p2p.getPeerlistManager().get_white_peers_count();
+    res.grey_peerlist_size = m_p2p.getPeerlistManager().get_gray_peers_count();
+
+    return true;
+}
+
+void RpcServer::fillChainInfo(uint32_t lastKnownBlockIndex, COMMAND_RPC_GET_INFO::response &res)
 {
     res.height = m_core.getCurrentBlockchainHeight();
-    res.last_known_block_index =
-            std::max(static_cast<uint32_t>(1), m_protocolQuery.getObservedHeight()) - 1;
+    res.last_known_block_index = lastKnownBlockIndex;
     if (res.height == res.last_known_block_index) {
         // node is synced
         res.difficulty = m_core.getNextBlockDifficulty(time(nullptr));
@@ -1329,12 +2146,6 @@ bool RpcServer::onGetInfo(const COMMAND_RPC_GET_INFO::request &req,
     res.tx_count = m_core.get_blockchain_total_transactions() - res.height; // without coinbase
     res.tx_pool_size = m_core.get_pool_transactions_count();
     res.alt_blocks_count = m_core.getAlternativeBlocksCount();
-    uint64_t total_conn = m_p2p.get_connections_count();
-    res.outgoing_connections_count = m_p2p.get_outgoing_connections_count();
-    res.incoming_connections_count = total_conn - res.outgoing_connections_count;
-    res.rpc_connections_count = get_connections_count();
-    res.white_peerlist_size = m_p2p.getPeerlistManager().get_white_peers_count();
-    res.grey_peerlist_size = m_p2p.getPeerlistManager().get_gray_peers_count();
     Crypto::Hash last_block_hash =
             m_core.getBlockIdByHeight(m_core.getCurrentBlockchainHeight() - 1);
     res.top_block_hash = Common::podToHex(last_block_hash);
@@ -1375,8 +2186,6 @@ bool RpcServer::onGetInfo(const COMMAND_RPC_GET_INFO::request &req,
     m_core.getBlockDifficulty(static_cast<uint32_t>(lastBlockHeight), res.last_block_difficulty);
 
     res.status = CORE_RPC_STATUS_OK;
-
-    return true;
 }
 
 bool RpcServer::onGetVersion(const COMMAND_RPC_GET_VERSION::request &req,
@@ -1384,6 +2193,13 @@ bool RpcServer::onGetVersion(const COMMAND_RPC_GET_VERSION::request &req,
 {
     res.version = PROJECT_VERSION_LONG;
 
+    for (const auto &handler : s_handlers) {
+        if (Common::ends_with(handler.first, ".bin")) {
+            res.binary_methods.push_back(handler.first);
+        }
+    }
+    std::sort(res.binary_methods.begin(), res.binary_methods.end());
+
     return true;
 }
 
@@ -1471,11 +2287,12 @@ bool RpcServer::onGetTransactions(const COMMAND_RPC_GET_TRANSACTIONS::request &r
 
 bool RpcServer::onGetTransactionsByHeights(
         const COMMAND_RPC_GET_TRANSACTIONS_BY_HEIGHTS::request &req,
-        COMMAND_RPC_GET_TRANSACTIONS_BY_HEIGHTS::response &res)
+        COMMAND_RPC_GET_TRANSACTIONS_BY_HEIGHTS::response &res,
+        StreamProducer<COMMAND_RPC_GET_TRANSACTIONS_BY_HEIGHTS::response> &produce)
 {
-    try {
-        std::vector<Crypto::Hash> vh;
+    std::vector<uint32_t> heights;
 
+    try {
         if (req.range) {
             if (req.heights.size() != 2) {
                 res.status = "Range set true but heights size != 2";
@@ -1483,115 +2300,101 @@ bool RpcServer::onGetTransactionsByHeights(
             }
 
             uint32_t upperBorder = std::min(req.heights[1], m_core.getCurrentBlockchainHeight());
-
-            for (size_t i = 0; i < (upperBorder - req.heights[0]); i++) {
-                Block blk;
-                Crypto::Hash blockHash = m_core.getBlockIdByHeight(req.heights[0] + i);
-
-                if (!m_core.getBlockByHash(blockHash, blk)) {
-                    throw JsonRpc::JsonRpcError { CORE_RPC_ERROR_CODE_INTERNAL_ERROR,
-                                                  "Internal error: can't get block by hash. Hash = "
-                                                          + podToHex(blockHash) + '.' };
-                }
-
-                if (blk.baseTransaction.inputs.front().type() != typeid(BaseInput)) {
+            for (uint32_t height = req.heights[0]; height < upperBorder; height++) {
+                heights.push_back(height);
+            }
+        } else {
+            for (const uint32_t &height : req.heights) {
+                if (m_core.getCurrentBlockchainHeight() <= height) {
                     throw JsonRpc::JsonRpcError {
-                        CORE_RPC_ERROR_CODE_INTERNAL_ERROR,
-                        "Internal error: coinbase transaction in the block has the wrong type"
+                        CORE_RPC_ERROR_CODE_TOO_BIG_HEIGHT,
+                        std::string("To big height: ") + std::to_string(height)
+                                + ", current blockchain height = "
+                                + std::to_string(m_core.getCurrentBlockchainHeight() - 1)
                     };
                 }
-
-                for (Crypto::Hash &bTxs : blk.transactionHashes) {
-                    vh.push_back(bTxs);
-                }
-
-                if (req.include_miner_txs) {
-                    vh.push_back(getObjectHash(blk.baseTransaction));
-                }
             }
-        } else {
-            for (size_t i = 0; i < req.heights.size(); i++) {
-                Block blk;
-                Crypto::Hash blockHash = m_core.getBlockIdByHeight(req.heights[i]);
 
-                for (Crypto::Hash &bTxs : blk.transactionHashes) {
-                    vh.push_back(bTxs);
-                }
+            heights = req.heights;
+        }
+    } catch (std::system_error &e) {
+        res.status = e.what();
+        return false;
+    } catch (std::exception &e) {
+        res.status = "Error: " + std::string(e.what());
+        return false;
+    }
 
-                if (req.include_miner_txs) {
-                    vh.push_back(getObjectHash(blk.baseTransaction));
-                }
-            }
+    res.status = CORE_RPC_STATUS_OK;
+
+    // the transactions are read one block at a time while the response is sent
+    bool includeMinerTxs = req.include_miner_txs;
+    bool asJson = req.as_json;
+    size_t next = 0;
+    produce = [this, heights, includeMinerTxs, asJson, next](
+            COMMAND_RPC_GET_TRANSACTIONS_BY_HEIGHTS::response &res) mutable {
+        if (next == heights.size()) {
+            return false;
         }
 
-        std::list<Crypto::Hash> missedTxs;
-        std::list<Transaction> txs;
+        uint32_t height = heights[next++];
+        Block blk;
+        Crypto::Hash blockHash = m_core.getBlockIdByHeight(height);
 
-        m_core.getTransactions(vh, txs, missedTxs, true);
+        if (!m_core.getBlockByHash(blockHash, blk)) {
+            throw std::runtime_error("Internal error: can't get block by hash. Hash = "
+                                     + podToHex(blockHash) + '.');
+        }
 
-        std::list<std::string> txHashes;
-        for (auto &tx : txs) {
-            txHashes.push_back(Common::podToHex(getObjectHash(tx)));
+        if (blk.baseTransaction.inputs.front().type() != typeid(BaseInput)) {
+            throw std::runtime_error(
+                "Internal error: coinbase transaction in the block has the wrong type");
         }
 
-        logger(DEBUGGING) << "Found " << txs.size() << "/" << vh.size()
-                          << " transactions on the blockchain.";
+        std::vector<Crypto::Hash> vh(blk.transactionHashes.begin(), blk.transactionHashes.end());
+        if (includeMinerTxs) {
+            vh.push_back(getObjectHash(blk.baseTransaction));
+        }
 
-        std::list<std::string>::const_iterator txHi = txHashes.begin();
-        std::vector<Crypto::Hash>::const_iterator vHi = vh.begin();
+        std::list<Crypto::Hash> missedTxs;
+        std::list<Transaction> txs;
+
+        m_core.getTransactions(vh, txs, missedTxs, true);
 
         for (const Transaction &tx : txs) {
             res.txs.push_back(COMMAND_RPC_GET_TRANSACTIONS_BY_HEIGHTS::entry());
             COMMAND_RPC_GET_TRANSACTIONS_BY_HEIGHTS::entry &e = res.txs.back();
 
-            Crypto::Hash blockHash;
-            uint32_t blockHeight;
             uint64_t fee;
             getTxFee(tx, fee);
 
-            Crypto::Hash txHash = *vHi++;
-            e.tx_hash = *txHi++;
+            Crypto::Hash txHash = getObjectHash(tx);
+            e.tx_hash = Common::podToHex(txHash);
 
-            bool r = m_core.getBlockContainingTx(txHash, blockHash, blockHeight);
-            bool oR = m_core.getTxOutputsGlobalIndexes(txHash, e.output_indices);
+            m_core.getTxOutputsGlobalIndexes(txHash, e.output_indices);
 
-            if (req.as_json) {
+            if (asJson) {
                 e.as_json = tx;
             }
 
-            e.block_height = blockHeight;
-            e.block_timestamp = m_core.getBlockTimestamp(blockHeight);
+            e.block_height = height;
+            e.block_timestamp = blk.timestamp;
             e.fee = fee;
         }
 
-        if (txs.empty() || !missedTxs.empty()) {
-            std::ostringstream oss;
-            std::string seperator;
-            for (auto h : missedTxs) {
-                oss << seperator << Common::podToHex(h);
-                seperator = ",";
-            }
-            res.status = "transaction(s) not found: " + oss.str() + ".";
-        }
-
-        res.status = CORE_RPC_STATUS_OK;
-        return true;
-
-    } catch (std::system_error &e) {
-        res.status = e.what();
-        return false;
-    } catch (std::exception &e) {
-        res.status = "Error: " + std::string(e.what());
-        return false;
-    }
+        return next != heights.size();
+    };
 
     return true;
 }
 
 bool RpcServer::onGetRawTransactionsByHeights(
         const COMMAND_RPC_GET_RAW_TRANSACTIONS_BY_HEIGHTS::request &req,
-        COMMAND_RPC_GET_RAW_TRANSACTIONS_BY_HEIGHTS::response &res)
+        COMMAND_RPC_GET_RAW_TRANSACTIONS_BY_HEIGHTS::response &res,
+        StreamProducer<COMMAND_RPC_GET_RAW_TRANSACTIONS_BY_HEIGHTS::response> &produce)
 {
+    std::vector<uint32_t> heights;
+
     try {
         if (req.heights.size() > BLOCK_LIST_MAX_COUNT) {
             throw JsonRpc::JsonRpcError { CORE_RPC_ERROR_CODE_WRONG_PARAM,
@@ -1601,8 +2404,6 @@ bool RpcServer::onGetRawTransactionsByHeights(
                                                   + std::to_string(BLOCK_LIST_MAX_COUNT) };
         }
 
-        std::vector<uint32_t> heights;
-
         if (req.range) {
             if (req.heights.size() != 2) {
                 throw JsonRpc::JsonRpcError {
@@ -1612,8 +2413,8 @@ bool RpcServer::onGetRawTransactionsByHeights(
             }
 
             uint32_t upperBound = std::min(req.heights[1], m_core.getCurrentBlockchainHeight());
-            for (size_t i = 0; i < (upperBound - req.heights[0]); i++) {
-                heights.push_back(req.heights[0] + i);
+            for (uint32_t height = req.heights[0]; height < upperBound; height++) {
+                heights.push_back(height);
             }
         } else {
             heights = req.heights;
@@ -1628,73 +2429,83 @@ bool RpcServer::onGetRawTransactionsByHeights(
                             + std::to_string(m_core.getCurrentBlockchainHeight() - 1)
                 };
             }
+        }
+    } catch (std::system_error &e) {
+        throw JsonRpc::JsonRpcError { CORE_RPC_ERROR_CODE_INTERNAL_ERROR, e.what() };
 
-            Crypto::Hash blockHash = m_core.getBlockIdByHeight(height);
-            Block blk;
-            std::vector<Crypto::Hash> txsIds;
-            if (!m_core.getBlockByHash(blockHash, blk)) {
-                throw JsonRpc::JsonRpcError { CORE_RPC_ERROR_CODE_INTERNAL_ERROR,
-                                              "Internal error: can't get block by height "
-                                                      + std::to_string(height) + '.' };
-            }
+        return false;
+    } catch (std::exception &e) {
+        throw JsonRpc::JsonRpcError { CORE_RPC_ERROR_CODE_INTERNAL_ERROR,
+                                      "Error: " + std::string(e.what()) };
 
-            if (req.includeMinerTxs) {
-                txsIds.reserve(blk.transactionHashes.size() + 1);
-                txsIds.push_back(getObjectHash(blk.baseTransaction));
-            } else {
-                txsIds.reserve(blk.transactionHashes.size());
-            }
+        return false;
+    }
 
-            if (!blk.transactionHashes.empty()) {
-                txsIds.insert(txsIds.end(), blk.transactionHashes.begin(),
-                              blk.transactionHashes.end());
-            }
+    res.status = CORE_RPC_STATUS_OK;
 
-            std::vector<Crypto::Hash>::const_iterator ti = txsIds.begin();
+    // the transactions are read one block at a time while the response is sent
+    bool includeMinerTxs = req.includeMinerTxs;
+    size_t next = 0;
+    produce = [this, heights, includeMinerTxs, next](
+            COMMAND_RPC_GET_RAW_TRANSACTIONS_BY_HEIGHTS::response &res) mutable {
+        if (next == heights.size()) {
+            return false;
+        }
 
-            std::vector<std::pair<Transaction, std::vector<uint32_t>>> txs;
-            std::list<Crypto::Hash> missed;
+        uint32_t height = heights[next++];
+        Crypto::Hash blockHash = m_core.getBlockIdByHeight(height);
+        Block blk;
+        std::vector<Crypto::Hash> txsIds;
+        if (!m_core.getBlockByHash(blockHash, blk)) {
+            throw std::runtime_error("Internal error: can't get block by height "
+                                     + std::to_string(height) + '.');
+        }
 
-            if (!txsIds.empty()) {
-                if (!m_core.getTransactionsWithOutputGlobalIndexes(txsIds, missed, txs)) {
-                    throw JsonRpc::JsonRpcError {
-                        CORE_RPC_ERROR_CODE_INTERNAL_ERROR,
-                        "Error getting transactions with output global indexes"
-                    };
-                }
+        if (includeMinerTxs) {
+            txsIds.reserve(blk.transactionHashes.size() + 1);
+            txsIds.push_back(getObjectHash(blk.baseTransaction));
+        } else {
+            txsIds.reserve(blk.transactionHashes.size());
+        }
 
-                for (const auto &txi : txs) {
-                    res.transactions.push_back(TxWithOutputGlobalIndices());
-                    TxWithOutputGlobalIndices &e = res.transactions.back();
-
-                    e.hash = *ti++;
-                    e.block_hash = blockHash;
-                    e.height = height;
-                    e.timestamp = blk.timestamp;
-                    e.transaction = *static_cast<const TransactionPrefix *>(&txi.first);
-                    e.output_indexes = txi.second;
-                    e.fee = is_coinbase(txi.first)
-                            ? 0
-                            : getInputAmount(txi.first) - getOutputAmount(txi.first);
-                }
+        if (!blk.transactionHashes.empty()) {
+            txsIds.insert(txsIds.end(), blk.transactionHashes.begin(),
+                          blk.transactionHashes.end());
+        }
+
+        std::vector<Crypto::Hash>::const_iterator ti = txsIds.begin();
+
+        std::vector<std::pair<Transaction, std::vector<uint32_t>>> txs;
+        std::list<Crypto::Hash> missed;
+
+        if (!txsIds.empty()) {
+            if (!m_core.getTransactionsWithOutputGlobalIndexes(txsIds, missed, txs)) {
+                throw std::runtime_error("Error getting transactions with output global indexes");
             }
 
-            for (const auto &missTx : missed) {
-                res.missedTxs.push_back(Common::podToHex(missTx));
+            for (const auto &txi : txs) {
+                res.transactions.push_back(TxWithOutputGlobalIndices());
+                TxWithOutputGlobalIndices &e = res.transactions.back();
+
+                e.hash = *ti++;
+                e.block_hash = blockHash;
+                e.height = height;
+                e.timestamp = blk.timestamp;
+                e.transaction = *static_cast<const TransactionPrefix *>(&txi.first);
+                e.output_indexes = txi.second;
+                e.fee = is_coinbase(txi.first)
+                        ? 0
+                        : getInputAmount(txi.first) - getOutputAmount(txi.first);
             }
         }
-    } catch (std::system_error &e) {
-        throw JsonRpc::JsonRpcError { CORE_RPC_ERROR_CODE_INTERNAL_ERROR, e.what() };
 
-        return false;
-    } catch (std::exception &e) {
-        throw JsonRpc::JsonRpcError { CORE_RPC_ERROR_CODE_INTERNAL_ERROR,
-                                      "Error: " + std::string(e.what()) };
+        for (const auto &missTx : missed) {
+            res.missedTxs.push_back(Common::podToHex(missTx));
+        }
 
-        return false;
-    }
+        return next != heights.size();
+    };
 
-    res.status = CORE_RPC_STATUS_OK;
     return true;
 }
 
@@ -2328,8 +3139,10 @@ bool RpcServer::onGetStatsByHeights(const COMMAND_RPC_GET_STATS_BY_HEIGHTS::requ
     return true;
 }
 
-bool RpcServer::onGetStatsByHeightsRange(const COMMAND_RPC_GET_STATS_BY_HEIGHTS_RANGE::request &req,
-                                         COMMAND_RPC_GET_STATS_BY_HEIGHTS_RANGE::response &res)
+bool RpcServer::onGetStatsByHeightsRange(
+        const COMMAND_RPC_GET_STATS_BY_HEIGHTS_RANGE::request &req,
+        COMMAND_RPC_GET_STATS_BY_HEIGHTS_RANGE::response &res,
+        StreamProducer<COMMAND_RPC_GET_STATS_BY_HEIGHTS_RANGE::response> &produce)
 {
     std::chrono::steady_clock::time_point timePoint = std::chrono::steady_clock::now();
 
@@ -2343,15 +3156,17 @@ bool RpcServer::onGetStatsByHeightsRange(const COMMAND_RPC_GET_STATS_BY_HEIGHTS_
         };
     }
 
-    std::vector<BLOCK_STATS_ENTRY> stats;
+    // unrestricted requests take every height from min to max
+    std::vector<uint32_t> selectedHeights;
+    size_t count = max - min + 1;
 
     if (m_restricted_rpc) {
-        uint32_t count = std::min<uint32_t>(
+        count = std::min<uint32_t>(
                 std::min<uint32_t>(
                         MAX_NUMBER_OF_BLOCKS_PER_STATS_REQUEST,
                         max - min),
                 m_core.getCurrentBlockchainHeight() - 1);
-        std::vector<uint32_t> selectedHeights(count);
+        selectedHeights.resize(count);
         double delta = (max - min) / static_cast<double>(count - 1);
         std::vector<uint32_t>::iterator i;
         double val;
@@ -2359,51 +3174,45 @@ bool RpcServer::onGetStatsByHeightsRange(const COMMAND_RPC_GET_STATS_BY_HEIGHTS_
         for (i = selectedHeights.begin(), val = min; i != selectedHeights.end(); i++, val += delta) {
             *i = static_cast<uint32_t>(val);
         }
+    }
 
-        for (const uint32_t &height : selectedHeights) {
-            BLOCK_STATS_ENTRY entry;
-            entry.height = height;
-            if (!m_core.getBlockEntry(height,
-                                      entry.blockSize,
-                                      entry.difficulty,
-                                      entry.alreadyGeneratedCoins,
-                                      entry.reward,
-                                      entry.transactionsCount,
-                                      entry.timestamp)) {
-                throw JsonRpc::JsonRpcError{
-                    CORE_RPC_ERROR_CODE_INTERNAL_ERROR,
-                    "Internal error: can't get stats for height" + std::to_string(height)
-                };
-            }
+    // the entries are read while the response is sent, the duration covers all of them
+    size_t next = 0;
+    produce = [this, timePoint, selectedHeights, min, count, next](
+            COMMAND_RPC_GET_STATS_BY_HEIGHTS_RANGE::response &res) mutable {
+        if (next == count) {
+            return false;
+        }
+
+        uint32_t height = selectedHeights.empty() ? min + static_cast<uint32_t>(next)
+                                                  : selectedHeights[next];
+        ++next;
 
-            entry.minFee = m_core.getMinimalFeeForHeight(height);
-            stats.push_back(entry);
+        BLOCK_STATS_ENTRY entry;
+        entry.height = height;
+        if (!m_core.getBlockEntry(height,
+                                  entry.blockSize,
+                                  entry.difficulty,
+                                  entry.alreadyGeneratedCoins,
+                                  entry.reward,
+                                  entry.transactionsCount,
+                                  entry.timestamp)) {
+            throw std::runtime_error("Internal error: can't get stats for height"
+                                     + std::to_string(height));
         }
-    } else {
-        for (uint32_t height = min; height <= max; height++) {
-            BLOCK_STATS_ENTRY entry;
-            entry.height = height;
-            if (!m_core.getBlockEntry(height,
-                                      entry.blockSize,
-                                      entry.difficulty,
-                                      entry.alreadyGeneratedCoins,
-                                      entry.reward,
-                                      entry.transactionsCount,
-                                      entry.timestamp)) {
-                throw JsonRpc::JsonRpcError{
-                        CORE_RPC_ERROR_CODE_INTERNAL_ERROR,
-                        "Internal error: can't get stats for height" + std::to_string(height)
-                };
-            }
-            entry.minFee = m_core.getMinimalFeeForHeight(height);
-            stats.push_back(entry);
+        entry.minFee = m_core.getMinimalFeeForHeight(height);
+        res.stats.push_back(entry);
+
+        if (next != count) {
+            return true;
         }
-    }
 
-    res.stats = std::move(stats);
+        std::chrono::duration<double> duration = std::chrono::steady_clock::now() - timePoint;
+        res.duration = duration.count();
+
+        return false;
+    };
 
-    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - timePoint;
-    res.duration = duration.count();
     res.status = CORE_RPC_STATUS_OK;
 
     return true;
@@ -20,13 +20,17 @@
 
 #pragma once
 
+#include <atomic>
+#include <ctime>
 #include <functional>
+#include <memory>
 #include <unordered_map>
 
 #include <BlockchainExplorer/BlockchainExplorerDataBuilder.h>
 
 #include <Common/Math.h>
 
+#include <CryptoNoteCore/ICoreObserver.h>
 #include <CryptoNoteCore/ITransaction.h>
 
 #include <Global/Constants.h>
@@ -34,6 +38,9 @@
 
 #include <Rpc/CoreRpcServerCommandsDefinitions.h>
 #include <Rpc/HttpServer.h>
+#include <Rpc/RpcAdmission.h>
+#include <Rpc/RpcResponseCache.h>
+#include <Rpc/RpcWorkerPool.h>
 
 using namespace Qwertycoin;
 
@@ -47,7 +54,7 @@ class BlockchainExplorer;
 
 class ICryptoNoteProtocolQuery;
 
-class RpcServer : public HttpServer
+class RpcServer : public HttpServer, private ICoreObserver
 {
     template<class Handler>
     struct RpcHandler {
@@ -58,17 +65,24 @@ class RpcServer : public HttpServer
 public:
     typedef std::function<bool(RpcServer *, const HttpRequest &request, HttpResponse &response)>
             HandlerFunction;
+    // adds the next batch of items to a streamed response, returns false once none are left
+    template<typename Response>
+    using StreamProducer = std::function<bool(Response &)>;
 
     RpcServer(System::Dispatcher &dispatcher,
               Logging::ILogger &log,
               core &core,
               NodeServer &p2p,
               ICryptoNoteProtocolQuery &protocolQuery);
+    ~RpcServer() override;
 
     bool restrictRPC(const bool is_resctricted);
 
     bool enableCors(const std::string domain);
 
+    // see RpcAdmission, a zero limit disables it
+    void setAdmissionLimits(size_t maxActiveRequests, double clientRate, double clientBurst);
+
     bool setFeeAddress(const std::string &fee_address, const AccountPublicAddress &fee_acc);
 
     bool setViewKey(const std::string &view_key);
@@ -79,10 +93,54 @@ public:
 
     std::string getCorsDomain();
 
+    // Answers from the response cache when an equal request was answered before, otherwise
+    // runs call and keeps its answer if it returns true with the height the answer was read
+    // from. Tip dependent answers are kept per chain height.
+    void callCached(std::string key,
+                    bool tipDependent,
+                    const std::function<bool(std::string &body, uint32_t &height)> &call,
+                    std::string &body);
+
 private:
+    /*!
+        What the most polled requests answer, taken from the chain once per change instead of
+        once per request. Never modified after it is published.
+    */
+    struct ChainStatus
+    {
+        uint64_t generation;
+        std::time_t builtAt;
+        // without the connection counts, they are filled in per request
+        COMMAND_RPC_GET_INFO::response info;
+        std::string heightBody;
+        std::string feeAddressBody;
+        std::string lastBlockHeaderResult;
+    };
+
+    // ICoreObserver, may be called from any thread
+    void blockchainUpdated() override;
+    void poolUpdated() override;
+    void blockRemoved(uint32_t height) override;
+
+    std::shared_ptr<const ChainStatus> getChainStatus();
+    void fillChainInfo(uint32_t lastKnownBlockIndex, COMMAND_RPC_GET_INFO::response &res);
+    bool sendChainStatus(std::string ChainStatus::*body, HttpResponse &response);
+
     void processRequest(const HttpRequest &request, HttpResponse &response) override;
+    void serveRequest(const HttpRequest &request, HttpResponse &response);
+    uint64_t requestCost(const HttpRequest &request) const;
+    void refuseRequest(const HttpRequest &request,
+                       HttpResponse &response,
+                       HttpResponse::HTTP_STATUS status,
+                       int code,
+                       const std::string &message);
 
     bool processJsonRpcRequest(const HttpRequest &request, HttpResponse &response);
+    std::string processJsonRpcBatch(const std::vector<std::string> &calls);
+    // streams into response when the method supports it and one is given
+    std::string processJsonRpcCall(const std::string &requestBody,
+                                   bool coreReady,
+                                   HttpResponse *response);
 
     bool isCoreReady();
 
@@ -133,12 +191,16 @@ private:
     bool onGetTransactions(const COMMAND_RPC_GET_TRANSACTIONS::request &req,
                            COMMAND_RPC_GET_TRANSACTIONS::response &res);
 
-    bool onGetTransactionsByHeights(const COMMAND_RPC_GET_TRANSACTIONS_BY_HEIGHTS::request &req,
-                                    COMMAND_RPC_GET_TRANSACTIONS_BY_HEIGHTS::response &res);
+    bool onGetTransactionsByHeights(
+            const COMMAND_RPC_GET_TRANSACTIONS_BY_HEIGHTS::request &req,
+            COMMAND_RPC_GET_TRANSACTIONS_BY_HEIGHTS::response &res,
+            StreamProducer<COMMAND_RPC_GET_TRANSACTIONS_BY_HEIGHTS::response> &produce);
 
     bool
-    onGetRawTransactionsByHeights(const COMMAND_RPC_GET_RAW_TRANSACTIONS_BY_HEIGHTS::request &req,
-                                  COMMAND_RPC_GET_RAW_TRANSACTIONS_BY_HEIGHTS::response &res);
+    onGetRawTransactionsByHeights(
+            const COMMAND_RPC_GET_RAW_TRANSACTIONS_BY_HEIGHTS::request &req,
+            COMMAND_RPC_GET_RAW_TRANSACTIONS_BY_HEIGHTS::response &res,
+            StreamProducer<COMMAND_RPC_GET_RAW_TRANSACTIONS_BY_HEIGHTS::response> &produce);
 
     bool onGetRawTransactionPool(const COMMAND_RPC_GET_RAW_TRANSACTIONS_FROM_POOL::request &req,
                                  COMMAND_RPC_GET_RAW_TRANSACTIONS_FROM_POOL::response &res);
@@ -161,8 +223,10 @@ private:
     bool onGetPeerList(const COMMAND_RPC_GET_PEER_LIST::request &req,
                        COMMAND_RPC_GET_PEER_LIST::response &res);
 
-    bool onGetBlocksDetailsByHeights(const COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS::request &req,
-                                     COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS::response &rsp);
+    bool onGetBlocksDetailsByHeights(
+            const COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS::request &req,
+            COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS::response &rsp,
+            StreamProducer<COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS::response> &produce);
 
     bool onGetBlocksDetailsByHashes(const COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES::request &req,
                                     COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES::response &rsp);
@@ -266,8 +330,10 @@ private:
 
     bool onGetStatsByHeights(const COMMAND_RPC_GET_STATS_BY_HEIGHTS::request &req,
                              COMMAND_RPC_GET_STATS_BY_HEIGHTS::response &res);
-    bool onGetStatsByHeightsRange(const COMMAND_RPC_GET_STATS_BY_HEIGHTS_RANGE::request &req,
-                                  COMMAND_RPC_GET_STATS_BY_HEIGHTS_RANGE::response &res);
+    bool onGetStatsByHeightsRange(
+            const COMMAND_RPC_GET_STATS_BY_HEIGHTS_RANGE::request &req,
+            COMMAND_RPC_GET_STATS_BY_HEIGHTS_RANGE::response &res,
+            StreamProducer<COMMAND_RPC_GET_STATS_BY_HEIGHTS_RANGE::response> &produce);
     bool onResolveOpenAlias(const COMMAND_RPC_RESOLVE_OPEN_ALIAS::request &req,
                             COMMAND_RPC_RESOLVE_OPEN_ALIAS::response &res);
 
@@ -284,6 +350,11 @@ private:
     std::string m_contact_info;
     Crypto::SecretKey m_view_key = NULL_SECRET_KEY;
     AccountPublicAddress m_fee_acc;
+    std::atomic<uint64_t> m_chainGeneration;
+    std::shared_ptr<const ChainStatus> m_chainStatus;
+    RpcResponseCache m_responseCache;
+    RpcAdmission m_admission;
+    RpcWorkerPool m_batchWorkers;
 };
 
 } // namespace CryptoNote
@@ -27,6 +27,9 @@ namespace {
 
 const std::string DEFAULT_RPC_IP = "127.0.0.1";
 const uint16_t DEFAULT_RPC_PORT = RPC_DEFAULT_PORT;
+const size_t DEFAULT_RPC_MAX_ACTIVE_REQUESTS = 32;
+const double DEFAULT_RPC_CLIENT_RATE = 1000;
+const double DEFAULT_RPC_CLIENT_BURST = 20000;
 
 const command_line::arg_descriptor<std::string> arg_rpc_bind_ip = {
     "rpc-bind-ip",
@@ -38,12 +41,32 @@ const command_line::arg_descriptor<uint16_t> arg_rpc_bind_port = {
     "",
     DEFAULT_RPC_PORT
 };
+const command_line::arg_descriptor<size_t> arg_rpc_max_active_requests = {
+    "rpc-max-active-requests",
+    "With --restricted-rpc, requests served and responses streamed at once, the others are "
+    "refused. 0 for no limit",
+    DEFAULT_RPC_MAX_ACTIVE_REQUESTS
+};
+const command_line::arg_descriptor<double> arg_rpc_client_rate = {
+    "rpc-client-rate",
+    "With --restricted-rpc, work units a client earns per second. "
+    "A unit is about one block, transaction or output read. 0 for no limit",
+    DEFAULT_RPC_CLIENT_RATE
+};
+const command_line::arg_descriptor<double> arg_rpc_client_burst = {
+    "rpc-client-burst",
+    "With --restricted-rpc, work units a client can spend at once",
+    DEFAULT_RPC_CLIENT_BURST
+};
 
 } // namespace
 
 RpcServerConfig::RpcServerConfig()
     : bindIp(DEFAULT_RPC_IP),
-      bindPort(DEFAULT_RPC_PORT)
+      bindPort(DEFAULT_RPC_PORT),
+      maxActiveRequests(DEFAULT_RPC_MAX_ACTIVE_REQUESTS),
+      clientRate(DEFAULT_RPC_CLIENT_RATE),
+      clientBurst(DEFAULT_RPC_CLIENT_BURST)
 {
 }
 
@@ -51,12 +74,18 @@ void RpcServerConfig::init(const boost::program_options::variables_map &vm)
 {
     bindIp = command_line::get_arg(vm, arg_rpc_bind_ip);
     bindPort = command_line::get_arg(vm, arg_rpc_bind_port);
+    maxActiveRequests = command_line::get_arg(vm, arg_rpc_max_active_requests);
+    clientRate = command_line::get_arg(vm, arg_rpc_client_rate);
+    clientBurst = command_line::get_arg(vm, arg_rpc_client_burst);
 }
 
 void RpcServerConfig::initOptions(boost::program_options::options_description &desc)
 {
     command_line::add_arg(desc, arg_rpc_bind_ip);
     command_line::add_arg(desc, arg_rpc_bind_port);
+    command_line::add_arg(desc, arg_rpc_max_active_requests);
+    command_line::add_arg(desc, arg_rpc_client_rate);
+    command_line::add_arg(desc, arg_rpc_client_burst);
 }
 
 std::string RpcServerConfig::getBindAddress() const
@@ -33,6 +33,10 @@ public:
 
     std::string bindIp;
     uint16_t bindPort;
+    // admission limits of a restricted server, in work units, see RpcAdmission
+    size_t maxActiveRequests;
+    double clientRate;
+    double clientBurst;
 };
 
 } // namespace CryptoNote
@@ -0,0 +1,82 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <exception>
+#include <Rpc/RpcWorkerPool.h>
+
+namespace CryptoNote {
+
+RpcWorkerPool::RpcWorkerPool(size_t threadCount)
+    : m_stopping(false)
+{
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_threads.emplace_back(&RpcWorkerPool::workerProcedure, this);
+    }
+}
+
+RpcWorkerPool::~RpcWorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_hasTask.notify_all();
+    for (std::thread &thread : m_threads) {
+        thread.join();
+    }
+}
+
+size_t RpcWorkerPool::threadCount() const
+{
+    return m_threads.size();
+}
+
+void RpcWorkerPool::post(std::function<void()> &&task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+
+    m_hasTask.notify_one();
+}
+
+void RpcWorkerPool::workerProcedure()
+{
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_hasTask.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+            if (m_stopping) {
+                return;
+            }
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        try {
+            task();
+        } catch (std::exception &) {
+            // the task reports its own errors
+        }
+    }
+}
+
+} // namespace CryptoNote
@@ -0,0 +1,57 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CryptoNote {
+
+/*!
+    Long-lived threads that run the calls of JSON-RPC batches, so the number of threads does
+    not grow with the batches being served. Tasks wait in turn while all threads are busy.
+*/
+class RpcWorkerPool
+{
+public:
+    explicit RpcWorkerPool(size_t threadCount);
+    RpcWorkerPool(const RpcWorkerPool &) = delete;
+    RpcWorkerPool &operator=(const RpcWorkerPool &) = delete;
+    // waits for the running tasks, the queued ones are dropped
+    ~RpcWorkerPool();
+
+    size_t threadCount() const;
+
+    // runs task on one of the threads, exceptions it throws are ignored
+    void post(std::function<void()> &&task);
+
+private:
+    void workerProcedure();
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_hasTask;
+    std::deque<std::function<void()>> m_tasks;
+    bool m_stopping;
+};
+
+} // namespace CryptoNote
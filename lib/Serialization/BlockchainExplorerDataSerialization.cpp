@@ -76,7 +76,7 @@ struct VariantSerializer : boost::static_visitor<>
 void getVariantValue(
     CryptoNote::ISerializer &serializer,
     uint8_t tag,
-    boost::variant<BaseInputDetails, KeyInputDetails, MultiSignatureInputDetails> in)
+    boost::variant<BaseInputDetails, KeyInputDetails, MultiSignatureInputDetails> &in)
 {
     switch (static_cast<SerializationTag>(tag)) {
     case SerializationTag::Base: {
@@ -160,7 +160,7 @@ void serialize(TransactionInputDetails &input, ISerializer &serializer)
 
 void serialize(TransactionExtraDetails &extra, ISerializer &serializer)
 {
-    serializePod(extra.publicKey, "publicKey", serializer);
+    serializer(extra.publicKey, "publicKey");
     serializer(extra.nonce, "nonce");
     serializeAsBinary(extra.raw, "raw", serializer);
     serializer(extra.size, "size");
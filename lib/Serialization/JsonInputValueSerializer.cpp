@@ -142,7 +142,14 @@ bool JsonInputValueSerializer::operator()(uint64_t &value, Common::StringView na
 
 bool JsonInputValueSerializer::operator()(double &value, Common::StringView name)
 {
-    return getNumber(name, value);
+    auto ptr = getValue(name);
+    if (ptr == nullptr) {
+        return false;
+    }
+
+    value = ptr->isReal() ? ptr->getReal() : static_cast<double>(ptr->getInteger());
+
+    return true;
 }
 
 bool JsonInputValueSerializer::operator()(uint8_t &value, Common::StringView name)
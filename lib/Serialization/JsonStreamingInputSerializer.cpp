@@ -0,0 +1,532 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <Common/StringTools.h>
+#include <Serialization/JsonStreamingInputSerializer.h>
+
+using namespace CryptoNote;
+
+namespace {
+
+void throwUnableToParse()
+{
+    throw std::runtime_error("Unable to parse");
+}
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+void decodeHex(Common::StringView text, void *value, size_t size)
+{
+    if ((text.getSize() & 1) != 0) {
+        throw std::runtime_error("fromHex: invalid string size");
+    }
+
+    if (text.getSize() >> 1 > size) {
+        throw std::runtime_error("fromHex: invalid buffer size");
+    }
+
+    const char *hex = text.getData();
+    uint8_t *data = static_cast<uint8_t *>(value);
+    for (size_t i = 0; i < text.getSize() >> 1; ++i) {
+        data[i] = Common::fromHex(hex[i << 1]) << 4 | Common::fromHex(hex[(i << 1) + 1]);
+    }
+}
+
+} // namespace
+
+JsonStreamingInputSerializer::JsonStreamingInputSerializer(Common::StringView text)
+    : m_end(text.getData() + text.getSize())
+{
+    const char *begin = skipSpace(text.getData());
+    if (begin == m_end || *begin != '{') {
+        throw std::runtime_error(
+            "Serializer doesn't support this type of serialization: Object expected."
+        );
+    }
+
+    indexObject(begin);
+}
+
+ISerializer::SerializerType JsonStreamingInputSerializer::type() const
+{
+    return ISerializer::INPUT;
+}
+
+const char *JsonStreamingInputSerializer::skipSpace(const char *begin) const
+{
+    while (begin != m_end && (*begin == ' ' || *begin == '\n' || *begin == '\r' || *begin == '\t')) {
+        ++begin;
+    }
+
+    return begin;
+}
+
+const char *JsonStreamingInputSerializer::skipString(const char *begin) const
+{
+    assert(*begin == '"');
+
+    for (const char *p = begin + 1; p < m_end; ++p) {
+        if (*p == '"') {
+            return p + 1;
+        }
+
+        // escapes are kept as they are, only the quote they may hide matters here
+        if (*p == '\\') {
+            ++p;
+        }
+    }
+
+    throw std::runtime_error("Unable to parse: unexpected end of stream");
+}
+
+const char *JsonStreamingInputSerializer::readString(const char *begin,
+                                                     Common::StringView &value) const
+{
+    const char *end = skipString(begin);
+    value = Common::StringView(begin + 1, end - begin - 2);
+
+    return end;
+}
+
+const char *JsonStreamingInputSerializer::skipSeparator(const char *begin, char close) const
+{
+    begin = skipSpace(begin);
+    if (begin == m_end) {
+        throwUnableToParse();
+    }
+
+    if (*begin == ',') {
+        return skipSpace(begin + 1);
+    }
+
+    if (*begin != close) {
+        throwUnableToParse();
+    }
+
+    return nullptr;
+}
+
+const char *JsonStreamingInputSerializer::skipValue(const char *begin) const
+{
+    if (begin == m_end) {
+        throw std::runtime_error("Unable to parse: unexpected end of stream");
+    }
+
+    switch (*begin) {
+    case '"':
+        return skipString(begin);
+    case '{': {
+        const char *p = skipSpace(begin + 1);
+        if (p != m_end && *p == '}') {
+            return p + 1;
+        }
+
+        for (;;) {
+            if (p == m_end || *p != '"') {
+                throwUnableToParse();
+            }
+
+            p = skipSpace(skipString(p));
+            if (p == m_end || *p != ':') {
+                throwUnableToParse();
+            }
+
+            const char *end = skipValue(skipSpace(p + 1));
+            p = skipSeparator(end, '}');
+            if (p == nullptr) {
+                return skipSpace(end) + 1;
+            }
+        }
+    }
+    case '[': {
+        const char *p = skipSpace(begin + 1);
+        if (p != m_end && *p == ']') {
+            return p + 1;
+        }
+
+        for (;;) {
+            const char *end = skipValue(p);
+            p = skipSeparator(end, ']');
+            if (p == nullptr) {
+                return skipSpace(end) + 1;
+            }
+        }
+    }
+    case 't':
+        if (m_end - begin >= 4 && memcmp(begin, "true", 4) == 0) {
+            return begin + 4;
+        }
+        break;
+    case 'f':
+        if (m_end - begin >= 5 && memcmp(begin, "false", 5) == 0) {
+            return begin + 5;
+        }
+        break;
+    case 'n':
+        if (m_end - begin >= 4 && memcmp(begin, "null", 4) == 0) {
+            return begin + 4;
+        }
+        break;
+    default:
+        if (*begin == '-' || isDigit(*begin)) {
+            const char *p = begin + 1;
+            while (p != m_end && (isDigit(*p) || *p == '.' || *p == 'e' || *p == 'E'
+                                  || *p == '+' || *p == '-')) {
+                ++p;
+            }
+
+            return p;
+        }
+        break;
+    }
+
+    throwUnableToParse();
+
+    return nullptr;
+}
+
+const char *JsonStreamingInputSerializer::indexObject(const char *begin)
+{
+    assert(*begin == '{');
+
+    Scope scope;
+    scope.isArray = false;
+    scope.firstMember = m_members.size();
+    scope.next = nullptr;
+
+    const char *p = skipSpace(begin + 1);
+    if (p != m_end && *p == '}') {
+        scope.endMember = m_members.size();
+        m_scopes.push_back(scope);
+
+        return p + 1;
+    }
+
+    for (;;) {
+        if (p == m_end || *p != '"') {
+            throwUnableToParse();
+        }
+
+        Member member;
+        p = skipSpace(readString(p, member.name));
+        if (p == m_end || *p != ':') {
+            throwUnableToParse();
+        }
+
+        member.value = skipSpace(p + 1);
+        m_members.push_back(member);
+
+        const char *end = skipValue(member.value);
+        p = skipSeparator(end, '}');
+        if (p == nullptr) {
+            p = skipSpace(end) + 1;
+            break;
+        }
+    }
+
+    scope.endMember = m_members.size();
+    m_scopes.push_back(scope);
+
+    return p;
+}
+
+const char *JsonStreamingInputSerializer::findValue(Common::StringView name)
+{
+    assert(!m_scopes.empty());
+
+    Scope &scope = m_scopes.back();
+    if (scope.isArray) {
+        if (scope.next == nullptr) {
+            throw std::out_of_range("JsonStreamingInputSerializer: array index out of range");
+        }
+
+        const char *value = scope.next;
+        scope.next = skipSeparator(skipValue(value), ']');
+
+        return value;
+    }
+
+    // the last one wins if a name repeats, as it does with JsonValue
+    for (size_t i = scope.endMember; i > scope.firstMember; --i) {
+        if (m_members[i - 1].name == name) {
+            return m_members[i - 1].value;
+        }
+    }
+
+    return nullptr;
+}
+
+bool JsonStreamingInputSerializer::beginObject(Common::StringView name)
+{
+    size_t parent = m_scopes.size() - 1;
+    const char *value;
+
+    if (m_scopes[parent].isArray) {
+        value = m_scopes[parent].next;
+        if (value == nullptr) {
+            throw std::out_of_range("JsonStreamingInputSerializer: array index out of range");
+        }
+    } else {
+        value = findValue(name);
+        if (value == nullptr) {
+            return false;
+        }
+    }
+
+    if (*value != '{') {
+        throw std::runtime_error("JsonValue type is not OBJECT");
+    }
+
+    const char *end = indexObject(value);
+
+    // an element of an array is indexed once, and the array moves past it right away
+    if (m_scopes[parent].isArray) {
+        m_scopes[parent].next = skipSeparator(end, ']');
+    }
+
+    return true;
+}
+
+void JsonStreamingInputSerializer::endObject()
+{
+    assert(m_scopes.size() > 1 && !m_scopes.back().isArray);
+
+    m_members.resize(m_scopes.back().firstMember);
+    m_scopes.pop_back();
+}
+
+bool JsonStreamingInputSerializer::beginArray(size_t &size, Common::StringView name)
+{
+    const char *value = findValue(name);
+    size = 0;
+
+    if (value == nullptr) {
+        return false;
+    }
+
+    if (*value != '[') {
+        throw std::runtime_error("JsonValue type is not ARRAY");
+    }
+
+    Scope scope;
+    scope.isArray = true;
+    scope.firstMember = m_members.size();
+    scope.endMember = m_members.size();
+    scope.next = skipSpace(value + 1);
+
+    if (scope.next != m_end && *scope.next == ']') {
+        scope.next = nullptr;
+    } else {
+        const char *p = scope.next;
+        while (p != nullptr) {
+            ++size;
+            p = skipSeparator(skipValue(p), ']');
+        }
+    }
+
+    m_scopes.push_back(scope);
+
+    return true;
+}
+
+void JsonStreamingInputSerializer::endArray()
+{
+    assert(m_scopes.size() > 1 && m_scopes.back().isArray);
+
+    m_scopes.pop_back();
+}
+
+bool JsonStreamingInputSerializer::getRaw(Common::StringView name, Common::StringView &raw)
+{
+    const char *value = findValue(name);
+    if (value == nullptr) {
+        return false;
+    }
+
+    raw = Common::StringView(value, skipValue(value) - value);
+
+    return true;
+}
+
+template<typename T>
+bool JsonStreamingInputSerializer::readInteger(Common::StringView name, T &value)
+{
+    const char *p = findValue(name);
+    if (p == nullptr) {
+        return false;
+    }
+
+    bool negative = *p == '-';
+    if (negative) {
+        ++p;
+    }
+
+    if (p == m_end || !isDigit(*p)) {
+        throw std::runtime_error("JsonValue type is not INTEGER");
+    }
+
+    uint64_t result = 0;
+    while (p != m_end && isDigit(*p)) {
+        result = result * 10 + static_cast<uint64_t>(*p - '0');
+        ++p;
+    }
+
+    if (p != m_end && (*p == '.' || *p == 'e' || *p == 'E')) {
+        throw std::runtime_error("JsonValue type is not INTEGER");
+    }
+
+    value = static_cast<T>(negative ? 0 - result : result);
+
+    return true;
+}
+
+bool JsonStreamingInputSerializer::operator()(uint8_t &value, Common::StringView name)
+{
+    return readInteger(name, value);
+}
+
+bool JsonStreamingInputSerializer::operator()(int16_t &value, Common::StringView name)
+{
+    return readInteger(name, value);
+}
+
+bool JsonStreamingInputSerializer::operator()(uint16_t &value, Common::StringView name)
+{
+    return readInteger(name, value);
+}
+
+bool JsonStreamingInputSerializer::operator()(int32_t &value, Common::StringView name)
+{
+    return readInteger(name, value);
+}
+
+bool JsonStreamingInputSerializer::operator()(uint32_t &value, Common::StringView name)
+{
+    return readInteger(name, value);
+}
+
+bool JsonStreamingInputSerializer::operator()(int64_t &value, Common::StringView name)
+{
+    return readInteger(name, value);
+}
+
+bool JsonStreamingInputSerializer::operator()(uint64_t &value, Common::StringView name)
+{
+    return readInteger(name, value);
+}
+
+bool JsonStreamingInputSerializer::operator()(double &value, Common::StringView name)
+{
+    const char *p = findValue(name);
+    if (p == nullptr) {
+        return false;
+    }
+
+    if (*p != '-' && !isDigit(*p)) {
+        throw std::runtime_error("JsonValue type is not REAL");
+    }
+
+    value = strtod(std::string(p, skipValue(p)).c_str(), nullptr);
+
+    return true;
+}
+
+bool JsonStreamingInputSerializer::operator()(bool &value, Common::StringView name)
+{
+    const char *p = findValue(name);
+    if (p == nullptr) {
+        return false;
+    }
+
+    if (*p != 't' && *p != 'f') {
+        throw std::runtime_error("JsonValue type is not BOOL");
+    }
+
+    skipValue(p);
+    value = *p == 't';
+
+    return true;
+}
+
+bool JsonStreamingInputSerializer::operator()(std::string &value, Common::StringView name)
+{
+    const char *p = findValue(name);
+    if (p == nullptr) {
+        return false;
+    }
+
+    if (*p != '"') {
+        throw std::runtime_error("JsonValue type is not STRING");
+    }
+
+    Common::StringView text;
+    readString(p, text);
+    value.assign(text.getData(), text.getSize());
+
+    return true;
+}
+
+bool JsonStreamingInputSerializer::binary(void *value, size_t size, Common::StringView name)
+{
+    const char *p = findValue(name);
+    if (p == nullptr) {
+        return false;
+    }
+
+    if (*p != '"') {
+        throw std::runtime_error("JsonValue type is not STRING");
+    }
+
+    Common::StringView text;
+    readString(p, text);
+    decodeHex(text, value, size);
+
+    return true;
+}
+
+bool JsonStreamingInputSerializer::binary(std::string &value, Common::StringView name)
+{
+    const char *p = findValue(name);
+    if (p == nullptr) {
+        return false;
+    }
+
+    if (*p != '"') {
+        throw std::runtime_error("JsonValue type is not STRING");
+    }
+
+    Common::StringView text;
+    readString(p, text);
+
+    if ((text.getSize() & 1) != 0) {
+        throw std::runtime_error("fromHex: invalid string size");
+    }
+
+    value.resize(text.getSize() >> 1);
+    if (!value.empty()) {
+        decodeHex(text, &value[0], value.size());
+    }
+
+    return true;
+}
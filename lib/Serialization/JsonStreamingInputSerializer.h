@@ -0,0 +1,101 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <Serialization/ISerializer.h>
+
+namespace CryptoNote {
+
+/*!
+    Reads JSON text in place, without building a Common::JsonValue tree.
+
+    Entering an object only records where each of its members starts, values are parsed
+    when they are asked for. The text must outlive the serializer. Accepts what
+    JsonInputValueSerializer accepts; malformed text and type mismatches throw.
+*/
+class JsonStreamingInputSerializer : public ISerializer
+{
+public:
+    explicit JsonStreamingInputSerializer(Common::StringView text);
+    ~JsonStreamingInputSerializer() override = default;
+
+    SerializerType type() const override;
+
+    bool beginObject(Common::StringView name) override;
+    void endObject() override;
+
+    bool beginArray(size_t &size, Common::StringView name) override;
+    void endArray() override;
+
+    bool operator()(uint8_t &value, Common::StringView name) override;
+    bool operator()(int16_t &value, Common::StringView name) override;
+    bool operator()(uint16_t &value, Common::StringView name) override;
+    bool operator()(int32_t &value, Common::StringView name) override;
+    bool operator()(uint32_t &value, Common::StringView name) override;
+    bool operator()(int64_t &value, Common::StringView name) override;
+    bool operator()(uint64_t &value, Common::StringView name) override;
+    bool operator()(double &value, Common::StringView name) override;
+    bool operator()(bool &value, Common::StringView name) override;
+    bool operator()(std::string &value, Common::StringView name) override;
+
+    bool binary(void *value, size_t size, Common::StringView name) override;
+    bool binary(std::string &value, Common::StringView name) override;
+
+    template<typename T>
+    bool operator()(T &value, Common::StringView name)
+    {
+        return ISerializer::operator()(value, name);
+    }
+
+    // Returns the unparsed text of a member of the current object.
+    bool getRaw(Common::StringView name, Common::StringView &raw);
+
+private:
+    struct Member
+    {
+        Common::StringView name;
+        const char *value;
+    };
+
+    struct Scope
+    {
+        bool isArray;
+        size_t firstMember; // objects: range in m_members
+        size_t endMember;
+        const char *next;   // arrays: the element to read next
+    };
+
+    const char *findValue(Common::StringView name);
+    const char *indexObject(const char *begin);
+    const char *skipValue(const char *begin) const;
+    const char *skipString(const char *begin) const;
+    const char *skipSpace(const char *begin) const;
+    const char *skipSeparator(const char *begin, char close) const;
+    const char *readString(const char *begin, Common::StringView &value) const;
+
+    template<typename T>
+    bool readInteger(Common::StringView name, T &value);
+
+    const char *m_end;
+    std::vector<Scope> m_scopes;
+    std::vector<Member> m_members;
+};
+
+} // namespace CryptoNote
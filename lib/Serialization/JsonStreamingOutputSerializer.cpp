@@ -0,0 +1,244 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cassert>
+#include <cstdio>
+#include <Serialization/JsonStreamingOutputSerializer.h>
+
+using namespace CryptoNote;
+
+namespace {
+
+const char HEX_DIGITS[] = "0123456789abcdef";
+
+} // namespace
+
+JsonStreamingOutputSerializer::JsonStreamingOutputSerializer(std::string &output)
+    : m_output(output)
+{
+    m_output += '{';
+    m_empty.push_back(true);
+    m_isArray.push_back(false);
+}
+
+ISerializer::SerializerType JsonStreamingOutputSerializer::type() const
+{
+    return ISerializer::OUTPUT;
+}
+
+void JsonStreamingOutputSerializer::finish()
+{
+    assert(m_empty.size() == 1);
+
+    m_output += '}';
+    m_empty.clear();
+    m_isArray.clear();
+}
+
+void JsonStreamingOutputSerializer::writeName(Common::StringView name)
+{
+    assert(!m_empty.empty());
+
+    if (!m_empty.back()) {
+        m_output += ',';
+    }
+    m_empty.back() = false;
+
+    if (!m_isArray.back()) {
+        m_output += '"';
+        m_output.append(name.getData(), name.getSize());
+        m_output += "\":";
+    }
+}
+
+void JsonStreamingOutputSerializer::writeInteger(int64_t value)
+{
+    char buffer[24];
+    char *end = buffer + sizeof(buffer);
+    char *begin = end;
+
+    // negate in unsigned arithmetic, so INT64_MIN does not overflow
+    uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    do {
+        *--begin = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    if (value < 0) {
+        *--begin = '-';
+    }
+
+    m_output.append(begin, end);
+}
+
+bool JsonStreamingOutputSerializer::beginObject(Common::StringView name)
+{
+    writeName(name);
+    m_output += '{';
+    m_empty.push_back(true);
+    m_isArray.push_back(false);
+
+    return true;
+}
+
+void JsonStreamingOutputSerializer::endObject()
+{
+    assert(m_empty.size() > 1 && !m_isArray.back());
+
+    m_output += '}';
+    m_empty.pop_back();
+    m_isArray.pop_back();
+}
+
+bool JsonStreamingOutputSerializer::beginArray(size_t &size, Common::StringView name)
+{
+    writeName(name);
+    m_output += '[';
+    m_empty.push_back(true);
+    m_isArray.push_back(true);
+
+    return true;
+}
+
+void JsonStreamingOutputSerializer::endArray()
+{
+    assert(m_empty.size() > 1 && m_isArray.back());
+
+    m_output += ']';
+    m_empty.pop_back();
+    m_isArray.pop_back();
+}
+
+bool JsonStreamingOutputSerializer::operator()(uint8_t &value, Common::StringView name)
+{
+    writeName(name);
+    writeInteger(value);
+
+    return true;
+}
+
+bool JsonStreamingOutputSerializer::operator()(int16_t &value, Common::StringView name)
+{
+    writeName(name);
+    writeInteger(value);
+
+    return true;
+}
+
+bool JsonStreamingOutputSerializer::operator()(uint16_t &value, Common::StringView name)
+{
+    writeName(name);
+    writeInteger(value);
+
+    return true;
+}
+
+bool JsonStreamingOutputSerializer::operator()(int32_t &value, Common::StringView name)
+{
+    writeName(name);
+    writeInteger(value);
+
+    return true;
+}
+
+bool JsonStreamingOutputSerializer::operator()(uint32_t &value, Common::StringView name)
+{
+    writeName(name);
+    writeInteger(value);
+
+    return true;
+}
+
+bool JsonStreamingOutputSerializer::operator()(int64_t &value, Common::StringView name)
+{
+    writeName(name);
+    writeInteger(value);
+
+    return true;
+}
+
+bool JsonStreamingOutputSerializer::operator()(uint64_t &value, Common::StringView name)
+{
+    // JsonValue keeps integers signed, stay compatible with what it writes
+    writeName(name);
+    writeInteger(static_cast<int64_t>(value));
+
+    return true;
+}
+
+bool JsonStreamingOutputSerializer::operator()(double &value, Common::StringView name)
+{
+    writeName(name);
+
+    // same as JsonValue: fixed with 11 digits, trailing zeros trimmed down to one
+    char buffer[384];
+    int length = snprintf(buffer, sizeof(buffer), "%.11f", value);
+    if (length < 0 || static_cast<size_t>(length) >= sizeof(buffer)) {
+        length = static_cast<int>(sizeof(buffer)) - 1;
+    }
+
+    while (length > 1 && buffer[length - 2] != '.' && buffer[length - 1] == '0') {
+        --length;
+    }
+
+    m_output.append(buffer, static_cast<size_t>(length));
+
+    return true;
+}
+
+bool JsonStreamingOutputSerializer::operator()(bool &value, Common::StringView name)
+{
+    writeName(name);
+    m_output += value ? "true" : "false";
+
+    return true;
+}
+
+bool JsonStreamingOutputSerializer::operator()(std::string &value, Common::StringView name)
+{
+    writeName(name);
+    m_output += '"';
+    m_output += value;
+    m_output += '"';
+
+    return true;
+}
+
+bool JsonStreamingOutputSerializer::binary(void *value, size_t size, Common::StringView name)
+{
+    writeName(name);
+    m_output += '"';
+
+    size_t offset = m_output.size();
+    m_output.resize(offset + size * 2);
+
+    const uint8_t *data = static_cast<const uint8_t *>(value);
+    char *out = &m_output[offset];
+    for (size_t i = 0; i < size; ++i) {
+        *out++ = HEX_DIGITS[data[i] >> 4];
+        *out++ = HEX_DIGITS[data[i] & 15];
+    }
+
+    m_output += '"';
+
+    return true;
+}
+
+bool JsonStreamingOutputSerializer::binary(std::string &value, Common::StringView name)
+{
+    return binary(const_cast<char *>(value.data()), value.size(), name);
+}
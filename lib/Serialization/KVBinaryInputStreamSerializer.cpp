@@ -11,220 +11,486 @@
 #include <cassert>
 #include <cstring>
 #include <stdexcept>
-#include <Common/StreamTools.h>
 #include <Serialization/KVBinaryCommon.h>
 #include <Serialization/KVBinaryInputStreamSerializer.h>
 
-using namespace Common;
 using namespace CryptoNote;
 
 namespace {
 
+// deeper nesting is only used to exhaust the stack
+const size_t MAX_NESTING_DEPTH = 100;
+
+size_t podSize(uint8_t type)
+{
+    switch (type) {
+    case BIN_KV_SERIALIZE_TYPE_INT64:
+    case BIN_KV_SERIALIZE_TYPE_UINT64:
+    case BIN_KV_SERIALIZE_TYPE_DOUBLE:
+        return 8;
+    case BIN_KV_SERIALIZE_TYPE_INT32:
+    case BIN_KV_SERIALIZE_TYPE_UINT32:
+        return 4;
+    case BIN_KV_SERIALIZE_TYPE_INT16:
+    case BIN_KV_SERIALIZE_TYPE_UINT16:
+        return 2;
+    case BIN_KV_SERIALIZE_TYPE_INT8:
+    case BIN_KV_SERIALIZE_TYPE_UINT8:
+    case BIN_KV_SERIALIZE_TYPE_BOOL:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
 template <typename T>
-T readPod(Common::IInputStream &s)
+T readPod(const char *p)
 {
     T v;
-    read(s, &v, sizeof(T));
+    memcpy(&v, p, sizeof(T));
 
     return v;
 }
 
-template <typename T, typename JsonT = T>
-JsonValue readPodJson(Common::IInputStream &s)
+// p must hold podSize(type) bytes
+int64_t readIntegerValue(const char *p, uint8_t type)
+{
+    switch (type) {
+    case BIN_KV_SERIALIZE_TYPE_INT64:
+        return readPod<int64_t>(p);
+    case BIN_KV_SERIALIZE_TYPE_INT32:
+        return readPod<int32_t>(p);
+    case BIN_KV_SERIALIZE_TYPE_INT16:
+        return readPod<int16_t>(p);
+    case BIN_KV_SERIALIZE_TYPE_INT8:
+        return readPod<int8_t>(p);
+    case BIN_KV_SERIALIZE_TYPE_UINT64:
+        return static_cast<int64_t>(readPod<uint64_t>(p));
+    case BIN_KV_SERIALIZE_TYPE_UINT32:
+        return readPod<uint32_t>(p);
+    case BIN_KV_SERIALIZE_TYPE_UINT16:
+        return readPod<uint16_t>(p);
+    case BIN_KV_SERIALIZE_TYPE_UINT8:
+        return readPod<uint8_t>(p);
+    default:
+        throw std::runtime_error("Integer value expected");
+    }
+}
+
+} // namespace
+
+KVBinaryInputStreamSerializer::KVBinaryInputStreamSerializer(Common::IInputStream &strm)
 {
-    JsonValue jv;
-    jv = static_cast<JsonT>(readPod<T>(s));
+    char buffer[4096];
+    size_t size;
+    while ((size = strm.readSome(buffer, sizeof(buffer))) != 0) {
+        m_storage.append(buffer, size);
+    }
 
-    return jv;
+    m_begin = m_storage.data();
+    m_end = m_begin + m_storage.size();
+    parse();
 }
 
-template <typename T>
-JsonValue readIntegerJson(Common::IInputStream &s)
-{
-    return readPodJson<T, int64_t>(s);
-}
-
-size_t readVarint(Common::IInputStream &s)
-{
-    auto b = read<uint8_t>(s);
-    uint8_t size_mask = b & PORTABLE_RAW_SIZE_MARK_MASK;
-    size_t bytesLeft = 0;
-
-    switch (size_mask) {
-    case PORTABLE_RAW_SIZE_MARK_BYTE:
-        bytesLeft = 0;
-        break;
-    case PORTABLE_RAW_SIZE_MARK_WORD:
-        bytesLeft = 1;
-        break;
-    case PORTABLE_RAW_SIZE_MARK_DWORD:
-        bytesLeft = 3;
-        break;
-    case PORTABLE_RAW_SIZE_MARK_INT64:
-        bytesLeft = 7;
-        break;
-    default:
-        // do nothing
-        break;
+KVBinaryInputStreamSerializer::KVBinaryInputStreamSerializer(Common::StringView data)
+    : m_begin(data.getData()),
+      m_end(data.getData() + data.getSize())
+{
+    parse();
+}
+
+ISerializer::SerializerType KVBinaryInputStreamSerializer::type() const
+{
+    return ISerializer::INPUT;
+}
+
+void KVBinaryInputStreamSerializer::parse()
+{
+    require(m_begin, sizeof(KVBinaryStorageBlockHeader));
+    auto hdr = readPod<KVBinaryStorageBlockHeader>(m_begin);
+
+    if (hdr.m_signature_a != PORTABLE_STORAGE_SIGNATUREA
+        || hdr.m_signature_b != PORTABLE_STORAGE_SIGNATUREB) {
+        throw std::runtime_error("Invalid binary storage signature");
     }
 
-    size_t value = b;
+    if (hdr.m_ver != PORTABLE_STORAGE_FORMAT_VER) {
+        throw std::runtime_error("Unknown binary storage format version");
+    }
+
+    indexSection(m_begin + sizeof(KVBinaryStorageBlockHeader));
+}
+
+bool KVBinaryInputStreamSerializer::beginObject(Common::StringView name)
+{
+    size_t scope = m_scopes.size() - 1;
+
+    if (m_scopes[scope].isArray) {
+        if (m_scopes[scope].itemType != BIN_KV_SERIALIZE_TYPE_OBJECT
+            || m_scopes[scope].remaining == 0) {
+            throw std::runtime_error("Object expected");
+        }
+
+        // the element is indexed once, the end of its index is where the next one starts
+        --m_scopes[scope].remaining;
+        const char *end = indexSection(m_scopes[scope].next);
+        m_scopes[scope].next = end;
+
+        return true;
+    }
+
+    uint8_t type;
+    const char *value = findValue(name, type);
+    if (value == nullptr) {
+        return false;
+    }
 
-    for (size_t i = 1; i <= bytesLeft; ++i) {
-        size_t n = read<uint8_t>(s);
-        value |= n << (i * 8);
+    if (type != BIN_KV_SERIALIZE_TYPE_OBJECT) {
+        throw std::runtime_error("Object expected");
     }
 
-    value >>= 2;
+    indexSection(value);
+
+    return true;
+}
+
+void KVBinaryInputStreamSerializer::endObject()
+{
+    assert(m_scopes.size() > 1 && !m_scopes.back().isArray);
 
-    return value;
+    m_members.resize(m_scopes.back().firstMember);
+    m_scopes.pop_back();
 }
 
-std::string readString(Common::IInputStream &s)
+bool KVBinaryInputStreamSerializer::beginArray(size_t &size, Common::StringView name)
 {
-    auto size = readVarint(s);
+    uint8_t type;
+    const char *value = findValue(name, type);
+    if (value == nullptr) {
+        size = 0;
+        return false;
+    }
 
-    std::string str;
-    str.resize(size);
-    if (size) {
-        read(s, &str[0], size);
+    // an array nested in an array carries its own type
+    if (type == BIN_KV_SERIALIZE_TYPE_ARRAY) {
+        require(value, 1);
+        type = static_cast<uint8_t>(*value++);
     }
 
-    return str;
+    if ((type & BIN_KV_SERIALIZE_FLAG_ARRAY) == 0) {
+        throw std::runtime_error("Array expected");
+    }
+
+    uint8_t itemType = type & ~BIN_KV_SERIALIZE_FLAG_ARRAY;
+    size_t count;
+    const char *items = readVarint(value, count);
+
+    // every element takes a byte at least, a forged count cannot grow the target past the data
+    size_t itemSize = std::max<size_t>(podSize(itemType), 1);
+    if (count > static_cast<size_t>(m_end - items) / itemSize) {
+        throw std::runtime_error("Array size exceeds the data");
+    }
+
+    m_scopes.push_back({ true, 0, 0, itemType, count, items });
+    size = count;
+
+    return true;
 }
 
-JsonValue readStringJson(Common::IInputStream &s)
+void KVBinaryInputStreamSerializer::endArray()
 {
-    return JsonValue(readString(s));
+    assert(m_scopes.size() > 1 && m_scopes.back().isArray);
+
+    m_scopes.pop_back();
 }
 
-void readName(Common::IInputStream &s, std::string &name)
+template<typename T>
+bool KVBinaryInputStreamSerializer::readInteger(Common::StringView name, T &value)
 {
-    auto len = readPod<uint8_t>(s);
-    if (len) {
-        name.resize(len);
-        read(s, &name[0], len);
+    uint8_t type;
+    const char *p = findValue(name, type);
+    if (p == nullptr) {
+        return false;
     }
+
+    require(p, podSize(type));
+    value = static_cast<T>(readIntegerValue(p, type));
+
+    return true;
 }
 
-JsonValue loadValue(Common::IInputStream &stream, uint8_t type);
-JsonValue loadSection(Common::IInputStream &stream);
-JsonValue loadEntry(Common::IInputStream &stream);
-JsonValue loadArray(Common::IInputStream &stream, uint8_t itemType);
+bool KVBinaryInputStreamSerializer::operator()(uint8_t &value, Common::StringView name)
+{
+    return readInteger(name, value);
+}
 
-JsonValue loadSection(Common::IInputStream &stream)
+bool KVBinaryInputStreamSerializer::operator()(int16_t &value, Common::StringView name)
 {
-    JsonValue sec(JsonValue::OBJECT);
-    size_t count = readVarint(stream);
-    std::string name;
+    return readInteger(name, value);
+}
 
-    while (count--) {
-        readName(stream, name);
-        sec.insert(name, loadEntry(stream));
+bool KVBinaryInputStreamSerializer::operator()(uint16_t &value, Common::StringView name)
+{
+    return readInteger(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(int32_t &value, Common::StringView name)
+{
+    return readInteger(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(uint32_t &value, Common::StringView name)
+{
+    return readInteger(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(int64_t &value, Common::StringView name)
+{
+    return readInteger(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(uint64_t &value, Common::StringView name)
+{
+    return readInteger(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(double &value, Common::StringView name)
+{
+    uint8_t type;
+    const char *p = findValue(name, type);
+    if (p == nullptr) {
+        return false;
+    }
+
+    require(p, podSize(type));
+    if (type == BIN_KV_SERIALIZE_TYPE_DOUBLE) {
+        value = readPod<double>(p);
+    } else {
+        value = static_cast<double>(readIntegerValue(p, type));
     }
 
-    return sec;
+    return true;
 }
 
-JsonValue loadValue(Common::IInputStream &stream, uint8_t type)
+bool KVBinaryInputStreamSerializer::operator()(bool &value, Common::StringView name)
 {
-    switch (type) {
-    case BIN_KV_SERIALIZE_TYPE_INT64:
-        return readIntegerJson<int64_t>(stream);
-    case BIN_KV_SERIALIZE_TYPE_INT32:
-        return readIntegerJson<int32_t>(stream);
-    case BIN_KV_SERIALIZE_TYPE_INT16:
-        return readIntegerJson<int16_t>(stream);
-    case BIN_KV_SERIALIZE_TYPE_INT8:
-        return readIntegerJson<int8_t>(stream);
-    case BIN_KV_SERIALIZE_TYPE_UINT64:
-        return readIntegerJson<uint64_t>(stream);
-    case BIN_KV_SERIALIZE_TYPE_UINT32:
-        return readIntegerJson<uint32_t>(stream);
-    case BIN_KV_SERIALIZE_TYPE_UINT16:
-        return readIntegerJson<uint16_t>(stream);
-    case BIN_KV_SERIALIZE_TYPE_UINT8:
-        return readIntegerJson<uint8_t>(stream);
-    case BIN_KV_SERIALIZE_TYPE_DOUBLE:
-        return readPodJson<double>(stream);
-    case BIN_KV_SERIALIZE_TYPE_BOOL:
-        return JsonValue(read<uint8_t>(stream) != 0);
-    case BIN_KV_SERIALIZE_TYPE_STRING:
-        return readStringJson(stream);
-    case BIN_KV_SERIALIZE_TYPE_OBJECT:
-        return loadSection(stream);
-    case BIN_KV_SERIALIZE_TYPE_ARRAY:
-        return loadArray(stream, type);
-    default:
-        throw std::runtime_error("Unknown data type");
+    uint8_t type;
+    const char *p = findValue(name, type);
+    if (p == nullptr) {
+        return false;
+    }
+
+    if (type != BIN_KV_SERIALIZE_TYPE_BOOL) {
+        throw std::runtime_error("Bool value expected");
+    }
+
+    require(p, 1);
+    value = *p != 0;
+
+    return true;
+}
+
+bool KVBinaryInputStreamSerializer::operator()(std::string &value, Common::StringView name)
+{
+    Common::StringView data;
+    if (!readString(name, data)) {
+        return false;
     }
+
+    value.assign(data.getData(), data.getSize());
+
+    return true;
 }
 
-JsonValue loadEntry(Common::IInputStream &stream)
+bool KVBinaryInputStreamSerializer::binary(void *value, size_t size, Common::StringView name)
 {
-    auto type = readPod<uint8_t>(stream);
+    Common::StringView data;
+    if (!readString(name, data)) {
+        return false;
+    }
+
+    if (data.getSize() != size) {
+        throw std::runtime_error("Binary block size mismatch");
+    }
 
-    if (type & BIN_KV_SERIALIZE_FLAG_ARRAY) {
-        type &= ~BIN_KV_SERIALIZE_FLAG_ARRAY;
-        return loadArray(stream, type);
+    if (size != 0) {
+        memcpy(value, data.getData(), size);
     }
 
-    return loadValue(stream, type);
+    return true;
 }
 
-JsonValue loadArray(Common::IInputStream &stream, uint8_t itemType)
+bool KVBinaryInputStreamSerializer::binary(std::string &value, Common::StringView name)
 {
-    JsonValue arr(JsonValue::ARRAY);
-    size_t count = readVarint(stream);
+    return (*this)(value, name); // load as string
+}
+
+const char *KVBinaryInputStreamSerializer::indexSection(const char *begin)
+{
+    size_t count;
+    const char *p = readVarint(begin, count);
+
+    Scope scope = { false, m_members.size(), 0, 0, 0, nullptr };
 
     while (count--) {
-        arr.pushBack(loadValue(stream, itemType));
+        require(p, 1);
+        auto length = static_cast<uint8_t>(*p++);
+        require(p, length + 1u);
+
+        Member member;
+        member.name = Common::StringView(p, length);
+        member.type = static_cast<uint8_t>(p[length]);
+        member.value = p + length + 1;
+        m_members.push_back(member);
+
+        p = skipValue(member.value, member.type);
     }
 
-    return arr;
+    scope.endMember = m_members.size();
+    m_scopes.push_back(scope);
+
+    return p;
 }
 
-JsonValue parseBinary(Common::IInputStream &stream)
+const char *KVBinaryInputStreamSerializer::findValue(Common::StringView name, uint8_t &type)
 {
-    auto hdr = readPod<KVBinaryStorageBlockHeader>(stream);
+    Scope &scope = m_scopes.back();
 
-    if (hdr.m_signature_a != PORTABLE_STORAGE_SIGNATUREA
-        || hdr.m_signature_b != PORTABLE_STORAGE_SIGNATUREB) {
-        throw std::runtime_error("Invalid binary storage signature");
+    if (scope.isArray) {
+        if (scope.remaining == 0) {
+            throw std::runtime_error("Array is exhausted");
+        }
+
+        const char *value = scope.next;
+        type = scope.itemType;
+        scope.next = skipValue(value, type);
+        --scope.remaining;
+
+        return value;
     }
 
-    if (hdr.m_ver != PORTABLE_STORAGE_FORMAT_VER) {
-        throw std::runtime_error("Unknown binary storage format version");
+    // the first one wins when a name repeats
+    for (size_t i = scope.firstMember; i < scope.endMember; ++i) {
+        if (m_members[i].name == name) {
+            type = m_members[i].type;
+
+            return m_members[i].value;
+        }
     }
 
-    return loadSection(stream);
+    return nullptr;
 }
 
-} // namespace
-
-KVBinaryInputStreamSerializer::KVBinaryInputStreamSerializer(Common::IInputStream &strm)
-    : JsonInputValueSerializer(parseBinary(strm))
+const char *KVBinaryInputStreamSerializer::skipValue(const char *begin,
+                                                     uint8_t type,
+                                                     size_t depth) const
 {
+    if (depth > MAX_NESTING_DEPTH) {
+        throw std::runtime_error("Binary storage is nested too deep");
+    }
+
+    if ((type & BIN_KV_SERIALIZE_FLAG_ARRAY) != 0) {
+        uint8_t itemType = type & ~BIN_KV_SERIALIZE_FLAG_ARRAY;
+        size_t count;
+        const char *p = readVarint(begin, count);
+
+        size_t size = podSize(itemType);
+        if (size != 0) {
+            if (count > static_cast<size_t>(m_end - p) / size) {
+                throw std::runtime_error("Array size exceeds the data");
+            }
+
+            return p + count * size;
+        }
+
+        while (count--) {
+            p = skipValue(p, itemType, depth + 1);
+        }
+
+        return p;
+    }
+
+    size_t size = podSize(type);
+    if (size != 0) {
+        return require(begin, size) + size;
+    }
+
+    switch (type) {
+    case BIN_KV_SERIALIZE_TYPE_STRING: {
+        size_t length;
+        const char *p = readVarint(begin, length);
+        if (length > static_cast<size_t>(m_end - p)) {
+            throw std::runtime_error("String exceeds the data");
+        }
+
+        return p + length;
+    }
+    case BIN_KV_SERIALIZE_TYPE_OBJECT: {
+        size_t count;
+        const char *p = readVarint(begin, count);
+        while (count--) {
+            require(p, 1);
+            auto length = static_cast<uint8_t>(*p++);
+            require(p, length + 1u);
+            p = skipValue(p + length + 1, static_cast<uint8_t>(p[length]), depth + 1);
+        }
+
+        return p;
+    }
+    case BIN_KV_SERIALIZE_TYPE_ARRAY:
+        require(begin, 1);
+        return skipValue(begin + 1, static_cast<uint8_t>(*begin) | BIN_KV_SERIALIZE_FLAG_ARRAY,
+                         depth + 1);
+    default:
+        throw std::runtime_error("Unknown data type");
+    }
 }
 
-bool KVBinaryInputStreamSerializer::binary(void *value, size_t size, Common::StringView name)
+const char *KVBinaryInputStreamSerializer::readVarint(const char *begin, size_t &value) const
 {
-    std::string str;
+    require(begin, 1);
+    auto b = static_cast<uint8_t>(*begin);
+    size_t bytes = size_t(1) << (b & PORTABLE_RAW_SIZE_MARK_MASK);
+    require(begin, bytes);
+
+    uint64_t v = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        v |= static_cast<uint64_t>(static_cast<uint8_t>(begin[i])) << (i * 8);
+    }
 
-    if (!(*this)(str, name)) {
+    value = static_cast<size_t>(v >> 2);
+
+    return begin + bytes;
+}
+
+bool KVBinaryInputStreamSerializer::readString(Common::StringView name, Common::StringView &value)
+{
+    uint8_t type;
+    const char *p = findValue(name, type);
+    if (p == nullptr) {
         return false;
     }
 
-    if (str.size() != size) {
-        throw std::runtime_error("Binary block size mismatch");
+    if (type != BIN_KV_SERIALIZE_TYPE_STRING) {
+        throw std::runtime_error("String value expected");
     }
 
-    memcpy(value, str.data(), size);
+    size_t length;
+    p = readVarint(p, length);
+    if (length > static_cast<size_t>(m_end - p)) {
+        throw std::runtime_error("String exceeds the data");
+    }
+
+    value = Common::StringView(p, length);
 
     return true;
 }
 
-bool KVBinaryInputStreamSerializer::binary(std::string &value, Common::StringView name)
+const char *KVBinaryInputStreamSerializer::require(const char *begin, size_t size) const
 {
-    return (*this)(value, name); // load as string
+    if (size > static_cast<size_t>(m_end - begin)) {
+        throw std::runtime_error("Unexpected end of binary storage");
+    }
+
+    return begin;
 }
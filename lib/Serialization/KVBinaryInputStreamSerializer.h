@@ -18,19 +18,90 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
 #include <Common/IInputStream.h>
 #include <Serialization/ISerializer.h>
-#include <Serialization/JsonInputValueSerializer.h>
 
 namespace CryptoNote {
 
-class KVBinaryInputStreamSerializer : public JsonInputValueSerializer
+/*!
+    Reads the portable storage (KV binary) format straight into the target structs.
+
+    Entering an object only records where each of its members starts, values are decoded
+    when they are asked for. The view constructor reads the data in place, it must outlive
+    the serializer; the stream constructor keeps a copy of what is left in the stream.
+    Malformed data and type mismatches throw.
+*/
+class KVBinaryInputStreamSerializer : public ISerializer
 {
 public:
     explicit KVBinaryInputStreamSerializer(Common::IInputStream &strm);
+    explicit KVBinaryInputStreamSerializer(Common::StringView data);
+    ~KVBinaryInputStreamSerializer() override = default;
+
+    SerializerType type() const override;
+
+    bool beginObject(Common::StringView name) override;
+    void endObject() override;
+
+    bool beginArray(size_t &size, Common::StringView name) override;
+    void endArray() override;
+
+    bool operator()(uint8_t &value, Common::StringView name) override;
+    bool operator()(int16_t &value, Common::StringView name) override;
+    bool operator()(uint16_t &value, Common::StringView name) override;
+    bool operator()(int32_t &value, Common::StringView name) override;
+    bool operator()(uint32_t &value, Common::StringView name) override;
+    bool operator()(int64_t &value, Common::StringView name) override;
+    bool operator()(uint64_t &value, Common::StringView name) override;
+    bool operator()(double &value, Common::StringView name) override;
+    bool operator()(bool &value, Common::StringView name) override;
+    bool operator()(std::string &value, Common::StringView name) override;
 
     bool binary(void *value, size_t size, Common::StringView name) override;
     bool binary(std::string &value, Common::StringView name) override;
+
+    template<typename T>
+    bool operator()(T &value, Common::StringView name)
+    {
+        return ISerializer::operator()(value, name);
+    }
+
+private:
+    struct Member
+    {
+        Common::StringView name;
+        uint8_t type;
+        const char *value;
+    };
+
+    struct Scope
+    {
+        bool isArray;
+        size_t firstMember; // objects: range in m_members
+        size_t endMember;
+        uint8_t itemType;   // arrays: type of the elements left to read
+        size_t remaining;
+        const char *next;
+    };
+
+    void parse();
+    const char *indexSection(const char *begin);
+    const char *findValue(Common::StringView name, uint8_t &type);
+    const char *skipValue(const char *begin, uint8_t type, size_t depth = 0) const;
+    const char *readVarint(const char *begin, size_t &value) const;
+    bool readString(Common::StringView name, Common::StringView &value);
+    const char *require(const char *begin, size_t size) const;
+
+    template<typename T>
+    bool readInteger(Common::StringView name, T &value);
+
+    std::string m_storage;
+    const char *m_begin;
+    const char *m_end;
+    std::vector<Scope> m_scopes;
+    std::vector<Member> m_members;
 };
 
 } // namespace CryptoNote
@@ -17,6 +17,8 @@
 // along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <cassert>
+#include <cstring>
+#include <limits>
 #include <stdexcept>
 #include <Common/StreamTools.h>
 #include <Serialization/KVBinaryCommon.h>
@@ -27,49 +29,65 @@ using namespace CryptoNote;
 
 namespace {
 
-template <typename T>
-void writePod(IOutputStream &s, const T &value)
+size_t varintSize(size_t val)
 {
-    write(s, &value, sizeof(T));
+    if (val <= 63) {
+        return 1;
+    } else if (val <= 16383) {
+        return 2;
+    } else if (val <= 1073741823) {
+        return 4;
+    } else {
+        if (val > 4611686018427387903) {
+            throw std::runtime_error("failed to pack varint - too big amount");
+        }
+        return 8;
+    }
 }
 
 template<class T>
-size_t packVarint(IOutputStream &s, uint8_t type_or, size_t pv)
+void packVarint(char *out, uint8_t type_or, size_t pv)
 {
     T v = static_cast<T>(pv << 2);
     v |= type_or;
 
-    write(s, &v, sizeof(T));
-
-    return sizeof(T);
+    memcpy(out, &v, sizeof(T));
 }
 
-void writeElementName(IOutputStream &s, Common::StringView name)
+// out must have room for varintSize(val) bytes
+void packArraySize(char *out, size_t val)
 {
-    if (name.getSize() > std::numeric_limits<uint8_t>::max()) {
-        throw std::runtime_error("Element name is too long");
+    switch (varintSize(val)) {
+    case 1:
+        packVarint<uint8_t>(out, PORTABLE_RAW_SIZE_MARK_BYTE, val);
+        break;
+    case 2:
+        packVarint<uint16_t>(out, PORTABLE_RAW_SIZE_MARK_WORD, val);
+        break;
+    case 4:
+        packVarint<uint32_t>(out, PORTABLE_RAW_SIZE_MARK_DWORD, val);
+        break;
+    default:
+        packVarint<uint64_t>(out, PORTABLE_RAW_SIZE_MARK_INT64, val);
+        break;
     }
+}
 
-    auto len = static_cast<uint8_t>(name.getSize());
-
-    write(s, &len, sizeof(len));
-    write(s, name.getData(), len);
+void writeArraySize(std::string &s, size_t val)
+{
+    size_t offset = s.size();
+    s.resize(offset + varintSize(val));
+    packArraySize(&s[offset], val);
 }
 
-size_t writeArraySize(IOutputStream &s, size_t val)
+void writeElementName(std::string &s, Common::StringView name)
 {
-    if (val <= 63) {
-        return packVarint<uint8_t>(s, PORTABLE_RAW_SIZE_MARK_BYTE, val);
-    } else if (val <= 16383) {
-        return packVarint<uint16_t>(s, PORTABLE_RAW_SIZE_MARK_WORD, val);
-    } else if (val <= 1073741823) {
-        return packVarint<uint32_t>(s, PORTABLE_RAW_SIZE_MARK_DWORD, val);
-    } else {
-        if (val > 4611686018427387903) {
-            throw std::runtime_error("failed to pack varint - too big amount");
-        }
-        return packVarint<uint64_t>(s, PORTABLE_RAW_SIZE_MARK_INT64, val);
+    if (name.getSize() > std::numeric_limits<uint8_t>::max()) {
+        throw std::runtime_error("Element name is too long");
     }
+
+    s += static_cast<char>(name.getSize());
+    s.append(name.getData(), name.getSize());
 }
 
 } // namespace
@@ -78,13 +96,11 @@ namespace CryptoNote {
 
 KVBinaryOutputStreamSerializer::KVBinaryOutputStreamSerializer()
 {
-    beginObject(std::string());
+    m_stack.emplace_back(State::Object, Common::StringView(), 0, 0);
 }
 
 void KVBinaryOutputStreamSerializer::dump(IOutputStream &target)
 {
-    assert(m_objectsStack.size() == 1);
-
     assert(m_stack.size() == 1);
 
     KVBinaryStorageBlockHeader hdr;
@@ -92,9 +108,12 @@ void KVBinaryOutputStreamSerializer::dump(IOutputStream &target)
     hdr.m_signature_b = PORTABLE_STORAGE_SIGNATUREB;
     hdr.m_ver = PORTABLE_STORAGE_FORMAT_VER;
 
+    std::string count;
+    writeArraySize(count, m_stack.front().count);
+
     Common::write(target, &hdr, sizeof(hdr));
-    writeArraySize(target, m_stack.front().count);
-    write(target, stream().data(), stream().size());
+    write(target, count.data(), count.size());
+    write(target, m_buffer.data(), m_buffer.size());
 }
 
 ISerializer::SerializerType KVBinaryOutputStreamSerializer::type() const
@@ -104,35 +123,33 @@ ISerializer::SerializerType KVBinaryOutputStreamSerializer::type() const
 
 bool KVBinaryOutputStreamSerializer::beginObject(Common::StringView name)
 {
-    checkArrayPreamble(BIN_KV_SERIALIZE_TYPE_OBJECT);
+    writeElementPrefix(BIN_KV_SERIALIZE_TYPE_OBJECT, name);
 
-    m_stack.push_back(Level(name));
-    m_objectsStack.push_back(MemoryStream());
+    // most objects have less than 64 members, one byte covers their count
+    m_stack.emplace_back(State::Object, name, 0, m_buffer.size());
+    m_buffer += '\0';
 
     return true;
 }
 
 void KVBinaryOutputStreamSerializer::endObject()
 {
-    assert(m_objectsStack.size());
+    assert(m_stack.size() > 1);
 
-    auto level = std::move(m_stack.back());
-    m_stack.pop_back();
+    const Level &level = m_stack.back();
 
-    auto objStream = std::move(m_objectsStack.back());
-    m_objectsStack.pop_back();
-
-    auto &out = stream();
-
-    writeElementPrefix(BIN_KV_SERIALIZE_TYPE_OBJECT, level.name);
+    size_t width = varintSize(level.count);
+    if (width > 1) {
+        m_buffer.insert(level.countOffset + 1, width - 1, '\0');
+    }
+    packArraySize(&m_buffer[level.countOffset], level.count);
 
-    writeArraySize(out, level.count);
-    write(out, objStream.data(), objStream.size());
+    m_stack.pop_back();
 }
 
 bool KVBinaryOutputStreamSerializer::beginArray(size_t &size, Common::StringView name)
 {
-    m_stack.push_back(Level(name, size));
+    m_stack.emplace_back(State::ArrayPrefix, name, size, 0);
 
     return true;
 }
@@ -147,74 +164,72 @@ void KVBinaryOutputStreamSerializer::endArray()
     }
 }
 
+template<typename T>
+void KVBinaryOutputStreamSerializer::writePod(uint8_t type, const T &value, Common::StringView name)
+{
+    writeElementPrefix(type, name);
+    m_buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
 bool KVBinaryOutputStreamSerializer::operator()(uint8_t &value, Common::StringView name)
 {
-    writeElementPrefix(BIN_KV_SERIALIZE_TYPE_UINT8, name);
-    writePod(stream(), value);
+    writePod(BIN_KV_SERIALIZE_TYPE_UINT8, value, name);
 
     return true;
 }
 
 bool KVBinaryOutputStreamSerializer::operator()(uint16_t &value, Common::StringView name)
 {
-    writeElementPrefix(BIN_KV_SERIALIZE_TYPE_UINT16, name);
-    writePod(stream(), value);
+    writePod(BIN_KV_SERIALIZE_TYPE_UINT16, value, name);
 
     return true;
 }
 
 bool KVBinaryOutputStreamSerializer::operator()(int16_t &value, Common::StringView name)
 {
-    writeElementPrefix(BIN_KV_SERIALIZE_TYPE_INT16, name);
-    writePod(stream(), value);
+    writePod(BIN_KV_SERIALIZE_TYPE_INT16, value, name);
 
     return true;
 }
 
 bool KVBinaryOutputStreamSerializer::operator()(uint32_t &value, Common::StringView name)
 {
-    writeElementPrefix(BIN_KV_SERIALIZE_TYPE_UINT32, name);
-    writePod(stream(), value);
+    writePod(BIN_KV_SERIALIZE_TYPE_UINT32, value, name);
 
     return true;
 }
 
 bool KVBinaryOutputStreamSerializer::operator()(int32_t &value, Common::StringView name)
 {
-    writeElementPrefix(BIN_KV_SERIALIZE_TYPE_INT32, name);
-    writePod(stream(), value);
+    writePod(BIN_KV_SERIALIZE_TYPE_INT32, value, name);
 
     return true;
 }
 
 bool KVBinaryOutputStreamSerializer::operator()(int64_t &value, Common::StringView name)
 {
-    writeElementPrefix(BIN_KV_SERIALIZE_TYPE_INT64, name);
-    writePod(stream(), value);
+    writePod(BIN_KV_SERIALIZE_TYPE_INT64, value, name);
 
     return true;
 }
 
 bool KVBinaryOutputStreamSerializer::operator()(uint64_t &value, Common::StringView name)
 {
-    writeElementPrefix(BIN_KV_SERIALIZE_TYPE_UINT64, name);
-    writePod(stream(), value);
+    writePod(BIN_KV_SERIALIZE_TYPE_UINT64, value, name);
 
     return true;
 }
 
 bool KVBinaryOutputStreamSerializer::operator()(bool &value, Common::StringView name)
 {
-    writeElementPrefix(BIN_KV_SERIALIZE_TYPE_BOOL, name);
-    writePod(stream(), value);
+    writePod(BIN_KV_SERIALIZE_TYPE_BOOL, value, name);
 
     return true;
 }
 
 bool KVBinaryOutputStreamSerializer::operator()(double &value, Common::StringView name)
 {
-    writeElementPrefix(BIN_KV_SERIALIZE_TYPE_DOUBLE, name);
-    writePod(stream(), value);
+    writePod(BIN_KV_SERIALIZE_TYPE_DOUBLE, value, name);
 
     return true;
 }
@@ -223,9 +238,8 @@ bool KVBinaryOutputStreamSerializer::operator()(std::string &value, Common::Stri
 {
     writeElementPrefix(BIN_KV_SERIALIZE_TYPE_STRING, name);
 
-    auto &out = stream();
-    writeArraySize(out, value.size());
-    write(out, value.data(), value.size());
+    writeArraySize(m_buffer, value.size());
+    m_buffer += value;
 
     return true;
 }
@@ -235,9 +249,8 @@ bool KVBinaryOutputStreamSerializer::binary(void *value, size_t size, Common::St
     if (size > 0) {
         writeElementPrefix(BIN_KV_SERIALIZE_TYPE_STRING, name);
 
-        auto &out = stream();
-        writeArraySize(out, size);
-        write(out, value, size);
+        writeArraySize(m_buffer, size);
+        m_buffer.append(static_cast<const char *>(value), size);
     }
 
     return true;
@@ -257,9 +270,8 @@ void KVBinaryOutputStreamSerializer::writeElementPrefix(uint8_t type, Common::St
 
     if (level.state != State::Array) {
         if (!name.isEmpty()) {
-            auto &s = stream();
-            writeElementName(s, name);
-            write(s, &type, 1);
+            writeElementName(m_buffer, name);
+            m_buffer += static_cast<char>(type);
         }
         ++level.count;
     }
@@ -267,30 +279,15 @@ void KVBinaryOutputStreamSerializer::writeElementPrefix(uint8_t type, Common::St
 
 void KVBinaryOutputStreamSerializer::checkArrayPreamble(uint8_t type)
 {
-    if (m_stack.empty()) {
-        return;
-    }
-
     Level &level = m_stack.back();
 
     if (level.state == State::ArrayPrefix) {
-        auto &s = stream();
-        writeElementName(s, level.name);
-
-        char c = BIN_KV_SERIALIZE_FLAG_ARRAY | type;
-
-        write(s, &c, 1);
-        writeArraySize(s, level.count);
+        writeElementName(m_buffer, level.name);
+        m_buffer += static_cast<char>(BIN_KV_SERIALIZE_FLAG_ARRAY | type);
+        writeArraySize(m_buffer, level.count);
 
         level.state = State::Array;
     }
 }
 
-MemoryStream& KVBinaryOutputStreamSerializer::stream()
-{
-    assert(m_objectsStack.size());
-
-    return m_objectsStack.back();
-}
-
 } // namespace CryptoNote
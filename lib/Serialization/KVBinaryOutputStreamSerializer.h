@@ -18,13 +18,20 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
 #include <Common/IOutputStream.h>
 #include <Serialization/ISerializer.h>
-#include <Serialization/MemoryStream.h>
 
 namespace CryptoNote {
 
+/*!
+    Writes the portable storage (KV binary) format in a single pass.
+
+    Everything goes into one buffer. An object reserves a byte for its member count
+    and patches it in endObject, the body is only moved when the count needs a wider varint.
+    Names are kept as views, they must stay valid until the value they name is written.
+*/
 class KVBinaryOutputStreamSerializer : public ISerializer
 {
     enum class State
@@ -38,29 +45,17 @@ class KVBinaryOutputStreamSerializer : public ISerializer
     struct Level
     {
         State state;
-        std::string name;
+        Common::StringView name;
         size_t count;
+        size_t countOffset;
 
-        explicit Level(Common::StringView nm)
-            : name(nm),
-              state(State::Object),
-              count(0)
-        {
-        }
-
-        Level(Common::StringView nm, size_t arraySize)
-            : name(nm),
-              state(State::ArrayPrefix),
-              count(arraySize)
+        Level(State st, Common::StringView nm, size_t cnt, size_t offset)
+            : state(st),
+              name(nm),
+              count(cnt),
+              countOffset(offset)
         {
         }
-
-        Level(Level &&rv) noexcept
-        {
-            state = rv.state;
-            name = std::move(rv.name);
-            count = rv.count;
-        }
     };
 
 public:
@@ -98,12 +93,14 @@ public:
     }
 
 private:
+    template<typename T>
+    void writePod(uint8_t type, const T &value, Common::StringView name);
     void writeElementPrefix(uint8_t type, Common::StringView name);
     void checkArrayPreamble(uint8_t type);
-    MemoryStream &stream();
 
 private:
-    std::vector<MemoryStream> m_objectsStack;
+    // the root object's members, the header and the root count are added by dump()
+    std::string m_buffer;
     std::vector<Level> m_stack;
 };
 
@@ -24,6 +24,8 @@
 #include <Common/StringOutputStream.h>
 #include <Serialization/JsonInputStreamSerializer.h>
 #include <Serialization/JsonOutputStreamSerializer.h>
+#include <Serialization/JsonStreamingInputSerializer.h>
+#include <Serialization/JsonStreamingOutputSerializer.h>
 #include <Serialization/KVBinaryInputStreamSerializer.h>
 #include <Serialization/KVBinaryOutputStreamSerializer.h>
 
@@ -114,12 +116,50 @@ void loadFromJsonValue(std::list<T> &v, const Common::JsonValue &js)
 
 template <typename T>
 std::string storeToJson(const T &v)
+{
+    std::string result;
+    JsonStreamingOutputSerializer s(result);
+    serialize(const_cast<T &>(v), s);
+    s.finish();
+
+    return result;
+}
+
+template <typename T>
+std::string storeToJson(const std::vector<T> &v)
+{
+    return storeToJsonValue(v).toString();
+}
+
+template <typename T>
+std::string storeToJson(const std::list<T> &v)
+{
+    return storeToJsonValue(v).toString();
+}
+
+inline std::string storeToJson(const std::string &v)
 {
     return storeToJsonValue(v).toString();
 }
 
 template <typename T>
 bool loadFromJson(T &v, const std::string &buf)
+{
+    try {
+        if (buf.empty()) {
+            return true;
+        }
+        JsonStreamingInputSerializer s(buf);
+        serialize(v, s);
+    } catch (std::exception &) {
+        return false;
+    }
+
+    return true;
+}
+
+template <typename T>
+bool loadFromJsonDom(T &v, const std::string &buf)
 {
     try {
         if (buf.empty()) {
@@ -134,6 +174,18 @@ bool loadFromJson(T &v, const std::string &buf)
     return true;
 }
 
+template <typename T>
+bool loadFromJson(std::vector<T> &v, const std::string &buf)
+{
+    return loadFromJsonDom(v, buf);
+}
+
+template <typename T>
+bool loadFromJson(std::list<T> &v, const std::string &buf)
+{
+    return loadFromJsonDom(v, buf);
+}
+
 template <typename T>
 std::string storeToBinaryKeyValue(const T &v)
 {
@@ -151,8 +203,7 @@ template <typename T>
 bool loadFromBinaryKeyValue(T &v, const std::string &buf)
 {
     try {
-        Common::MemoryInputStream stream(buf.data(), buf.size());
-        KVBinaryInputStreamSerializer s(stream);
+        KVBinaryInputStreamSerializer s(buf);
         serialize(v, s);
 
         return true;
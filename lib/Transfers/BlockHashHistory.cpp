@@ -0,0 +1,239 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cassert>
+
+#include <Global/Constants.h>
+#include <Transfers/BlockHashHistory.h>
+
+using namespace Qwertycoin;
+
+namespace CryptoNote {
+
+BlockHashHistory::Pool::Pool()
+    : m_sweepSize(16)
+{
+}
+
+std::shared_ptr<const BlockHashHistory::Chunk> BlockHashHistory::Pool::intern(Chunk &&chunk)
+{
+    assert(!chunk.empty());
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+
+    auto &slot = m_chunks[chunk.back()];
+    std::shared_ptr<const Chunk> shared = slot.lock();
+    if (shared && *shared == chunk) {
+        return shared;
+    }
+
+    shared = std::make_shared<const Chunk>(std::move(chunk));
+    slot = shared;
+
+    if (m_chunks.size() >= m_sweepSize) {
+        sweep();
+    }
+
+    return shared;
+}
+
+size_t BlockHashHistory::Pool::size()
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    sweep();
+
+    return m_chunks.size();
+}
+
+void BlockHashHistory::Pool::sweep()
+{
+    for (auto it = m_chunks.begin(); it != m_chunks.end();) {
+        if (it->second.expired()) {
+            it = m_chunks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    m_sweepSize = std::max<size_t>(16, m_chunks.size() * 2);
+}
+
+BlockHashHistory::BlockHashHistory(std::shared_ptr<Pool> pool, uint32_t window)
+    : m_pool(std::move(pool)),
+      m_window(window)
+{
+}
+
+uint32_t BlockHashHistory::size() const
+{
+    return prunedHeight()
+           + static_cast<uint32_t>(m_chunks.size()) * CHUNK_SIZE
+           + static_cast<uint32_t>(m_tail.size());
+}
+
+uint32_t BlockHashHistory::prunedHeight() const
+{
+    return static_cast<uint32_t>(m_checkpoints.size()) * CHUNK_SIZE;
+}
+
+bool BlockHashHistory::isKnown(uint32_t height) const
+{
+    return height < size() && (height >= prunedHeight() || height % CHUNK_SIZE == 0);
+}
+
+const Crypto::Hash &BlockHashHistory::operator[](uint32_t height) const
+{
+    assert(isKnown(height));
+
+    if (height < prunedHeight()) {
+        return m_checkpoints[height / CHUNK_SIZE];
+    }
+
+    uint32_t offset = height - prunedHeight();
+    uint32_t chunk = offset / CHUNK_SIZE;
+    if (chunk < m_chunks.size()) {
+        return (*m_chunks[chunk])[offset % CHUNK_SIZE];
+    }
+
+    return m_tail[offset - static_cast<uint32_t>(m_chunks.size()) * CHUNK_SIZE];
+}
+
+void BlockHashHistory::append(const Crypto::Hash *hashes, uint32_t count)
+{
+    while (count > 0) {
+        if (m_tail.empty()) {
+            m_tail.reserve(CHUNK_SIZE);
+        }
+
+        uint32_t taken = std::min(count, CHUNK_SIZE - static_cast<uint32_t>(m_tail.size()));
+        m_tail.insert(m_tail.end(), hashes, hashes + taken);
+        hashes += taken;
+        count -= taken;
+
+        if (m_tail.size() == CHUNK_SIZE) {
+            seal();
+        }
+    }
+}
+
+void BlockHashHistory::truncate(uint32_t height)
+{
+    assert(height <= size());
+    assert(height >= prunedHeight() || height % CHUNK_SIZE == 0);
+
+    if (height < prunedHeight()) {
+        m_checkpoints.resize(height / CHUNK_SIZE);
+        m_chunks.clear();
+        m_tail.clear();
+        return;
+    }
+
+    uint32_t offset = height - prunedHeight();
+    uint32_t chunk = offset / CHUNK_SIZE;
+    if (chunk < m_chunks.size()) {
+        // the cut chunk is shared, continue from a copy of what stays
+        const Chunk &cut = *m_chunks[chunk];
+        m_tail.assign(cut.begin(), cut.begin() + offset % CHUNK_SIZE);
+        m_chunks.resize(chunk);
+    } else {
+        m_tail.resize(offset - static_cast<uint32_t>(m_chunks.size()) * CHUNK_SIZE);
+    }
+}
+
+void BlockHashHistory::clear()
+{
+    m_checkpoints.clear();
+    m_chunks.clear();
+    m_tail.clear();
+}
+
+void BlockHashHistory::setWindow(uint32_t window)
+{
+    m_window = window;
+    prune();
+}
+
+std::vector<Crypto::Hash> BlockHashHistory::getHashes() const
+{
+    std::vector<Crypto::Hash> hashes;
+    hashes.reserve(size());
+
+    for (const Crypto::Hash &checkpoint : m_checkpoints) {
+        hashes.push_back(checkpoint);
+        hashes.resize(hashes.size() + CHUNK_SIZE - 1, NULL_HASH);
+    }
+
+    for (const auto &chunk : m_chunks) {
+        hashes.insert(hashes.end(), chunk->begin(), chunk->end());
+    }
+
+    hashes.insert(hashes.end(), m_tail.begin(), m_tail.end());
+
+    return hashes;
+}
+
+void BlockHashHistory::getHashes(std::vector<Crypto::Hash> &checkpoints,
+                                 std::vector<Crypto::Hash> &hashes) const
+{
+    checkpoints = m_checkpoints;
+
+    hashes.clear();
+    hashes.reserve(size() - prunedHeight());
+    for (const auto &chunk : m_chunks) {
+        hashes.insert(hashes.end(), chunk->begin(), chunk->end());
+    }
+
+    hashes.insert(hashes.end(), m_tail.begin(), m_tail.end());
+}
+
+void BlockHashHistory::assign(std::vector<Crypto::Hash> &&checkpoints,
+                              const std::vector<Crypto::Hash> &hashes)
+{
+    clear();
+    m_checkpoints = std::move(checkpoints);
+    append(hashes.data(), static_cast<uint32_t>(hashes.size()));
+}
+
+void BlockHashHistory::seal()
+{
+    assert(m_tail.size() == CHUNK_SIZE);
+
+    if (m_pool) {
+        m_chunks.push_back(m_pool->intern(std::move(m_tail)));
+    } else {
+        m_chunks.push_back(std::make_shared<const Chunk>(std::move(m_tail)));
+    }
+
+    m_tail.clear();
+    prune();
+}
+
+void BlockHashHistory::prune()
+{
+    if (m_window == 0) {
+        return;
+    }
+
+    // a chunk goes once all of it is below the window
+    while (!m_chunks.empty() && prunedHeight() + CHUNK_SIZE + m_window <= size()) {
+        m_checkpoints.push_back(m_chunks.front()->front());
+        m_chunks.pop_front();
+    }
+}
+
+} // namespace CryptoNote
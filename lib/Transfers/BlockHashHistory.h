@@ -0,0 +1,102 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <crypto/hash.h>
+
+namespace CryptoNote {
+
+/*!
+    Block hashes from the genesis block up, stored in chunks of CHUNK_SIZE hashes.
+
+    Full chunks are immutable and can be shared: histories created with the same Pool get
+    the same chunk for the same blocks, so consumers synchronized to the same height keep
+    one copy of their common part. With a window, only the last window hashes (rounded up
+    to whole chunks) are kept in full, older chunks are reduced to the hash of their first
+    block, which is enough for a sparse chain sent to the node.
+*/
+class BlockHashHistory
+{
+public:
+    static const uint32_t CHUNK_SIZE = 1024;
+
+    typedef std::vector<Crypto::Hash> Chunk;
+
+    class Pool
+    {
+    public:
+        Pool();
+        Pool(const Pool &) = delete;
+        Pool &operator=(const Pool &) = delete;
+
+        // returns the chunk already shared for the same blocks if there is one
+        std::shared_ptr<const Chunk> intern(Chunk &&chunk);
+        // chunks still referenced by some history
+        size_t size();
+
+    private:
+        void sweep();
+
+        std::mutex m_mutex;
+        // a block hash commits to all blocks below it, the last one identifies a chunk
+        std::unordered_map<Crypto::Hash, std::weak_ptr<const Chunk>> m_chunks;
+        size_t m_sweepSize;
+    };
+
+    // window 0 keeps every hash
+    explicit BlockHashHistory(std::shared_ptr<Pool> pool = nullptr, uint32_t window = 0);
+
+    uint32_t size() const;
+    // heights below have their hash known only at chunk starts
+    uint32_t prunedHeight() const;
+    bool isKnown(uint32_t height) const;
+    // pre: isKnown(height)
+    const Crypto::Hash &operator[](uint32_t height) const;
+
+    void append(const Crypto::Hash *hashes, uint32_t count);
+    // pre: height <= size(), height >= prunedHeight() or height is a chunk start
+    void truncate(uint32_t height);
+    void clear();
+    void setWindow(uint32_t window);
+
+    // pruned heights are NULL_HASH
+    std::vector<Crypto::Hash> getHashes() const;
+    // first hashes of the pruned chunks and every hash from prunedHeight() up
+    void getHashes(std::vector<Crypto::Hash> &checkpoints, std::vector<Crypto::Hash> &hashes) const;
+    // inverse of getHashes(checkpoints, hashes)
+    void assign(std::vector<Crypto::Hash> &&checkpoints, const std::vector<Crypto::Hash> &hashes);
+
+private:
+    void seal();
+    void prune();
+
+    std::shared_ptr<Pool> m_pool;
+    uint32_t m_window;
+    std::vector<Crypto::Hash> m_checkpoints;
+    std::deque<std::shared_ptr<const Chunk>> m_chunks;
+    Chunk m_tail;
+};
+
+} // namespace CryptoNote
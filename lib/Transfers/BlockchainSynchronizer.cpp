@@ -16,8 +16,10 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <chrono>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <unordered_set>
 #include <Common/StreamTools.h>
@@ -92,6 +94,8 @@ BlockchainSynchronizer::BlockchainSynchronizer(
     : m_logger(logger, "BlockchainSynchronizer"),
       m_node(node),
       m_genesisBlockHash(genesisBlockHash),
+      m_historyPool(std::make_shared<BlockHashHistory::Pool>()),
+      m_historyWindow(0),
       m_currentState(State::stopped),
       m_futureState(State::stopped)
 {
@@ -115,7 +119,7 @@ void BlockchainSynchronizer::addConsumer(IBlockchainConsumer *consumer)
 
     m_consumers.insert(std::make_pair(
         consumer,
-        std::make_shared<SynchronizationState>(m_genesisBlockHash)
+        std::make_shared<SynchronizationState>(m_genesisBlockHash, m_historyPool, m_historyWindow)
     ));
 
     m_logger(INFO, BRIGHT_WHITE)
@@ -445,9 +449,20 @@ void BlockchainSynchronizer::stop()
     }
 
     workingThread.reset();
+    m_prefetch.reset();
     m_logger(INFO, BRIGHT_WHITE) << "Stopped";
 }
 
+void BlockchainSynchronizer::setHistoryWindow(uint32_t window)
+{
+    std::unique_lock<std::mutex> lk(m_consumersMutex);
+
+    m_historyWindow = window;
+    for (auto &kv : m_consumers) {
+        kv.second->setHistoryWindow(window);
+    }
+}
+
 void BlockchainSynchronizer::localBlockchainUpdated(uint32_t height)
 {
     m_logger(DEBUGGING) << "Event: localBlockchainUpdated " << height;
@@ -498,6 +513,16 @@ void BlockchainSynchronizer::getPoolUnionAndIntersection(
 }
 
 BlockchainSynchronizer::GetBlocksRequest BlockchainSynchronizer::getCommonHistory()
+{
+    // nothing pending, the history is what the consumers already have
+    BlockchainInterval pending;
+    pending.startHeight = std::numeric_limits<uint32_t>::max();
+
+    return getCommonHistory(pending);
+}
+
+BlockchainSynchronizer::GetBlocksRequest BlockchainSynchronizer::getCommonHistory(
+    const BlockchainInterval &pending)
 {
     GetBlocksRequest request;
     std::unique_lock<std::mutex> lk(m_consumersMutex);
@@ -521,7 +546,8 @@ BlockchainSynchronizer::GetBlocksRequest BlockchainSynchronizer::getCommonHistor
 
     m_logger(DEBUGGING) << "Shortest chain size " << shortest->second->getHeight();
 
-    request.knownBlocks = shortest->second->getShortHistory(m_node.getLastLocalBlockHeight());
+    request.knownBlocks = shortest->second->getShortHistory(m_node.getLastLocalBlockHeight(),
+                                                            pending);
     request.syncStart = syncStart;
 
     m_logger(DEBUGGING)
@@ -537,26 +563,25 @@ void BlockchainSynchronizer::startBlockchainSync()
 {
     m_logger(DEBUGGING) << "Starting blockchain synchronization...";
 
-    GetBlocksResponse response;
     GetBlocksRequest req = getCommonHistory();
+    std::shared_ptr<BlocksQuery> query = std::move(m_prefetch);
 
     try {
         if (!req.knownBlocks.empty()) {
-            auto queryBlocksCompleted = std::promise<std::error_code>();
-            auto queryBlocksWaitFuture = queryBlocksCompleted.get_future();
-
-            m_node.queryBlocks(
-                std::move(req.knownBlocks),
-                req.syncStart.timestamp,
-                response.newBlocks,
-                response.startHeight,
-                [&queryBlocksCompleted](std::error_code ec) {
-                    auto detachedPromise = std::move(queryBlocksCompleted);
-                    detachedPromise.set_value(ec);
-                }
-            );
+            // the prefetched batch is only usable if the consumers ended up where it expected
+            if (query
+                && (query->request.knownBlocks != req.knownBlocks
+                    || query->request.syncStart.timestamp != req.syncStart.timestamp)) {
+                m_logger(DEBUGGING) << "Prefetched blocks are outdated, querying again";
+                query.reset();
+            }
 
-            std::error_code ec = queryBlocksWaitFuture.get();
+            if (!query) {
+                query = queryBlocks(req);
+            }
+
+            std::error_code ec = query->completed.get();
+            GetBlocksResponse &response = query->response;
 
             if (ec) {
                 m_logger(ERROR, BRIGHT_RED)
@@ -585,6 +610,54 @@ void BlockchainSynchronizer::startBlockchainSync()
     }
 }
 
+std::shared_ptr<BlockchainSynchronizer::BlocksQuery> BlockchainSynchronizer::queryBlocks(
+    const GetBlocksRequest &request)
+{
+    auto query = std::make_shared<BlocksQuery>();
+    query->request = request;
+    query->response.startHeight = 0;
+
+    auto completed = std::make_shared<std::promise<std::error_code>>();
+    query->completed = completed->get_future();
+
+    std::vector<Crypto::Hash> knownBlocks = request.knownBlocks;
+    m_node.queryBlocks(
+        std::move(knownBlocks),
+        request.syncStart.timestamp,
+        query->response.newBlocks,
+        query->response.startHeight,
+        [query, completed](std::error_code ec) {
+            completed->set_value(ec);
+        }
+    );
+
+    return query;
+}
+
+/// Requests the batch following interval, so the node works on it while interval is scanned.
+/// At most one batch is prefetched; it is checked against the real history before use.
+void BlockchainSynchronizer::prefetchBlocks(const BlockchainInterval &interval)
+{
+    assert(!m_prefetch);
+
+    uint32_t nextHeight = interval.startHeight + static_cast<uint32_t>(interval.blocks.size());
+    if (interval.blocks.empty() || nextHeight > m_node.getLastLocalBlockHeight()) {
+        return;
+    }
+
+    GetBlocksRequest request = getCommonHistory(interval);
+    if (request.knownBlocks.empty()) {
+        return;
+    }
+
+    try {
+        m_prefetch = queryBlocks(request);
+        m_logger(DEBUGGING) << "Prefetching blocks from index " << nextHeight;
+    } catch (const std::exception &e) {
+        m_logger(WARNING, BRIGHT_YELLOW) << "Failed to prefetch blocks: " << e.what();
+    }
+}
+
 void BlockchainSynchronizer::processBlocks(GetBlocksResponse &response)
 {
     m_logger(DEBUGGING)
@@ -634,10 +707,19 @@ void BlockchainSynchronizer::processBlocks(GetBlocksResponse &response)
                                    + static_cast<uint32_t>(response.newBlocks.size());
     if (!checkIfShouldStop()) {
         response.newBlocks.clear();
+        prefetchBlocks(interval);
+
         std::unique_lock<std::mutex> lk(m_consumersMutex);
+        auto scanStart = std::chrono::steady_clock::now();
         auto result = updateConsumers(interval, blocks);
+        std::chrono::duration<double> scanTime = std::chrono::steady_clock::now() - scanStart;
         lk.unlock();
 
+        if (result == UpdateConsumersResult::addedNewBlocks && scanTime.count() > 0) {
+            m_observerManager.notify(&IBlockchainSynchronizerObserver::scanningThroughputUpdated,
+                                     static_cast<double>(blocks.size()) / scanTime.count());
+        }
+
         switch (result) {
         case UpdateConsumersResult::errorOccurred:
             if (setFutureStateIf(State::idle, [this] { return m_futureState != State::stopped; })) {
@@ -54,6 +54,14 @@ class BlockchainSynchronizer : public IObservableImpl<
         std::vector<Crypto::Hash> knownBlocks;
     };
 
+    // a queryBlocks call, kept alive by its callback if the synchronizer abandons it
+    struct BlocksQuery
+    {
+        GetBlocksRequest request;
+        GetBlocksResponse response;
+        std::future<std::error_code> completed;
+    };
+
     struct GetPoolResponse
     {
         bool isLastKnownBlockActual;
@@ -105,6 +113,11 @@ public:
     void start() override;
     void stop() override;
 
+    // Keeps only the last window block hashes of each consumer in full, older ones are
+    // reduced to sparse checkpoints. 0, the default, keeps every hash, which
+    // getConsumerKnownBlocks() callers that need all of them rely on.
+    void setHistoryWindow(uint32_t window);
+
     // IStreamSerializable
     void save(std::ostream &os) override;
     void load(std::istream &in) override;
@@ -119,6 +132,8 @@ private:
     void startPoolSync();
     void startBlockchainSync();
 
+    std::shared_ptr<BlocksQuery> queryBlocks(const GetBlocksRequest &request);
+    void prefetchBlocks(const BlockchainInterval &interval);
     void processBlocks(GetBlocksResponse &response);
     UpdateConsumersResult updateConsumers(const BlockchainInterval &interval,
                                           const std::vector<CompleteBlock> &blocks);
@@ -140,6 +155,7 @@ private:
     void workingProcedure();
 
     GetBlocksRequest getCommonHistory();
+    GetBlocksRequest getCommonHistory(const BlockchainInterval &pending);
     void getPoolUnionAndIntersection(std::unordered_set<Crypto::Hash> &poolUnion,
                                      std::unordered_set<Crypto::Hash> &poolIntersection) const;
     SynchronizationState *getConsumerSynchronizationState(IBlockchainConsumer *consumer) const;
@@ -149,6 +165,9 @@ private:
     ConsumersMap m_consumers;
     INode &m_node;
     const Crypto::Hash m_genesisBlockHash;
+    // shares the block hashes consumers have in common
+    std::shared_ptr<BlockHashHistory::Pool> m_historyPool;
+    uint32_t m_historyWindow;
 
     Crypto::Hash lastBlockId;
 
@@ -157,6 +176,8 @@ private:
     std::unique_ptr<std::thread> workingThread;
     std::list<std::pair<const ITransactionReader *, std::promise<std::error_code>>> m_addTransactionTasks;
     std::list<std::pair<const Crypto::Hash *, std::promise<void>>> m_removeTransactionTasks;
+    // next batch, requested while the current one is being processed; working thread only
+    std::shared_ptr<BlocksQuery> m_prefetch;
 
     mutable std::mutex m_consumersMutex;
     mutable std::mutex m_stateMutex;
@@ -43,6 +43,11 @@ public:
     virtual void synchronizationCompleted(std::error_code result)
     {
     }
+
+    // blocks per second the consumers got through in the last batch they scanned
+    virtual void scanningThroughputUpdated(double blocksPerSecond)
+    {
+    }
 };
 
 class IBlockchainConsumerObserver;
@@ -0,0 +1,328 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <CryptoNoteCore/TransactionExtra.h>
+#include <Global/Constants.h>
+#include <Transfers/ScanningEngine.h>
+#include <Transfers/ScanningPool.h>
+
+using namespace Crypto;
+using namespace Qwertycoin;
+
+namespace CryptoNote {
+
+namespace {
+
+struct OutputKey
+{
+    PublicKey key;
+    size_t keyIndex;
+    uint32_t outputIndex;
+    bool tagged; // a view tag can be checked, key outputs only
+};
+
+// same keys and indices findMyOutputs() in TransfersConsumer checks
+void getOutputKeys(const ITransactionReader &tx, std::vector<OutputKey> &keys)
+{
+    size_t keyIndex = 0;
+    size_t outputCount = tx.getOutputCount();
+
+    for (size_t idx = 0; idx < outputCount; ++idx) {
+        auto outType = tx.getOutputType(idx);
+
+        if (outType == TransactionTypes::OutputType::Key) {
+            uint64_t amount;
+            KeyOutput out;
+            tx.getOutput(idx, out, amount);
+
+            keys.push_back({ out.key, keyIndex, static_cast<uint32_t>(idx), true });
+            ++keyIndex;
+        } else if (outType == TransactionTypes::OutputType::Multisignature) {
+            uint64_t amount;
+            MultiSignatureOutput out;
+            tx.getOutput(idx, out, amount);
+
+            for (const auto &key : out.keys) {
+                keys.push_back({ key, idx, static_cast<uint32_t>(idx), false });
+                ++keyIndex;
+            }
+        }
+    }
+}
+
+} // namespace
+
+void getViewTags(const ITransactionReader &tx, std::vector<uint8_t> &tags)
+{
+    TransactionExtraViewTags viewTags;
+    if (getViewTagsFromExtra(tx.getExtra(), viewTags) && viewTags.tags.size() == tx.getOutputCount()) {
+        tags.swap(viewTags.tags);
+    } else {
+        tags.clear();
+    }
+}
+
+void ScanningEngine::setViewTagFilter(bool enable)
+{
+    m_viewTagFilter = enable;
+}
+
+void ScanningEngine::addConsumer(IBlockchainConsumer *consumer,
+                                 const SecretKey &viewSecret,
+                                 const std::unordered_set<PublicKey> &spendKeys)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+
+    Account &account = m_accounts[consumer];
+    account.viewSecret = viewSecret;
+    account.spendKeys = &spendKeys;
+    account.heightKnown = false;
+    account.nextHeight = 0;
+}
+
+void ScanningEngine::removeConsumer(IBlockchainConsumer *consumer)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+
+    m_accounts.erase(consumer);
+    forgetScanned(consumer);
+}
+
+void ScanningEngine::onSubscriptionsChanged(IBlockchainConsumer *consumer)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    forgetScanned(consumer);
+}
+
+void ScanningEngine::onBlockchainDetach(IBlockchainConsumer *consumer, uint32_t height)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+
+    auto it = m_accounts.find(consumer);
+    if (it != m_accounts.end()) {
+        it->second.heightKnown = true;
+        it->second.nextHeight = height;
+    }
+}
+
+ScanningEngine::BatchOutputs ScanningEngine::scan(IBlockchainConsumer *consumer,
+                                                  const CompleteBlock *blocks,
+                                                  uint32_t startHeight,
+                                                  uint32_t count)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+
+    auto it = m_accounts.find(consumer);
+    assert(it != m_accounts.end());
+
+    if (!isScanned(consumer, blocks, startHeight, count)) {
+        // everyone who is going to be handed these blocks next
+        std::vector<Scanner> scanners;
+        for (const auto &kv : m_accounts) {
+            const Account &account = kv.second;
+            if (kv.first == consumer
+                || !account.heightKnown
+                || (account.nextHeight >= startHeight && account.nextHeight - startHeight < count)) {
+                scanners.push_back({ kv.first, &account, kv.first->getSyncStart().timestamp });
+            }
+        }
+
+        scanBlocks(scanners, blocks, startHeight, count);
+    }
+
+    it->second.heightKnown = true;
+    it->second.nextHeight = startHeight + count;
+
+    BatchOutputs result;
+    for (uint32_t i = 0; i < count; ++i) {
+        auto block = m_blocks.find(startHeight + i);
+        assert(block != m_blocks.end());
+        const auto &scannedTransactions = block->second.transactions;
+
+        size_t position = 0;
+        for (const auto &tx : blocks[i].transactions) {
+            if (position == scannedTransactions.size()) {
+                break;
+            }
+
+            for (const Hit &hit : scannedTransactions[position]) {
+                if (hit.consumer == consumer) {
+                    result[tx.get()] = hit.outputs;
+                }
+            }
+            ++position;
+        }
+    }
+
+    return result;
+}
+
+void ScanningEngine::forgetScanned(IBlockchainConsumer *consumer)
+{
+    if (m_scannedConsumers.erase(consumer) == 0) {
+        return;
+    }
+
+    for (auto &block : m_blocks) {
+        for (auto &hits : block.second.transactions) {
+            hits.erase(std::remove_if(hits.begin(), hits.end(), [consumer](const Hit &hit) {
+                return hit.consumer == consumer;
+            }), hits.end());
+        }
+    }
+}
+
+bool ScanningEngine::isScanned(IBlockchainConsumer *consumer,
+                               const CompleteBlock *blocks,
+                               uint32_t startHeight,
+                               uint32_t count) const
+{
+    if (m_scannedConsumers.count(consumer) == 0) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        auto block = m_blocks.find(startHeight + i);
+        if (block == m_blocks.end() || block->second.hash != blocks[i].blockHash) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void ScanningEngine::scanBlocks(const std::vector<Scanner> &scanners,
+                                const CompleteBlock *blocks,
+                                uint32_t startHeight,
+                                uint32_t count)
+{
+    struct Tx
+    {
+        const ITransactionReader *tx;
+        uint64_t timestamp;
+        std::vector<Hit> *hits;
+    };
+
+    m_blocks.clear();
+    m_scannedConsumers.clear();
+
+    std::vector<Tx> transactions;
+    for (uint32_t i = 0; i < count; ++i) {
+        ScannedBlock &block = m_blocks[startHeight + i];
+        block.hash = blocks[i].blockHash;
+        block.transactions.resize(blocks[i].transactions.size());
+
+        if (!blocks[i].block.is_initialized()) {
+            continue;
+        }
+
+        size_t position = 0;
+        for (const auto &tx : blocks[i].transactions) {
+            if (tx->getTransactionPublicKey() != NULL_PUBLIC_KEY) {
+                transactions.push_back({ tx.get(), blocks[i].block->timestamp, &block.transactions[position] });
+            }
+            ++position;
+        }
+    }
+
+    bool viewTagFilter = m_viewTagFilter;
+    ScanningPool::instance().run(transactions.size(), [&](size_t index) {
+        const Tx &item = transactions[index];
+        std::vector<OutputKey> keys;
+        getOutputKeys(*item.tx, keys);
+
+        std::vector<const Scanner *> active;
+        std::vector<SecretKey> viewSecrets;
+        for (const Scanner &scanner : scanners) {
+            // filter by syncStartTimestamp, as the consumer does
+            if (scanner.syncStartTimestamp && item.timestamp < scanner.syncStartTimestamp) {
+                continue;
+            }
+
+            active.push_back(&scanner);
+            viewSecrets.push_back(scanner.account->viewSecret);
+        }
+
+        if (active.empty() || keys.empty()) {
+            return;
+        }
+
+        std::vector<uint8_t> tags;
+        if (viewTagFilter) {
+            getViewTags(*item.tx, tags);
+        }
+
+        // all accounts and outputs of the transaction go through the batched calls together
+        std::vector<PublicKey> txPublicKeys(active.size(), item.tx->getTransactionPublicKey());
+        std::vector<KeyDerivation> derivations(active.size());
+        std::unique_ptr<bool[]> derived(new bool[active.size()]);
+        generateKeyDerivations(active.size(), txPublicKeys.data(), viewSecrets.data(),
+                               derivations.data(), derived.get());
+
+        std::vector<KeyDerivation> outputDerivations;
+        std::vector<size_t> keyIndexes;
+        std::vector<PublicKey> outputKeys;
+        std::vector<size_t> owners;
+        std::vector<uint32_t> outputIndexes;
+        for (size_t i = 0; i < active.size(); ++i) {
+            if (!derived[i]) {
+                continue;
+            }
+
+            for (const OutputKey &key : keys) {
+                if (!tags.empty() && key.tagged
+                    && deriveViewTag(derivations[i], key.keyIndex) != tags[key.outputIndex]) {
+                    continue;
+                }
+
+                outputDerivations.push_back(derivations[i]);
+                keyIndexes.push_back(key.keyIndex);
+                outputKeys.push_back(key.key);
+                owners.push_back(i);
+                outputIndexes.push_back(key.outputIndex);
+            }
+        }
+
+        std::vector<PublicKey> spendKeys(outputKeys.size());
+        std::unique_ptr<bool[]> underived(new bool[outputKeys.size()]);
+        underivePublicKeys(outputKeys.size(), outputDerivations.data(), keyIndexes.data(),
+                           outputKeys.data(), spendKeys.data(), underived.get());
+
+        std::vector<Outputs> outputs(active.size());
+        for (size_t i = 0; i < spendKeys.size(); ++i) {
+            const Scanner &scanner = *active[owners[i]];
+            if (underived[i] && scanner.account->spendKeys->count(spendKeys[i]) != 0) {
+                outputs[owners[i]][spendKeys[i]].push_back(outputIndexes[i]);
+            }
+        }
+
+        for (size_t i = 0; i < active.size(); ++i) {
+            if (!outputs[i].empty()) {
+                item.hits->push_back({ active[i]->consumer, std::move(outputs[i]) });
+            }
+        }
+    });
+
+    for (const Scanner &scanner : scanners) {
+        m_scannedConsumers.insert(scanner.consumer);
+    }
+}
+
+} // namespace CryptoNote
@@ -0,0 +1,115 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <crypto/Crypto.h>
+#include <Transfers/CommonTypes.h>
+#include <Transfers/IBlockchainSynchronizer.h>
+
+namespace CryptoNote {
+
+/*!
+    Finds the outputs of many view keys in one walk over the blocks.
+
+    Every consumer of a TransfersSynchronizer registers its view key here. When a consumer
+    gets a batch of blocks, the batch is scanned for all registered consumers that are at
+    the same height, so the consumers called next with the same blocks only pick up their
+    results. Consumers at other heights are left out to not scan blocks they never get.
+*/
+// The view tags of tx, one per output, or nothing if tx does not carry a tag for every output.
+void getViewTags(const ITransactionReader &tx, std::vector<uint8_t> &tags);
+
+class ScanningEngine
+{
+public:
+    // output indices of a transaction, by the spend key they belong to
+    typedef std::unordered_map<Crypto::PublicKey, std::vector<uint32_t>> Outputs;
+    typedef std::unordered_map<const ITransactionReader *, Outputs> BatchOutputs;
+
+    // spendKeys must stay valid and unchanged while the consumer is being synchronized
+    void addConsumer(IBlockchainConsumer *consumer,
+                     const Crypto::SecretKey &viewSecret,
+                     const std::unordered_set<Crypto::PublicKey> &spendKeys);
+    void removeConsumer(IBlockchainConsumer *consumer);
+    // the spend keys or the sync start of consumer changed, what was scanned for it is stale
+    void onSubscriptionsChanged(IBlockchainConsumer *consumer);
+    void onBlockchainDetach(IBlockchainConsumer *consumer, uint32_t height);
+
+    // Skip the outputs whose view tag does not match before underiving their keys. Only
+    // transactions that carry a tag for every output are filtered, the others are scanned fully.
+    void setViewTagFilter(bool enable);
+
+    // Outputs of consumer in the transactions of blocks; only transactions with outputs are listed.
+    BatchOutputs scan(IBlockchainConsumer *consumer,
+                      const CompleteBlock *blocks,
+                      uint32_t startHeight,
+                      uint32_t count);
+
+private:
+    struct Account
+    {
+        Crypto::SecretKey viewSecret;
+        const std::unordered_set<Crypto::PublicKey> *spendKeys;
+        bool heightKnown;
+        uint32_t nextHeight;
+    };
+
+    struct Hit
+    {
+        IBlockchainConsumer *consumer;
+        Outputs outputs;
+    };
+
+    struct ScannedBlock
+    {
+        Crypto::Hash hash;
+        // by transaction position in the block
+        std::vector<std::vector<Hit>> transactions;
+    };
+
+    struct Scanner
+    {
+        IBlockchainConsumer *consumer;
+        const Account *account;
+        uint64_t syncStartTimestamp;
+    };
+
+    void forgetScanned(IBlockchainConsumer *consumer);
+    bool isScanned(IBlockchainConsumer *consumer,
+                   const CompleteBlock *blocks,
+                   uint32_t startHeight,
+                   uint32_t count) const;
+    void scanBlocks(const std::vector<Scanner> &scanners,
+                    const CompleteBlock *blocks,
+                    uint32_t startHeight,
+                    uint32_t count);
+
+    std::mutex m_mutex;
+    std::atomic<bool> m_viewTagFilter{ false };
+    std::unordered_map<IBlockchainConsumer *, Account> m_accounts;
+    // the last scanned batch by block height
+    std::unordered_map<uint32_t, ScannedBlock> m_blocks;
+    std::unordered_set<IBlockchainConsumer *> m_scannedConsumers;
+};
+
+} // namespace CryptoNote
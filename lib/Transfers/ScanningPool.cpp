@@ -0,0 +1,213 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <Transfers/ScanningPool.h>
+
+namespace CryptoNote {
+
+namespace {
+
+uint64_t packRange(uint64_t begin, uint64_t end)
+{
+    return begin << 32 | end;
+}
+
+uint64_t rangeBegin(uint64_t bounds)
+{
+    return bounds >> 32;
+}
+
+uint64_t rangeEnd(uint64_t bounds)
+{
+    return bounds & std::numeric_limits<uint32_t>::max();
+}
+
+size_t defaultThreadCount()
+{
+    return std::max(2u, std::thread::hardware_concurrency()) - 1;
+}
+
+} // namespace
+
+ScanningPool &ScanningPool::instance()
+{
+    static ScanningPool pool(defaultThreadCount());
+
+    return pool;
+}
+
+ScanningPool &ScanningPool::signingInstance()
+{
+    static ScanningPool pool(defaultThreadCount());
+
+    return pool;
+}
+
+ScanningPool::ScanningPool(size_t threadCount)
+    : m_ranges(new Range[threadCount + 1]),
+      m_task(nullptr),
+      m_jobId(0),
+      m_busyThreads(0),
+      m_stopping(false)
+{
+    for (size_t slot = 0; slot <= threadCount; ++slot) {
+        m_ranges[slot].bounds = 0;
+    }
+
+    for (size_t slot = 1; slot <= threadCount; ++slot) {
+        m_threads.emplace_back(&ScanningPool::workerProcedure, this, slot);
+    }
+}
+
+ScanningPool::~ScanningPool()
+{
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_stopping = true;
+    }
+
+    m_hasJob.notify_all();
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+}
+
+size_t ScanningPool::concurrency() const
+{
+    return m_threads.size() + 1;
+}
+
+void ScanningPool::run(size_t count, const std::function<void(size_t)> &task)
+{
+    if (m_threads.empty() || count < 2) {
+        for (size_t index = 0; index < count; ++index) {
+            task(index);
+        }
+
+        return;
+    }
+
+    assert(count <= std::numeric_limits<uint32_t>::max());
+
+    std::lock_guard<std::mutex> runLock(m_runMutex);
+
+    size_t slots = concurrency();
+    for (size_t slot = 0; slot < slots; ++slot) {
+        m_ranges[slot].bounds = packRange(count * slot / slots, count * (slot + 1) / slots);
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_task = &task;
+        m_error = nullptr;
+        m_busyThreads = m_threads.size();
+        ++m_jobId;
+    }
+
+    m_hasJob.notify_all();
+    work(0);
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        m_jobDone.wait(lk, [this] { return m_busyThreads == 0; });
+        m_task = nullptr;
+        error = m_error;
+        m_error = nullptr;
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void ScanningPool::workerProcedure(size_t slot)
+{
+    uint64_t lastJobId = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(m_mutex);
+            m_hasJob.wait(lk, [&] { return m_stopping || m_jobId != lastJobId; });
+            if (m_stopping) {
+                return;
+            }
+
+            lastJobId = m_jobId;
+        }
+
+        work(slot);
+
+        std::lock_guard<std::mutex> lk(m_mutex);
+        if (--m_busyThreads == 0) {
+            m_jobDone.notify_one();
+        }
+    }
+}
+
+void ScanningPool::work(size_t slot)
+{
+    size_t index;
+    while (takeFront(slot, index) || takeBack(slot, index)) {
+        try {
+            (*m_task)(index);
+        } catch (...) {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            if (!m_error) {
+                m_error = std::current_exception();
+            }
+        }
+    }
+}
+
+bool ScanningPool::takeFront(size_t slot, size_t &index)
+{
+    auto &bounds = m_ranges[slot].bounds;
+    uint64_t current = bounds.load();
+    while (rangeBegin(current) < rangeEnd(current)) {
+        if (bounds.compare_exchange_weak(current,
+                                         packRange(rangeBegin(current) + 1, rangeEnd(current)))) {
+            index = static_cast<size_t>(rangeBegin(current));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ScanningPool::takeBack(size_t slot, size_t &index)
+{
+    size_t slots = concurrency();
+    for (size_t offset = 1; offset < slots; ++offset) {
+        auto &bounds = m_ranges[(slot + offset) % slots].bounds;
+        uint64_t current = bounds.load();
+        while (rangeBegin(current) < rangeEnd(current)) {
+            if (bounds.compare_exchange_weak(current,
+                                             packRange(rangeBegin(current), rangeEnd(current) - 1))) {
+                index = static_cast<size_t>(rangeEnd(current) - 1);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+} // namespace CryptoNote
@@ -0,0 +1,88 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CryptoNote {
+
+/*!
+    Long-lived threads that scan blocks for all consumers.
+
+    run() splits the indices of a job into one contiguous range per thread, the calling
+    thread included. A thread that finishes its range takes indices from the back of
+    another one, so uneven transactions do not leave threads idle. Jobs from different
+    callers run one after another.
+*/
+class ScanningPool
+{
+public:
+    static ScanningPool &instance();
+    // Threads of its own for signing transactions. A scan job may hold instance() while it
+    // waits for the node, signing must not queue behind it.
+    static ScanningPool &signingInstance();
+
+    explicit ScanningPool(size_t threadCount);
+    ScanningPool(const ScanningPool &) = delete;
+    ScanningPool &operator=(const ScanningPool &) = delete;
+    ~ScanningPool();
+
+    // threads a job is spread over, the calling one included
+    size_t concurrency() const;
+
+    // Calls task once for every index below count and returns when all calls have returned.
+    // The first exception thrown by task is rethrown once the others are done.
+    // task must not call run() itself.
+    void run(size_t count, const std::function<void(size_t)> &task);
+
+private:
+    struct Range
+    {
+        // begin in the high half, end in the low half
+        std::atomic<uint64_t> bounds;
+        char padding[64 - sizeof(std::atomic<uint64_t>)];
+    };
+
+    void workerProcedure(size_t slot);
+    void work(size_t slot);
+    bool takeFront(size_t slot, size_t &index);
+    bool takeBack(size_t slot, size_t &index);
+
+    std::vector<std::thread> m_threads;
+    std::unique_ptr<Range[]> m_ranges;
+
+    std::mutex m_runMutex;
+    std::mutex m_mutex;
+    std::condition_variable m_hasJob;
+    std::condition_variable m_jobDone;
+    const std::function<void(size_t)> *m_task;
+    uint64_t m_jobId;
+    size_t m_busyThreads;
+    bool m_stopping;
+    std::exception_ptr m_error;
+};
+
+} // namespace CryptoNote
@@ -28,24 +28,48 @@ using namespace Common;
 namespace CryptoNote {
 
 SynchronizationState::ShortHistory SynchronizationState::getShortHistory(uint32_t localHeight) const
+{
+    BlockchainInterval pending;
+    pending.startHeight = m_blockchain.size();
+
+    return getShortHistory(localHeight, pending);
+}
+
+SynchronizationState::ShortHistory SynchronizationState::getShortHistory(
+    uint32_t localHeight,
+    const BlockchainInterval &pending) const
 {
     ShortHistory history;
     uint32_t i = 0;
     uint32_t current_multiplier = 1;
-    uint32_t sz = std::min(static_cast<uint32_t>(m_blockchain.size()), localHeight + 1);
+    uint32_t pendingStart = std::min(m_blockchain.size(), pending.startHeight);
+    uint32_t size = pendingStart + static_cast<uint32_t>(pending.blocks.size());
+    uint32_t sz = std::min(size, localHeight + 1);
 
     if (!sz) {
         return history;
     }
 
+    // pruned heights fall back to the start of their chunk, each height is sent once
+    uint32_t lastHeight = sz;
+    auto pushBlock = [&](uint32_t height) {
+        if (height < pendingStart && !m_blockchain.isKnown(height)) {
+            height -= height % BlockHashHistory::CHUNK_SIZE;
+        }
+
+        if (height >= lastHeight) {
+            return;
+        }
+
+        lastHeight = height;
+        history.push_back(height < pendingStart ? m_blockchain[height]
+                                                : pending.blocks[height - pendingStart]);
+    };
+
     uint32_t current_back_offset = 1;
-    bool genesis_included = false;
 
     while (current_back_offset < sz) {
-        history.push_back(m_blockchain[sz - current_back_offset]);
-        if (sz - current_back_offset == 0) {
-            genesis_included = true;
-        }
+        pushBlock(sz - current_back_offset);
         if (i < 10) {
             ++current_back_offset;
         } else {
@@ -54,9 +78,7 @@ SynchronizationState::ShortHistory SynchronizationState::getShortHistory(uint32_
         ++i;
     }
 
-    if (!genesis_included) {
-        history.push_back(m_blockchain[0]);
-    }
+    pushBlock(0);
 
     return history;
 }
@@ -69,14 +91,29 @@ SynchronizationState::CheckResult SynchronizationState::checkInterval(
     CheckResult result = { false, 0, false, 0 };
 
     uint32_t intervalEnd = interval.startHeight + static_cast<uint32_t>(interval.blocks.size());
-    uint32_t iterationEnd = std::min(static_cast<uint32_t>(m_blockchain.size()), intervalEnd);
+    uint32_t iterationEnd = std::min(m_blockchain.size(), intervalEnd);
+    bool matched = false;
+    uint32_t lastMatch = 0;
 
     for (uint32_t i = interval.startHeight; i < iterationEnd; ++i) {
+        if (!m_blockchain.isKnown(i)) {
+            continue;
+        }
+
         if (m_blockchain[i] != interval.blocks[i - interval.startHeight]) {
             result.detachRequired = true;
             result.detachHeight = i;
+            // the chains split somewhere after the last known match; a pruned match can
+            // only be cut at, the interval starts at or below it so it is added back
+            if (matched) {
+                result.detachHeight = lastMatch < m_blockchain.prunedHeight() ? lastMatch
+                                                                               : lastMatch + 1;
+            }
             break;
         }
+
+        matched = true;
+        lastMatch = i;
     }
 
     if (result.detachRequired) {
@@ -87,7 +124,7 @@ SynchronizationState::CheckResult SynchronizationState::checkInterval(
 
     if (intervalEnd > m_blockchain.size()) {
         result.hasNewBlocks = true;
-        result.newBlockHeight = static_cast<uint32_t>(m_blockchain.size());
+        result.newBlockHeight = m_blockchain.size();
     }
 
     return result;
@@ -96,7 +133,7 @@ SynchronizationState::CheckResult SynchronizationState::checkInterval(
 void SynchronizationState::detach(uint32_t height)
 {
     assert(height < m_blockchain.size());
-    m_blockchain.resize(height);
+    m_blockchain.truncate(height);
 }
 
 void SynchronizationState::addBlocks(const Crypto::Hash *blockHashes,uint32_t height,uint32_t count)
@@ -104,17 +141,22 @@ void SynchronizationState::addBlocks(const Crypto::Hash *blockHashes,uint32_t he
     assert(blockHashes);
     auto size = m_blockchain.size();
     assert( size == height);
-    m_blockchain.insert(m_blockchain.end(), blockHashes, blockHashes + count);
+    m_blockchain.append(blockHashes, count);
 }
 
 uint32_t SynchronizationState::getHeight() const
 {
-    return static_cast<uint32_t>(m_blockchain.size());
+    return m_blockchain.size();
+}
+
+std::vector<Crypto::Hash> SynchronizationState::getKnownBlockHashes() const
+{
+    return m_blockchain.getHashes();
 }
 
-const std::vector<Crypto::Hash> &SynchronizationState::getKnownBlockHashes() const
+void SynchronizationState::setHistoryWindow(uint32_t window)
 {
-    return m_blockchain;
+    m_blockchain.setWindow(window);
 }
 
 void SynchronizationState::save(std::ostream &os)
@@ -135,7 +177,31 @@ CryptoNote::ISerializer &SynchronizationState::serialize(CryptoNote::ISerializer
                                                          const std::string &name)
 {
     s.beginObject(name);
-    s(m_blockchain, "blockchain");
+
+    // an unpruned history keeps the old layout; a pruned one leaves "blockchain" empty,
+    // which an old state never does, and follows it with the checkpoints and recent hashes
+    std::vector<Crypto::Hash> checkpoints;
+    std::vector<Crypto::Hash> hashes;
+    if (s.type() == ISerializer::OUTPUT) {
+        m_blockchain.getHashes(checkpoints, hashes);
+        if (checkpoints.empty()) {
+            s(hashes, "blockchain");
+        } else {
+            std::vector<Crypto::Hash> legacy;
+            s(legacy, "blockchain");
+            s(checkpoints, "checkpoints");
+            s(hashes, "hashes");
+        }
+    } else {
+        s(hashes, "blockchain");
+        if (hashes.empty()) {
+            s(checkpoints, "checkpoints");
+            s(hashes, "hashes");
+        }
+
+        m_blockchain.assign(std::move(checkpoints), hashes);
+    }
+
     s.endObject();
 
     return s;
@@ -19,8 +19,10 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <vector>
 #include <Serialization/ISerializer.h>
+#include <Transfers/BlockHashHistory.h>
 #include <Transfers/CommonTypes.h>
 #include <IStreamSerializable.h>
 
@@ -39,18 +41,26 @@ public:
 
     typedef std::vector<Crypto::Hash> ShortHistory;
 
-    explicit SynchronizationState(const Crypto::Hash &genesisBlockHash)
+    // window limits how many recent hashes are kept in full, 0 keeps all of them
+    explicit SynchronizationState(const Crypto::Hash &genesisBlockHash,
+                                  std::shared_ptr<BlockHashHistory::Pool> pool = nullptr,
+                                  uint32_t window = 0)
+        : m_blockchain(std::move(pool), window)
     {
-        m_blockchain.push_back(genesisBlockHash);
+        m_blockchain.append(&genesisBlockHash, 1);
     }
 
     ShortHistory getShortHistory(uint32_t localHeight) const;
+    // history as it will be once pending is added on top of the blocks below its start
+    ShortHistory getShortHistory(uint32_t localHeight, const BlockchainInterval &pending) const;
     CheckResult checkInterval(const BlockchainInterval &interval) const;
 
     void detach(uint32_t height);
     void addBlocks(const Crypto::Hash *blockHashes, uint32_t height, uint32_t count);
     uint32_t getHeight() const;
-    const std::vector<Crypto::Hash> &getKnownBlockHashes() const;
+    // hashes of pruned blocks are NULL_HASH
+    std::vector<Crypto::Hash> getKnownBlockHashes() const;
+    void setHistoryWindow(uint32_t window);
 
     // IStreamSerializable
     void save(std::ostream &os) override;
@@ -60,7 +70,7 @@ public:
     CryptoNote::ISerializer &serialize(CryptoNote::ISerializer &s, const std::string &name);
 
 private:
-    std::vector<Crypto::Hash> m_blockchain;
+    BlockHashHistory m_blockchain;
 };
 
 } // namespace CryptoNote
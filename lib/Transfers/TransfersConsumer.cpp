@@ -19,13 +19,14 @@
 // along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <future>
+#include <memory>
 #include <numeric>
-#include <Common/BlockingQueue.h>
 #include <Common/StringTools.h>
 #include <CryptoNoteCore/CryptoNoteFormatUtils.h>
 #include <CryptoNoteCore/TransactionApi.h>
 #include <Global/Constants.h>
 #include <Transfers/CommonTypes.h>
+#include <Transfers/ScanningPool.h>
 #include <Transfers/TransfersConsumer.h>
 #include <Wallet/IWallet.h>
 #include <INode.h>
@@ -43,26 +44,11 @@ namespace {
 
 using namespace CryptoNote;
 
-void checkOutputKey(
-    const KeyDerivation &derivation,
-    const PublicKey &key,
-    size_t keyIndex,
-    size_t outputIndex,
-    const std::unordered_set<PublicKey> &spendKeys,
-    std::unordered_map<PublicKey, std::vector<uint32_t>> &outputs)
-{
-    PublicKey spendKey;
-    underivePublicKey(derivation, keyIndex, key, spendKey);
-
-    if (spendKeys.find(spendKey) != spendKeys.end()) {
-        outputs[spendKey].push_back(static_cast<uint32_t>(outputIndex));
-    }
-}
-
 void findMyOutputs(
     const ITransactionReader &tx,
     const SecretKey &viewSecretKey,
     const std::unordered_set<PublicKey> &spendKeys,
+    bool viewTagFilter,
     std::unordered_map<PublicKey, std::vector<uint32_t>> &outputs)
 {
     auto txPublicKey = tx.getTransactionPublicKey();
@@ -73,6 +59,14 @@ void findMyOutputs(
         return;
     }
 
+    std::vector<uint8_t> tags;
+    if (viewTagFilter) {
+        getViewTags(tx, tags);
+    }
+
+    std::vector<PublicKey> keys;
+    std::vector<size_t> keyIndexes;
+    std::vector<uint32_t> outputIndexes;
     size_t keyIndex = 0;
     size_t outputCount = tx.getOutputCount();
 
@@ -84,7 +78,14 @@ void findMyOutputs(
             KeyOutput out;
             tx.getOutput(idx, out, amount);
 
-            checkOutputKey(derivation, out.key, keyIndex, idx, spendKeys, outputs);
+            if (!tags.empty() && deriveViewTag(derivation, keyIndex) != tags[idx]) {
+                ++keyIndex;
+                continue;
+            }
+
+            keys.push_back(out.key);
+            keyIndexes.push_back(keyIndex);
+            outputIndexes.push_back(static_cast<uint32_t>(idx));
             ++keyIndex;
         } else if (outType == TransactionTypes::OutputType::Multisignature) {
             uint64_t amount;
@@ -92,11 +93,25 @@ void findMyOutputs(
             tx.getOutput(idx, out, amount);
 
             for (const auto &key : out.keys) {
-                checkOutputKey(derivation, key, idx, idx, spendKeys, outputs);
+                keys.push_back(key);
+                keyIndexes.push_back(idx);
+                outputIndexes.push_back(static_cast<uint32_t>(idx));
                 ++keyIndex;
             }
         }
     }
+
+    std::vector<KeyDerivation> derivations(keys.size(), derivation);
+    std::vector<PublicKey> underivedKeys(keys.size());
+    std::unique_ptr<bool[]> valid(new bool[keys.size()]);
+    underivePublicKeys(keys.size(), derivations.data(), keyIndexes.data(), keys.data(),
+                       underivedKeys.data(), valid.get());
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (valid[i] && spendKeys.find(underivedKeys[i]) != spendKeys.end()) {
+            outputs[underivedKeys[i]].push_back(outputIndexes[i]);
+        }
+    }
 }
 
 std::vector<Crypto::Hash> getBlockHashes(const CryptoNote::CompleteBlock *blocks, size_t count)
@@ -119,13 +134,27 @@ TransfersConsumer::TransfersConsumer(
     const CryptoNote::Currency &currency,
     INode &node,
     Logging::ILogger &logger,
-    const SecretKey &viewSecret)
+    const SecretKey &viewSecret,
+    ScanningEngine *scanningEngine)
     : m_node(node),
       m_viewSecret(viewSecret),
       m_currency(currency),
-      m_logger(logger, "TransfersConsumer")
+      m_logger(logger, "TransfersConsumer"),
+      m_scanningEngine(scanningEngine),
+      m_viewTagFilter(false)
 {
     updateSyncStart();
+
+    if (m_scanningEngine != nullptr) {
+        m_scanningEngine->addConsumer(this, m_viewSecret, m_spendKeys);
+    }
+}
+
+TransfersConsumer::~TransfersConsumer()
+{
+    if (m_scanningEngine != nullptr) {
+        m_scanningEngine->removeConsumer(this);
+    }
 }
 
 ITransfersSubscription& TransfersConsumer::addSubscription(const AccountSubscription &subscription)
@@ -146,6 +175,10 @@ ITransfersSubscription& TransfersConsumer::addSubscription(const AccountSubscrip
             m_syncStart.height = std::min(m_syncStart.height, subStart.height);
             m_syncStart.timestamp = std::min(m_syncStart.timestamp, subStart.timestamp);
         }
+
+        if (m_scanningEngine != nullptr) {
+            m_scanningEngine->onSubscriptionsChanged(this);
+        }
     }
 
     return *res;
@@ -157,6 +190,9 @@ bool TransfersConsumer::removeSubscription(const AccountPublicAddress &address)
     m_spendKeys.erase(address.spendPublicKey);
 
     updateSyncStart();
+    if (m_scanningEngine != nullptr) {
+        m_scanningEngine->onSubscriptionsChanged(this);
+    }
 
     return m_subscriptions.empty();
 }
@@ -218,6 +254,10 @@ void TransfersConsumer::onBlockchainDetach(uint32_t height)
 {
     m_observerManager.notify(&IBlockchainConsumerObserver::onBlockchainDetach, this, height);
 
+    if (m_scanningEngine != nullptr) {
+        m_scanningEngine->onBlockchainDetach(this, height);
+    }
+
     for (const auto &kv : m_subscriptions) {
         kv.second->onBlockchainDetach(height);
     }
@@ -236,87 +276,85 @@ bool TransfersConsumer::onNewBlocks(const CompleteBlock *blocks,uint32_t startHe
 
     struct PreprocessedTx : Tx, PreprocessInfo {};
 
+    // in block height and transaction index order, each worker fills the entries it takes
     std::vector<PreprocessedTx> preprocessedTransactions;
-    std::mutex preprocessedTransactionsMutex;
 
-    size_t workers = std::thread::hardware_concurrency();
-    if (workers == 0) {
-        workers = 2;
-    }
-
-    BlockingQueue<Tx> inputQueue(workers * 2);
+    for (uint32_t i = 0; i < count; ++i) {
+        const auto &block = blocks[i].block;
 
-    std::atomic<bool> stopProcessing(false);
+        if (!block.is_initialized()) {
+            continue;
+        }
 
-    auto pushingThread = std::async(std::launch::async, [&] {
-        for( uint32_t i = 0; i < count && !stopProcessing; ++i) {
-            const auto &block = blocks[i].block;
+        // filter by syncStartTimestamp
+        if (m_syncStart.timestamp && block->timestamp < m_syncStart.timestamp) {
+            continue;
+        }
 
-            if (!block.is_initialized()) {
-                continue;
-            }
+        TransactionBlockInfo blockInfo;
+        blockInfo.height = startHeight + i;
+        blockInfo.timestamp = block->timestamp;
+        blockInfo.transactionIndex = 0; // position in block
 
-            // filter by syncStartTimestamp
-            if (m_syncStart.timestamp && block->timestamp < m_syncStart.timestamp) {
+        for (const auto &tx : blocks[i].transactions) {
+            auto pubKey = tx->getTransactionPublicKey();
+            if (pubKey == NULL_PUBLIC_KEY) {
+                ++blockInfo.transactionIndex;
                 continue;
             }
 
-            TransactionBlockInfo blockInfo;
-            blockInfo.height = startHeight + i;
-            blockInfo.timestamp = block->timestamp;
-            blockInfo.transactionIndex = 0; // position in block
+            PreprocessedTx item;
+            item.blockInfo = blockInfo;
+            item.tx = tx.get();
+            preprocessedTransactions.push_back(std::move(item));
+            ++blockInfo.transactionIndex;
+        }
+    }
 
-            for (const auto &tx : blocks[i].transactions) {
-                auto pubKey = tx->getTransactionPublicKey();
-                if (pubKey == NULL_PUBLIC_KEY) {
-                    ++blockInfo.transactionIndex;
-                    continue;
-                }
+    std::vector<std::error_code> errors(preprocessedTransactions.size());
+    std::atomic<bool> stopProcessing(false);
 
-                Tx item = { blockInfo, tx.get() };
-                inputQueue.push(item);
-                ++blockInfo.transactionIndex;
-            }
+    std::error_code processingError;
+    try {
+        // with a shared engine the outputs are found for all consumers at once
+        ScanningEngine::BatchOutputs scannedOutputs;
+        if (m_scanningEngine != nullptr) {
+            scannedOutputs = m_scanningEngine->scan(this, blocks, startHeight, count);
         }
 
-        inputQueue.close();
-    });
-
-    auto processingFunction = [&] {
-        Tx item;
-        std::error_code ec;
-        while (!stopProcessing && inputQueue.pop(item)) {
-            PreprocessedTx output;
-            static_cast<Tx &>(output) = item;
+        ScanningPool::instance().run(preprocessedTransactions.size(), [&](size_t index) {
+            if (stopProcessing) {
+                return;
+            }
 
-            ec = preprocessOutputs(item.blockInfo, *item.tx, output);
-            if (ec) {
+            auto &item = preprocessedTransactions[index];
+            if (m_scanningEngine == nullptr) {
+                errors[index] = preprocessOutputs(item.blockInfo, *item.tx, item);
+            } else {
+                auto outputs = scannedOutputs.find(item.tx);
+                if (outputs != scannedOutputs.end()) {
+                    errors[index] = preprocessOutputs(item.blockInfo,
+                                                      *item.tx,
+                                                      outputs->second,
+                                                      item);
+                }
+            }
+            if (errors[index]) {
                 stopProcessing = true;
-                break;
             }
-
-            std::lock_guard<std::mutex> lk(preprocessedTransactionsMutex);
-            preprocessedTransactions.push_back(std::move(output));
-        }
-        return ec;
-    };
-
-    std::vector<std::future<std::error_code>> processingThreads;
-    for (size_t i = 0; i < workers; ++i) {
-        processingThreads.push_back(std::async(std::launch::async, processingFunction));
+        });
+    } catch (const std::system_error &e) {
+        processingError = e.code();
+    } catch (const std::exception &) {
+        processingError = std::make_error_code(std::errc::operation_canceled);
     }
 
-    std::error_code processingError;
-    for (auto &f : processingThreads) {
-        try {
-            std::error_code ec = f.get();
-            if (!processingError && ec) {
-                processingError = ec;
-            }
-        } catch (const std::system_error &e) {
-            processingError = e.code();
-        } catch (const std::exception &) {
-            processingError = std::make_error_code(std::errc::operation_canceled);
+    if (!processingError) {
+        auto failed = std::find_if(errors.begin(), errors.end(), [](const std::error_code &ec) {
+            return static_cast<bool>(ec);
+        });
+        if (failed != errors.end()) {
+            processingError = *failed;
         }
     }
 
@@ -324,15 +362,6 @@ bool TransfersConsumer::onNewBlocks(const CompleteBlock *blocks,uint32_t startHe
     if (!processingError) {
         m_observerManager.notify(&IBlockchainConsumerObserver::onBlocksAdded, this, blockHashes);
 
-        // sort by block height and transaction index in block
-        std::sort(preprocessedTransactions.begin(),
-                  preprocessedTransactions.end(),
-                  [](const PreprocessedTx &a, const PreprocessedTx &b) {
-            auto tieA = std::tie(a.blockInfo.height, a.blockInfo.transactionIndex);
-            auto tieB = std::tie(b.blockInfo.height, b.blockInfo.transactionIndex);
-            return tieA < tieB;
-        });
-
         for (const auto &tx : preprocessedTransactions) {
             processTransaction(tx.blockInfo, *tx.tx, tx);
         }
@@ -435,6 +464,11 @@ void TransfersConsumer::markTransactionSafe(const Hash &transactionHash)
     });
 }
 
+void TransfersConsumer::setViewTagFilter(bool enable)
+{
+    m_viewTagFilter = enable;
+}
+
 void TransfersConsumer::addPublicKeysSeen(
     const Crypto::Hash &transactionHash,
     const Crypto::PublicKey &outputKey)
@@ -563,7 +597,17 @@ std::error_code TransfersConsumer::preprocessOutputs(
     PreprocessInfo &info)
 {
     std::unordered_map<PublicKey, std::vector<uint32_t>> outputs;
-    findMyOutputs(tx, m_viewSecret, m_spendKeys, outputs);
+    findMyOutputs(tx, m_viewSecret, m_spendKeys, m_viewTagFilter, outputs);
+
+    return preprocessOutputs(blockInfo, tx, outputs, info);
+}
+
+std::error_code TransfersConsumer::preprocessOutputs(
+    const TransactionBlockInfo &blockInfo,
+    const ITransactionReader &tx,
+    const ScanningEngine::Outputs &outputs,
+    PreprocessInfo &info)
+{
     if (outputs.empty()) {
         return std::error_code{};
     }
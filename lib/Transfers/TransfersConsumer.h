@@ -20,11 +20,13 @@
 
 #pragma once
 
+#include <atomic>
 #include <unordered_set>
 #include <crypto/Crypto.h>
 #include <Logging/LoggerRef.h>
 #include <Transfers/IBlockchainSynchronizer.h>
 #include <Transfers/IObservableImpl.h>
+#include <Transfers/ScanningEngine.h>
 #include <Transfers/TransfersSubscription.h>
 #include <Transfers/TypeHelpers.h>
 #include <ITransfersSynchronizer.h>
@@ -45,7 +47,9 @@ public:
     TransfersConsumer(const CryptoNote::Currency &currency,
                       INode &node,
                       Logging::ILogger &logger,
-                      const Crypto::SecretKey &viewSecret);
+                      const Crypto::SecretKey &viewSecret,
+                      ScanningEngine *scanningEngine = nullptr);
+    ~TransfersConsumer() override;
 
     ITransfersSubscription& addSubscription(const AccountSubscription &subscription);
     bool removeSubscription(const AccountPublicAddress &address); // true if no subscribers left
@@ -69,6 +73,8 @@ public:
 
 
     void markTransactionSafe(const Crypto::Hash &transactionHash);
+    // see ScanningEngine::setViewTagFilter(), applies when the consumer scans on its own
+    void setViewTagFilter(bool enable);
 private:
     template <typename F>
     void forEachSubscription(F action)
@@ -82,6 +88,11 @@ private:
         const TransactionBlockInfo &blockInfo,
         const ITransactionReader &tx,
         PreprocessInfo &info);
+    std::error_code preprocessOutputs(
+        const TransactionBlockInfo &blockInfo,
+        const ITransactionReader &tx,
+        const ScanningEngine::Outputs &outputs,
+        PreprocessInfo &info);
     std::error_code processTransaction(
         const TransactionBlockInfo &blockInfo,
         const ITransactionReader &tx);
@@ -121,6 +132,9 @@ private:
     INode &m_node;
     const CryptoNote::Currency &m_currency;
     Logging::LoggerRef m_logger;
+    // shared with the other consumers of the synchronizer, may be null
+    ScanningEngine *m_scanningEngine;
+    std::atomic<bool> m_viewTagFilter;
 };
 
 } // namespace CryptoNote
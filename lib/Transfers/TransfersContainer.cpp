@@ -16,6 +16,7 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <Common/ShuffleGenerator.h>
 #include <Common/StdInputStream.h>
 #include <Common/StdOutputStream.h>
 #include <CryptoNoteCore/CryptoNoteBasicImpl.h>
@@ -210,6 +211,7 @@ TransfersContainer::TransfersContainer(const Currency &currency,
       m_currency(currency),
       m_logger(logger, "TransfersContainer")
 {
+    rebuildBalances();
 }
 
 bool TransfersContainer::addTransaction(
@@ -250,7 +252,7 @@ bool TransfersContainer::addTransaction(
         }
 
         if (block.height != WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT) {
-            m_currentHeight = block.height;
+            setCurrentHeight(block.height);
         }
 
         return added;
@@ -327,8 +329,8 @@ bool TransfersContainer::addTransactionOutputs(
 
         if (transferIsUnconfirmed) {
             auto result = m_unconfirmedTransfers.emplace(std::move(info));
-            (void)result; // Disable unused warning
             assert(result.second);
+            addToBalance(*result.first);
         } else {
             if (info.type == TransactionTypes::OutputType::Key) {
                 bool duplicate = false;
@@ -376,8 +378,8 @@ bool TransfersContainer::addTransactionOutputs(
             }
 
             auto result = m_availableTransfers.emplace(std::move(info));
-            (void)result; // Disable unused warning
             assert(result.second);
+            addToBalance(*result.first);
         }
 
         if (info.type == TransactionTypes::OutputType::Key) {
@@ -470,6 +472,7 @@ bool TransfersContainer::addTransactionInputs(
 
             copyToSpent(block, tx, i, *spendingTransferIt);
             // erase from available outputs
+            removeFromBalance(*spendingTransferIt);
             outputDescriptorIndex.erase(spendingTransferIt);
             updateTransfersVisibility(input.keyImage);
 
@@ -485,6 +488,7 @@ bool TransfersContainer::addTransactionInputs(
             if (availableOutputIt != outputDescriptorIndex.end()) {
                 copyToSpent(block, tx, i, *availableOutputIt);
                 // erase from available outputs
+                removeFromBalance(*availableOutputIt);
                 outputDescriptorIndex.erase(availableOutputIt);
 
                 inputsAdded = true;
@@ -573,9 +577,10 @@ bool TransfersContainer::markTransactionConfirmed(const TransactionBlockInfo &bl
         }
 
         auto result = m_availableTransfers.emplace(std::move(transfer));
-        (void)result; // Disable unused warning
         assert(result.second);
+        addToBalance(*result.first);
 
+        removeFromBalance(*transferIt);
         transferIt = m_unconfirmedTransfers.get<ContainingTransactionIndex>().erase(transferIt);
 
         if (transfer.type == TransactionTypes::OutputType::Key) {
@@ -599,7 +604,19 @@ bool TransfersContainer::markTransactionConfirmed(const TransactionBlockInfo &bl
 void TransfersContainer::markTransactionSafe(const Hash &transactionHash)
 {
     std::unique_lock<std::mutex> lock(m_mutex);
+
+    // the transfers of a safe transaction unlock earlier
+    auto &transactionIndex = m_availableTransfers.get<ContainingTransactionIndex>();
+    auto range = transactionIndex.equal_range(transactionHash);
+    for (auto it = range.first; it != range.second; ++it) {
+        removeFromBalance(*it);
+    }
+
     m_safeTxes.insert(transactionHash);
+
+    for (auto it = range.first; it != range.second; ++it) {
+        addToBalance(*it);
+    }
 }
 
 void TransfersContainer::getSafeTransactions(std::vector<Hash> &transactions) const
@@ -622,6 +639,7 @@ void TransfersContainer::deleteTransactionTransfers(const Hash& transactionHash)
             static_cast<const TransactionOutputInformationEx &>(*it)
         );
         assert(result.second);
+        addToBalance(*result.first);
         it = spendingTransactionIndex.erase(it);
 
         if (result.first->type == TransactionTypes::OutputType::Key) {
@@ -632,6 +650,7 @@ void TransfersContainer::deleteTransactionTransfers(const Hash& transactionHash)
     auto unconfirmedTransfersRange =
         m_unconfirmedTransfers.get<ContainingTransactionIndex>().equal_range(transactionHash);
     for (auto it = unconfirmedTransfersRange.first; it != unconfirmedTransfersRange.second;) {
+        removeFromBalance(*it);
         if (it->type == TransactionTypes::OutputType::Key) {
             KeyImage keyImage = it->keyImage;
             it = m_unconfirmedTransfers.get<ContainingTransactionIndex>().erase(it);
@@ -644,6 +663,7 @@ void TransfersContainer::deleteTransactionTransfers(const Hash& transactionHash)
     auto &transactionTransfersIndex = m_availableTransfers.get<ContainingTransactionIndex>();
     auto transactionTransfersRange = transactionTransfersIndex.equal_range(transactionHash);
     for (auto it = transactionTransfersRange.first; it != transactionTransfersRange.second;) {
+        removeFromBalance(*it);
         if (it->type == TransactionTypes::OutputType::Key) {
             KeyImage keyImage = it->keyImage;
             it = transactionTransfersIndex.erase(it);
@@ -713,7 +733,7 @@ std::vector<Hash> TransfersContainer::detach(uint32_t height)
     }
 
     // TODO: notification on detach
-    m_currentHeight = height == 0 ? 0 : height - 1;
+    setCurrentHeight(height == 0 ? 0 : height - 1);
 
     return deletedTransactions;
 }
@@ -749,6 +769,15 @@ void TransfersContainer::updateTransfersVisibility(const KeyImage &keyImage)
     size_t spentCount = std::distance(spentRange.first, spentRange.second);
     assert(spentCount == 0 || spentCount == 1);
 
+    // only visible transfers are in the balance, take them out while visibility changes
+    for (auto it = unconfirmedRange.first; it != unconfirmedRange.second; ++it) {
+        removeFromBalance(*it);
+    }
+
+    for (auto it = availableRange.first; it != availableRange.second; ++it) {
+        removeFromBalance(*it);
+    }
+
     if (spentCount > 0) {
         updateVisibility(unconfirmedIndex, unconfirmedRange, false);
         updateVisibility(availableIndex, availableRange, false);
@@ -767,6 +796,214 @@ void TransfersContainer::updateTransfersVisibility(const KeyImage &keyImage)
     } else {
         updateVisibility(unconfirmedIndex, unconfirmedRange, unconfirmedCount == 1);
     }
+
+    unconfirmedRange = unconfirmedIndex.equal_range(descriptor);
+    for (auto it = unconfirmedRange.first; it != unconfirmedRange.second; ++it) {
+        addToBalance(*it);
+    }
+
+    availableRange = availableIndex.equal_range(descriptor);
+    for (auto it = availableRange.first; it != availableRange.second; ++it) {
+        addToBalance(*it);
+    }
+}
+
+// Same states as isIncluded() gives a confirmed transfer with an unlock height, at any height.
+uint32_t TransfersContainer::getTransferState(const TransactionOutputInformationEx &info,
+                                              uint64_t height) const
+{
+    if (height + m_currency.lockedTxAllowedDeltaBlocks() < info.unlockTime) {
+        return IncludeStateLocked;
+    }
+
+    if (height < info.blockHeight + m_transactionSpendableAge) {
+        if (m_safeTxes.count(info.transactionHash) != 0
+            && height >= info.blockHeight - 1 + m_safeTransactionSpendableAge) {
+            return IncludeStateUnlocked;
+        }
+
+        return IncludeStateSoftLocked;
+    }
+
+    return IncludeStateUnlocked;
+}
+
+// Calls f(height, change) for every state change of a confirmed transfer above m_currentHeight.
+template<typename F>
+void TransfersContainer::forEachBalanceChange(const TransactionOutputInformationEx &info,
+                                              F &&f) const
+{
+    // the heights at which one of the conditions of getTransferState() flips
+    uint64_t delta = m_currency.lockedTxAllowedDeltaBlocks();
+    uint64_t heights[] = {
+        info.unlockTime > delta ? info.unlockTime - delta : 0,
+        info.blockHeight + m_transactionSpendableAge,
+        info.blockHeight - 1 + m_safeTransactionSpendableAge
+    };
+    std::sort(std::begin(heights), std::end(heights));
+
+    uint32_t state = getTransferState(info, m_currentHeight);
+    for (uint64_t height : heights) {
+        if (height <= m_currentHeight) {
+            continue;
+        }
+
+        uint32_t next = getTransferState(info, height);
+        if (next != state) {
+            f(height, BalanceChange{ info.amount, info.type, state, next });
+            state = next;
+        }
+    }
+}
+
+uint64_t &TransfersContainer::balanceOf(TransactionTypes::OutputType type, uint32_t state)
+{
+    assert(type == TransactionTypes::OutputType::Key
+           || type == TransactionTypes::OutputType::Multisignature);
+
+    size_t typeIndex = type == TransactionTypes::OutputType::Key ? 0 : 1;
+    size_t stateIndex = state == IncludeStateLocked ? 0 : state == IncludeStateSoftLocked ? 1 : 2;
+
+    return m_balances[typeIndex][stateIndex];
+}
+
+// pre: m_mutex is locked.
+void TransfersContainer::addToBalance(const TransactionOutputInformationEx &info)
+{
+    if (!info.visible) {
+        return;
+    }
+
+    if (info.blockHeight == WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT) {
+        balanceOf(info.type, IncludeStateLocked) += info.amount;
+        return;
+    }
+
+    if (info.type == TransactionTypes::OutputType::Key) {
+        addSelectableOutput(info);
+    }
+
+    if (info.unlockTime >= m_currency.maxBlockHeight()) {
+        m_timeLockedTransfers.insert(&info);
+        return;
+    }
+
+    balanceOf(info.type, getTransferState(info, m_currentHeight)) += info.amount;
+    forEachBalanceChange(info, [this](uint64_t height, const BalanceChange &change) {
+        m_balanceChanges.emplace(height, change);
+    });
+}
+
+// pre: m_mutex is locked, info is counted as it is now.
+void TransfersContainer::removeFromBalance(const TransactionOutputInformationEx &info)
+{
+    if (!info.visible) {
+        return;
+    }
+
+    if (info.blockHeight == WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT) {
+        balanceOf(info.type, IncludeStateLocked) -= info.amount;
+        return;
+    }
+
+    if (info.type == TransactionTypes::OutputType::Key) {
+        removeSelectableOutput(info);
+    }
+
+    if (info.unlockTime >= m_currency.maxBlockHeight()) {
+        m_timeLockedTransfers.erase(&info);
+        return;
+    }
+
+    balanceOf(info.type, getTransferState(info, m_currentHeight)) -= info.amount;
+    // equal changes are interchangeable, any of them can go
+    forEachBalanceChange(info, [this](uint64_t height, const BalanceChange &change) {
+        auto range = m_balanceChanges.equal_range(height);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second.amount == change.amount
+                && it->second.type == change.type
+                && it->second.fromState == change.fromState
+                && it->second.toState == change.toState) {
+                m_balanceChanges.erase(it);
+                return;
+            }
+        }
+
+        assert(false);
+    });
+}
+
+// pre: m_mutex is locked.
+void TransfersContainer::rebuildBalances()
+{
+    std::fill(&m_balances[0][0], &m_balances[0][0] + 6, 0);
+    m_balanceChanges.clear();
+    m_timeLockedTransfers.clear();
+    for (auto &outputs : m_selectableOutputs) {
+        outputs.clear();
+    }
+    m_selectablePositions.clear();
+
+    for (const auto &transfer : m_unconfirmedTransfers) {
+        addToBalance(transfer);
+    }
+
+    for (const auto &transfer : m_availableTransfers) {
+        addToBalance(transfer);
+    }
+}
+
+// pre: m_mutex is locked.
+void TransfersContainer::setCurrentHeight(uint32_t height)
+{
+    if (height < m_currentHeight) {
+        // states only move forward with the height, recount from scratch
+        m_currentHeight = height;
+        rebuildBalances();
+        return;
+    }
+
+    m_currentHeight = height;
+    while (!m_balanceChanges.empty() && m_balanceChanges.begin()->first <= height) {
+        const BalanceChange &change = m_balanceChanges.begin()->second;
+        balanceOf(change.type, change.fromState) -= change.amount;
+        balanceOf(change.type, change.toState) += change.amount;
+        m_balanceChanges.erase(m_balanceChanges.begin());
+    }
+}
+
+size_t TransfersContainer::amountBucket(uint64_t amount)
+{
+    size_t bucket = 0;
+    while (amount >= 10 && bucket + 1 < AMOUNT_BUCKETS) {
+        amount /= 10;
+        ++bucket;
+    }
+
+    return bucket;
+}
+
+// pre: m_mutex is locked.
+void TransfersContainer::addSelectableOutput(const TransactionOutputInformationEx &info)
+{
+    auto &outputs = m_selectableOutputs[amountBucket(info.amount)];
+    m_selectablePositions.emplace(&info, outputs.size());
+    outputs.push_back(&info);
+}
+
+// pre: m_mutex is locked.
+void TransfersContainer::removeSelectableOutput(const TransactionOutputInformationEx &info)
+{
+    auto it = m_selectablePositions.find(&info);
+    assert(it != m_selectablePositions.end());
+
+    // the last output of the bucket takes the place of the removed one
+    auto &outputs = m_selectableOutputs[amountBucket(info.amount)];
+    const TransactionOutputInformationEx *last = outputs.back();
+    outputs[it->second] = last;
+    m_selectablePositions[last] = it->second;
+    outputs.pop_back();
+    m_selectablePositions.erase(it);
 }
 
 bool TransfersContainer::advanceHeight(uint32_t height)
@@ -774,7 +1011,7 @@ bool TransfersContainer::advanceHeight(uint32_t height)
     std::lock_guard<std::mutex> lk(m_mutex);
 
     if (m_currentHeight <= height) {
-        m_currentHeight = height;
+        setCurrentHeight(height);
         return true;
     }
 
@@ -798,17 +1035,22 @@ uint64_t TransfersContainer::balance(uint32_t flags) const
     std::lock_guard<std::mutex> lk(m_mutex);
     uint64_t amount = 0;
 
-    for (const auto &t : m_availableTransfers) {
-        if (t.visible && isIncluded(t, flags)) {
-            amount += t.amount;
+    const TransactionTypes::OutputType types[] = {
+        TransactionTypes::OutputType::Key,
+        TransactionTypes::OutputType::Multisignature
+    };
+    const uint32_t states[] = { IncludeStateLocked, IncludeStateSoftLocked, IncludeStateUnlocked };
+    for (size_t type = 0; type < 2; ++type) {
+        for (size_t state = 0; state < 3; ++state) {
+            if (isIncluded(types[type], states[state], flags)) {
+                amount += m_balances[type][state];
+            }
         }
     }
 
-    if ((flags & IncludeStateLocked) != 0) {
-        for (const auto &t : m_unconfirmedTransfers) {
-            if (t.visible && isIncluded(t.type, IncludeStateLocked, flags)) {
-                amount += t.amount;
-            }
+    for (const TransactionOutputInformationEx *t : m_timeLockedTransfers) {
+        if (isIncluded(*t, flags)) {
+            amount += t->amount;
         }
     }
 
@@ -835,6 +1077,76 @@ void TransfersContainer::getOutputs(
     }
 }
 
+size_t TransfersContainer::getRandomOutputsPoolSize(uint64_t minAmount, uint64_t maxAmount) const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (minAmount > maxAmount) {
+        return 0;
+    }
+
+    size_t size = 0;
+    for (size_t bucket = amountBucket(minAmount); bucket <= amountBucket(maxAmount); ++bucket) {
+        size += m_selectableOutputs[bucket].size();
+    }
+
+    return size;
+}
+
+size_t TransfersContainer::getRandomOutputs(
+    size_t count,
+    uint64_t minAmount,
+    uint64_t maxAmount,
+    std::vector<TransactionOutputInformation> &outputs) const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (minAmount > maxAmount) {
+        return 0;
+    }
+
+    std::unordered_set<const TransactionOutputInformationEx *> picked;
+    auto &transactionIndex = m_availableTransfers.get<ContainingTransactionIndex>();
+    for (const auto &output : outputs) {
+        auto range = transactionIndex.equal_range(output.transactionHash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->outputInTransaction == output.outputInTransaction) {
+                picked.insert(&*it);
+            }
+        }
+    }
+
+    size_t firstBucket = amountBucket(minAmount);
+    size_t lastBucket = amountBucket(maxAmount);
+    size_t poolSize = 0;
+    for (size_t bucket = firstBucket; bucket <= lastBucket; ++bucket) {
+        poolSize += m_selectableOutputs[bucket].size();
+    }
+
+    // walks a random permutation of the buckets joined together, only touching what it draws
+    ShuffleGenerator<size_t, Crypto::RandomEngine<size_t>> generator(poolSize);
+    size_t added = 0;
+    while (added < count && !generator.empty()) {
+        size_t position = generator();
+        size_t bucket = firstBucket;
+        while (position >= m_selectableOutputs[bucket].size()) {
+            position -= m_selectableOutputs[bucket].size();
+            ++bucket;
+        }
+
+        const TransactionOutputInformationEx *output = m_selectableOutputs[bucket][position];
+        if (output->amount < minAmount
+            || output->amount > maxAmount
+            || picked.count(output) != 0
+            || !isIncluded(*output, IncludeKeyUnlocked)) {
+            continue;
+        }
+
+        outputs.push_back(*output);
+        ++added;
+    }
+
+    return added;
+}
+
 bool TransfersContainer::getTransactionInformation(
     const Hash &transactionHash,
     TransactionInformation &info,
@@ -1064,6 +1376,7 @@ void TransfersContainer::load(std::istream &in)
     m_unconfirmedTransfers = std::move(unconfirmedTransfers);
     m_availableTransfers = std::move(availableTransfers);
     m_spentTransfers = std::move(spentTransfers);
+    rebuildBalances();
 
     // Repair the container if it was broken while handling addTransaction()
     // in previous version of the code.
@@ -1099,6 +1412,7 @@ void TransfersContainer::repair()
                 static_cast<const TransactionOutputInformationEx &>(*it)
             );
             assert(result.second);
+            addToBalance(*result.first);
             it = m_spentTransfers.erase(it);
 
             if (result.first->type == TransactionTypes::OutputType::Key) {
@@ -1121,6 +1435,7 @@ void TransfersContainer::repair()
             ", output " << std::setw(2) << it->outputInTransaction <<
             ", amount " << m_currency.formatAmount(it->amount);
 
+            removeFromBalance(*it);
             if (it->type == TransactionTypes::OutputType::Key) {
             KeyImage keyImage = it->keyImage;
             it = m_unconfirmedTransfers.erase(it);
@@ -1147,6 +1462,7 @@ void TransfersContainer::repair()
                 ", output " << std::setw(2) << it->outputInTransaction <<
                 ", amount " << m_currency.formatAmount(it->amount);
 
+            removeFromBalance(*it);
             if (it->type == TransactionTypes::OutputType::Key) {
                 KeyImage keyImage = it->keyImage;
                 it = m_availableTransfers.erase(it);
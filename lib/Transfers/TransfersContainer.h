@@ -19,8 +19,10 @@
 #pragma once
 
 #include <cstdint>
+#include <map>
 #include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/member.hpp>
@@ -175,6 +177,12 @@ public:
     void getOutputs(
         std::vector<TransactionOutputInformation> &transfers,
         uint32_t flags) const override;
+    size_t getRandomOutputsPoolSize(uint64_t minAmount, uint64_t maxAmount) const override;
+    size_t getRandomOutputs(
+        size_t count,
+        uint64_t minAmount,
+        uint64_t maxAmount,
+        std::vector<TransactionOutputInformation> &outputs) const override;
     bool getTransactionInformation(
         const Crypto::Hash &transactionHash,
         TransactionInformation &info,
@@ -290,6 +298,15 @@ private:
         >
     > SpentTransfersMultiIndex;
 
+    // a confirmed transfer moving to another state once the height is reached
+    struct BalanceChange
+    {
+        uint64_t amount;
+        TransactionTypes::OutputType type;
+        uint32_t fromState;
+        uint32_t toState;
+    };
+
 private:
     void addTransaction(const TransactionBlockInfo &block, const ITransactionReader &tx);
     bool addTransactionOutputs(const TransactionBlockInfo &block,
@@ -302,6 +319,19 @@ private:
     static bool isIncluded(TransactionTypes::OutputType type, uint32_t state, uint32_t flags);
     void updateTransfersVisibility(const Crypto::KeyImage &keyImage);
 
+    uint32_t getTransferState(const TransactionOutputInformationEx &info, uint64_t height) const;
+    template<typename F>
+    void forEachBalanceChange(const TransactionOutputInformationEx &info, F &&f) const;
+    uint64_t &balanceOf(TransactionTypes::OutputType type, uint32_t state);
+    void addToBalance(const TransactionOutputInformationEx &info);
+    void removeFromBalance(const TransactionOutputInformationEx &info);
+    void rebuildBalances();
+    void setCurrentHeight(uint32_t height);
+
+    static size_t amountBucket(uint64_t amount);
+    void addSelectableOutput(const TransactionOutputInformationEx &info);
+    void removeSelectableOutput(const TransactionOutputInformationEx &info);
+
     void copyToSpent(const TransactionBlockInfo &block,
                      const ITransactionReader &tx,
                      size_t inputIndex,
@@ -316,6 +346,19 @@ private:
 
     mutable std::set<Crypto::Hash, Crypto::HashCompare> m_safeTxes;
 
+    // Visible unconfirmed and available amounts by output type and state, kept up to date
+    // so balance() does not walk the transfers. Transfers locked until a time depend on the
+    // clock and are only kept aside.
+    uint64_t m_balances[2][3];
+    std::multimap<uint64_t, BalanceChange> m_balanceChanges;
+    std::unordered_set<const TransactionOutputInformationEx *> m_timeLockedTransfers;
+
+    // Visible available key outputs by the power of ten of their amount, so getRandomOutputs()
+    // draws from them in place. Follows the same transfers as the balances.
+    static const size_t AMOUNT_BUCKETS = 20;
+    std::vector<const TransactionOutputInformationEx *> m_selectableOutputs[AMOUNT_BUCKETS];
+    std::unordered_map<const TransactionOutputInformationEx *, size_t> m_selectablePositions;
+
     uint32_t m_currentHeight; // current height is needed to check if a transfer is unlocked
     size_t m_transactionSpendableAge;
     size_t m_safeTransactionSpendableAge;
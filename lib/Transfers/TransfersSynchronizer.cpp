@@ -41,7 +41,8 @@ TransfersSynchronizer::TransfersSynchronizer(
     : m_currency(currency),
       m_logger(logger, "TransfersSynchronizer"),
       m_sync(sync),
-      m_node(node)
+      m_node(node),
+      m_viewTagFilter(false)
 {
 }
 
@@ -66,8 +67,13 @@ ITransfersSubscription& TransfersSynchronizer::addSubscription(const AccountSubs
 
     if (it == m_consumers.end()) {
         std::unique_ptr<TransfersConsumer> consumer(
-            new TransfersConsumer(m_currency, m_node, m_logger.getLogger(), acc.keys.viewSecretKey)
+            new TransfersConsumer(m_currency,
+                                  m_node,
+                                  m_logger.getLogger(),
+                                  acc.keys.viewSecretKey,
+                                  &m_scanningEngine)
         );
+        consumer->setViewTagFilter(m_viewTagFilter);
 
         m_sync.addConsumer(consumer.get());
         consumer->addObserver(this);
@@ -127,6 +133,15 @@ void TransfersSynchronizer::markTransactionSafe(const Hash &transactionHash)
     }
 }
 
+void TransfersSynchronizer::setViewTagFilter(bool enable)
+{
+    m_viewTagFilter = enable;
+    m_scanningEngine.setViewTagFilter(enable);
+    for (const auto &kv : m_consumers) {
+        kv.second->setViewTagFilter(enable);
+    }
+}
+
 std::vector<Crypto::Hash> TransfersSynchronizer::getViewKeyKnownBlocks(
     const Crypto::PublicKey &publicViewKey)
 {
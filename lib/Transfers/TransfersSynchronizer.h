@@ -26,6 +26,7 @@
 #include <Common/ObserverManager.h>
 #include <Logging/LoggerRef.h>
 #include <Transfers/IBlockchainSynchronizer.h>
+#include <Transfers/ScanningEngine.h>
 #include <Transfers/TypeHelpers.h>
 #include <ITransfersSynchronizer.h>
 
@@ -74,7 +75,8 @@ public:
                            const Crypto::Hash &transactionHash,
                            const Crypto::PublicKey &outputKey);
     void markTransactionSafe(const Crypto::Hash &transactionHash);
-
+    // opt-in: reject outputs by their view tag before underiving them, see ScanningEngine
+    void setViewTagFilter(bool enable);
 
     // IStreamSerializable
     void save(std::ostream &os) override;
@@ -103,11 +105,13 @@ private:
 
 private:
     Logging::LoggerRef m_logger;
+    ScanningEngine m_scanningEngine; // must outlive the consumers
     ConsumersContainer m_consumers; // map { view public key -> consumer }
     SubscribersContainer m_subscribers;
     IBlockchainSynchronizer &m_sync;
     INode &m_node;
     const CryptoNote::Currency &m_currency;
+    bool m_viewTagFilter;
 };
 
 } // namespace CryptoNote
@@ -0,0 +1,224 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <random>
+#include <crypto/Crypto.h>
+#include <Wallet/DecoyCache.h>
+
+using namespace Logging;
+
+namespace CryptoNote {
+
+DecoyCache::DecoyCache(INode &node,
+                       Logging::ILogger &logger,
+                       size_t poolSize,
+                       std::chrono::seconds maxAge)
+    : m_node(node),
+      m_logger(logger, "DecoyCache"),
+      m_poolSize(poolSize),
+      m_maxAge(maxAge),
+      m_state(std::make_shared<State>())
+{
+}
+
+std::vector<size_t> DecoyCache::take(
+    const std::vector<uint64_t> &amounts,
+    uint64_t count,
+    std::vector<OutsForAmount> &result)
+{
+    Clock::time_point now = Clock::now();
+    std::vector<size_t> missing;
+
+    std::lock_guard<std::mutex> lk(m_state->mutex);
+    expire(now);
+
+    result.clear();
+    result.resize(amounts.size());
+    for (size_t i = 0; i < amounts.size(); ++i) {
+        result[i].amount = amounts[i];
+
+        Pool &pool = m_state->pools[amounts[i]];
+        pool.lastWanted = now;
+        if (pool.candidates.size() < count) {
+            missing.push_back(i);
+            continue;
+        }
+
+        for (uint64_t j = 0; j < count; ++j) {
+            const OutEntry &entry = pool.candidates.front().entry;
+            result[i].outs.push_back(entry);
+            pool.indices.erase(entry.global_amount_index);
+            pool.candidates.pop_front();
+        }
+    }
+
+    return missing;
+}
+
+void DecoyCache::fetch(
+    std::vector<uint64_t> &&amounts,
+    uint64_t count,
+    std::vector<OutsForAmount> &result,
+    const INode::Callback &callback)
+{
+    std::shared_ptr<State> state = m_state;
+    auto outs = std::make_shared<std::vector<OutsForAmount>>();
+    std::vector<uint64_t> requested = amounts;
+
+    m_node.getRandomOutsByAmounts(
+        std::move(amounts),
+        std::max<uint64_t>(count, m_poolSize),
+        *outs,
+        [state, outs, requested, count, &result, callback](std::error_code ec) {
+        if (!ec) {
+            // match the answers by amount, each of them goes to one requested amount
+            std::unordered_map<uint64_t, std::vector<size_t>> answers;
+            for (size_t i = outs->size(); i-- > 0;) {
+                answers[(*outs)[i].amount].push_back(i);
+            }
+
+            result.clear();
+            result.resize(requested.size());
+            for (size_t i = 0; i < requested.size(); ++i) {
+                result[i].amount = requested[i];
+
+                std::vector<size_t> &indices = answers[requested[i]];
+                if (indices.empty()) {
+                    continue;
+                }
+
+                std::vector<OutEntry> &answer = (*outs)[indices.back()].outs;
+                indices.pop_back();
+
+                // the node may answer in order of the global indices
+                shuffle(answer);
+
+                auto used = answer.begin() + std::min<size_t>(count, answer.size());
+                result[i].outs.assign(answer.begin(), used);
+                answer.erase(answer.begin(), used);
+            }
+
+            Clock::time_point now = Clock::now();
+            std::lock_guard<std::mutex> lk(state->mutex);
+            for (uint64_t amount : requested) {
+                state->pools[amount].lastWanted = now;
+            }
+
+            store(*state, *outs, now);
+        }
+
+        callback(ec);
+    });
+}
+
+void DecoyCache::refill()
+{
+    Clock::time_point now = Clock::now();
+    std::vector<uint64_t> amounts;
+    {
+        std::lock_guard<std::mutex> lk(m_state->mutex);
+        if (m_state->refillError) {
+            m_logger(WARNING, BRIGHT_YELLOW)
+                << "Failed to refill decoys: " << m_state->refillError.message();
+            m_state->refillError = std::error_code();
+        }
+
+        if (m_state->refilling) {
+            return;
+        }
+
+        expire(now);
+        for (const auto &pool : m_state->pools) {
+            if (pool.second.candidates.size() < m_poolSize / 2) {
+                amounts.push_back(pool.first);
+            }
+        }
+
+        if (amounts.empty()) {
+            return;
+        }
+
+        m_state->refilling = true;
+    }
+
+    m_logger(DEBUGGING) << "Refilling decoys for " << amounts.size() << " amounts";
+
+    std::shared_ptr<State> state = m_state;
+    auto outs = std::make_shared<std::vector<OutsForAmount>>();
+    m_node.getRandomOutsByAmounts(std::move(amounts), m_poolSize, *outs,
+        [state, outs](std::error_code ec) {
+        std::lock_guard<std::mutex> lk(state->mutex);
+        if (ec) {
+            state->refillError = ec;
+        } else {
+            store(*state, *outs, Clock::now());
+        }
+
+        state->refilling = false;
+    });
+}
+
+// pre: state.mutex is locked.
+void DecoyCache::store(State &state, const std::vector<OutsForAmount> &outs, Clock::time_point now)
+{
+    for (const auto &answer : outs) {
+        Pool &pool = state.pools[answer.amount];
+        std::vector<OutEntry> entries;
+        for (const auto &entry : answer.outs) {
+            if (pool.indices.insert(entry.global_amount_index).second) {
+                entries.push_back(entry);
+            }
+        }
+
+        // candidates are handed out in the order they are kept
+        shuffle(entries);
+        for (const auto &entry : entries) {
+            pool.candidates.push_back(Candidate{ entry, now });
+        }
+    }
+}
+
+void DecoyCache::shuffle(std::vector<OutEntry> &entries)
+{
+    std::shuffle(
+        entries.begin(),
+        entries.end(),
+        std::default_random_engine{Crypto::rand<std::default_random_engine::result_type>()});
+}
+
+// pre: m_state->mutex is locked.
+void DecoyCache::expire(Clock::time_point now)
+{
+    for (auto it = m_state->pools.begin(); it != m_state->pools.end();) {
+        Pool &pool = it->second;
+        if (pool.lastWanted + m_maxAge < now) {
+            it = m_state->pools.erase(it);
+            continue;
+        }
+
+        // candidates are stored in the order they arrived
+        while (!pool.candidates.empty() && pool.candidates.front().fetched + m_maxAge < now) {
+            pool.indices.erase(pool.candidates.front().entry.global_amount_index);
+            pool.candidates.pop_front();
+        }
+
+        ++it;
+    }
+}
+
+} // namespace CryptoNote
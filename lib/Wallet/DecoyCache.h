@@ -0,0 +1,107 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <INode.h>
+#include <Logging/LoggerRef.h>
+
+namespace CryptoNote {
+
+/*!
+    Random outputs to mix inputs with, fetched from the node ahead of the transactions
+    that use them.
+
+    Every candidate is handed out once, in random order. Amounts that transactions ask for are remembered and
+    refilled together, in one request, whenever they run low, so most transactions get their
+    decoys without a round trip. Candidates older than maxAge are dropped, by then the node
+    would pick among newer outputs.
+*/
+class DecoyCache
+{
+public:
+    typedef COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount OutsForAmount;
+    typedef COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry OutEntry;
+
+    DecoyCache(INode &node, Logging::ILogger &logger, size_t poolSize, std::chrono::seconds maxAge);
+    DecoyCache(const DecoyCache &) = delete;
+    DecoyCache &operator=(const DecoyCache &) = delete;
+
+    // Sets result to one entry per amount, in their order, with count candidates each where
+    // there are enough of them. Returns the indices of the amounts left empty.
+    std::vector<size_t> take(
+        const std::vector<uint64_t> &amounts,
+        uint64_t count,
+        std::vector<OutsForAmount> &result);
+
+    // Asks the node for count candidates per amount, and for more to keep. result gets one
+    // entry per amount, in their order, before callback is called.
+    void fetch(
+        std::vector<uint64_t> &&amounts,
+        uint64_t count,
+        std::vector<OutsForAmount> &result,
+        const INode::Callback &callback);
+
+    // Tops the amounts asked for lately up in the background, unless a refill is running.
+    void refill();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Candidate
+    {
+        OutEntry entry;
+        Clock::time_point fetched;
+    };
+
+    struct Pool
+    {
+        std::deque<Candidate> candidates;
+        std::unordered_set<uint64_t> indices; // global indices of the candidates
+        Clock::time_point lastWanted;
+    };
+
+    // outlives the cache while a request is pending
+    struct State
+    {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, Pool> pools;
+        bool refilling = false;
+        std::error_code refillError;
+    };
+
+    static void store(State &state, const std::vector<OutsForAmount> &outs, Clock::time_point now);
+    static void shuffle(std::vector<OutEntry> &entries);
+    void expire(Clock::time_point now);
+
+    INode &m_node;
+    Logging::LoggerRef m_logger;
+    const size_t m_poolSize;
+    const std::chrono::seconds m_maxAge;
+    std::shared_ptr<State> m_state;
+};
+
+} // namespace CryptoNote
@@ -23,6 +23,7 @@
 #include <cassert>
 #include <ctime>
 #include <fstream>
+#include <limits>
 #include <numeric>
 #include <random>
 #include <set>
@@ -44,9 +45,11 @@
 #include <CryptoNoteCore/CryptoNoteTools.h>
 #include <CryptoNoteCore/ITransaction.h>
 #include <CryptoNoteCore/TransactionApi.h>
+#include <CryptoNoteCore/TransactionUtils.h>
 #include <Global/Constants.h>
 #include <System/EventLock.h>
 #include <System/RemoteContext.h>
+#include <Transfers/ScanningPool.h>
 #include <Transfers/TransfersContainer.h>
 #include <Wallet/WalletErrors.h>
 #include <Wallet/WalletGreen.h>
@@ -65,6 +68,10 @@ using namespace Logging;
 
 namespace {
 
+// random outputs kept per amount, and how long they are kept
+const size_t DECOY_POOL_SIZE = 64;
+const std::chrono::seconds DECOY_MAX_AGE(600);
+
 void asyncRequestCompletion(System::Event &requestFinished)
 {
     requestFinished.set();
@@ -155,6 +162,7 @@ WalletGreen::WalletGreen(System::Dispatcher &dispatcher,
       m_currency(currency),
       m_node(node),
       m_logger(logger, "WalletGreen/empty"),
+      m_decoyCache(node, logger, DECOY_POOL_SIZE, DECOY_MAX_AGE),
       m_stopped(false),
       m_blockchainSynchronizerStarted(false),
       m_blockchainSynchronizer(node, logger, currency.genesisBlockHash()),
@@ -1696,7 +1704,7 @@ size_t WalletGreen::transfer(const TransactionParameters &transactionParameters,
     return id;
 }
 
-void WalletGreen::prepareTransaction(std::vector<WalletOuts> &&wallets,
+void WalletGreen::prepareTransaction(const std::vector<WalletRecord *> &wallets,
                                      const std::vector<WalletOrder> &orders,
                                      uint64_t fee,
                                      uint64_t mixIn,
@@ -1715,7 +1723,7 @@ void WalletGreen::prepareTransaction(std::vector<WalletOuts> &&wallets,
         preparedTransaction.neededMoney,
         mixIn == 0,
         0,
-        std::move(wallets),
+        wallets,
         selectedTransfers
     );
 
@@ -2041,15 +2049,10 @@ size_t WalletGreen::doTransfer(const TransactionParameters &transactionParameter
     );
     m_logger(DEBUGGING)<< "Change address " << m_currency.accountAddressAsString(changeDestination);
 
-    std::vector<WalletOuts> wallets;
-    if (!transactionParameters.sourceAddresses.empty()) {
-        wallets = pickWallets(transactionParameters.sourceAddresses);
-    } else {
-        wallets = pickWalletsWithMoney();
-    }
+    std::vector<WalletRecord *> wallets = pickSpendingWallets(transactionParameters.sourceAddresses);
 
     PreparedTransaction preparedTransaction;
-    prepareTransaction(std::move(wallets),
+    prepareTransaction(wallets,
     transactionParameters.destinations,
     transactionParameters.fee,
     transactionParameters.mixIn,
@@ -2108,17 +2111,12 @@ size_t WalletGreen::makeTransaction(const TransactionParameters &sendingTransact
     );
     m_logger(DEBUGGING) << "Change address " << m_currency.accountAddressAsString(changeDestination);
 
-    std::vector<WalletOuts> wallets;
-    if (!sendingTransaction.sourceAddresses.empty()) {
-        wallets = pickWallets(sendingTransaction.sourceAddresses);
-    } else {
-        wallets = pickWalletsWithMoney();
-    }
+    std::vector<WalletRecord *> wallets = pickSpendingWallets(sendingTransaction.sourceAddresses);
 
     PreparedTransaction preparedTransaction;
     Crypto::SecretKey txSecretKey;
     prepareTransaction(
-    std::move(wallets),
+    wallets,
     sendingTransaction.destinations,
     sendingTransaction.fee,
     sendingTransaction.mixIn,
@@ -2725,14 +2723,29 @@ std::unique_ptr<CryptoNote::ITransaction> WalletGreen::makeTransaction(
     tx->setUnlockTime(unlockTimestamp);
     tx->appendExtra(Common::asBinaryArray(extra));
 
-    for (auto &input : keysInfo) {
-        tx->addInput(makeAccountKeys(*input.walletRecord), input.keyInfo, input.ephKeys);
+    // inputs do not depend on each other, so their keys are derived and their ring
+    // signatures computed in parallel; only their order makes it into the transaction
+    auto forEach = [](size_t count, const std::function<void(size_t)> &task) {
+        ScanningPool::signingInstance().run(count, task);
+    };
+
+    std::vector<KeyInput> inputs(keysInfo.size());
+    forEach(keysInfo.size(), [&](size_t i) {
+        InputInfo &input = keysInfo[i];
+        inputs[i] = makeKeyInput(makeAccountKeys(*input.walletRecord), input.keyInfo, input.ephKeys);
+    });
+
+    for (const auto &input : inputs) {
+        tx->addInput(input);
     }
 
-    size_t i = 0;
-    for(auto &input : keysInfo) {
-        tx->signInputKey(i++, input.keyInfo, input.ephKeys);
+    std::vector<TransactionTypes::InputKeyInfo> infos;
+    std::vector<KeyPair> ephKeys;
+    for (const auto &input : keysInfo) {
+        infos.push_back(input.keyInfo);
+        ephKeys.push_back(input.ephKeys);
     }
+    tx->signInputKeys(0, infos, ephKeys, forEach);
 
     SecretKey txkey;
     tx->getTransactionSecretKey(txkey);
@@ -2872,27 +2885,42 @@ void WalletGreen::requestMixinOuts(
         amounts.push_back(out.out.amount);
     }
 
-    System::Event requestFinished(m_dispatcher);
-    std::error_code mixinError;
-
     throwIfStopped();
 
     auto requestMixinCount = mixIn + 1; //+1 to allow to skip real output
 
-    m_logger(DEBUGGING) << "Requesting random outputs";
-    m_node.getRandomOutsByAmounts(
-        std::move(amounts),
-        requestMixinCount,
-        mixinResult,
-        [&requestFinished, &mixinError, this] (std::error_code ec) {
-        mixinError = ec;
-        this->m_dispatcher.remoteSpawn(std::bind(
-            asyncRequestCompletion,
-            std::ref(requestFinished))
-        );
-    });
+    std::error_code mixinError;
+    std::vector<size_t> missing = m_decoyCache.take(amounts, requestMixinCount, mixinResult);
+    if (!missing.empty()) {
+        std::vector<uint64_t> missingAmounts;
+        for (size_t i : missing) {
+            missingAmounts.push_back(amounts[i]);
+        }
+
+        System::Event requestFinished(m_dispatcher);
+        std::vector<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount> fetched;
+
+        m_logger(DEBUGGING)
+            << "Requesting random outputs for " << missing.size()
+            << " of " << amounts.size() << " amounts";
+        m_decoyCache.fetch(
+            std::move(missingAmounts),
+            requestMixinCount,
+            fetched,
+            [&requestFinished, &mixinError, this] (std::error_code ec) {
+            mixinError = ec;
+            this->m_dispatcher.remoteSpawn(std::bind(
+                asyncRequestCompletion,
+                std::ref(requestFinished))
+            );
+        });
+
+        requestFinished.wait();
 
-    requestFinished.wait();
+        for (size_t i = 0; i < missing.size() && i < fetched.size(); ++i) {
+            mixinResult[missing[i]].outs = std::move(fetched[i].outs);
+        }
+    }
 
     checkIfEnoughMixins(mixinResult, requestMixinCount);
 
@@ -2903,57 +2931,115 @@ void WalletGreen::requestMixinOuts(
         throw std::system_error(mixinError);
     }
 
+    // top the pools up in the background for the next transaction
+    m_decoyCache.refill();
+
     m_logger(DEBUGGING) << "Random outputs received";
 }
 
 uint64_t WalletGreen::selectTransfers(uint64_t neededMoney,
                                       bool dust,
                                       uint64_t dustThreshold,
-                                      std::vector<WalletOuts> &&wallets,
+                                      const std::vector<WalletRecord *> &wallets,
                                       std::vector<OutputToTransfer> &selectedTransfers)
 {
     uint64_t foundMoney = 0;
+    if (dustThreshold < std::numeric_limits<uint64_t>::max()) {
+        foundMoney = pickRandomTransfers(
+            neededMoney,
+            dustThreshold + 1,
+            std::numeric_limits<uint64_t>::max(),
+            false,
+            wallets,
+            selectedTransfers
+        );
+    }
 
-    typedef std::pair<WalletRecord *, TransactionOutputInformation> OutputData;
-    std::vector<OutputData> dustOutputs;
-    std::vector<OutputData> walletOuts;
-    for (auto walletIt = wallets.begin(); walletIt != wallets.end(); ++walletIt) {
-        for (auto outIt = walletIt->outs.begin(); outIt != walletIt->outs.end(); ++outIt) {
-            if (outIt->amount > dustThreshold) {
-                walletOuts.emplace_back(
-                    std::piecewise_construct,
-                    std::forward_as_tuple(walletIt->wallet),
-                    std::forward_as_tuple(*outIt)
-                );
-            } else if (dust) {
-                dustOutputs.emplace_back(
-                    std::piecewise_construct,
-                    std::forward_as_tuple(walletIt->wallet),
-                    std::forward_as_tuple(*outIt)
-                );
+    // dust goes along whenever it may, at least one output of it
+    if (dust) {
+        foundMoney += pickRandomTransfers(
+            foundMoney < neededMoney ? neededMoney - foundMoney : 0,
+            0,
+            dustThreshold,
+            true,
+            wallets,
+            selectedTransfers
+        );
+    }
+
+    return foundMoney;
+}
+
+uint64_t WalletGreen::pickRandomTransfers(uint64_t neededMoney,
+                                          uint64_t minAmount,
+                                          uint64_t maxAmount,
+                                          bool atLeastOne,
+                                          const std::vector<WalletRecord *> &wallets,
+                                          std::vector<OutputToTransfer> &selectedTransfers)
+{
+    // Outputs of all the wallets are taken in a random order without copying them: every draw
+    // goes to a wallet in proportion to its pool size and the containers pick the outputs
+    // themselves. Pool sizes are upper bounds that also count locked outputs and some outside
+    // the amount range, so this only approximates drawing from one set: a wallet with many of
+    // those gets more draws than its eligible outputs deserve, until a short answer shows its
+    // pool is used up. Draws are made in growing batches, so each container is asked once per
+    // batch.
+    std::vector<size_t> left(wallets.size());
+    size_t total = 0;
+    for (size_t i = 0; i < wallets.size(); ++i) {
+        left[i] = wallets[i]->container->getRandomOutputsPoolSize(minAmount, maxAmount);
+        total += left[i];
+    }
+
+    std::vector<std::vector<TransactionOutputInformation>> picked(wallets.size());
+    Crypto::RandomEngine<size_t> randomEngine;
+    uint64_t foundMoney = 0;
+    size_t selected = 0;
+    size_t batchSize = 16;
+    while ((foundMoney < neededMoney || (atLeastOne && selected == 0)) && total != 0) {
+        std::vector<size_t> draws;
+        std::vector<size_t> counts(wallets.size());
+        while (draws.size() < batchSize && total != 0) {
+            size_t position = std::uniform_int_distribution<size_t>(0, total - 1)(randomEngine);
+            size_t i = 0;
+            while (position >= left[i]) {
+                position -= left[i];
+                ++i;
             }
+
+            --left[i];
+            --total;
+            ++counts[i];
+            draws.push_back(i);
         }
-    }
 
-    ShuffleGenerator<size_t, Crypto::RandomEngine<size_t>> indexGenerator(walletOuts.size());
-    while (foundMoney < neededMoney && !indexGenerator.empty()) {
-        auto &out = walletOuts[indexGenerator()];
-        foundMoney += out.second.amount;
-        selectedTransfers.emplace_back(OutputToTransfer{
-            std::move(out.second), std::move(out.first)
-        });
-    }
+        std::vector<size_t> next(wallets.size());
+        for (size_t i = 0; i < wallets.size(); ++i) {
+            next[i] = picked[i].size();
+            if (counts[i] != 0
+                && wallets[i]->container->getRandomOutputs(
+                    counts[i], minAmount, maxAmount, picked[i]) < counts[i]) {
+                // the rest of its pool is locked
+                total -= left[i];
+                left[i] = 0;
+            }
+        }
 
-    if (dust && !dustOutputs.empty()) {
-        auto dustOutputsSize = dustOutputs.size();
-        ShuffleGenerator<size_t, Crypto::RandomEngine<size_t>> dustIndexGenerator(dustOutputsSize);
-        do {
-            auto &out = dustOutputs[dustIndexGenerator()];
-            foundMoney += out.second.amount;
-            selectedTransfers.emplace_back(OutputToTransfer{
-                std::move(out.second), std::move(out.first)
-            });
-        } while (foundMoney < neededMoney && !dustIndexGenerator.empty());
+        for (size_t i : draws) {
+            if (next[i] == picked[i].size()) {
+                continue;
+            }
+
+            const TransactionOutputInformation &out = picked[i][next[i]++];
+            foundMoney += out.amount;
+            selectedTransfers.emplace_back(OutputToTransfer{ out, wallets[i] });
+            ++selected;
+            if (foundMoney >= neededMoney) {
+                break;
+            }
+        }
+
+        batchSize *= 2;
     }
 
     return foundMoney;
@@ -3009,6 +3095,26 @@ std::vector<WalletGreen::WalletOuts> WalletGreen::pickWallets(
     return wallets;
 }
 
+std::vector<WalletRecord *> WalletGreen::pickSpendingWallets(
+    const std::vector<std::string> &addresses) const
+{
+    std::vector<WalletRecord *> wallets;
+    if (addresses.empty()) {
+        for (const auto &wallet : m_walletsContainer.get<RandomAccessIndex>()) {
+            if (wallet.actualBalance != 0) {
+                wallets.push_back(const_cast<WalletRecord *>(&wallet));
+            }
+        }
+    } else {
+        wallets.reserve(addresses.size());
+        for (const auto &address : addresses) {
+            wallets.push_back(const_cast<WalletRecord *>(&getWalletRecord(address)));
+        }
+    }
+
+    return wallets;
+}
+
 std::vector<CryptoNote::WalletGreen::ReceiverAmounts> WalletGreen::splitDestinations(
     const std::vector<CryptoNote::WalletTransfer> &destinations,
     uint64_t dustThreshold,
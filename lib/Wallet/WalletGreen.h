@@ -27,6 +27,7 @@
 #include <System/Event.h>
 #include <Transfers/BlockchainSynchronizer.h>
 #include <Transfers/TransfersSynchronizer.h>
+#include <Wallet/DecoyCache.h>
 #include <Wallet/IFusionManager.h>
 #include <Wallet/IWallet.h>
 #include <Wallet/WalletIndices.h>
@@ -294,6 +295,7 @@ protected:
     std::vector<WalletOuts> pickWalletsWithMoney() const;
     WalletOuts pickWallet(const std::string &address) const;
     std::vector<WalletOuts> pickWallets(const std::vector<std::string> &addresses) const;
+    std::vector<WalletRecord *> pickSpendingWallets(const std::vector<std::string> &addresses) const;
 
     void updateBalance(CryptoNote::ITransfersContainer *container);
     void unlockBalances(uint32_t height);
@@ -321,7 +323,7 @@ protected:
     };
 
     void prepareTransaction(
-        std::vector<WalletOuts> &&wallets,
+        const std::vector<WalletRecord *> &wallets,
         const std::vector<WalletOrder> &orders,
         uint64_t fee,
         uint64_t mixIn,
@@ -375,7 +377,14 @@ protected:
         uint64_t needeMoney,
         bool dust,
         uint64_t dustThreshold,
-        std::vector<WalletOuts> &&wallets,
+        const std::vector<WalletRecord *> &wallets,
+        std::vector<OutputToTransfer> &selectedTransfers);
+    uint64_t pickRandomTransfers(
+        uint64_t neededMoney,
+        uint64_t minAmount,
+        uint64_t maxAmount,
+        bool atLeastOne,
+        const std::vector<WalletRecord *> &wallets,
         std::vector<OutputToTransfer> &selectedTransfers);
 
     std::vector<ReceiverAmounts> splitDestinations(
@@ -554,6 +563,7 @@ private:
     const Currency &m_currency;
     INode& m_node;
     mutable Logging::LoggerRef m_logger;
+    DecoyCache m_decoyCache;
     bool m_stopped;
 
     WalletsContainer m_walletsContainer;
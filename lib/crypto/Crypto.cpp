@@ -28,6 +28,7 @@
 #include <cstring>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include "Common/Varint.h"
 #include "Crypto.h"
@@ -316,6 +317,102 @@ bool crypto_ops::underivePublicKey(const KeyDerivation &keyDerivation, size_t ou
     return true;
 }
 
+uint8_t crypto_ops::deriveViewTag(const KeyDerivation &derivation, size_t outputIndex)
+{
+    struct {
+        char salt[8];
+        KeyDerivation derivation;
+        char output_index[(sizeof(size_t) * 8 + 6) / 7];
+    } buf;
+    char *end = buf.output_index;
+    memcpy(buf.salt, "view_tag", sizeof(buf.salt));
+    buf.derivation = derivation;
+    Tools::write_varint(end, outputIndex);
+    assert(end <= buf.output_index + sizeof buf.output_index);
+    Hash hash;
+    cn_fast_hash(&buf, end - reinterpret_cast<char *>(&buf), hash);
+    return hash.data[0];
+}
+
+bool crypto_ops::generateKeyDerivations(size_t count, const PublicKey *publicKeys,
+                                        const SecretKey *secretKeys, KeyDerivation *derivations,
+                                        bool *valid)
+{
+    std::vector<ge_p2> points(count);
+    std::unique_ptr<fe[]> scratch(new fe[count]);
+    size_t validCount = 0;
+    ge_p3 point;
+    ge_p1p1 point2;
+    for (size_t i = 0; i < count; ++i) {
+        assert(sc_check(reinterpret_cast<const unsigned char *>(&secretKeys[i])) == 0);
+        // transactions of a block are often scanned with several keys, decompress once
+        bool decompressed = i > 0 && valid[i - 1] && publicKeys[i] == publicKeys[i - 1];
+        if (!decompressed
+            && ge_frombytes_vartime(&point,
+                                    reinterpret_cast<const unsigned char *>(&publicKeys[i]))
+                   != 0) {
+            valid[i] = false;
+            continue;
+        }
+        valid[i] = true;
+        ge_scalarmult(&points[validCount], reinterpret_cast<const unsigned char *>(&secretKeys[i]),
+                      &point);
+        ge_mul8(&point2, &points[validCount]);
+        ge_p1p1_to_p2(&points[validCount], &point2);
+        ++validCount;
+    }
+
+    std::vector<KeyDerivation> results(validCount);
+    ge_tobytes_batch(reinterpret_cast<unsigned char *>(results.data()), points.data(), validCount,
+                     scratch.get());
+    for (size_t i = 0, j = 0; i < count; ++i) {
+        if (valid[i]) {
+            derivations[i] = results[j++];
+        }
+    }
+
+    return validCount == count;
+}
+
+bool crypto_ops::underivePublicKeys(size_t count, const KeyDerivation *derivations,
+                                    const size_t *outputIndexes, const PublicKey *derivedKeys,
+                                    PublicKey *baseKeys, bool *valid)
+{
+    std::vector<ge_p2> points(count);
+    std::unique_ptr<fe[]> scratch(new fe[count]);
+    size_t validCount = 0;
+    EllipticCurveScalar scalar;
+    ge_p3 point1;
+    ge_p3 point2;
+    ge_cached point3;
+    ge_p1p1 point4;
+    for (size_t i = 0; i < count; ++i) {
+        if (ge_frombytes_vartime(&point1, reinterpret_cast<const unsigned char *>(&derivedKeys[i]))
+            != 0) {
+            valid[i] = false;
+            continue;
+        }
+        valid[i] = true;
+        derivationToScalar(derivations[i], outputIndexes[i], scalar);
+        ge_scalarmult_base(&point2, reinterpret_cast<unsigned char *>(&scalar));
+        ge_p3_to_cached(&point3, &point2);
+        ge_sub(&point4, &point1, &point3);
+        ge_p1p1_to_p2(&points[validCount], &point4);
+        ++validCount;
+    }
+
+    std::vector<PublicKey> results(validCount);
+    ge_tobytes_batch(reinterpret_cast<unsigned char *>(results.data()), points.data(), validCount,
+                     scratch.get());
+    for (size_t i = 0, j = 0; i < count; ++i) {
+        if (valid[i]) {
+            baseKeys[i] = results[j++];
+        }
+    }
+
+    return validCount == count;
+}
+
 struct sComm {
     Hash h;
     EllipticCurvePoint key;
@@ -608,7 +705,6 @@ void crypto_ops::generateRingSignature(const Hash &prefixHash, const KeyImage &k
                                        const SecretKey &secretKey, size_t secIndex,
                                        Signature *signature)
 {
-    lock_guard<mutex> lock(random_lock);
     size_t i;
     ge_p3 image_unp;
     ge_dsmp image_pre;
@@ -634,6 +730,19 @@ void crypto_ops::generateRingSignature(const Hash &prefixHash, const KeyImage &k
     if (ge_frombytes_vartime(&image_unp, reinterpret_cast<const unsigned char *>(&keyImage)) != 0) {
         abort();
     }
+    {
+        // only drawing the scalars needs the lock, inputs can be signed in parallel
+        lock_guard<mutex> lock(random_lock);
+        for (i = 0; i < pubsCount; i++) {
+            if (i == secIndex) {
+                randomScalar(k);
+            } else {
+                randomScalar(reinterpret_cast<EllipticCurveScalar &>(signature[i]));
+                randomScalar(*reinterpret_cast<EllipticCurveScalar *>(
+                        reinterpret_cast<unsigned char *>(&signature[i]) + 32));
+            }
+        }
+    }
     ge_dsm_precomp(image_pre, &image_unp);
     sc_0(reinterpret_cast<unsigned char *>(&sum));
     buf->h = prefixHash;
@@ -641,16 +750,12 @@ void crypto_ops::generateRingSignature(const Hash &prefixHash, const KeyImage &k
         ge_p2 tmp2;
         ge_p3 tmp3;
         if (i == secIndex) {
-            randomScalar(k);
             ge_scalarmult_base(&tmp3, reinterpret_cast<unsigned char *>(&k));
             ge_p3_tobytes(reinterpret_cast<unsigned char *>(&buf->ab[i].a), &tmp3);
             hashToEC(*pPublicKey[i], tmp3);
             ge_scalarmult(&tmp2, reinterpret_cast<unsigned char *>(&k), &tmp3);
             ge_tobytes(reinterpret_cast<unsigned char *>(&buf->ab[i].b), &tmp2);
         } else {
-            randomScalar(reinterpret_cast<EllipticCurveScalar &>(signature[i]));
-            randomScalar(*reinterpret_cast<EllipticCurveScalar *>(
-                    reinterpret_cast<unsigned char *>(&signature[i]) + 32));
             if (ge_frombytes_vartime(&tmp3,
                                      reinterpret_cast<const unsigned char *>(&*pPublicKey[i]))
                 != 0) {
@@ -96,6 +96,16 @@ class crypto_ops
                                   size_t, PublicKey &);
     friend bool underivePublicKey(const KeyDerivation &, size_t, const PublicKey &, const uint8_t *,
                                   size_t, PublicKey &);
+    static uint8_t deriveViewTag(const KeyDerivation &, size_t);
+    friend uint8_t deriveViewTag(const KeyDerivation &, size_t);
+    static bool generateKeyDerivations(size_t, const PublicKey *, const SecretKey *,
+                                       KeyDerivation *, bool *);
+    friend bool generateKeyDerivations(size_t, const PublicKey *, const SecretKey *,
+                                       KeyDerivation *, bool *);
+    static bool underivePublicKeys(size_t, const KeyDerivation *, const size_t *,
+                                   const PublicKey *, PublicKey *, bool *);
+    friend bool underivePublicKeys(size_t, const KeyDerivation *, const size_t *,
+                                   const PublicKey *, PublicKey *, bool *);
     static void generateSignature(const Hash &, const PublicKey &, const SecretKey &, Signature &);
     friend void generateSignature(const Hash &, const PublicKey &, const SecretKey &, Signature &);
     static bool checkSignature(const Hash &, const PublicKey &, const Signature &);
@@ -268,6 +278,39 @@ inline bool underivePublicKey(const KeyDerivation &keyDerivation,
     return crypto_ops::underivePublicKey(keyDerivation, outputIndex, derivedKey, baseKey);
 }
 
+/* A one byte tag of an output, derived from the same secret as its key. A receiver whose tag does
+ * not match can skip underivePublicKey, the output cannot be addressed to it.
+ */
+inline uint8_t deriveViewTag(const KeyDerivation &derivation, size_t outputIndex)
+{
+    return crypto_ops::deriveViewTag(derivation, outputIndex);
+}
+
+/* Batched forms of generateKeyDerivation and underivePublicKey, for scanning many outputs at once.
+ * The results are the same as calling the single functions element by element, but all points are
+ * converted to bytes with one field inversion. valid[i] is set to false where the single function
+ * would have returned false, the function returns true only if every element is valid.
+ */
+inline bool generateKeyDerivations(size_t count,
+                                   const PublicKey *publicKeys,
+                                   const SecretKey *secretKeys,
+                                   KeyDerivation *derivations,
+                                   bool *valid)
+{
+    return crypto_ops::generateKeyDerivations(count, publicKeys, secretKeys, derivations, valid);
+}
+
+inline bool underivePublicKeys(size_t count,
+                               const KeyDerivation *derivations,
+                               const size_t *outputIndexes,
+                               const PublicKey *derivedKeys,
+                               PublicKey *baseKeys,
+                               bool *valid)
+{
+    return crypto_ops::underivePublicKeys(count, derivations, outputIndexes, derivedKeys, baseKeys,
+                                          valid);
+}
+
 /* Generation and checking of a standard signature.
  */
 inline void generateSignature(const Hash &prefixHash,
@@ -17,6 +17,7 @@
 // along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <assert.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "crypto-ops.h"
@@ -2907,3 +2908,37 @@ int sc_isnonzero(const unsigned char *s) {
     s[18] | s[19] | s[20] | s[21] | s[22] | s[23] | s[24] | s[25] | s[26] |
     s[27] | s[28] | s[29] | s[30] | s[31]) - 1) >> 8) + 1;
 }
+
+/* Same as ge_tobytes on each of the count points, with a single field inversion
+   (Montgomery's trick). scratch holds count field elements. */
+void ge_tobytes_batch(unsigned char *s, const ge_p2 *h, size_t count, fe *scratch) {
+  fe inverse;
+  fe recip;
+  fe x;
+  fe y;
+  size_t i;
+
+  if (count == 0) {
+    return;
+  }
+
+  fe_copy(scratch[0], h[0].Z);
+  for (i = 1; i < count; ++i) {
+    fe_mul(scratch[i], scratch[i - 1], h[i].Z);
+  }
+
+  fe_invert(inverse, scratch[count - 1]);
+  for (i = count - 1; i > 0; --i) {
+    fe_mul(recip, inverse, scratch[i - 1]);
+    fe_mul(inverse, inverse, h[i].Z);
+    fe_mul(x, h[i].X, recip);
+    fe_mul(y, h[i].Y, recip);
+    fe_tobytes(s + 32 * i, y);
+    s[32 * i + 31] ^= fe_isnegative(x) << 7;
+  }
+
+  fe_mul(x, h[0].X, inverse);
+  fe_mul(y, h[0].Y, inverse);
+  fe_tobytes(s, y);
+  s[31] ^= fe_isnegative(x) << 7;
+}
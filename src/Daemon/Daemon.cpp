@@ -449,6 +449,11 @@ int main(int argc, char *argv[])
         logger(INFO) << "Starting core rpc server on address " << rpcConfig.getBindAddress();
         rpcServer.start(rpcConfig.bindIp, rpcConfig.bindPort);
         rpcServer.restrictRPC(command_line::get_arg(vm, arg_restricted_rpc));
+        if (command_line::get_arg(vm, arg_restricted_rpc)) {
+            rpcServer.setAdmissionLimits(rpcConfig.maxActiveRequests,
+                                         rpcConfig.clientRate,
+                                         rpcConfig.clientBurst);
+        }
         rpcServer.enableCors(command_line::get_arg(vm, arg_enable_cors));
         if (command_line::has_arg(vm, arg_set_fee_address)) {
             std::string addr_str = command_line::get_arg(vm, arg_set_fee_address);
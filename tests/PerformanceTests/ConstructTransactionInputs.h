@@ -0,0 +1,122 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/TransactionApi.h"
+#include "CryptoNoteCore/TransactionUtils.h"
+#include "Transfers/ScanningPool.h"
+
+#include "crypto/Crypto.h"
+
+// Builds the inputs of a transaction spending inputs_count outputs, each hidden among mixin
+// decoys, the way WalletGreen::makeTransaction does: key images first, ring signatures after.
+// parallel spreads both over the signing pool, otherwise inputs are added and signed one by one.
+template<size_t inputs_count, size_t mixin, bool parallel>
+class test_construct_tx_inputs
+{
+public:
+  static const size_t loop_count = 10;
+
+  bool init()
+  {
+    using namespace CryptoNote;
+
+    m_sender.generate();
+    const AccountKeys& keys = m_sender.getAccountKeys();
+
+    for (size_t i = 0; i < inputs_count; ++i) {
+      KeyPair sourceTxKeys = generateKeyPair();
+      const size_t outputInTransaction = i % 4;
+      const size_t realIndex = i % (mixin + 1);
+
+      TransactionTypes::InputKeyInfo info;
+      info.amount = 1000;
+      for (size_t j = 0; j <= mixin; ++j) {
+        TransactionTypes::GlobalOutput output;
+        output.outputIndex = static_cast<uint32_t>(i * (mixin + 1) + j);
+        if (j == realIndex) {
+          Crypto::KeyDerivation derivation;
+          Crypto::generateKeyDerivation(sourceTxKeys.publicKey, keys.viewSecretKey, derivation);
+          Crypto::derivePublicKey(derivation, outputInTransaction, keys.address.spendPublicKey, output.targetKey);
+        } else {
+          output.targetKey = generateKeyPair().publicKey;
+        }
+
+        info.outputs.push_back(output);
+      }
+
+      info.realOutput.transactionPublicKey = sourceTxKeys.publicKey;
+      info.realOutput.transactionIndex = realIndex;
+      info.realOutput.outputInTransaction = outputInTransaction;
+      m_infos.push_back(info);
+    }
+
+    m_receiver.generate();
+
+    return true;
+  }
+
+  bool test()
+  {
+    using namespace CryptoNote;
+
+    std::unique_ptr<ITransaction> tx = createTransaction();
+    tx->addOutput(1000 * inputs_count, m_receiver.getAccountKeys().address);
+
+    const AccountKeys& keys = m_sender.getAccountKeys();
+    std::vector<KeyPair> ephKeys(inputs_count);
+    if (!parallel) {
+      for (size_t i = 0; i < inputs_count; ++i) {
+        tx->addInput(keys, m_infos[i], ephKeys[i]);
+      }
+
+      for (size_t i = 0; i < inputs_count; ++i) {
+        tx->signInputKey(i, m_infos[i], ephKeys[i]);
+      }
+
+      return tx->validateSignatures();
+    }
+
+    auto forEach = [](size_t count, const std::function<void(size_t)>& task) {
+      ScanningPool::signingInstance().run(count, task);
+    };
+
+    std::vector<KeyInput> inputs(inputs_count);
+    forEach(inputs_count, [&](size_t i) {
+      inputs[i] = makeKeyInput(keys, m_infos[i], ephKeys[i]);
+    });
+
+    for (const auto& input : inputs) {
+      tx->addInput(input);
+    }
+
+    tx->signInputKeys(0, m_infos, ephKeys, forEach);
+
+    return tx->validateSignatures();
+  }
+
+private:
+  CryptoNote::AccountBase m_sender;
+  CryptoNote::AccountBase m_receiver;
+  std::vector<CryptoNote::TransactionTypes::InputKeyInfo> m_infos;
+};
@@ -0,0 +1,121 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <sstream>
+#include <string>
+
+#include <Http/HttpParser.h>
+
+#include "PerformanceTests.h"
+
+// A batch of pipelined getheight requests answered the way HttpServer does it, without
+// the socket. in_place selects parsing from the buffer over the std::istream parser.
+template<size_t requests_count, bool in_place>
+class test_http_pipeline
+{
+public:
+  static const size_t loop_count = 100;
+
+  bool init()
+  {
+    for (size_t i = 0; i < requests_count; ++i) {
+      m_input +=
+        "POST /getheight HTTP/1.1\r\n"
+        "Host: 127.0.0.1:8197\r\n"
+        "User-Agent: curl/7.68.0\r\n"
+        "Accept: */*\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: 2\r\n"
+        "\r\n"
+        "{}";
+    }
+
+    performance_timer timer;
+    timer.start();
+    for (size_t i = 0; i < loop_count; ++i) {
+      test();
+    }
+
+    int elapsed = std::max(timer.elapsed_ms(), 1);
+    std::cout << "  requests/s:    " << requests_count * loop_count * 1000 / elapsed << std::endl;
+    return true;
+  }
+
+  bool test()
+  {
+    return (in_place ? serve_in_place() : serve_stream()) == requests_count;
+  }
+
+private:
+  static void respond(const CryptoNote::HttpRequest &request, CryptoNote::HttpResponse &response)
+  {
+    response.addHeader("Access-Control-Allow-Origin", "*");
+    response.addHeader("Content-Type", "application/json");
+    response.setBody("{\"height\":1234567,\"network_height\":1234567,\"status\":\"OK\"}");
+  }
+
+  size_t serve_in_place()
+  {
+    std::string output;
+    size_t served = 0;
+    size_t parsed = 0;
+
+    for (;;) {
+      CryptoNote::HttpRequest request;
+      size_t size = CryptoNote::HttpParser::parseRequest(m_input.data() + parsed,
+                                                         m_input.size() - parsed,
+                                                         request);
+      if (size == 0) {
+        break;
+      }
+
+      parsed += size;
+
+      CryptoNote::HttpResponse response;
+      respond(request, response);
+      response.appendHead(output);
+      output += response.getBody();
+      ++served;
+    }
+
+    return served;
+  }
+
+  size_t serve_stream()
+  {
+    std::istringstream input(m_input);
+    std::ostringstream output;
+    CryptoNote::HttpParser parser;
+    size_t served = 0;
+
+    while (input.peek() != std::istream::traits_type::eof()) {
+      CryptoNote::HttpRequest request;
+      parser.receiveRequest(input, request);
+
+      CryptoNote::HttpResponse response;
+      respond(request, response);
+      output << response;
+      ++served;
+    }
+
+    return served;
+  }
+
+  std::string m_input;
+};
@@ -0,0 +1,144 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <Common/StringTools.h>
+#include <crypto/Crypto.h>
+#include <Rpc/CoreRpcServerCommandsDefinitions.h>
+#include <Serialization/JsonInputValueSerializer.h>
+#include <Serialization/JsonOutputStreamSerializer.h>
+#include <Serialization/JsonStreamingInputSerializer.h>
+#include <Serialization/JsonStreamingOutputSerializer.h>
+
+#include "PerformanceTests.h"
+
+// f_blocks_list_json sized response, written or read either through a JsonValue tree or streamed
+template<size_t blocks_count>
+class json_serialization_test_base
+{
+public:
+  static const size_t loop_count = 20;
+
+protected:
+  void make_response()
+  {
+    for (size_t i = 0; i < blocks_count; ++i) {
+      CryptoNote::BLOCK_SHORT_RESPONSE block;
+      block.timestamp = 1500000000 + i * 120;
+      block.height = static_cast<uint32_t>(i);
+      block.hash = Common::podToHex(Crypto::rand<Crypto::Hash>());
+      block.cumul_size = 400 + i % 1000;
+      block.tx_count = i % 7;
+      block.reward = 100000000000 + i;
+      block.difficulty = 1000000 + i * 3;
+      block.min_tx_fee = 100000;
+      m_response.blocks.push_back(block);
+    }
+    m_response.status = CORE_RPC_STATUS_OK;
+  }
+
+  static std::string store_dom(CryptoNote::COMMAND_RPC_GET_BLOCKS_LIST::response &response)
+  {
+    CryptoNote::JsonOutputStreamSerializer s;
+    serialize(response, s);
+    return s.getValue().toString();
+  }
+
+  static std::string store_streaming(CryptoNote::COMMAND_RPC_GET_BLOCKS_LIST::response &response)
+  {
+    std::string text;
+    CryptoNote::JsonStreamingOutputSerializer s(text);
+    serialize(response, s);
+    s.finish();
+    return text;
+  }
+
+  static void load_dom(const std::string &text, CryptoNote::COMMAND_RPC_GET_BLOCKS_LIST::response &response)
+  {
+    CryptoNote::JsonInputValueSerializer s(Common::JsonValue::fromString(text));
+    serialize(response, s);
+  }
+
+  static void load_streaming(const std::string &text, CryptoNote::COMMAND_RPC_GET_BLOCKS_LIST::response &response)
+  {
+    CryptoNote::JsonStreamingInputSerializer s(text);
+    serialize(response, s);
+  }
+
+  template<typename F>
+  void report_throughput(F f)
+  {
+    performance_timer timer;
+    timer.start();
+    for (size_t i = 0; i < loop_count; ++i) {
+      f();
+    }
+
+    int elapsed = std::max(timer.elapsed_ms(), 1);
+    std::cout << "  payload:       " << m_text.size() << " bytes\n";
+    std::cout << "  throughput:    " << m_text.size() * loop_count * 1000 / elapsed / (1024 * 1024)
+              << " MB/s" << std::endl;
+  }
+
+  CryptoNote::COMMAND_RPC_GET_BLOCKS_LIST::response m_response;
+  std::string m_text;
+};
+
+template<size_t blocks_count, bool streaming>
+class test_json_store : public json_serialization_test_base<blocks_count>
+{
+public:
+  bool init()
+  {
+    this->make_response();
+    this->m_text = this->store_streaming(this->m_response);
+    this->report_throughput([this] { test(); });
+    return true;
+  }
+
+  bool test()
+  {
+    std::string text = streaming ? this->store_streaming(this->m_response)
+                                 : this->store_dom(this->m_response);
+    return text.size() == this->m_text.size();
+  }
+};
+
+template<size_t blocks_count, bool streaming>
+class test_json_load : public json_serialization_test_base<blocks_count>
+{
+public:
+  bool init()
+  {
+    this->make_response();
+    this->m_text = this->store_streaming(this->m_response);
+    this->report_throughput([this] { test(); });
+    return true;
+  }
+
+  bool test()
+  {
+    CryptoNote::COMMAND_RPC_GET_BLOCKS_LIST::response response;
+    if (streaming) {
+      this->load_streaming(this->m_text, response);
+    } else {
+      this->load_dom(this->m_text, response);
+    }
+    return response.blocks.size() == blocks_count;
+  }
+};
@@ -0,0 +1,153 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <crypto/Crypto.h>
+#include <CryptoNoteProtocol/CryptoNoteProtocolDefinitions.h>
+#include <P2p/LevinProtocol.h>
+#include <Rpc/CoreRpcServerCommandsDefinitions.h>
+
+#include "PerformanceTests.h"
+
+// a sync batch: few members, large blobs
+struct kv_objects_message
+{
+  typedef CryptoNote::NOTIFY_RESPONSE_GET_OBJECTS::request type;
+
+  static bool check(const type &message, size_t count) { return message.blocks.size() == count; }
+
+  static type make(size_t count)
+  {
+    type message;
+    message.current_blockchain_height = static_cast<uint32_t>(count);
+    for (size_t i = 0; i < count; ++i) {
+      CryptoNote::BlockCompleteEntry entry;
+      entry.block = random_blob(300);
+      for (size_t j = 0; j < 4; ++j) {
+        entry.txs.push_back(random_blob(600));
+      }
+      message.blocks.push_back(std::move(entry));
+    }
+    message.missed_ids.push_back(Crypto::rand<Crypto::Hash>());
+    return message;
+  }
+
+  static std::string random_blob(size_t size)
+  {
+    std::string blob(size, '\0');
+    for (auto &c : blob) {
+      c = static_cast<char>(Crypto::rand<uint8_t>());
+    }
+    return blob;
+  }
+};
+
+// a stats range: many small objects of scalar members
+struct kv_stats_message
+{
+  typedef CryptoNote::COMMAND_RPC_GET_STATS_BY_HEIGHTS_RANGE::response type;
+
+  static bool check(const type &message, size_t count) { return message.stats.size() == count; }
+
+  static type make(size_t count)
+  {
+    type message;
+    for (size_t i = 0; i < count; ++i) {
+      CryptoNote::BLOCK_STATS_ENTRY entry;
+      entry.height = static_cast<uint32_t>(i);
+      entry.alreadyGeneratedCoins = 1000000000000 + i;
+      entry.transactionsCount = i % 7;
+      entry.blockSize = 400 + i % 1000;
+      entry.difficulty = 1000000 + i * 3;
+      entry.reward = 100000000000 + i;
+      entry.timestamp = 1500000000 + i * 120;
+      entry.minFee = 100000;
+      message.stats.push_back(entry);
+    }
+    message.duration = 0.5;
+    message.status = CORE_RPC_STATUS_OK;
+    return message;
+  }
+};
+
+// KV binary as the P2P layer and the .bin RPC methods write and read it
+template<typename message, size_t count>
+class kv_serialization_test_base
+{
+public:
+  static const size_t loop_count = 50;
+
+protected:
+  void prepare()
+  {
+    m_message = message::make(count);
+    m_payload = CryptoNote::LevinProtocol::encode(m_message);
+  }
+
+  template<typename F>
+  void report_throughput(F f)
+  {
+    performance_timer timer;
+    timer.start();
+    for (size_t i = 0; i < loop_count; ++i) {
+      f();
+    }
+
+    int elapsed = std::max(timer.elapsed_ms(), 1);
+    std::cout << "  payload:       " << m_payload.size() << " bytes\n";
+    std::cout << "  throughput:    " << m_payload.size() * loop_count * 1000 / elapsed / (1024 * 1024)
+              << " MB/s" << std::endl;
+  }
+
+  typename message::type m_message;
+  CryptoNote::BinaryArray m_payload;
+};
+
+template<typename message, size_t count>
+class test_kv_store : public kv_serialization_test_base<message, count>
+{
+public:
+  bool init()
+  {
+    this->prepare();
+    this->report_throughput([this] { test(); });
+    return true;
+  }
+
+  bool test()
+  {
+    return CryptoNote::LevinProtocol::encode(this->m_message).size() == this->m_payload.size();
+  }
+};
+
+template<typename message, size_t count>
+class test_kv_load : public kv_serialization_test_base<message, count>
+{
+public:
+  bool init()
+  {
+    this->prepare();
+    this->report_throughput([this] { test(); });
+    return true;
+  }
+
+  bool test()
+  {
+    typename message::type decoded;
+    return CryptoNote::LevinProtocol::decode(this->m_payload, decoded) && message::check(decoded, count);
+  }
+};
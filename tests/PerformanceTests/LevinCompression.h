@@ -0,0 +1,127 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolDefinitions.h"
+#include "P2p/LevinProtocol.h"
+
+#include <Logging/LoggerGroup.h>
+
+class levin_compression_test_base
+{
+public:
+  bool test()
+  {
+    CryptoNote::BinaryArray compressed = CryptoNote::LevinProtocol::compress(m_payload);
+    return CryptoNote::LevinProtocol::decompress(compressed, m_decompressed) && m_decompressed == m_payload;
+  }
+
+protected:
+  void report_ratio()
+  {
+    size_t compressed = CryptoNote::LevinProtocol::compress(m_payload).size();
+    std::cout << "  payload:       " << m_payload.size() << " bytes\n";
+    std::cout << "  compressed:    " << compressed << " bytes ("
+              << (m_payload.size() - std::min(compressed, m_payload.size())) * 100 / m_payload.size()
+              << "% saved)" << std::endl;
+  }
+
+  CryptoNote::BinaryArray m_payload;
+  CryptoNote::BinaryArray m_decompressed;
+};
+
+// NOTIFY_RESPONSE_GET_OBJECTS carrying a full sync batch
+template<size_t blocks_count, size_t txs_per_block>
+class test_levin_compression_objects : public levin_compression_test_base
+{
+public:
+  static const size_t loop_count = 20;
+
+  bool init()
+  {
+    using namespace CryptoNote;
+
+    Logging::LoggerGroup nullLog;
+    Currency currency = CurrencyBuilder(nullLog).currency();
+
+    NOTIFY_RESPONSE_GET_OBJECTS::request response;
+    response.current_blockchain_height = blocks_count;
+
+    for (size_t i = 0; i < blocks_count; ++i) {
+      BlockCompleteEntry entry;
+
+      Block block = boost::value_initialized<Block>();
+      block.majorVersion = BLOCK_MAJOR_VERSION_1;
+      block.timestamp = 1500000000 + i * 120;
+      if (!make_miner_tx(currency, static_cast<uint32_t>(i), block.baseTransaction))
+        return false;
+
+      for (size_t j = 0; j < txs_per_block; ++j) {
+        Transaction tx;
+        if (!make_miner_tx(currency, static_cast<uint32_t>(i), tx))
+          return false;
+
+        block.transactionHashes.push_back(getObjectHash(tx));
+        entry.txs.push_back(Common::asString(toBinaryArray(tx)));
+      }
+
+      entry.block = Common::asString(toBinaryArray(block));
+      response.blocks.push_back(std::move(entry));
+    }
+
+    m_payload = LevinProtocol::encode(response);
+    report_ratio();
+    return true;
+  }
+
+private:
+  static bool make_miner_tx(const CryptoNote::Currency &currency, uint32_t height, CryptoNote::Transaction &tx)
+  {
+    CryptoNote::AccountBase account;
+    account.generate();
+    return currency.constructMinerTx(CryptoNote::BLOCK_MAJOR_VERSION_1, height, 0, 0, 2, 0,
+                                     account.getAccountKeys().address, tx);
+  }
+};
+
+// NOTIFY_RESPONSE_CHAIN_ENTRY carrying a full list of block ids
+class test_levin_compression_chain_entry : public levin_compression_test_base
+{
+public:
+  static const size_t loop_count = 20;
+
+  bool init()
+  {
+    using namespace CryptoNote;
+
+    NOTIFY_RESPONSE_CHAIN_ENTRY::request response;
+    response.start_height = 0;
+    response.total_height = static_cast<uint32_t>(BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT);
+    for (size_t i = 0; i < BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT; ++i) {
+      response.m_block_ids.push_back(Crypto::rand<Crypto::Hash>());
+    }
+
+    m_payload = LevinProtocol::encode(response);
+    report_ratio();
+    return true;
+  }
+};
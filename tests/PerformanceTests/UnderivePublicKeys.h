@@ -0,0 +1,105 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "crypto/Crypto.h"
+
+// Scans outputs_count outputs of one transaction the way the wallet does: the view key
+// derivation followed by underivePublicKey on every output. batched selects
+// underivePublicKeys over one call per output.
+template<size_t outputs_count, bool batched>
+class test_underive_public_keys
+{
+public:
+  static const size_t loop_count = 100;
+
+  bool init()
+  {
+    Crypto::PublicKey txPublicKey;
+    Crypto::SecretKey txSecretKey;
+    Crypto::generateKeys(txPublicKey, txSecretKey);
+    Crypto::PublicKey viewPublicKey;
+    Crypto::generateKeys(viewPublicKey, m_viewSecretKey);
+    Crypto::PublicKey spendPublicKey;
+    Crypto::SecretKey spendSecretKey;
+    Crypto::generateKeys(spendPublicKey, spendSecretKey);
+
+    m_txPublicKeys.assign(outputs_count, txPublicKey);
+    m_viewSecretKeys.assign(outputs_count, m_viewSecretKey);
+
+    Crypto::KeyDerivation derivation;
+    if (!Crypto::generateKeyDerivation(viewPublicKey, txSecretKey, derivation)) {
+      return false;
+    }
+
+    m_outputKeys.resize(outputs_count);
+    m_outputIndexes.resize(outputs_count);
+    for (size_t i = 0; i < outputs_count; ++i) {
+      m_outputIndexes[i] = i;
+      if (!Crypto::derivePublicKey(derivation, i, spendPublicKey, m_outputKeys[i])) {
+        return false;
+      }
+    }
+
+    m_derivations.resize(outputs_count);
+    m_spendKeys.resize(outputs_count);
+    m_valid.reset(new bool[outputs_count]);
+    return true;
+  }
+
+  bool test()
+  {
+    if (batched) {
+      if (!Crypto::generateKeyDerivations(1, m_txPublicKeys.data(), m_viewSecretKeys.data(),
+                                          m_derivations.data(), m_valid.get())) {
+        return false;
+      }
+
+      std::fill(m_derivations.begin() + 1, m_derivations.end(), m_derivations[0]);
+      return Crypto::underivePublicKeys(outputs_count, m_derivations.data(), m_outputIndexes.data(),
+                                        m_outputKeys.data(), m_spendKeys.data(), m_valid.get());
+    }
+
+    Crypto::KeyDerivation derivation;
+    if (!Crypto::generateKeyDerivation(m_txPublicKeys[0], m_viewSecretKey, derivation)) {
+      return false;
+    }
+
+    for (size_t i = 0; i < outputs_count; ++i) {
+      if (!Crypto::underivePublicKey(derivation, i, m_outputKeys[i], m_spendKeys[i])) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+private:
+  Crypto::SecretKey m_viewSecretKey;
+  std::vector<Crypto::PublicKey> m_txPublicKeys;
+  std::vector<Crypto::SecretKey> m_viewSecretKeys;
+  std::vector<Crypto::PublicKey> m_outputKeys;
+  std::vector<size_t> m_outputIndexes;
+  std::vector<Crypto::KeyDerivation> m_derivations;
+  std::vector<Crypto::PublicKey> m_spendKeys;
+  std::unique_ptr<bool[]> m_valid;
+};
@@ -0,0 +1,114 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
+#include "crypto/Crypto.h"
+
+#include "PerformanceTests.h"
+
+// Checks outputs_count outputs of one transaction, none of them ours, the way findMyOutputs
+// does. view_tags rejects them by their view tag first, so the difference between the two
+// runs is the scan time the tags remove.
+template<size_t outputs_count, bool view_tags>
+class test_view_tag_scan
+{
+public:
+  static const size_t loop_count = 100;
+
+  bool init()
+  {
+    Crypto::PublicKey txPublicKey;
+    Crypto::SecretKey txSecretKey;
+    Crypto::generateKeys(txPublicKey, txSecretKey);
+    Crypto::PublicKey viewPublicKey;
+    Crypto::generateKeys(viewPublicKey, m_viewSecretKey);
+    Crypto::PublicKey spendPublicKey;
+    Crypto::SecretKey spendSecretKey;
+    Crypto::generateKeys(spendPublicKey, spendSecretKey);
+    m_spendKeys.insert(spendPublicKey);
+    m_txPublicKey = txPublicKey;
+
+    // outputs to other receivers, tagged for them
+    for (size_t i = 0; i < outputs_count; ++i) {
+      Crypto::PublicKey otherView;
+      Crypto::SecretKey otherViewSecret;
+      Crypto::generateKeys(otherView, otherViewSecret);
+      Crypto::PublicKey otherSpend;
+      Crypto::SecretKey otherSpendSecret;
+      Crypto::generateKeys(otherSpend, otherSpendSecret);
+
+      Crypto::KeyDerivation derivation;
+      Crypto::PublicKey outputKey;
+      if (!Crypto::generateKeyDerivation(otherView, txSecretKey, derivation)
+          || !Crypto::derivePublicKey(derivation, i, otherSpend, outputKey)) {
+        return false;
+      }
+
+      m_outputKeys.push_back(outputKey);
+      m_tags.push_back(Crypto::deriveViewTag(derivation, i));
+    }
+
+    performance_timer timer;
+    timer.start();
+    for (size_t i = 0; i < loop_count; ++i) {
+      test();
+    }
+
+    int elapsed = std::max(timer.elapsed_ms(), 1);
+    std::cout << "  outputs/s:     " << outputs_count * loop_count * 1000 / elapsed << std::endl;
+    std::cout << "  underived:     " << m_underived << " of " << outputs_count << std::endl;
+    return true;
+  }
+
+  bool test()
+  {
+    Crypto::KeyDerivation derivation;
+    if (!Crypto::generateKeyDerivation(m_txPublicKey, m_viewSecretKey, derivation)) {
+      return false;
+    }
+
+    m_underived = 0;
+    for (size_t i = 0; i < outputs_count; ++i) {
+      if (view_tags && Crypto::deriveViewTag(derivation, i) != m_tags[i]) {
+        continue;
+      }
+
+      Crypto::PublicKey spendKey;
+      Crypto::underivePublicKey(derivation, i, m_outputKeys[i], spendKey);
+      if (m_spendKeys.count(spendKey) != 0) {
+        return false;
+      }
+
+      ++m_underived;
+    }
+
+    return true;
+  }
+
+private:
+  Crypto::SecretKey m_viewSecretKey;
+  Crypto::PublicKey m_txPublicKey;
+  std::unordered_set<Crypto::PublicKey> m_spendKeys;
+  std::vector<Crypto::PublicKey> m_outputKeys;
+  std::vector<uint8_t> m_tags;
+  size_t m_underived = 0;
+};
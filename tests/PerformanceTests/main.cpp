@@ -21,6 +21,7 @@
 
 // tests
 #include "ConstructTransaction.h"
+#include "ConstructTransactionInputs.h"
 #include "CheckRingSignature.h"
 #include "CryptoNoteSlowHash.h"
 #include "DerivePublicKey.h"
@@ -28,10 +29,19 @@
 #include "GenerateKeyDerivation.h"
 #include "GenerateKeyImage.h"
 #include "GenerateKeyImageHelper.h"
+#include "HttpPipeline.h"
 #include "IsOutToAccount.h"
+#include "JsonSerialization.h"
+#include "KVSerialization.h"
+#include "LevinCompression.h"
+#include "UnderivePublicKeys.h"
+#include "ViewTagScan.h"
 
 int main(int argc, char** argv)
 {
+  // the pool threads are started first, so they are not pinned to the core of the main thread
+  CryptoNote::ScanningPool::instance();
+  CryptoNote::ScanningPool::signingInstance();
   set_process_affinity(1);
   set_thread_high_priority();
 
@@ -59,6 +69,13 @@ int main(int argc, char** argv)
   TEST_PERFORMANCE2(test_construct_tx, 100, 10);
   TEST_PERFORMANCE2(test_construct_tx, 100, 100);
 
+  TEST_PERFORMANCE3(test_construct_tx_inputs, 100, 3, false);
+  TEST_PERFORMANCE3(test_construct_tx_inputs, 100, 3, true);
+  TEST_PERFORMANCE3(test_construct_tx_inputs, 100, 10, false);
+  TEST_PERFORMANCE3(test_construct_tx_inputs, 100, 10, true);
+  TEST_PERFORMANCE3(test_construct_tx_inputs, 300, 10, false);
+  TEST_PERFORMANCE3(test_construct_tx_inputs, 300, 10, true);
+
   TEST_PERFORMANCE1(test_check_ring_signature, 1);
   TEST_PERFORMANCE1(test_check_ring_signature, 2);
   TEST_PERFORMANCE1(test_check_ring_signature, 10);
@@ -71,8 +88,34 @@ int main(int argc, char** argv)
   TEST_PERFORMANCE0(test_derive_public_key);
   TEST_PERFORMANCE0(test_derive_secret_key);
 
+  TEST_PERFORMANCE2(test_underive_public_keys, 2, false);
+  TEST_PERFORMANCE2(test_underive_public_keys, 2, true);
+  TEST_PERFORMANCE2(test_underive_public_keys, 16, false);
+  TEST_PERFORMANCE2(test_underive_public_keys, 16, true);
+  TEST_PERFORMANCE2(test_underive_public_keys, 128, false);
+  TEST_PERFORMANCE2(test_underive_public_keys, 128, true);
+  TEST_PERFORMANCE2(test_view_tag_scan, 128, false);
+  TEST_PERFORMANCE2(test_view_tag_scan, 128, true);
+
   TEST_PERFORMANCE0(test_cn_slow_hash);
 
+  TEST_PERFORMANCE2(test_levin_compression_objects, 128, 0);
+  TEST_PERFORMANCE2(test_levin_compression_objects, 128, 10);
+  TEST_PERFORMANCE0(test_levin_compression_chain_entry);
+
+  TEST_PERFORMANCE2(test_json_store, 10000, false);
+  TEST_PERFORMANCE2(test_json_store, 10000, true);
+  TEST_PERFORMANCE2(test_json_load, 10000, false);
+  TEST_PERFORMANCE2(test_json_load, 10000, true);
+
+  TEST_PERFORMANCE2(test_kv_store, kv_objects_message, 200);
+  TEST_PERFORMANCE2(test_kv_load, kv_objects_message, 200);
+  TEST_PERFORMANCE2(test_kv_store, kv_stats_message, 10000);
+  TEST_PERFORMANCE2(test_kv_load, kv_stats_message, 10000);
+
+  TEST_PERFORMANCE2(test_http_pipeline, 1000, false);
+  TEST_PERFORMANCE2(test_http_pipeline, 1000, true);
+
   std::cout << "Tests finished. Elapsed time: " << timer.elapsed_ms() / 1000 << " sec" << std::endl;
 
   return 0;
@@ -135,3 +135,118 @@ TEST(KVSerialize, BigCollection) {
   ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(ts2, buf));
   EXPECT_EQ(ts1, ts2);
 }
+
+namespace {
+
+struct WideStruct {
+  uint32_t values[80] = {};
+  std::vector<std::string> names;
+
+  void serialize(ISerializer& s) {
+    names.resize(80);
+    for (size_t i = 0; i < 80; ++i) {
+      names[i] = "f" + std::to_string(i);
+      s(values[i], names[i]);
+    }
+  }
+};
+
+struct WideHolder {
+  WideStruct wide;
+  std::vector<WideStruct> list;
+  uint8_t tail = 0;
+
+  void serialize(ISerializer& s) {
+    s(wide, "wide");
+    s(list, "list");
+    s(tail, "tail");
+  }
+};
+
+struct NumbersStruct {
+  std::vector<uint32_t> numbers;
+
+  void serialize(ISerializer& s) {
+    s(numbers, "numbers");
+  }
+};
+
+}
+
+TEST(KVSerialize, ObjectWithMoreThan63Members) {
+  WideHolder holder1;
+  for (uint32_t i = 0; i < 80; ++i) {
+    holder1.wide.values[i] = i * 3;
+  }
+  holder1.list.resize(3, holder1.wide);
+  holder1.tail = 42;
+
+  WideHolder holder2;
+  ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(holder2, CryptoNote::storeToBinaryKeyValue(holder1)));
+
+  ASSERT_EQ(3, holder2.list.size());
+  for (size_t i = 0; i < 80; ++i) {
+    EXPECT_EQ(holder1.wide.values[i], holder2.wide.values[i]);
+    EXPECT_EQ(holder1.wide.values[i], holder2.list[2].values[i]);
+  }
+  EXPECT_EQ(42, holder2.tail);
+}
+
+TEST(KVSerialize, MissingMembersKeepTheirValues) {
+  NumbersStruct empty;
+
+  TestElement element;
+  element.name = "kept";
+  element.nonce = 7;
+
+  ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(element, CryptoNote::storeToBinaryKeyValue(empty)));
+  EXPECT_EQ("kept", element.name);
+  EXPECT_EQ(7, element.nonce);
+}
+
+TEST(KVSerialize, TypeMismatchFails) {
+  TestElement element;
+  element.name = "text";
+
+  std::string buf = CryptoNote::storeToBinaryKeyValue(element);
+  // "name" holds a string, reading it as an integer must fail rather than guess
+  buf.replace(buf.find("name"), 4, "nums");
+
+  struct Renamed {
+    uint32_t nums = 0;
+    void serialize(ISerializer& s) { s(nums, "nums"); }
+  } renamed;
+
+  EXPECT_FALSE(CryptoNote::loadFromBinaryKeyValue(renamed, buf));
+}
+
+TEST(KVSerialize, TruncatedDataFails) {
+  TestStruct ts;
+  ts.u8 = 1;
+  ts.u32 = 2;
+  ts.u64 = 3;
+  ts.root.name = "root";
+  ts.vec1.resize(3);
+  ts.vec1[1].u32array = { 1, 2, 3 };
+
+  std::string buf = CryptoNote::storeToBinaryKeyValue(ts);
+  for (size_t size = 0; size < buf.size(); ++size) {
+    TestStruct loaded;
+    EXPECT_FALSE(CryptoNote::loadFromBinaryKeyValue(loaded, buf.substr(0, size))) << size;
+  }
+}
+
+TEST(KVSerialize, ForgedArraySizeFails) {
+  NumbersStruct numbers;
+  numbers.numbers = { 1, 2 };
+
+  std::string buf = CryptoNote::storeToBinaryKeyValue(numbers);
+  // widen the element count to a 4 byte varint claiming a billion elements
+  size_t countOffset = buf.find("numbers") + 8;
+  ASSERT_EQ(2 << 2, buf[countOffset]);
+  uint32_t forged = (1000000000u << 2) | 2;
+  buf.replace(countOffset, 1, reinterpret_cast<const char*>(&forged), sizeof(forged));
+
+  NumbersStruct loaded;
+  EXPECT_FALSE(CryptoNote::loadFromBinaryKeyValue(loaded, buf));
+}
@@ -0,0 +1,152 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "crypto/Crypto.h"
+
+using namespace Crypto;
+
+namespace {
+
+PublicKey invalidPublicKey()
+{
+  // y = 2 is not the y coordinate of any point on the curve
+  PublicKey key = PublicKey();
+  key.data[0] = 2;
+  EXPECT_FALSE(checkKey(key));
+  return key;
+}
+
+struct Keys
+{
+  std::vector<PublicKey> publicKeys;
+  std::vector<SecretKey> secretKeys;
+};
+
+Keys generate(size_t count)
+{
+  Keys keys;
+  keys.publicKeys.resize(count);
+  keys.secretKeys.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    generateKeys(keys.publicKeys[i], keys.secretKeys[i]);
+  }
+
+  return keys;
+}
+
+} // namespace
+
+TEST(BatchDerivation, generateKeyDerivationsMatchesSingleCalls) {
+  Keys txKeys = generate(8);
+  Keys viewKeys = generate(2);
+
+  // every transaction key against both view keys, so the same public key repeats
+  std::vector<PublicKey> publicKeys;
+  std::vector<SecretKey> secretKeys;
+  for (const PublicKey &txKey : txKeys.publicKeys) {
+    for (const SecretKey &viewKey : viewKeys.secretKeys) {
+      publicKeys.push_back(txKey);
+      secretKeys.push_back(viewKey);
+    }
+  }
+
+  std::vector<KeyDerivation> derivations(publicKeys.size());
+  std::unique_ptr<bool[]> valid(new bool[publicKeys.size()]);
+  ASSERT_TRUE(generateKeyDerivations(publicKeys.size(), publicKeys.data(), secretKeys.data(),
+                                     derivations.data(), valid.get()));
+
+  for (size_t i = 0; i < publicKeys.size(); ++i) {
+    KeyDerivation expected;
+    ASSERT_TRUE(generateKeyDerivation(publicKeys[i], secretKeys[i], expected));
+    EXPECT_TRUE(valid[i]);
+    EXPECT_EQ(0, memcmp(&expected, &derivations[i], sizeof(expected))) << i;
+  }
+}
+
+TEST(BatchDerivation, generateKeyDerivationsSkipsInvalidKeys) {
+  Keys keys = generate(4);
+  keys.publicKeys[1] = invalidPublicKey();
+  keys.publicKeys[2] = invalidPublicKey();
+
+  std::vector<KeyDerivation> derivations(4);
+  bool valid[4];
+  EXPECT_FALSE(generateKeyDerivations(4, keys.publicKeys.data(), keys.secretKeys.data(),
+                                      derivations.data(), valid));
+
+  EXPECT_TRUE(valid[0]);
+  EXPECT_FALSE(valid[1]);
+  EXPECT_FALSE(valid[2]);
+  EXPECT_TRUE(valid[3]);
+  for (size_t i : { 0, 3 }) {
+    KeyDerivation expected;
+    ASSERT_TRUE(generateKeyDerivation(keys.publicKeys[i], keys.secretKeys[i], expected));
+    EXPECT_EQ(0, memcmp(&expected, &derivations[i], sizeof(expected))) << i;
+  }
+}
+
+TEST(BatchDerivation, underivePublicKeysMatchesSingleCalls) {
+  Keys txKeys = generate(3);
+  Keys spendKeys = generate(1);
+
+  std::vector<KeyDerivation> derivations;
+  std::vector<size_t> outputIndexes;
+  std::vector<PublicKey> outputKeys;
+  for (size_t tx = 0; tx < txKeys.publicKeys.size(); ++tx) {
+    KeyDerivation derivation;
+    ASSERT_TRUE(generateKeyDerivation(txKeys.publicKeys[tx], spendKeys.secretKeys[0], derivation));
+    for (size_t i = 0; i < 5; ++i) {
+      PublicKey outputKey;
+      ASSERT_TRUE(derivePublicKey(derivation, i, spendKeys.publicKeys[0], outputKey));
+      derivations.push_back(derivation);
+      outputIndexes.push_back(i);
+      // the last output of every transaction belongs to someone else
+      outputKeys.push_back(i == 4 ? txKeys.publicKeys[tx] : outputKey);
+    }
+  }
+
+  outputKeys[7] = invalidPublicKey();
+
+  size_t count = outputKeys.size();
+  std::vector<PublicKey> baseKeys(count);
+  std::unique_ptr<bool[]> valid(new bool[count]);
+  EXPECT_FALSE(underivePublicKeys(count, derivations.data(), outputIndexes.data(),
+                                  outputKeys.data(), baseKeys.data(), valid.get()));
+
+  for (size_t i = 0; i < count; ++i) {
+    PublicKey expected;
+    bool expectedValid = underivePublicKey(derivations[i], outputIndexes[i], outputKeys[i],
+                                           expected);
+    ASSERT_EQ(expectedValid, valid[i]) << i;
+    EXPECT_EQ(i != 7, valid[i]) << i;
+    if (expectedValid) {
+      EXPECT_EQ(expected, baseKeys[i]) << i;
+      EXPECT_EQ(i % 5 != 4, baseKeys[i] == spendKeys.publicKeys[0]) << i;
+    }
+  }
+}
+
+TEST(BatchDerivation, emptyBatch) {
+  EXPECT_TRUE(generateKeyDerivations(0, nullptr, nullptr, nullptr, nullptr));
+  EXPECT_TRUE(underivePublicKeys(0, nullptr, nullptr, nullptr, nullptr, nullptr));
+}
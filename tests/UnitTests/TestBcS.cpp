@@ -1280,16 +1280,22 @@ TEST_F(BcSTest, checkBlocksRerequestingOnError) {
   generator.generateEmptyBlocks(20);
   m_node.setGetNewBlocksLimit(10);
 
-  std::atomic<int> requestsCount(0);
-  std::list<Hash> firstlyKnownBlockIdsTaken;
-  std::list<Hash> secondlyKnownBlockIdsTaken;
+  // the next batch may already be requested while a batch is processed,
+  // so requests are matched to batches by the block the batch follows
+  std::mutex mutex;
+  std::vector<std::vector<Hash>> knownBlockIdsTaken;
+  int batchesReceived = 0;
+  Hash failedBatchParent;
 
   std::vector<Hash> firstlyReceivedBlocks;
   std::vector<Hash> secondlyReceivedBlocks;
 
-
   c.onNewBlocksFunctor = [&](const CompleteBlock* blocks, uint32_t, size_t count) -> bool {
-    if (requestsCount == 2) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++batchesReceived;
+
+    if (batchesReceived == 2) {
+      failedBatchParent = blocks[0].block->previousBlockHash;
       for (size_t i = 0; i < count; ++i) {
         firstlyReceivedBlocks.push_back(blocks[i].blockHash);
       }
@@ -1297,7 +1303,7 @@ TEST_F(BcSTest, checkBlocksRerequestingOnError) {
       return false;
     }
 
-    if (requestsCount == 3) {
+    if (batchesReceived == 3) {
       for (size_t i = 0; i < count; ++i) {
         secondlyReceivedBlocks.push_back(blocks[i].blockHash);
       }
@@ -1307,14 +1313,60 @@ TEST_F(BcSTest, checkBlocksRerequestingOnError) {
   };
 
   m_node.queryBlocksFunctor = [&](const std::vector<Hash>& knownBlockIds, uint64_t timestamp, std::vector<BlockShortEntry>& newBlocks, uint32_t& startHeight, const INode::Callback& callback) -> bool {
-    ++requestsCount;
+    std::lock_guard<std::mutex> lock(mutex);
+    knownBlockIdsTaken.push_back(knownBlockIds);
+    return true;
+  };
 
-    if (requestsCount == 2) {
-      firstlyKnownBlockIdsTaken.assign(knownBlockIds.begin(), knownBlockIds.end());
+  m_sync.addObserver(&o1);
+  m_sync.addConsumer(&c);
+  m_sync.start();
+  e.wait();
+  m_sync.stop();
+
+  m_sync.start();
+  e.wait();
+  m_sync.stop();
+  m_sync.removeObserver(&o1);
+  o1.syncFunc = [](std::error_code) {};
+
+  std::vector<std::vector<Hash>> failedBatchRequests;
+  for (const auto& knownBlockIds : knownBlockIdsTaken) {
+    if (knownBlockIds.front() == failedBatchParent) {
+      failedBatchRequests.push_back(knownBlockIds);
     }
+  }
 
-    if (requestsCount == 3) {
-      secondlyKnownBlockIdsTaken.assign(knownBlockIds.begin(), knownBlockIds.end());
+  ASSERT_LE(2, failedBatchRequests.size());
+  EXPECT_EQ(failedBatchRequests.front(), failedBatchRequests.back());
+  EXPECT_FALSE(firstlyReceivedBlocks.empty());
+  EXPECT_EQ(firstlyReceivedBlocks, secondlyReceivedBlocks);
+}
+
+TEST_F(BcSTest, prefetchedBlocksAreNotRequestedAgain) {
+  FunctorialBlockhainConsumerStub c(m_currency.genesisBlockHash());
+  IBlockchainSynchronizerFunctorialObserver o1;
+  EventWaiter e;
+  o1.syncFunc = [&](std::error_code) {
+    e.notify();
+  };
+
+  generator.generateEmptyBlocks(19);
+  m_node.setGetNewBlocksLimit(5);
+
+  // queries and scanning both run on the synchronizer thread
+  std::vector<Hash> receivedBlocks;
+  std::vector<Hash> requestedAfter;
+  std::vector<size_t> receivedWhenRequested;
+  m_node.queryBlocksFunctor = [&](const std::vector<Hash>& knownBlockIds, uint64_t, std::vector<BlockShortEntry>&, uint32_t&, const INode::Callback&) -> bool {
+    requestedAfter.push_back(knownBlockIds.front());
+    receivedWhenRequested.push_back(receivedBlocks.size());
+    return true;
+  };
+
+  c.onNewBlocksFunctor = [&](const CompleteBlock* blocks, uint32_t, size_t count) -> bool {
+    for (size_t i = 0; i < count; ++i) {
+      receivedBlocks.push_back(blocks[i].blockHash);
     }
 
     return true;
@@ -1325,15 +1377,182 @@ TEST_F(BcSTest, checkBlocksRerequestingOnError) {
   m_sync.start();
   e.wait();
   m_sync.stop();
+  m_sync.removeObserver(&o1);
+  o1.syncFunc = [](std::error_code) {};
+
+  // every block after genesis, each of them once
+  std::unordered_set<Hash> uniqueBlocks(receivedBlocks.begin(), receivedBlocks.end());
+  EXPECT_EQ(generator.getBlockchain().size() - 1, receivedBlocks.size());
+  EXPECT_EQ(receivedBlocks.size(), uniqueBlocks.size());
+
+  // the second batch is asked for before the first one is scanned, and no batch twice
+  ASSERT_LE(2, receivedWhenRequested.size());
+  EXPECT_EQ(0, receivedWhenRequested[1]);
+  std::unordered_set<Hash> uniqueRequests(requestedAfter.begin(), requestedAfter.end());
+  EXPECT_EQ(requestedAfter.size(), uniqueRequests.size());
+}
+
+TEST_F(BcSTest, prefetchedBlocksAreDiscardedAfterDetach) {
+  FunctorialBlockhainConsumerStub c(m_currency.genesisBlockHash());
+  IBlockchainSynchronizerFunctorialObserver o1;
+  EventWaiter e;
+  o1.syncFunc = [&](std::error_code) {
+    e.notify();
+  };
+
+  generator.generateEmptyBlocks(20);
+  m_node.setGetNewBlocksLimit(5);
+
+  c.onNewBlocksFunctor = [&](const CompleteBlock*, uint32_t, size_t) -> bool {
+    return true;
+  };
+
+  m_sync.addObserver(&o1);
+  m_sync.addConsumer(&c);
+  m_sync.start();
+  e.wait();
+  m_sync.stop();
+
+  uint32_t alternativeHeight = 10;
+  m_node.startAlternativeChain(alternativeHeight);
+  generator.generateEmptyBlocks(20);
+
+  std::vector<uint32_t> detachHeights;
+  c.onBlockchainDetachFunctor = [&](uint32_t height) {
+    detachHeights.push_back(height);
+  };
+
+  // the first batch of the new chain detaches the consumer and is then refused,
+  // the batch after it is already requested by then
+  std::vector<uint32_t> receivedStartHeights;
+  c.onNewBlocksFunctor = [&](const CompleteBlock*, uint32_t startHeight, size_t) -> bool {
+    receivedStartHeights.push_back(startHeight);
+    return receivedStartHeights.size() > 1;
+  };
 
   m_sync.start();
   e.wait();
+
+  // not stopped in between, so only the history check can drop the prefetched batch
+  m_node.updateObservers();
+  e.wait();
   m_sync.stop();
   m_sync.removeObserver(&o1);
   o1.syncFunc = [](std::error_code) {};
 
-  EXPECT_EQ(firstlyKnownBlockIdsTaken, secondlyKnownBlockIdsTaken);
-  EXPECT_EQ(firstlyReceivedBlocks, secondlyReceivedBlocks);
+  ASSERT_EQ(1, detachHeights.size());
+  EXPECT_EQ(alternativeHeight, detachHeights[0]);
+  ASSERT_LE(2, receivedStartHeights.size());
+  EXPECT_EQ(alternativeHeight, receivedStartHeights[0]);
+  EXPECT_EQ(alternativeHeight, receivedStartHeights[1]);
+}
+
+TEST_F(BcSTest, prefetchedBlocksAreDiscardedWhenConsumerIsAdded) {
+  FunctorialBlockhainConsumerStub c(m_currency.genesisBlockHash());
+  IBlockchainSynchronizerFunctorialObserver o1;
+  EventWaiter e;
+  o1.syncFunc = [&](std::error_code) {
+    e.notify();
+  };
+
+  generator.generateEmptyBlocks(20);
+  m_node.setGetNewBlocksLimit(5);
+
+  c.onNewBlocksFunctor = [&](const CompleteBlock*, uint32_t, size_t) -> bool {
+    return true;
+  };
+
+  m_sync.addObserver(&o1);
+  m_sync.addConsumer(&c);
+  m_sync.start();
+  e.wait();
+  m_sync.stop();
+
+  generator.generateEmptyBlocks(10);
+
+  // refusing the first new batch leaves the one after it prefetched
+  std::vector<uint32_t> receivedStartHeights;
+  c.onNewBlocksFunctor = [&](const CompleteBlock*, uint32_t startHeight, size_t) -> bool {
+    receivedStartHeights.push_back(startHeight);
+    return receivedStartHeights.size() > 1;
+  };
+
+  m_sync.start();
+  e.wait();
+  m_sync.stop();
+
+  addConsumers(1);
+
+  std::vector<Hash> requestedAfter;
+  m_node.queryBlocksFunctor = [&](const std::vector<Hash>& knownBlockIds, uint64_t, std::vector<BlockShortEntry>&, uint32_t&, const INode::Callback&) -> bool {
+    requestedAfter.push_back(knownBlockIds.front());
+    return true;
+  };
+
+  m_sync.start();
+  e.wait();
+  m_sync.stop();
+  m_sync.removeObserver(&o1);
+  o1.syncFunc = [](std::error_code) {};
+
+  ASSERT_FALSE(requestedAfter.empty());
+  EXPECT_EQ(m_currency.genesisBlockHash(), requestedAfter.front());
+  checkSyncedBlockchains();
+  ASSERT_LE(2, receivedStartHeights.size());
+  EXPECT_EQ(receivedStartHeights[0], receivedStartHeights[1]);
+}
+
+TEST_F(BcSTest, prefetchedBlocksAreDiscardedWhenConsumerIsRemoved) {
+  FunctorialBlockhainConsumerStub c(m_currency.genesisBlockHash());
+  IBlockchainSynchronizerFunctorialObserver o1;
+  EventWaiter e;
+  o1.syncFunc = [&](std::error_code) {
+    e.notify();
+  };
+
+  generator.generateEmptyBlocks(20);
+  m_node.setGetNewBlocksLimit(5);
+
+  c.onNewBlocksFunctor = [&](const CompleteBlock*, uint32_t, size_t) -> bool {
+    return true;
+  };
+
+  m_sync.addObserver(&o1);
+  m_sync.addConsumer(&c);
+  addConsumers(1);
+  m_sync.start();
+  e.wait();
+  m_sync.stop();
+
+  generator.generateEmptyBlocks(10);
+
+  // c refuses every batch, so the sync fails with the batch after the first new one prefetched
+  c.onNewBlocksFunctor = [&](const CompleteBlock*, uint32_t, size_t) -> bool {
+    return false;
+  };
+
+  m_sync.start();
+  e.wait();
+  m_sync.stop();
+
+  ASSERT_TRUE(m_sync.removeConsumer(&c));
+  Hash lastKnownBlock = m_sync.getConsumerKnownBlocks(*m_consumers.front()).back();
+
+  std::vector<Hash> requestedAfter;
+  m_node.queryBlocksFunctor = [&](const std::vector<Hash>& knownBlockIds, uint64_t, std::vector<BlockShortEntry>&, uint32_t&, const INode::Callback&) -> bool {
+    requestedAfter.push_back(knownBlockIds.front());
+    return true;
+  };
+
+  m_sync.start();
+  e.wait();
+  m_sync.stop();
+  m_sync.removeObserver(&o1);
+  o1.syncFunc = [](std::error_code) {};
+
+  ASSERT_FALSE(requestedAfter.empty());
+  EXPECT_EQ(lastKnownBlock, requestedAfter.front());
+  checkSyncedBlockchains();
 }
 
 TEST_F(BcSTest, checkTxOrder) {
@@ -0,0 +1,116 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "CryptoNoteCore/BlockEntryCache.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+Crypto::Hash makeHash(uint8_t value)
+{
+  Crypto::Hash hash = Crypto::Hash();
+  hash.data[0] = value;
+  return hash;
+}
+
+std::shared_ptr<const BlockEntryCache::Entry> makeEntry(uint8_t id, size_t size)
+{
+  auto entry = std::make_shared<BlockEntryCache::Entry>();
+  entry->blockId = makeHash(id);
+  entry->timestamp = id;
+  entry->size = size;
+  return entry;
+}
+
+} // namespace
+
+TEST(BlockEntryCache, returnsStoredEntry) {
+  BlockEntryCache cache(1000);
+
+  ASSERT_EQ(nullptr, cache.get(1, makeHash(1)));
+
+  cache.put(1, makeEntry(1, 100));
+
+  auto entry = cache.get(1, makeHash(1));
+  ASSERT_NE(nullptr, entry);
+  ASSERT_EQ(makeHash(1), entry->blockId);
+  ASSERT_EQ(100, cache.size());
+}
+
+TEST(BlockEntryCache, dropsEntryOfAnotherBlock) {
+  BlockEntryCache cache(1000);
+  cache.put(1, makeEntry(1, 100));
+
+  ASSERT_EQ(nullptr, cache.get(1, makeHash(2)));
+  ASSERT_EQ(0, cache.count());
+  ASSERT_EQ(0, cache.size());
+}
+
+TEST(BlockEntryCache, evictsLeastRecentlyUsed) {
+  BlockEntryCache cache(300);
+  cache.put(1, makeEntry(1, 100));
+  cache.put(2, makeEntry(2, 100));
+  cache.put(3, makeEntry(3, 100));
+
+  ASSERT_NE(nullptr, cache.get(1, makeHash(1)));
+
+  cache.put(4, makeEntry(4, 100));
+
+  ASSERT_EQ(3, cache.count());
+  ASSERT_EQ(300, cache.size());
+  ASSERT_NE(nullptr, cache.get(1, makeHash(1)));
+  ASSERT_EQ(nullptr, cache.get(2, makeHash(2)));
+  ASSERT_NE(nullptr, cache.get(3, makeHash(3)));
+  ASSERT_NE(nullptr, cache.get(4, makeHash(4)));
+}
+
+TEST(BlockEntryCache, skipsEntryLargerThanLimit) {
+  BlockEntryCache cache(300);
+  cache.put(1, makeEntry(1, 100));
+  cache.put(2, makeEntry(2, 301));
+
+  ASSERT_EQ(1, cache.count());
+  ASSERT_NE(nullptr, cache.get(1, makeHash(1)));
+}
+
+TEST(BlockEntryCache, replacesEntryAtSameHeight) {
+  BlockEntryCache cache(1000);
+  cache.put(1, makeEntry(1, 100));
+  cache.put(1, makeEntry(2, 200));
+
+  ASSERT_EQ(1, cache.count());
+  ASSERT_EQ(200, cache.size());
+  ASSERT_NE(nullptr, cache.get(1, makeHash(2)));
+}
+
+TEST(BlockEntryCache, removeFromDropsHigherEntries) {
+  BlockEntryCache cache(1000);
+  for (uint8_t i = 0; i < 5; ++i) {
+    cache.put(i, makeEntry(i, 10));
+  }
+
+  cache.removeFrom(3);
+
+  ASSERT_EQ(3, cache.count());
+  ASSERT_EQ(30, cache.size());
+  ASSERT_NE(nullptr, cache.get(2, makeHash(2)));
+  ASSERT_EQ(nullptr, cache.get(3, makeHash(3)));
+  ASSERT_EQ(nullptr, cache.get(4, makeHash(4)));
+}
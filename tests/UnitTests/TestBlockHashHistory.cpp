@@ -0,0 +1,279 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Global/Constants.h"
+#include "Transfers/BlockHashHistory.h"
+#include "Transfers/SynchronizationState.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const uint32_t CHUNK = BlockHashHistory::CHUNK_SIZE;
+
+std::vector<Crypto::Hash> makeHashes(uint32_t count, uint32_t seed = 0)
+{
+  std::vector<Crypto::Hash> hashes(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    uint64_t value = (static_cast<uint64_t>(seed) << 32) | i;
+    hashes[i] = Crypto::cn_fast_hash(&value, sizeof(value));
+  }
+
+  return hashes;
+}
+
+BlockchainInterval makeInterval(const std::vector<Crypto::Hash> &chain, uint32_t start, uint32_t end)
+{
+  BlockchainInterval interval;
+  interval.startHeight = start;
+  interval.blocks.assign(chain.begin() + start, chain.begin() + end);
+  return interval;
+}
+
+// genesis plus count - 1 blocks of chain
+SynchronizationState makeState(const std::vector<Crypto::Hash> &chain, uint32_t count, uint32_t window,
+                               std::shared_ptr<BlockHashHistory::Pool> pool = nullptr)
+{
+  SynchronizationState state(chain[0], pool, window);
+  state.addBlocks(chain.data() + 1, 1, count - 1);
+  return state;
+}
+
+} // namespace
+
+TEST(BlockHashHistory, keepsEveryHashWithoutWindow) {
+  auto hashes = makeHashes(3000);
+  BlockHashHistory history;
+  history.append(hashes.data(), 1000);
+  history.append(hashes.data() + 1000, 2000);
+
+  ASSERT_EQ(3000, history.size());
+  EXPECT_EQ(0, history.prunedHeight());
+  for (uint32_t i = 0; i < history.size(); ++i) {
+    ASSERT_TRUE(history.isKnown(i));
+    ASSERT_EQ(hashes[i], history[i]);
+  }
+
+  EXPECT_FALSE(history.isKnown(3000));
+  EXPECT_EQ(hashes, history.getHashes());
+}
+
+TEST(BlockHashHistory, windowKeepsCheckpointsOfOlderChunks) {
+  auto hashes = makeHashes(5000);
+  BlockHashHistory history(nullptr, 1500);
+  history.append(hashes.data(), 5000);
+
+  // chunks are pruned as they are sealed
+  ASSERT_EQ(5000, history.size());
+  EXPECT_EQ(2 * CHUNK, history.prunedHeight());
+  EXPECT_GE(history.size() - history.prunedHeight(), 1500);
+
+  EXPECT_TRUE(history.isKnown(0));
+  EXPECT_TRUE(history.isKnown(CHUNK));
+  EXPECT_FALSE(history.isKnown(CHUNK + 1));
+  EXPECT_EQ(hashes[2 * CHUNK], history[2 * CHUNK]);
+  EXPECT_EQ(hashes[3500], history[3500]);
+
+  auto known = history.getHashes();
+  ASSERT_EQ(5000, known.size());
+  EXPECT_EQ(hashes[CHUNK], known[CHUNK]);
+  EXPECT_EQ(Qwertycoin::NULL_HASH, known[CHUNK + 1]);
+  EXPECT_EQ(hashes[4999], known[4999]);
+}
+
+TEST(BlockHashHistory, poolSharesChunksOfTheSameBlocks) {
+  auto pool = std::make_shared<BlockHashHistory::Pool>();
+  auto hashes = makeHashes(2 * CHUNK + 10);
+  auto other = makeHashes(CHUNK, 1);
+
+  {
+    BlockHashHistory first(pool);
+    BlockHashHistory second(pool);
+    first.append(hashes.data(), static_cast<uint32_t>(hashes.size()));
+    second.append(hashes.data(), 2 * CHUNK + 5);
+
+    EXPECT_EQ(2, pool->size());
+    EXPECT_EQ(&first[CHUNK + 3], &second[CHUNK + 3]);
+
+    BlockHashHistory third(pool);
+    third.append(other.data(), CHUNK);
+    EXPECT_EQ(3, pool->size());
+  }
+
+  EXPECT_EQ(0, pool->size());
+}
+
+TEST(BlockHashHistory, truncateDoesNotChangeSharedChunks) {
+  auto pool = std::make_shared<BlockHashHistory::Pool>();
+  auto hashes = makeHashes(3 * CHUNK);
+  auto fork = makeHashes(CHUNK, 1);
+
+  BlockHashHistory first(pool);
+  BlockHashHistory second(pool);
+  first.append(hashes.data(), 3 * CHUNK);
+  second.append(hashes.data(), 3 * CHUNK);
+
+  first.truncate(CHUNK + 100);
+  ASSERT_EQ(CHUNK + 100, first.size());
+  first.append(fork.data(), CHUNK);
+
+  ASSERT_EQ(2 * CHUNK + 100, first.size());
+  EXPECT_EQ(hashes[CHUNK + 99], first[CHUNK + 99]);
+  EXPECT_EQ(fork[0], first[CHUNK + 100]);
+  EXPECT_EQ(hashes, second.getHashes());
+}
+
+TEST(BlockHashHistory, truncateBelowWindowCutsAtCheckpoint) {
+  auto hashes = makeHashes(5000);
+  BlockHashHistory history(nullptr, CHUNK);
+  history.append(hashes.data(), 5000);
+  ASSERT_EQ(3 * CHUNK, history.prunedHeight());
+
+  history.truncate(CHUNK);
+  EXPECT_EQ(CHUNK, history.size());
+  EXPECT_EQ(CHUNK, history.prunedHeight());
+
+  history.append(hashes.data() + CHUNK, 100);
+  EXPECT_EQ(CHUNK + 100, history.size());
+  EXPECT_EQ(hashes[CHUNK + 50], history[CHUNK + 50]);
+  EXPECT_EQ(hashes[0], history[0]);
+}
+
+TEST(SynchronizationState, shortHistoryOfPrunedStateHasOnlyKnownHashes) {
+  auto chain = makeHashes(100000);
+  SynchronizationState full = makeState(chain, 100000, 0);
+  SynchronizationState pruned = makeState(chain, 100000, 2000);
+
+  auto fullHistory = full.getShortHistory(100000);
+  auto history = pruned.getShortHistory(100000);
+
+  ASSERT_FALSE(history.empty());
+  EXPECT_EQ(chain[0], history.back());
+  // the recent part is the same, older entries are moved to chunk starts
+  for (size_t i = 0; i < 11; ++i) {
+    EXPECT_EQ(fullHistory[i], history[i]);
+  }
+
+  auto known = pruned.getKnownBlockHashes();
+  size_t height = known.size();
+  for (const auto &hash : history) {
+    auto it = std::find(chain.begin(), chain.begin() + height, hash);
+    ASSERT_NE(chain.begin() + height, it);
+    height = static_cast<size_t>(it - chain.begin());
+    EXPECT_EQ(hash, known[height]);
+  }
+}
+
+TEST(SynchronizationState, shortHistoryIncludesPendingBlocks) {
+  auto chain = makeHashes(200);
+  auto fork = chain;
+  for (uint32_t i = 90; i < fork.size(); ++i) {
+    fork[i] = makeHashes(1, i)[0];
+  }
+
+  SynchronizationState state = makeState(chain, 100, 0);
+
+  // pending blocks on top of the known ones
+  SynchronizationState appended = makeState(chain, 130, 0);
+  auto history = state.getShortHistory(1000, makeInterval(chain, 100, 130));
+  EXPECT_EQ(chain[129], history.front());
+  EXPECT_EQ(appended.getShortHistory(1000), history);
+
+  // pending blocks replacing the known ones above their start
+  SynchronizationState detached = makeState(chain, 90, 0);
+  auto interval = makeInterval(fork, 90, 120);
+  detached.addBlocks(interval.blocks.data(), 90, static_cast<uint32_t>(interval.blocks.size()));
+  history = state.getShortHistory(1000, interval);
+  EXPECT_EQ(fork[119], history.front());
+  EXPECT_EQ(detached.getShortHistory(1000), history);
+
+  // never past the local height of the node
+  EXPECT_EQ(chain[110], state.getShortHistory(110, makeInterval(chain, 100, 130)).front());
+}
+
+TEST(SynchronizationState, checkIntervalDetachesAfterLastKnownMatch) {
+  auto chain = makeHashes(5000);
+  auto fork = chain;
+  for (uint32_t i = 4500; i < fork.size(); ++i) {
+    fork[i] = makeHashes(1, i)[0];
+  }
+
+  SynchronizationState state = makeState(chain, 5000, CHUNK);
+
+  auto result = state.checkInterval(makeInterval(fork, 4000, 4600));
+  EXPECT_TRUE(result.detachRequired);
+  EXPECT_EQ(4500, result.detachHeight);
+  EXPECT_EQ(4500, result.newBlockHeight);
+
+  // the last match is pruned, detach from it and take it back from the interval
+  for (uint32_t i = CHUNK + 1; i < fork.size(); ++i) {
+    fork[i] = makeHashes(1, i)[0];
+  }
+
+  result = state.checkInterval(makeInterval(fork, CHUNK, 5000));
+  EXPECT_TRUE(result.detachRequired);
+  EXPECT_EQ(CHUNK, result.detachHeight);
+
+  state.detach(result.detachHeight);
+  auto interval = makeInterval(fork, CHUNK, 5000);
+  state.addBlocks(interval.blocks.data(), CHUNK, static_cast<uint32_t>(interval.blocks.size()));
+  EXPECT_EQ(5000, state.getHeight());
+  EXPECT_FALSE(state.checkInterval(makeInterval(fork, 4000, 5000)).detachRequired);
+}
+
+TEST(SynchronizationState, pruningShrinksSavedState) {
+  auto chain = makeHashes(20000);
+  SynchronizationState full = makeState(chain, 20000, 0);
+  SynchronizationState pruned = makeState(chain, 20000, 2000);
+
+  std::stringstream fullStream;
+  std::stringstream prunedStream;
+  full.save(fullStream);
+  pruned.save(prunedStream);
+  EXPECT_LT(prunedStream.str().size() * 5, fullStream.str().size());
+
+  SynchronizationState restored(chain[0], nullptr, 2000);
+  restored.load(prunedStream);
+  EXPECT_EQ(20000, restored.getHeight());
+  EXPECT_EQ(pruned.getKnownBlockHashes(), restored.getKnownBlockHashes());
+  EXPECT_EQ(pruned.getShortHistory(20000), restored.getShortHistory(20000));
+}
+
+TEST(SynchronizationState, loadsUnprunedStateWithWindow) {
+  auto chain = makeHashes(20000);
+  SynchronizationState full = makeState(chain, 20000, 0);
+
+  std::stringstream stream;
+  full.save(stream);
+
+  SynchronizationState pruned(chain[0], nullptr, 2000);
+  pruned.load(stream);
+  EXPECT_EQ(20000, pruned.getHeight());
+  EXPECT_EQ(makeState(chain, 20000, 2000).getKnownBlockHashes(), pruned.getKnownBlockHashes());
+
+  std::stringstream unprunedStream;
+  full.save(unprunedStream);
+  SynchronizationState unpruned(chain[0]);
+  unpruned.load(unprunedStream);
+  EXPECT_EQ(chain, unpruned.getKnownBlockHashes());
+}
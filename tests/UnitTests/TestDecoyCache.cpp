@@ -0,0 +1,199 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <set>
+#include <gtest/gtest.h>
+
+#include "INodeStubs.h"
+#include "Logging/ConsoleLogger.h"
+#include "Wallet/DecoyCache.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+// answers synchronously, in reverse order of the requested amounts, each one with ascending
+// global indices as the node does when an amount has few outputs
+class INodeRandomOutsStub : public INodeDummyStub
+{
+public:
+  void getRandomOutsByAmounts(
+      std::vector<uint64_t> &&amounts,
+      uint64_t outsCount,
+      std::vector<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount> &result,
+      const Callback &callback) override
+  {
+    ++requests;
+    lastOutsCount = outsCount;
+    result.clear();
+    for (auto it = amounts.rbegin(); it != amounts.rend(); ++it) {
+      COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount outs;
+      outs.amount = *it;
+      for (uint64_t i = 0; i < outsCount; ++i) {
+        COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry entry;
+        entry.global_amount_index = nextIndex++;
+        outs.outs.push_back(entry);
+      }
+
+      result.push_back(outs);
+    }
+
+    callback(error);
+  }
+
+  size_t requests = 0;
+  uint64_t lastOutsCount = 0;
+  uint64_t nextIndex = 0;
+  std::error_code error;
+};
+
+bool isSorted(const std::vector<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry> &outs)
+{
+  return std::is_sorted(outs.begin(), outs.end(),
+      [](const COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry &a,
+         const COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry &b) {
+        return a.global_amount_index < b.global_amount_index;
+      });
+}
+
+class DecoyCacheTest : public ::testing::Test
+{
+public:
+  DecoyCacheTest()
+    : m_cache(m_node, m_logger, 8, std::chrono::seconds(600))
+  {
+  }
+
+  std::vector<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount> fetch(
+      std::vector<uint64_t> amounts,
+      uint64_t count)
+  {
+    std::vector<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount> result;
+    std::error_code ec;
+    m_cache.fetch(std::move(amounts), count, result, [&ec](std::error_code e) { ec = e; });
+    EXPECT_FALSE(ec);
+
+    return result;
+  }
+
+protected:
+  Logging::ConsoleLogger m_logger;
+  INodeRandomOutsStub m_node;
+  DecoyCache m_cache;
+};
+
+} // namespace
+
+TEST_F(DecoyCacheTest, takeMissesUntilFetched) {
+  std::vector<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount> result;
+  EXPECT_EQ(std::vector<size_t>({ 0, 1 }), m_cache.take({ 10, 20 }, 3, result));
+  ASSERT_EQ(2, result.size());
+  EXPECT_TRUE(result[0].outs.empty());
+
+  auto fetched = fetch({ 10, 20 }, 3);
+  EXPECT_EQ(1, m_node.requests);
+  EXPECT_EQ(8, m_node.lastOutsCount);
+  ASSERT_EQ(2, fetched.size());
+  EXPECT_EQ(3, fetched[0].outs.size());
+
+  EXPECT_TRUE(m_cache.take({ 10, 20 }, 3, result).empty());
+  EXPECT_EQ(1, m_node.requests);
+  EXPECT_EQ(3, result[1].outs.size());
+}
+
+TEST_F(DecoyCacheTest, resultFollowsRequestedAmounts) {
+  auto fetched = fetch({ 30, 10, 20, 10 }, 2);
+  ASSERT_EQ(4, fetched.size());
+  EXPECT_EQ(30, fetched[0].amount);
+  EXPECT_EQ(10, fetched[1].amount);
+  EXPECT_EQ(20, fetched[2].amount);
+  EXPECT_EQ(10, fetched[3].amount);
+
+  std::vector<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount> result;
+  EXPECT_TRUE(m_cache.take({ 20, 30 }, 2, result).empty());
+  EXPECT_EQ(20, result[0].amount);
+  EXPECT_EQ(30, result[1].amount);
+}
+
+TEST_F(DecoyCacheTest, neverHandsOutTheSameOutputTwice) {
+  std::set<uint64_t> seen;
+  auto fetched = fetch({ 10 }, 3);
+  for (const auto &entry : fetched[0].outs) {
+    EXPECT_TRUE(seen.insert(entry.global_amount_index).second);
+  }
+
+  std::vector<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount> result;
+  EXPECT_TRUE(m_cache.take({ 10 }, 3, result).empty());
+  for (const auto &entry : result[0].outs) {
+    EXPECT_TRUE(seen.insert(entry.global_amount_index).second);
+  }
+
+  // only two outputs are left in the pool
+  EXPECT_EQ(std::vector<size_t>({ 0 }), m_cache.take({ 10 }, 3, result));
+}
+
+TEST_F(DecoyCacheTest, refillTopsUpLowPools) {
+  std::vector<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount> result;
+  fetch({ 10 }, 3);
+  m_cache.refill();
+  EXPECT_EQ(1, m_node.requests);
+
+  EXPECT_TRUE(m_cache.take({ 10 }, 3, result).empty());
+  m_cache.refill();
+  EXPECT_EQ(2, m_node.requests);
+  EXPECT_EQ(8, m_node.lastOutsCount);
+
+  EXPECT_TRUE(m_cache.take({ 10 }, 8, result).empty());
+}
+
+TEST_F(DecoyCacheTest, failedFetchReportsError) {
+  m_node.error = std::make_error_code(std::errc::connection_refused);
+
+  std::vector<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount> result;
+  std::error_code ec;
+  m_cache.fetch({ 10 }, 3, result, [&ec](std::error_code e) { ec = e; });
+  EXPECT_EQ(m_node.error, ec);
+
+  EXPECT_EQ(std::vector<size_t>({ 0 }), m_cache.take({ 10 }, 3, result));
+}
+
+TEST_F(DecoyCacheTest, handsOutSortedAnswersInRandomOrder) {
+  DecoyCache cache(m_node, m_logger, 64, std::chrono::seconds(600));
+
+  std::vector<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount> fetched;
+  std::error_code ec;
+  cache.fetch({ 10 }, 16, fetched, [&ec](std::error_code e) { ec = e; });
+  ASSERT_FALSE(ec);
+  ASSERT_EQ(16, fetched[0].outs.size());
+  // sorted by chance once in 16! times
+  EXPECT_FALSE(isSorted(fetched[0].outs));
+
+  std::vector<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount> result;
+  EXPECT_TRUE(cache.take({ 10 }, 16, result).empty());
+  EXPECT_FALSE(isSorted(result[0].outs));
+
+  // nor are the lowest outputs the ones handed out first
+  std::set<uint64_t> handedOut;
+  for (const auto &entry : fetched[0].outs) {
+    handedOut.insert(entry.global_amount_index);
+  }
+  for (const auto &entry : result[0].outs) {
+    handedOut.insert(entry.global_amount_index);
+  }
+  EXPECT_NE(31, *handedOut.rbegin());
+}
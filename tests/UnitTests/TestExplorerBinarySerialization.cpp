@@ -0,0 +1,156 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "Rpc/CoreRpcServerCommandsDefinitions.h"
+#include "Serialization/SerializationTools.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+template<typename T>
+T filled(uint8_t seed)
+{
+  T value;
+  for (size_t i = 0; i < sizeof(value.data); ++i) {
+    value.data[i] = static_cast<uint8_t>(seed + i);
+  }
+
+  return value;
+}
+
+TransactionDetails makeTransaction(uint8_t seed)
+{
+  TransactionDetails tx;
+  tx.hash = filled<Crypto::Hash>(seed);
+  tx.size = 420;
+  tx.fee = 100000;
+  tx.totalInputsAmount = 5000000;
+  tx.totalOutputsAmount = 4900000;
+  tx.mixin = 2;
+  tx.timestamp = 1600000000;
+  tx.version = 1;
+  tx.paymentId = filled<Crypto::Hash>(seed + 1);
+  tx.inBlockchain = true;
+  tx.blockHash = filled<Crypto::Hash>(seed + 2);
+  tx.blockHeight = 1000;
+  tx.extra.publicKey.push_back(filled<Crypto::PublicKey>(seed + 3));
+  tx.extra.raw = { 1, 2, 3 };
+  tx.extra.size = 3;
+
+  KeyInputDetails input;
+  input.input.amount = 5000000;
+  input.input.outputIndexes = { 10, 20, 30 };
+  input.input.keyImage = filled<Crypto::KeyImage>(seed + 4);
+  input.mixin = 2;
+  input.outputs.push_back({ filled<Crypto::Hash>(seed + 5), 1 });
+  tx.inputs.push_back(input);
+
+  TransactionOutputDetails output;
+  output.output.amount = 4900000;
+  output.output.target = KeyOutput{ filled<Crypto::PublicKey>(seed + 6) };
+  output.globalIndex = 77;
+  tx.outputs.push_back(output);
+
+  tx.signatures.resize(1);
+  tx.signatures[0].push_back(filled<Crypto::Signature>(seed + 7));
+
+  return tx;
+}
+
+} // namespace
+
+TEST(ExplorerBinarySerialization, blocksRoundTrip)
+{
+  COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS::response sent;
+  sent.status = CORE_RPC_STATUS_OK;
+  sent.blocks.resize(2);
+  for (size_t i = 0; i < sent.blocks.size(); ++i) {
+    BlockDetails &block = sent.blocks[i];
+    block.majorVersion = 5;
+    block.height = static_cast<uint32_t>(1000 + i);
+    block.hash = filled<Crypto::Hash>(static_cast<uint8_t>(i));
+    block.prevBlockHash = filled<Crypto::Hash>(static_cast<uint8_t>(i + 40));
+    block.penalty = 0.25;
+    block.transactions.push_back(makeTransaction(static_cast<uint8_t>(i * 16)));
+  }
+
+  COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS::response received;
+  ASSERT_TRUE(loadFromBinaryKeyValue(received, storeToBinaryKeyValue(sent)));
+
+  ASSERT_EQ(sent.blocks.size(), received.blocks.size());
+  EXPECT_EQ(sent.status, received.status);
+  for (size_t i = 0; i < sent.blocks.size(); ++i) {
+    const BlockDetails &expected = sent.blocks[i];
+    const BlockDetails &actual = received.blocks[i];
+    EXPECT_EQ(expected.height, actual.height);
+    EXPECT_EQ(expected.hash, actual.hash);
+    EXPECT_EQ(expected.prevBlockHash, actual.prevBlockHash);
+    EXPECT_EQ(expected.penalty, actual.penalty);
+    ASSERT_EQ(1, actual.transactions.size());
+
+    const TransactionDetails &tx = actual.transactions[0];
+    EXPECT_EQ(expected.transactions[0].hash, tx.hash);
+    EXPECT_EQ(expected.transactions[0].extra.publicKey, tx.extra.publicKey);
+    EXPECT_EQ(expected.transactions[0].signatures, tx.signatures);
+    ASSERT_EQ(1, tx.outputs.size());
+    EXPECT_EQ(77, tx.outputs[0].globalIndex);
+
+    ASSERT_EQ(1, tx.inputs.size());
+    ASSERT_EQ(typeid(KeyInputDetails), tx.inputs[0].type());
+    const KeyInputDetails &input = boost::get<KeyInputDetails>(tx.inputs[0]);
+    EXPECT_EQ(std::vector<uint32_t>({ 10, 20, 30 }), input.input.outputIndexes);
+    EXPECT_EQ(boost::get<KeyInputDetails>(expected.transactions[0].inputs[0]).input.keyImage,
+              input.input.keyImage);
+  }
+}
+
+TEST(ExplorerBinarySerialization, isSmallerThanJson)
+{
+  COMMAND_RPC_GET_TRANSACTIONS_DETAILS_BY_HASHES::response response;
+  response.status = CORE_RPC_STATUS_OK;
+  for (uint8_t i = 0; i < 10; ++i) {
+    response.transactions.push_back(makeTransaction(i));
+  }
+
+  EXPECT_LT(storeToBinaryKeyValue(response).size(), storeToJson(response).size());
+}
+
+TEST(ExplorerBinarySerialization, statsRoundTrip)
+{
+  COMMAND_RPC_GET_STATS_BY_HEIGHTS_RANGE::response sent;
+  sent.status = CORE_RPC_STATUS_OK;
+  sent.duration = 0.5;
+  for (uint32_t height = 1; height <= 3; ++height) {
+    BLOCK_STATS_ENTRY entry = BLOCK_STATS_ENTRY();
+    entry.height = height;
+    entry.difficulty = height * 1000;
+    entry.minFee = 100;
+    sent.stats.push_back(entry);
+  }
+
+  COMMAND_RPC_GET_STATS_BY_HEIGHTS_RANGE::response received;
+  ASSERT_TRUE(loadFromBinaryKeyValue(received, storeToBinaryKeyValue(sent)));
+
+  ASSERT_EQ(3, received.stats.size());
+  EXPECT_EQ(2, received.stats[1].height);
+  EXPECT_EQ(2000, received.stats[1].difficulty);
+  EXPECT_EQ(100, received.stats[2].minFee);
+  EXPECT_EQ(0.5, received.duration);
+}
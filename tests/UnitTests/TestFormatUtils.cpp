@@ -127,6 +127,40 @@ TEST(parseTransactionExtra, handles_pub_key_and_padding)
   ASSERT_EQ(typeid(CryptoNote::TransactionExtraPadding), tx_extra_fields[1].type());
 }
 
+TEST(parseTransactionExtra, skips_view_tags_byte_as_unknown)
+{
+  const uint8_t extra_arr[] = {7, 0, 0};
+  std::vector<uint8_t> extra(&extra_arr[0], &extra_arr[0] + sizeof(extra_arr));
+  std::vector<CryptoNote::TransactionExtraField> tx_extra_fields;
+  ASSERT_TRUE(CryptoNote::parseTransactionExtra(extra, tx_extra_fields));
+  ASSERT_EQ(1, tx_extra_fields.size());
+  ASSERT_EQ(typeid(CryptoNote::TransactionExtraPadding), tx_extra_fields[0].type());
+  ASSERT_EQ(2, boost::get<CryptoNote::TransactionExtraPadding>(tx_extra_fields[0]).size);
+}
+
+TEST(getViewTagsFromExtra, handles_view_tags_and_padding)
+{
+  const uint8_t extra_arr[] = {7, 3, 10, 20, 30, 0, 0};
+  std::vector<uint8_t> extra(&extra_arr[0], &extra_arr[0] + sizeof(extra_arr));
+  CryptoNote::TransactionExtraViewTags viewTags;
+  ASSERT_TRUE(CryptoNote::getViewTagsFromExtra(extra, viewTags));
+  ASSERT_EQ(std::vector<uint8_t>({10, 20, 30}), viewTags.tags);
+
+  std::vector<uint8_t> written;
+  CryptoNote::appendViewTagsToExtra(written, viewTags);
+  written.push_back(0);
+  written.push_back(0);
+  ASSERT_EQ(extra, written);
+}
+
+TEST(getViewTagsFromExtra, handles_truncated_view_tags)
+{
+  const uint8_t extra_arr[] = {7, 3, 10, 20};
+  std::vector<uint8_t> extra(&extra_arr[0], &extra_arr[0] + sizeof(extra_arr));
+  CryptoNote::TransactionExtraViewTags viewTags;
+  ASSERT_FALSE(CryptoNote::getViewTagsFromExtra(extra, viewTags));
+}
+
 TEST(parse_and_validate_tx_extra, is_valid_tx_extra_parsed)
 {
   Logging::LoggerGroup logger;
@@ -0,0 +1,174 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "Http/HttpParser.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+size_t parse(const std::string &text, HttpRequest &request)
+{
+  return HttpParser::parseRequest(text.data(), text.size(), request);
+}
+
+const std::string getHeightRequest =
+  "POST /getheight HTTP/1.1\r\n"
+  "Host: 127.0.0.1\r\n"
+  "Content-Type: application/json\r\n"
+  "Content-Length: 2\r\n"
+  "\r\n"
+  "{}";
+
+} // namespace
+
+TEST(HttpParser, parsesRequest) {
+  HttpRequest request;
+  ASSERT_EQ(getHeightRequest.size(), parse(getHeightRequest, request));
+
+  ASSERT_EQ("POST", request.getMethod());
+  ASSERT_EQ("/getheight", request.getUrl());
+  ASSERT_EQ("{}", request.getBody());
+  ASSERT_TRUE(request.isKeepAlive());
+  ASSERT_EQ("application/json", request.getHeaders().at("content-type"));
+  ASSERT_EQ("127.0.0.1", request.getHeaders().at("host"));
+}
+
+TEST(HttpParser, waitsForCompleteRequest) {
+  for (size_t size = 0; size < getHeightRequest.size(); ++size) {
+    HttpRequest request;
+    ASSERT_EQ(0, parse(getHeightRequest.substr(0, size), request)) << size;
+  }
+}
+
+TEST(HttpParser, parsesPipelinedRequests) {
+  std::string text = getHeightRequest + "GET /getinfo HTTP/1.1\r\nConnection: close\r\n\r\n";
+
+  HttpRequest first;
+  size_t size = parse(text, first);
+  ASSERT_EQ(getHeightRequest.size(), size);
+
+  HttpRequest second;
+  ASSERT_EQ(text.size() - size, HttpParser::parseRequest(text.data() + size, text.size() - size, second));
+  ASSERT_EQ("GET", second.getMethod());
+  ASSERT_EQ("/getinfo", second.getUrl());
+  ASSERT_TRUE(second.getBody().empty());
+  ASSERT_FALSE(second.isKeepAlive());
+}
+
+TEST(HttpParser, trimsHeaderValues) {
+  HttpRequest request;
+  parse("GET / HTTP/1.1\r\nAuthorization:\t Basic abc  \r\nX-Empty:\r\n\r\n", request);
+
+  ASSERT_EQ("Basic abc", request.getHeaders().at("authorization"));
+  ASSERT_EQ("", request.getHeaders().at("x-empty"));
+}
+
+TEST(HttpParser, followsKeepAliveRules) {
+  HttpRequest request;
+
+  parse("GET / HTTP/1.0\r\n\r\n", request);
+  ASSERT_FALSE(request.isKeepAlive());
+
+  parse("GET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n", request);
+  ASSERT_TRUE(request.isKeepAlive());
+
+  parse("GET / HTTP/1.1\r\nConnection: Close\r\n\r\n", request);
+  ASSERT_FALSE(request.isKeepAlive());
+}
+
+TEST(HttpParser, acceptsChunkedFromHttp11Only) {
+  HttpRequest request;
+
+  parse("GET / HTTP/1.1\r\n\r\n", request);
+  ASSERT_TRUE(request.acceptsChunked());
+
+  parse("GET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n", request);
+  ASSERT_FALSE(request.acceptsChunked());
+}
+
+TEST(HttpParser, rejectsMalformedRequests) {
+  std::vector<std::string> badPatterns{
+    "GET\r\n\r\n",
+    "GET /\r\n\r\n",
+    "GET  / HTTP/1.1\r\n\r\n",
+    "GET / HTTP/2.0\r\n\r\n",
+    "GET / HTTP/1.1\r\nno colon\r\n\r\n",
+    "GET / HTTP/1.1\r\n: value\r\n\r\n",
+    "POST / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n",
+    "POST / HTTP/1.1\r\nContent-Length: 99999999999999999999\r\n\r\n",
+    "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n",
+  };
+
+  for (const auto &p : badPatterns) {
+    HttpRequest request;
+    ASSERT_ANY_THROW(parse(p, request)) << p;
+  }
+}
+
+TEST(HttpParser, rejectsOversizedHead) {
+  HttpRequest request;
+  ASSERT_ANY_THROW(parse("GET / HTTP/1.1\r\nX: " + std::string(128 * 1024, 'a'), request));
+}
+
+TEST(HttpResponse, appendsHead) {
+  HttpResponse response;
+  response.addHeader("Content-Type", "application/json");
+  response.setBody("{}");
+
+  std::string head;
+  response.appendHead(head);
+
+  std::ostringstream stream;
+  stream << response;
+
+  ASSERT_EQ(stream.str(), head + response.getBody());
+}
+
+TEST(HttpResponse, chunkedBodyReplacesContentLength) {
+  HttpResponse response;
+  response.setBody("{}");
+  response.setChunkedBody([](std::string &) { return false; });
+
+  ASSERT_TRUE(response.isChunked());
+  ASSERT_EQ(0, response.getHeaders().count("Content-Length"));
+  ASSERT_EQ("chunked", response.getHeaders().at("Transfer-Encoding"));
+
+  response.setBody("{}");
+  ASSERT_FALSE(response.isChunked());
+  ASSERT_EQ(0, response.getHeaders().count("Transfer-Encoding"));
+}
+
+TEST(HttpParser, readsChunkedResponse) {
+  std::string body(40000, 'x');
+
+  std::string text = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n";
+  HttpResponse::appendChunk(text, body.substr(0, 17));
+  HttpResponse::appendChunk(text, body.substr(17));
+  HttpResponse::appendChunk(text, std::string());
+
+  std::istringstream stream(text + "HTTP/1.1");
+  HttpResponse response;
+  HttpParser().receiveResponse(stream, response);
+
+  ASSERT_EQ(body, response.getBody());
+  ASSERT_EQ('H', stream.peek());
+}
@@ -0,0 +1,155 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <list>
+
+#include "Rpc/JsonArrayStream.h"
+#include "Serialization/SerializationTools.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+struct Item {
+  uint32_t height;
+  std::string hash;
+
+  void serialize(ISerializer &s) {
+    KV_MEMBER(height)
+    KV_MEMBER(hash)
+  }
+};
+
+struct Response {
+  std::string status;
+  std::vector<Item> items;
+  std::list<std::string> missed;
+  uint64_t count = 0;
+
+  void serialize(ISerializer &s) {
+    KV_MEMBER(status)
+    KV_MEMBER(items)
+    KV_MEMBER(missed)
+    KV_MEMBER(count)
+  }
+};
+
+Item makeItem(uint32_t height) {
+  return Item{ height, "hash" + std::to_string(height) };
+}
+
+// Adds batchSize items per call, the members after the array change along the way.
+std::function<bool(Response &)> makeProducer(uint32_t total, uint32_t batchSize) {
+  uint32_t next = 0;
+  return [=](Response &response) mutable {
+    for (uint32_t i = 0; i < batchSize && next < total; ++i) {
+      response.items.push_back(makeItem(next++));
+      response.count = next;
+      if (next % 7 == 0) {
+        response.missed.push_back(std::to_string(next));
+      }
+    }
+
+    return next < total;
+  };
+}
+
+Response makeExpected(uint32_t total) {
+  Response expected;
+  expected.status = "OK";
+  auto produce = makeProducer(total, total);
+  produce(expected);
+
+  return expected;
+}
+
+std::string readAll(HttpResponse::ChunkSource source, size_t *calls = nullptr) {
+  std::string text;
+  size_t count = 0;
+  while (source(text)) {
+    ++count;
+  }
+
+  if (calls != nullptr) {
+    *calls = count;
+  }
+
+  return text;
+}
+
+HttpResponse::ChunkSource makeStream(uint32_t total, uint32_t batchSize) {
+  auto response = std::make_shared<Response>();
+  response->status = "OK";
+
+  return makeJsonArrayStream<Response, Item>(
+    response,
+    &Response::items,
+    "items",
+    [](const Response &r) { return storeToJson(r); },
+    makeProducer(total, batchSize));
+}
+
+} // namespace
+
+TEST(JsonArrayStream, writesSameTextAsWholeResponse) {
+  for (uint32_t batchSize : { 1, 3, 50 }) {
+    ASSERT_EQ(storeToJson(makeExpected(50)), readAll(makeStream(50, batchSize))) << batchSize;
+  }
+}
+
+TEST(JsonArrayStream, producesOneChunkPerBatch) {
+  size_t calls = 0;
+  std::string text = readAll(makeStream(10, 2), &calls);
+
+  // the head plus five batches
+  ASSERT_EQ(6, calls);
+  ASSERT_EQ(storeToJson(makeExpected(10)), text);
+}
+
+TEST(JsonArrayStream, writesEmptyArray) {
+  ASSERT_EQ(storeToJson(makeExpected(0)), readAll(makeStream(0, 1)));
+}
+
+TEST(JsonArrayStream, findsArrayAfterEarlierMatch) {
+  auto response = std::make_shared<Response>();
+  response->status = "\"items\":[]";
+
+  std::string text = readAll(makeJsonArrayStream<Response, Item>(
+    response,
+    &Response::items,
+    "items",
+    [](const Response &r) { return "{\"id\":\"\"items\":[]\",\"result\":" + storeToJson(r) + "}"; },
+    makeProducer(5, 2)));
+
+  Response expected = makeExpected(5);
+  expected.status = response->status;
+  ASSERT_EQ("{\"id\":\"\"items\":[]\",\"result\":" + storeToJson(expected) + "}", text);
+}
+
+TEST(JsonArrayStream, throwsWithoutArray) {
+  auto source = makeJsonArrayStream<Response, Item>(
+    std::make_shared<Response>(),
+    &Response::items,
+    "other",
+    [](const Response &r) { return storeToJson(r); },
+    makeProducer(5, 2));
+
+  std::string text;
+  ASSERT_ANY_THROW(source(text));
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "Rpc/JsonRpc.h"
+
+using namespace CryptoNote;
+using namespace CryptoNote::JsonRpc;
+
+namespace {
+
+int errorCode(const std::string &body) {
+  std::vector<std::string> calls;
+  try {
+    splitBatch(body, calls);
+  } catch (const JsonRpcError &error) {
+    return error.code;
+  }
+
+  return 0;
+}
+
+} // namespace
+
+TEST(JsonRpcBatch, leavesSingleCall) {
+  std::vector<std::string> calls;
+  ASSERT_FALSE(splitBatch(" {\"method\":\"getblockcount\"}", calls));
+  ASSERT_FALSE(splitBatch("", calls));
+}
+
+TEST(JsonRpcBatch, splitsCalls) {
+  std::vector<std::string> calls;
+  ASSERT_TRUE(splitBatch(
+    " [ {\"id\":1,\"params\":{\"h\":[1,2]}} ,\n"
+    "{\"id\":\"a]},\\\"[\"}, 5 ]\r\n",
+    calls));
+
+  ASSERT_EQ(3, calls.size());
+  ASSERT_EQ("{\"id\":1,\"params\":{\"h\":[1,2]}}", calls[0]);
+  ASSERT_EQ("{\"id\":\"a]},\\\"[\"}", calls[1]);
+  ASSERT_EQ("5", calls[2]);
+}
+
+TEST(JsonRpcBatch, rejectsMalformedBatches) {
+  ASSERT_EQ(errInvalidRequest, errorCode("[]"));
+  ASSERT_EQ(errInvalidRequest, errorCode("[ ]"));
+  ASSERT_EQ(errParseError, errorCode("[{}"));
+  ASSERT_EQ(errParseError, errorCode("[{},]"));
+  ASSERT_EQ(errParseError, errorCode("[,{}]"));
+  ASSERT_EQ(errParseError, errorCode("[{}] x"));
+  ASSERT_EQ(errParseError, errorCode("[{\"a\":\"]}"));
+}
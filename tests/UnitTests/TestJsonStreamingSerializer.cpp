@@ -0,0 +1,239 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <limits>
+
+#include "crypto/Crypto.h"
+#include "Rpc/JsonRpc.h"
+#include "Serialization/JsonOutputStreamSerializer.h"
+#include "Serialization/JsonStreamingInputSerializer.h"
+#include "Serialization/JsonStreamingOutputSerializer.h"
+#include "Serialization/SerializationOverloads.h"
+#include "Serialization/SerializationTools.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+struct Inner
+{
+  uint32_t number = 0;
+  std::string text;
+
+  void serialize(ISerializer &s)
+  {
+    KV_MEMBER(number)
+    KV_MEMBER(text)
+  }
+
+  bool operator==(const Inner &other) const
+  {
+    return number == other.number && text == other.text;
+  }
+};
+
+struct Outer
+{
+  int64_t negative = 0;
+  uint64_t big = 0;
+  uint8_t small = 0;
+  double real = 0;
+  bool flag = false;
+  Crypto::Hash hash = Crypto::Hash();
+  std::string blob;
+  Inner inner;
+  std::vector<Inner> items;
+  std::vector<uint32_t> numbers;
+
+  void serialize(ISerializer &s)
+  {
+    KV_MEMBER(negative)
+    KV_MEMBER(big)
+    KV_MEMBER(small)
+    KV_MEMBER(real)
+    KV_MEMBER(flag)
+    KV_MEMBER(hash)
+    s.binary(blob, "blob");
+    KV_MEMBER(inner)
+    KV_MEMBER(items)
+    KV_MEMBER(numbers)
+  }
+
+  bool operator==(const Outer &other) const
+  {
+    return negative == other.negative && big == other.big && small == other.small &&
+           real == other.real && flag == other.flag && hash == other.hash &&
+           blob == other.blob && inner == other.inner && items == other.items &&
+           numbers == other.numbers;
+  }
+};
+
+Outer makeOuter()
+{
+  Outer v;
+  v.negative = std::numeric_limits<int64_t>::min();
+  v.big = 1234567890123456789;
+  v.small = 255;
+  v.real = 0.125;
+  v.flag = true;
+  v.hash = Crypto::rand<Crypto::Hash>();
+  v.blob = std::string("\x00\x01\xfe\xff", 4);
+  v.inner = { 7, "seven" };
+  v.items = { { 1, "one" }, { 2, "two" } };
+  v.numbers = { 10, 20, 30 };
+  return v;
+}
+
+// JsonOutputStreamSerializer can not write arrays of arrays
+struct Nested
+{
+  std::vector<std::vector<uint32_t>> nested;
+
+  void serialize(ISerializer &s) { KV_MEMBER(nested) }
+};
+
+struct Request
+{
+  uint32_t height = 0;
+
+  void serialize(ISerializer &s) { KV_MEMBER(height) }
+};
+
+} // namespace
+
+TEST(JsonStreamingSerializer, roundTrip) {
+  Outer v = makeOuter();
+  Outer loaded;
+
+  ASSERT_TRUE(loadFromJson(loaded, storeToJson(v)));
+  ASSERT_EQ(v, loaded);
+}
+
+TEST(JsonStreamingSerializer, roundTripNestedArrays) {
+  Nested v;
+  v.nested = { {}, { 1 }, { 2, 3 } };
+
+  std::string text = storeToJson(v);
+  ASSERT_EQ("{\"nested\":[[],[1],[2,3]]}", text);
+
+  Nested loaded;
+  ASSERT_TRUE(loadFromJson(loaded, text));
+  ASSERT_EQ(v.nested, loaded.nested);
+}
+
+TEST(JsonStreamingSerializer, writesSameValuesAsJsonValue) {
+  Outer v = makeOuter();
+
+  JsonOutputStreamSerializer dom;
+  serialize(v, dom);
+
+  std::string text;
+  JsonStreamingOutputSerializer s(text);
+  serialize(v, s);
+  s.finish();
+
+  ASSERT_EQ(dom.getValue().toString(), Common::JsonValue::fromString(text).toString());
+}
+
+TEST(JsonStreamingSerializer, readsTextWrittenByJsonValue) {
+  Outer v = makeOuter();
+  Outer loaded;
+
+  ASSERT_TRUE(loadFromJson(loaded, storeToJsonValue(v).toString()));
+  ASSERT_EQ(v, loaded);
+}
+
+TEST(JsonStreamingSerializer, skipsUnknownAndReportsMissingMembers) {
+  JsonStreamingInputSerializer s(std::string(
+    " { \"unknown\" : { \"a\" : [ 1 , \"}\" , { } ] } , \"number\" : 5 , \"text\" : \"x\\\"y\" } "));
+
+  uint32_t number = 0;
+  std::string text;
+  uint32_t missing = 42;
+
+  ASSERT_TRUE(s(number, "number"));
+  ASSERT_TRUE(s(text, "text"));
+  ASSERT_FALSE(s(missing, "missing"));
+  ASSERT_EQ(5, number);
+  ASSERT_EQ("x\\\"y", text);
+  ASSERT_EQ(42, missing);
+}
+
+TEST(JsonStreamingSerializer, throwsOnMalformedText) {
+  std::vector<std::string> badPatterns{
+    "",
+    "[]",
+    "{",
+    "{\"a\": }",
+    "{\"a\": 1,}",
+    "{\"a\" 1}",
+    "{\"a\": [1, 2}",
+    "{\"a\": \"text}",
+  };
+
+  for (const auto &p : badPatterns) {
+    std::cout << "Pattern: " << p << std::endl;
+    Inner v;
+    ASSERT_ANY_THROW({
+      JsonStreamingInputSerializer s(p);
+      serialize(v, s);
+    });
+  }
+}
+
+TEST(JsonStreamingSerializer, throwsOnTypeMismatch) {
+  Inner v;
+  ASSERT_FALSE(loadFromJson(v, "{\"number\": \"1\"}"));
+  ASSERT_FALSE(loadFromJson(v, "{\"number\": 1.5}"));
+  ASSERT_FALSE(loadFromJson(v, "{\"number\": 1, \"text\": 2}"));
+}
+
+TEST(JsonStreamingSerializer, jsonRpcRoundTrip) {
+  JsonRpc::JsonRpcRequest request;
+  request.parseRequest("{\"jsonrpc\":\"2.0\",\"id\":\"abc\",\"method\":\"test\",\"params\":{\"height\":12}}");
+
+  Request params;
+  ASSERT_TRUE(request.loadParams(params));
+  ASSERT_EQ("test", request.getMethod());
+  ASSERT_EQ(12, params.height);
+
+  Outer v = makeOuter();
+  JsonRpc::JsonRpcResponse response;
+  response.setId(request.getId());
+  response.setResult(v);
+
+  JsonRpc::JsonRpcResponse parsed;
+  parsed.parse(response.getBody());
+
+  Outer loaded;
+  JsonRpc::JsonRpcError error;
+  ASSERT_FALSE(parsed.getError(error));
+  ASSERT_TRUE(parsed.getResult(loaded));
+  ASSERT_EQ(v, loaded);
+
+  Common::JsonValue body = Common::JsonValue::fromString(response.getBody());
+  ASSERT_EQ("abc", body("id").getString());
+  ASSERT_EQ("2.0", body("jsonrpc").getString());
+}
+
+TEST(JsonStreamingSerializer, jsonRpcRejectsBadRequests) {
+  JsonRpc::JsonRpcRequest request;
+  ASSERT_THROW(request.parseRequest("{\"method\":"), JsonRpc::JsonRpcError);
+  ASSERT_THROW(request.parseRequest("{\"params\":{}}"), JsonRpc::JsonRpcError);
+}
@@ -22,6 +22,10 @@
 
 #include "P2p/PeerListManager.h"
 #include "P2p/PeerListManager.cpp"
+#include "Serialization/BinaryInputStreamSerializer.h"
+#include "Serialization/BinaryOutputStreamSerializer.h"
+#include "Common/MemoryInputStream.h"
+#include "Common/VectorOutputStream.h"
 
 using namespace CryptoNote;
 
@@ -75,3 +79,85 @@ TEST(peer_list, merge_peer_lists)
 
 
 }
+
+TEST(peer_list, white_peers_ordered_by_score)
+{
+  PeerlistManager plm;
+  plm.init(false);
+
+  ADD_WHITE_NODE(MAKE_IP(123,43,12,1), 8080, 1, 34345);
+  ADD_WHITE_NODE(MAKE_IP(123,43,12,2), 8080, 2, 34346);
+  ADD_WHITE_NODE(MAKE_IP(123,43,12,3), 8080, 3, 34347);
+  ADD_WHITE_NODE(MAKE_IP(123,43,12,4), 8080, 4, 34348);
+
+  // fast and reliable
+  plm.on_peer_handshake({ MAKE_IP(123,43,12,1), 8080 }, 20);
+  plm.on_peer_disconnected({ MAKE_IP(123,43,12,1), 8080 }, 3600, 2 * 1024 * 1024, 0);
+  // slow
+  plm.on_peer_handshake({ MAKE_IP(123,43,12,2), 8080 }, 1500);
+  // sent invalid blocks
+  plm.on_peer_handshake({ MAKE_IP(123,43,12,3), 8080 }, 20);
+  plm.on_peer_disconnected({ MAKE_IP(123,43,12,3), 8080 }, 60, 0, 1);
+  // peer 4 was never measured
+
+  std::vector<PeerlistEntry> peers;
+  plm.get_white_peers_by_score(peers, 10);
+  ASSERT_EQ(4, peers.size());
+  ASSERT_EQ(1, peers[0].id);
+  ASSERT_EQ(4, peers[1].id);
+  ASSERT_EQ(2, peers[2].id);
+  ASSERT_EQ(3, peers[3].id);
+
+  plm.get_white_peers_by_score(peers, 2);
+  ASSERT_EQ(2, peers.size());
+}
+
+TEST(peer_list, failures_lower_score)
+{
+  PeerStats stats;
+  double neutral = stats.score();
+
+  stats.failures = 3;
+  ASSERT_LT(stats.score(), neutral);
+
+  stats.failures = 0;
+  stats.handshake_rtt = 50;
+  ASSERT_GT(stats.score(), neutral);
+}
+
+TEST(peer_list, stats_are_serialized)
+{
+  PeerlistManager plm;
+  plm.init(false);
+
+  ADD_WHITE_NODE(MAKE_IP(123,43,12,1), 8080, 1, 34345);
+  plm.on_peer_handshake({ MAKE_IP(123,43,12,1), 8080 }, 120);
+  plm.on_peer_disconnected({ MAKE_IP(123,43,12,1), 8080 }, 600, 4096, 2);
+  // not in any list, so it is not stored
+  plm.on_peer_failure({ MAKE_IP(123,43,12,9), 8080 });
+
+  std::vector<uint8_t> data;
+  {
+    Common::VectorOutputStream stream(data);
+    BinaryOutputStreamSerializer s(stream);
+    plm.serialize(s);
+    plm.serialize_stats(s);
+  }
+
+  PeerlistManager restored;
+  restored.init(false);
+  {
+    Common::MemoryInputStream stream(data.data(), data.size());
+    BinaryInputStreamSerializer s(stream);
+    restored.serialize(s);
+    restored.serialize_stats(s);
+  }
+
+  PeerStats stats;
+  ASSERT_TRUE(restored.get_peer_stats({ MAKE_IP(123,43,12,1), 8080 }, stats));
+  ASSERT_EQ(120, stats.handshake_rtt);
+  ASSERT_EQ(4096, stats.sync_throughput);
+  ASSERT_EQ(2, stats.invalid_objects);
+  ASSERT_EQ(600, stats.uptime);
+  ASSERT_FALSE(restored.get_peer_stats({ MAKE_IP(123,43,12,9), 8080 }, stats));
+}
@@ -0,0 +1,142 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "Rpc/RpcAdmission.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const uint32_t CLIENT = 0x0100007f;
+const uint32_t OTHER_CLIENT = 0x0200007f;
+
+RpcAdmission::Clock::time_point at(double seconds)
+{
+  return RpcAdmission::Clock::time_point(std::chrono::duration_cast<RpcAdmission::Clock::duration>(
+      std::chrono::duration<double>(seconds)));
+}
+
+} // namespace
+
+TEST(RpcAdmission, admitsEverythingWithoutLimits) {
+  RpcAdmission admission;
+
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(admission.charge(CLIENT, 1000000, at(0)));
+  }
+  ASSERT_NE(nullptr, admission.enter());
+  ASSERT_FALSE(admission.chargesClients());
+  ASSERT_EQ(0, admission.clientCount());
+}
+
+TEST(RpcAdmission, refusesClientWithEmptyBucket) {
+  RpcAdmission admission;
+  admission.setLimits(0, 10, 100);
+
+  ASSERT_TRUE(admission.charge(CLIENT, 60, at(0)));
+  ASSERT_TRUE(admission.charge(CLIENT, 40, at(0)));
+  ASSERT_FALSE(admission.charge(CLIENT, 1, at(0)));
+
+  // the others keep their own budget
+  ASSERT_TRUE(admission.charge(OTHER_CLIENT, 1, at(0)));
+}
+
+TEST(RpcAdmission, refillsBucketOverTime) {
+  RpcAdmission admission;
+  admission.setLimits(0, 10, 100);
+
+  ASSERT_TRUE(admission.charge(CLIENT, 100, at(0)));
+  ASSERT_FALSE(admission.charge(CLIENT, 1, at(0)));
+  ASSERT_TRUE(admission.charge(CLIENT, 1, at(0.5)));
+  ASSERT_TRUE(admission.charge(CLIENT, 1, at(0.5)));
+  ASSERT_TRUE(admission.charge(CLIENT, 3, at(0.5)));
+  ASSERT_FALSE(admission.charge(CLIENT, 1, at(0.5)));
+}
+
+TEST(RpcAdmission, refusesRequestOverBudgetWithoutCharging) {
+  RpcAdmission admission;
+  admission.setLimits(0, 10, 100);
+
+  // costlier than a full bucket, never admitted
+  ASSERT_FALSE(admission.charge(CLIENT, 300, at(0)));
+  ASSERT_TRUE(admission.charge(CLIENT, 70, at(0)));
+
+  ASSERT_FALSE(admission.charge(CLIENT, 31, at(0)));
+  ASSERT_TRUE(admission.charge(CLIENT, 30, at(0)));
+  ASSERT_FALSE(admission.charge(CLIENT, 1, at(0)));
+}
+
+TEST(RpcAdmission, limitsStreamsApartFromRequests) {
+  RpcAdmission admission;
+  admission.setLimits(1, 0, 0);
+
+  std::shared_ptr<void> request = admission.enter();
+  std::shared_ptr<void> stream = admission.enterStream();
+  ASSERT_NE(nullptr, request);
+  ASSERT_NE(nullptr, stream);
+  ASSERT_EQ(nullptr, admission.enterStream());
+
+  request.reset();
+  ASSERT_EQ(0, admission.activeCount());
+  ASSERT_EQ(1, admission.streamCount());
+  ASSERT_NE(nullptr, admission.enter());
+
+  stream.reset();
+  ASSERT_EQ(0, admission.streamCount());
+}
+
+TEST(RpcAdmission, limitsActiveRequests) {
+  RpcAdmission admission;
+  admission.setLimits(2, 0, 0);
+
+  std::shared_ptr<void> first = admission.enter();
+  std::shared_ptr<void> second = admission.enter();
+  ASSERT_NE(nullptr, first);
+  ASSERT_NE(nullptr, second);
+  ASSERT_EQ(nullptr, admission.enter());
+  ASSERT_EQ(2, admission.activeCount());
+
+  std::shared_ptr<void> copy = second;
+  second.reset();
+  ASSERT_EQ(nullptr, admission.enter());
+
+  copy.reset();
+  ASSERT_EQ(1, admission.activeCount());
+  ASSERT_NE(nullptr, admission.enter());
+}
+
+TEST(RpcAdmission, forgetsIdleClients) {
+  RpcAdmission admission;
+  admission.setLimits(0, 10, 100);
+
+  for (uint32_t client = 0; client < 1024; ++client) {
+    ASSERT_TRUE(admission.charge(client, 50, at(0)));
+  }
+  ASSERT_EQ(1024, admission.clientCount());
+
+  // the first ones are busy again, the rest had time to refill
+  for (uint32_t client = 0; client < 10; ++client) {
+    ASSERT_TRUE(admission.charge(client, 50, at(10)));
+  }
+  ASSERT_TRUE(admission.charge(5000, 1, at(10)));
+
+  ASSERT_EQ(11, admission.clientCount());
+  ASSERT_TRUE(admission.charge(3, 50, at(10)));
+  ASSERT_FALSE(admission.charge(3, 1, at(10)));
+}
@@ -0,0 +1,123 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "Rpc/RpcResponseCache.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+// what a body of length bodySize takes under key "k<n>", see RpcResponseCache::put
+size_t entrySize(size_t bodySize)
+{
+  return 2 + bodySize + 128;
+}
+
+} // namespace
+
+TEST(RpcResponseCache, returnsStoredBody) {
+  RpcResponseCache cache(1000);
+  std::string body;
+
+  ASSERT_FALSE(cache.get("k1", body));
+
+  cache.put("k1", 10, "answer", cache.generation());
+
+  ASSERT_TRUE(cache.get("k1", body));
+  ASSERT_EQ("answer", body);
+  ASSERT_EQ(entrySize(6), cache.size());
+  ASSERT_EQ(1, cache.hits());
+  ASSERT_EQ(1, cache.misses());
+}
+
+TEST(RpcResponseCache, evictsLeastRecentlyUsed) {
+  RpcResponseCache cache(3 * entrySize(10));
+  std::string body;
+  cache.put("k1", 1, std::string(10, '1'), 0);
+  cache.put("k2", 2, std::string(10, '2'), 0);
+  cache.put("k3", 3, std::string(10, '3'), 0);
+
+  ASSERT_TRUE(cache.get("k1", body));
+
+  cache.put("k4", 4, std::string(10, '4'), 0);
+
+  ASSERT_EQ(3, cache.count());
+  ASSERT_EQ(3 * entrySize(10), cache.size());
+  ASSERT_TRUE(cache.get("k1", body));
+  ASSERT_FALSE(cache.get("k2", body));
+  ASSERT_TRUE(cache.get("k3", body));
+  ASSERT_TRUE(cache.get("k4", body));
+}
+
+TEST(RpcResponseCache, skipsBodyLargerThanLimit) {
+  RpcResponseCache cache(entrySize(10));
+  cache.put("k1", 1, std::string(11, '1'), 0);
+
+  ASSERT_EQ(0, cache.count());
+  ASSERT_EQ(0, cache.size());
+}
+
+TEST(RpcResponseCache, replacesBodyOfSameKey) {
+  RpcResponseCache cache(1000);
+  std::string body;
+  cache.put("k1", 1, "old", 0);
+  cache.put("k1", 5, "newer", 0);
+
+  ASSERT_EQ(1, cache.count());
+  ASSERT_EQ(entrySize(5), cache.size());
+  ASSERT_TRUE(cache.get("k1", body));
+  ASSERT_EQ("newer", body);
+
+  cache.removeFrom(2);
+  ASSERT_EQ(0, cache.count());
+}
+
+TEST(RpcResponseCache, removeFromDropsEntriesReadFromHigherBlocks) {
+  RpcResponseCache cache(10000);
+  std::string body;
+  for (uint32_t i = 0; i < 5; ++i) {
+    cache.put("k" + std::to_string(i), i, "body", 0);
+  }
+  cache.put("k5", 3, "body", 0);
+
+  cache.removeFrom(3);
+
+  ASSERT_EQ(3, cache.count());
+  ASSERT_EQ(3 * entrySize(4), cache.size());
+  ASSERT_TRUE(cache.get("k2", body));
+  ASSERT_FALSE(cache.get("k3", body));
+  ASSERT_FALSE(cache.get("k4", body));
+  ASSERT_FALSE(cache.get("k5", body));
+}
+
+TEST(RpcResponseCache, ignoresBodyReadBeforeRemoval) {
+  RpcResponseCache cache(1000);
+  std::string body;
+  uint64_t generation = cache.generation();
+
+  cache.removeFrom(7);
+  cache.put("k1", 5, "stale", generation);
+
+  ASSERT_FALSE(cache.get("k1", body));
+
+  cache.put("k1", 5, "fresh", cache.generation());
+
+  ASSERT_TRUE(cache.get("k1", body));
+  ASSERT_EQ("fresh", body);
+}
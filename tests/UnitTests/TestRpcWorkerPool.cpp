@@ -0,0 +1,92 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <gtest/gtest.h>
+
+#include "Rpc/RpcWorkerPool.h"
+
+using namespace CryptoNote;
+
+TEST(RpcWorkerPool, runsEveryTask) {
+  std::mutex mutex;
+  std::condition_variable done;
+  size_t finished = 0;
+  {
+    RpcWorkerPool pool(3);
+    for (size_t i = 0; i < 100; ++i) {
+      pool.post([&]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++finished;
+        done.notify_one();
+      });
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&]() { return finished == 100; });
+  }
+
+  ASSERT_EQ(100, finished);
+}
+
+TEST(RpcWorkerPool, runsAtMostThreadCountTasksAtOnce) {
+  std::atomic<size_t> running(0);
+  std::atomic<size_t> mostRunning(0);
+  std::atomic<size_t> finished(0);
+  {
+    RpcWorkerPool pool(2);
+    ASSERT_EQ(2, pool.threadCount());
+    for (size_t i = 0; i < 20; ++i) {
+      pool.post([&]() {
+        size_t now = ++running;
+        size_t most = mostRunning;
+        while (now > most && !mostRunning.compare_exchange_weak(most, now)) {
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        --running;
+        ++finished;
+      });
+    }
+
+    while (finished != 20) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  ASSERT_LE(mostRunning, 2);
+}
+
+TEST(RpcWorkerPool, keepsRunningAfterTaskThrows) {
+  std::atomic<bool> ran(false);
+  {
+    RpcWorkerPool pool(1);
+    pool.post([]() { throw std::runtime_error("failed"); });
+    pool.post([&]() { ran = true; });
+
+    while (!ran) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  ASSERT_TRUE(ran);
+}
@@ -0,0 +1,263 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "CryptoNoteCore/TransactionApi.h"
+#include "Transfers/IObservableImpl.h"
+#include "Transfers/ScanningEngine.h"
+#include "TransactionApiHelpers.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+class ConsumerStub : public IObservableImpl<IBlockchainConsumerObserver, IBlockchainConsumer> {
+public:
+  explicit ConsumerStub(uint64_t syncStartTimestamp = 0) {
+    m_syncStart.height = 0;
+    m_syncStart.timestamp = syncStartTimestamp;
+  }
+
+  SynchronizationStart getSyncStart() override { return m_syncStart; }
+  const std::unordered_set<Crypto::Hash>& getKnownPoolTxIds() const override { return m_poolTxs; }
+  void onBlockchainDetach(uint32_t height) override {}
+  bool onNewBlocks(const CompleteBlock* blocks, uint32_t startHeight, uint32_t count) override { return true; }
+  std::error_code onPoolUpdated(const std::vector<std::unique_ptr<ITransactionReader>>& addedTransactions,
+                                const std::vector<Crypto::Hash>& deletedTransactions) override {
+    return std::error_code();
+  }
+  std::error_code addUnconfirmedTransaction(const ITransactionReader& transaction) override { return std::error_code(); }
+  void removeUnconfirmedTransaction(const Crypto::Hash& transactionHash) override {}
+
+private:
+  SynchronizationStart m_syncStart;
+  std::unordered_set<Crypto::Hash> m_poolTxs;
+};
+
+class ScanningEngineTest : public ::testing::Test {
+public:
+  ScanningEngineTest() :
+    m_alice(generateAccountKeys()),
+    m_bob(generateAccountKeys()) {
+    m_aliceSpendKeys.insert(m_alice.address.spendPublicKey);
+    m_bobSpendKeys.insert(m_bob.address.spendPublicKey);
+  }
+
+protected:
+  void addBlock(uint64_t timestamp, const std::shared_ptr<ITransactionReader>& tx) {
+    CompleteBlock block;
+    block.blockHash = Crypto::rand<Crypto::Hash>();
+    block.block = CryptoNote::Block();
+    block.block->timestamp = timestamp;
+    block.transactions.push_back(tx);
+    m_blocks.push_back(std::move(block));
+  }
+
+  std::vector<uint32_t> outputsOf(const ScanningEngine::BatchOutputs& outputs,
+                                  const std::shared_ptr<ITransactionReader>& tx,
+                                  const AccountKeys& keys) {
+    auto txOutputs = outputs.find(tx.get());
+    if (txOutputs == outputs.end()) {
+      return {};
+    }
+
+    auto keyOutputs = txOutputs->second.find(keys.address.spendPublicKey);
+    return keyOutputs == txOutputs->second.end() ? std::vector<uint32_t>() : keyOutputs->second;
+  }
+
+  AccountKeys m_alice;
+  AccountKeys m_bob;
+  std::unordered_set<Crypto::PublicKey> m_aliceSpendKeys;
+  std::unordered_set<Crypto::PublicKey> m_bobSpendKeys;
+  std::vector<CompleteBlock> m_blocks;
+  ScanningEngine m_engine;
+};
+
+std::shared_ptr<ITransactionReader> buildTransaction(const std::vector<AccountKeys>& receivers) {
+  TestTransactionBuilder builder;
+  builder.addTestInput(100000);
+  uint32_t globalIndex = 0;
+  for (const auto& keys : receivers) {
+    builder.addTestKeyOutput(1000, globalIndex++, keys);
+  }
+
+  return std::shared_ptr<ITransactionReader>(builder.build().release());
+}
+
+} // namespace
+
+TEST_F(ScanningEngineTest, findsOutputsOfEveryConsumer) {
+  ConsumerStub alice;
+  ConsumerStub bob;
+  m_engine.addConsumer(&alice, m_alice.viewSecretKey, m_aliceSpendKeys);
+  m_engine.addConsumer(&bob, m_bob.viewSecretKey, m_bobSpendKeys);
+
+  auto tx = buildTransaction({ m_bob, generateAccountKeys(), m_alice, m_bob });
+  auto foreignTx = buildTransaction({ generateAccountKeys() });
+  addBlock(100, tx);
+  addBlock(101, foreignTx);
+
+  auto aliceOutputs = m_engine.scan(&alice, m_blocks.data(), 10, 2);
+  auto bobOutputs = m_engine.scan(&bob, m_blocks.data(), 10, 2);
+
+  ASSERT_EQ(1, aliceOutputs.size());
+  ASSERT_EQ(std::vector<uint32_t>({ 2 }), outputsOf(aliceOutputs, tx, m_alice));
+  ASSERT_EQ(1, bobOutputs.size());
+  ASSERT_EQ(std::vector<uint32_t>({ 0, 3 }), outputsOf(bobOutputs, tx, m_bob));
+}
+
+TEST_F(ScanningEngineTest, handsOverPartOfScannedBatch) {
+  ConsumerStub alice;
+  ConsumerStub bob;
+  m_engine.addConsumer(&alice, m_alice.viewSecretKey, m_aliceSpendKeys);
+  m_engine.addConsumer(&bob, m_bob.viewSecretKey, m_bobSpendKeys);
+
+  auto first = buildTransaction({ m_alice, m_bob });
+  auto second = buildTransaction({ m_bob });
+  addBlock(100, first);
+  addBlock(101, second);
+
+  m_engine.scan(&alice, m_blocks.data(), 10, 2);
+  // bob already had the first block
+  auto bobOutputs = m_engine.scan(&bob, m_blocks.data() + 1, 11, 1);
+
+  ASSERT_EQ(1, bobOutputs.size());
+  ASSERT_EQ(std::vector<uint32_t>({ 0 }), outputsOf(bobOutputs, second, m_bob));
+}
+
+TEST_F(ScanningEngineTest, skipsBlocksBeforeSyncStart) {
+  ConsumerStub alice;
+  ConsumerStub bob(1000);
+  m_engine.addConsumer(&alice, m_alice.viewSecretKey, m_aliceSpendKeys);
+  m_engine.addConsumer(&bob, m_bob.viewSecretKey, m_bobSpendKeys);
+
+  auto early = buildTransaction({ m_alice, m_bob });
+  auto late = buildTransaction({ m_alice, m_bob });
+  addBlock(999, early);
+  addBlock(1000, late);
+
+  auto aliceOutputs = m_engine.scan(&alice, m_blocks.data(), 1, 2);
+  auto bobOutputs = m_engine.scan(&bob, m_blocks.data(), 1, 2);
+
+  ASSERT_EQ(2, aliceOutputs.size());
+  ASSERT_EQ(1, bobOutputs.size());
+  ASSERT_EQ(std::vector<uint32_t>({ 1 }), outputsOf(bobOutputs, late, m_bob));
+}
+
+TEST_F(ScanningEngineTest, scansAgainForConsumerAtOtherHeight) {
+  ConsumerStub alice;
+  ConsumerStub bob;
+  m_engine.addConsumer(&alice, m_alice.viewSecretKey, m_aliceSpendKeys);
+  m_engine.addConsumer(&bob, m_bob.viewSecretKey, m_bobSpendKeys);
+  m_engine.onBlockchainDetach(&bob, 500);
+
+  auto tx = buildTransaction({ m_alice, m_bob });
+  addBlock(100, tx);
+
+  m_engine.scan(&alice, m_blocks.data(), 10, 1);
+  auto bobOutputs = m_engine.scan(&bob, m_blocks.data(), 10, 1);
+
+  ASSERT_EQ(std::vector<uint32_t>({ 1 }), outputsOf(bobOutputs, tx, m_bob));
+}
+
+TEST_F(ScanningEngineTest, scansAgainWhenBlockChanges) {
+  ConsumerStub alice;
+  m_engine.addConsumer(&alice, m_alice.viewSecretKey, m_aliceSpendKeys);
+
+  auto tx = buildTransaction({ m_alice });
+  addBlock(100, tx);
+  ASSERT_EQ(1, m_engine.scan(&alice, m_blocks.data(), 10, 1).size());
+
+  // another block at the same height after a detach
+  auto otherTx = buildTransaction({ generateAccountKeys(), m_alice });
+  m_blocks.clear();
+  addBlock(100, otherTx);
+  m_engine.onBlockchainDetach(&alice, 10);
+  auto outputs = m_engine.scan(&alice, m_blocks.data(), 10, 1);
+
+  ASSERT_EQ(std::vector<uint32_t>({ 1 }), outputsOf(outputs, otherTx, m_alice));
+}
+
+TEST_F(ScanningEngineTest, forgetsRemovedConsumer) {
+  ConsumerStub alice;
+  ConsumerStub bob;
+  m_engine.addConsumer(&alice, m_alice.viewSecretKey, m_aliceSpendKeys);
+  m_engine.addConsumer(&bob, m_bob.viewSecretKey, m_bobSpendKeys);
+
+  auto tx = buildTransaction({ m_alice, m_bob });
+  addBlock(100, tx);
+  m_engine.scan(&alice, m_blocks.data(), 10, 1);
+  m_engine.removeConsumer(&bob);
+
+  m_engine.addConsumer(&bob, m_bob.viewSecretKey, m_bobSpendKeys);
+  auto bobOutputs = m_engine.scan(&bob, m_blocks.data(), 10, 1);
+
+  ASSERT_EQ(std::vector<uint32_t>({ 1 }), outputsOf(bobOutputs, tx, m_bob));
+}
+
+TEST_F(ScanningEngineTest, scansAgainWhenSubscriptionsChange) {
+  ConsumerStub alice;
+  std::unordered_set<Crypto::PublicKey> spendKeys;
+  m_engine.addConsumer(&alice, m_alice.viewSecretKey, spendKeys);
+
+  auto tx = buildTransaction({ m_alice });
+  addBlock(100, tx);
+  ASSERT_TRUE(m_engine.scan(&alice, m_blocks.data(), 10, 1).empty());
+
+  spendKeys.insert(m_alice.address.spendPublicKey);
+  m_engine.onSubscriptionsChanged(&alice);
+  auto outputs = m_engine.scan(&alice, m_blocks.data(), 10, 1);
+
+  ASSERT_EQ(std::vector<uint32_t>({ 0 }), outputsOf(outputs, tx, m_alice));
+}
+
+TEST_F(ScanningEngineTest, viewTagFilterSkipsOutputsWithOtherTags) {
+  ConsumerStub alice;
+  ConsumerStub bob;
+  m_engine.addConsumer(&alice, m_alice.viewSecretKey, m_aliceSpendKeys);
+  m_engine.addConsumer(&bob, m_bob.viewSecretKey, m_bobSpendKeys);
+  m_engine.setViewTagFilter(true);
+
+  std::shared_ptr<ITransaction> tx(createTransaction());
+  addTestInput(*tx, 100000);
+  addTestKeyOutput(*tx, 1000, 0, m_alice);
+  addTestKeyOutput(*tx, 1000, 1, m_bob);
+  std::vector<uint8_t> tags = getTestViewTags(*tx, { m_alice, m_bob });
+  // a tag the sender got wrong, the filter has to drop the output
+  tags[1] ^= 1;
+  addTestViewTags(*tx, tags);
+  addBlock(100, tx);
+
+  auto aliceOutputs = m_engine.scan(&alice, m_blocks.data(), 10, 1);
+  auto bobOutputs = m_engine.scan(&bob, m_blocks.data(), 10, 1);
+
+  ASSERT_EQ(std::vector<uint32_t>({ 0 }), outputsOf(aliceOutputs, tx, m_alice));
+  ASSERT_TRUE(bobOutputs.empty());
+}
+
+TEST_F(ScanningEngineTest, viewTagFilterScansUntaggedTransactionsFully) {
+  ConsumerStub alice;
+  m_engine.addConsumer(&alice, m_alice.viewSecretKey, m_aliceSpendKeys);
+  m_engine.setViewTagFilter(true);
+
+  auto tx = buildTransaction({ generateAccountKeys(), m_alice });
+  addBlock(100, tx);
+  auto outputs = m_engine.scan(&alice, m_blocks.data(), 10, 1);
+
+  ASSERT_EQ(std::vector<uint32_t>({ 1 }), outputsOf(outputs, tx, m_alice));
+}
@@ -0,0 +1,126 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include "Transfers/ScanningPool.h"
+
+using namespace CryptoNote;
+
+TEST(ScanningPool, callsEveryIndexOnce) {
+  ScanningPool pool(3);
+  std::vector<std::atomic<int>> calls(1000);
+  for (auto& call : calls) {
+    call = 0;
+  }
+
+  pool.run(calls.size(), [&](size_t index) { ++calls[index]; });
+
+  for (size_t i = 0; i < calls.size(); ++i) {
+    ASSERT_EQ(1, calls[i]) << "index " << i;
+  }
+}
+
+TEST(ScanningPool, runsWithoutThreads) {
+  ScanningPool pool(0);
+  std::vector<size_t> order;
+
+  pool.run(5, [&](size_t index) { order.push_back(index); });
+
+  ASSERT_EQ(std::vector<size_t>({ 0, 1, 2, 3, 4 }), order);
+}
+
+TEST(ScanningPool, reusesThreadsAcrossJobs) {
+  ScanningPool pool(2);
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+
+  for (int job = 0; job < 50; ++job) {
+    pool.run(30, [&](size_t) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      std::lock_guard<std::mutex> lock(mutex);
+      threads.insert(std::this_thread::get_id());
+    });
+  }
+
+  ASSERT_GE(pool.concurrency(), threads.size());
+}
+
+TEST(ScanningPool, stealsFromSlowRange) {
+  ScanningPool pool(1);
+  std::atomic<size_t> slowDone(0);
+  std::atomic<size_t> fastDone(0);
+
+  // the first half goes to the calling thread, which blocks on its first index
+  // until the worker has taken over the rest of that half
+  pool.run(20, [&](size_t index) {
+    if (index == 0) {
+      while (fastDone < 19) {
+        std::this_thread::yield();
+      }
+      ++slowDone;
+    } else {
+      ++fastDone;
+    }
+  });
+
+  ASSERT_EQ(1, slowDone);
+  ASSERT_EQ(19, fastDone);
+}
+
+TEST(ScanningPool, rethrowsTaskException) {
+  ScanningPool pool(2);
+  std::atomic<size_t> calls(0);
+
+  ASSERT_THROW(pool.run(100, [&](size_t index) {
+    ++calls;
+    if (index == 42) {
+      throw std::runtime_error("failed");
+    }
+  }), std::runtime_error);
+
+  ASSERT_EQ(100, calls);
+
+  // the pool stays usable
+  calls = 0;
+  pool.run(10, [&](size_t) { ++calls; });
+  ASSERT_EQ(10, calls);
+}
+
+TEST(ScanningPool, serializesConcurrentJobs) {
+  ScanningPool pool(2);
+  std::atomic<size_t> total(0);
+
+  std::thread other([&] {
+    for (int job = 0; job < 20; ++job) {
+      pool.run(50, [&](size_t) { ++total; });
+    }
+  });
+
+  for (int job = 0; job < 20; ++job) {
+    pool.run(50, [&](size_t) { ++total; });
+  }
+  other.join();
+
+  ASSERT_EQ(2000, total);
+}
@@ -0,0 +1,128 @@
+// Copyright (c) 2018-2021, The Qwertycoin Group.
+//
+// This file is part of Qwertycoin.
+//
+// Qwertycoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Qwertycoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "CryptoNoteProtocol/SyncBatchController.h"
+#include "Global/CryptoNoteConfig.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+typedef SyncBatchController::Clock Clock;
+
+// sends one batch of the suggested size and receives it after the given delay
+size_t transferBatch(SyncBatchController &controller, Clock::time_point &now,
+                     size_t blockSize, std::chrono::milliseconds delay)
+{
+  size_t blocks = controller.nextBatchSize();
+  controller.onRequestSent(blocks, now);
+  now += delay;
+  controller.onResponseReceived(blocks, blocks * blockSize, now);
+  return blocks;
+}
+
+} // namespace
+
+TEST(SyncBatchController, startsWithDefaultBatchAndSingleRequest) {
+  SyncBatchController controller;
+
+  ASSERT_EQ(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT, controller.nextBatchSize());
+  ASSERT_TRUE(controller.canRequest());
+
+  controller.onRequestSent(controller.nextBatchSize());
+  ASSERT_FALSE(controller.canRequest());
+  ASSERT_EQ(1, controller.requestsInFlight());
+  ASSERT_EQ(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT, controller.expectedBlocks());
+}
+
+TEST(SyncBatchController, growsBatchOnFastPeer) {
+  SyncBatchController controller;
+  Clock::time_point now = Clock::now();
+
+  // 1 KB blocks, 128 blocks in 10 ms
+  for (int i = 0; i < 10; ++i) {
+    transferBatch(controller, now, 1024, std::chrono::milliseconds(10));
+  }
+
+  ASSERT_EQ(BLOCKS_SYNCHRONIZING_MAX_COUNT, controller.nextBatchSize());
+  ASSERT_TRUE(controller.canRequest());
+}
+
+TEST(SyncBatchController, shrinksBatchOnSlowPeer) {
+  SyncBatchController controller;
+  Clock::time_point now = Clock::now();
+
+  // 100 KB blocks at about 100 KB/s
+  for (int i = 0; i < 10; ++i) {
+    size_t blocks = controller.nextBatchSize();
+    transferBatch(controller, now, 100 * 1024, std::chrono::milliseconds(1000 * blocks));
+  }
+
+  size_t expected = BLOCKS_SYNCHRONIZING_MIN_BATCH_SIZE / (100 * 1024);
+  ASSERT_LT(controller.nextBatchSize(), BLOCKS_SYNCHRONIZING_DEFAULT_COUNT);
+  ASSERT_EQ(std::max(expected, BLOCKS_SYNCHRONIZING_MIN_COUNT), controller.nextBatchSize());
+}
+
+TEST(SyncBatchController, limitsRequestsInFlight) {
+  SyncBatchController controller;
+  Clock::time_point now = Clock::now();
+  transferBatch(controller, now, 1024, std::chrono::milliseconds(100));
+  ASSERT_EQ(std::chrono::milliseconds(100), controller.roundTrip());
+
+  size_t sent = 0;
+  while (controller.canRequest()) {
+    controller.onRequestSent(controller.nextBatchSize(), now);
+    ++sent;
+  }
+
+  ASSERT_EQ(2, sent);
+
+  controller.onResponseReceived(controller.expectedBlocks(), 1024, now);
+  ASSERT_TRUE(controller.canRequest());
+}
+
+TEST(SyncBatchController, coversLongRoundTrip) {
+  SyncBatchController controller;
+  Clock::time_point now = Clock::now();
+  transferBatch(controller, now, 1024, std::chrono::milliseconds(10000));
+
+  size_t sent = 0;
+  while (controller.canRequest()) {
+    controller.onRequestSent(controller.nextBatchSize(), now);
+    ++sent;
+  }
+
+  ASSERT_EQ(BLOCKS_SYNCHRONIZING_MAX_REQUESTS_IN_FLIGHT, sent);
+}
+
+TEST(SyncBatchController, discardsResponsesToCancelledRequests) {
+  SyncBatchController controller;
+  Clock::time_point now = Clock::now();
+  transferBatch(controller, now, 1024, std::chrono::milliseconds(100));
+
+  controller.onRequestSent(10, now);
+  controller.onRequestSent(20, now);
+  controller.cancelRequests();
+
+  ASSERT_EQ(0, controller.requestsInFlight());
+  ASSERT_EQ(0, controller.expectedBlocks());
+  ASSERT_TRUE(controller.discardResponse());
+  ASSERT_TRUE(controller.discardResponse());
+  ASSERT_FALSE(controller.discardResponse());
+}
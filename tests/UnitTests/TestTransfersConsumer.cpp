@@ -503,6 +503,54 @@ TEST_F(TransfersConsumerTest, onNewBlocks_DifferentSubscribers) {
   ASSERT_EQ(amount2, outs2[0].amount);
 }
 
+TEST_F(TransfersConsumerTest, onNewBlocks_viewTagFilterFindsTaggedOutputs) {
+  auto& container = addSubscription().getContainer();
+  m_consumer.setViewTagFilter(true);
+
+  auto other = generateAccountKeys();
+  std::shared_ptr<ITransaction> tx(createTransaction());
+  addTestInput(*tx, 10000);
+  addTestKeyOutput(*tx, 900, 0, other);
+  addTestKeyOutput(*tx, 850, 1, m_accountKeys);
+  addTestViewTags(*tx, getTestViewTags(*tx, { other, m_accountKeys }));
+
+  CompleteBlock block;
+  block.block = CryptoNote::Block();
+  block.block->timestamp = 0;
+  block.transactions.push_back(tx);
+
+  ASSERT_TRUE(m_consumer.onNewBlocks(&block, 0, 1));
+  auto outs = container.getTransactionOutputs(tx->getTransactionHash(), ITransfersContainer::IncludeAll);
+  ASSERT_EQ(1, outs.size());
+  ASSERT_EQ(850, outs[0].amount);
+}
+
+TEST_F(TransfersConsumerTest, onNewBlocks_viewTagFilterRejectsOtherTags) {
+  auto& container = addSubscription().getContainer();
+
+  std::shared_ptr<ITransaction> tx(createTransaction());
+  addTestInput(*tx, 10000);
+  addTestKeyOutput(*tx, 900, 0, m_accountKeys);
+  std::vector<uint8_t> tags = getTestViewTags(*tx, { m_accountKeys });
+  tags[0] ^= 1;
+  addTestViewTags(*tx, tags);
+
+  CompleteBlock block;
+  block.block = CryptoNote::Block();
+  block.block->timestamp = 0;
+  block.transactions.push_back(tx);
+
+  // legacy scanning ignores the tags
+  TransfersConsumer legacyConsumer(m_currency, m_node, m_logger, m_accountKeys.viewSecretKey);
+  auto& legacyContainer = addSubscription(legacyConsumer).getContainer();
+  ASSERT_TRUE(legacyConsumer.onNewBlocks(&block, 0, 1));
+  ASSERT_EQ(1, legacyContainer.getTransactionOutputs(tx->getTransactionHash(), ITransfersContainer::IncludeAll).size());
+
+  m_consumer.setViewTagFilter(true);
+  ASSERT_TRUE(m_consumer.onNewBlocks(&block, 0, 1));
+  ASSERT_TRUE(container.getTransactionOutputs(tx->getTransactionHash(), ITransfersContainer::IncludeAll).empty());
+}
+
 TEST_F(TransfersConsumerTest, onNewBlocks_MultisignatureTransaction) {
   auto& container1 = addSubscription().getContainer();
 
@@ -16,6 +16,10 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with Qwertycoin.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <limits>
+#include <set>
+#include <sstream>
+
 #include "gtest/gtest.h"
 
 #include "WalletLegacy/IWalletLegacy.h"
@@ -919,6 +923,35 @@ public:
     AMOUNT_1 = 13,
     AMOUNT_2 = 17
   };
+
+  // the running balances must agree with the outputs they are made of
+  void expectBalanceMatchesOutputs(const TransfersContainer& c) {
+    const uint32_t states[] = {
+      ITransfersContainer::IncludeStateLocked,
+      ITransfersContainer::IncludeStateSoftLocked,
+      ITransfersContainer::IncludeStateUnlocked,
+      ITransfersContainer::IncludeStateLocked | ITransfersContainer::IncludeStateSoftLocked,
+      ITransfersContainer::IncludeStateAll
+    };
+    const uint32_t types[] = {
+      ITransfersContainer::IncludeTypeKey,
+      ITransfersContainer::IncludeTypeMultisignature,
+      ITransfersContainer::IncludeTypeAll
+    };
+
+    for (uint32_t state : states) {
+      for (uint32_t type : types) {
+        std::vector<TransactionOutputInformation> outputs;
+        c.getOutputs(outputs, state | type);
+        uint64_t amount = 0;
+        for (const auto& output : outputs) {
+          amount += output.amount;
+        }
+
+        EXPECT_EQ(amount, c.balance(state | type)) << "flags " << (state | type);
+      }
+    }
+  }
 };
 
 
@@ -1003,6 +1036,77 @@ TEST_F(TransfersContainer_balance, filtersByStateAndKeySimultaneously) {
   ASSERT_EQ(AMOUNT_1 + AMOUNT_2, container.balance(ITransfersContainer::IncludeStateUnlocked | ITransfersContainer::IncludeTypeKey));
 }
 
+TEST_F(TransfersContainer_balance, movesHeightLockedAmountsAsHeightAdvances) {
+  TestTransactionBuilder tx1;
+  tx1.setUnlockTime(TEST_BLOCK_HEIGHT + 10);
+  tx1.addTestInput(AMOUNT_1 + AMOUNT_2 + 1);
+  auto outInfo1 = tx1.addTestKeyOutput(AMOUNT_1, TEST_TRANSACTION_OUTPUT_GLOBAL_INDEX, account);
+  auto outInfo2 = tx1.addTestMultisignatureOutput(AMOUNT_2, TEST_TRANSACTION_OUTPUT_GLOBAL_INDEX);
+  ASSERT_TRUE(container.addTransaction(blockInfo(TEST_BLOCK_HEIGHT), *tx1.build(), { outInfo1, outInfo2 }));
+
+  uint32_t unlockHeight = static_cast<uint32_t>(TEST_BLOCK_HEIGHT + 10 - currency.lockedTxAllowedDeltaBlocks());
+  for (uint32_t height = TEST_BLOCK_HEIGHT; height <= unlockHeight + 2; ++height) {
+    ASSERT_TRUE(container.advanceHeight(height));
+    expectBalanceMatchesOutputs(container);
+  }
+
+  ASSERT_EQ(AMOUNT_1 + AMOUNT_2, container.balance(ITransfersContainer::IncludeAllUnlocked));
+  ASSERT_EQ(0, container.balance(ITransfersContainer::IncludeAllLocked));
+}
+
+TEST_F(TransfersContainer_balance, followsSpendsConfirmationsDetachAndSafeTransactions) {
+  TransfersContainer safeContainer(currency, logger, 10, 3);
+
+  TestTransactionBuilder incoming;
+  incoming.addTestInput(AMOUNT_1 + AMOUNT_2 + 1);
+  auto keyOut = incoming.addTestKeyOutput(AMOUNT_1, TEST_TRANSACTION_OUTPUT_GLOBAL_INDEX, account);
+  auto multisigOut = incoming.addTestMultisignatureOutput(AMOUNT_2, TEST_TRANSACTION_OUTPUT_GLOBAL_INDEX);
+  auto incomingTx = incoming.build();
+  ASSERT_TRUE(safeContainer.addTransaction(blockInfo(TEST_BLOCK_HEIGHT), *incomingTx, { keyOut, multisigOut }));
+  expectBalanceMatchesOutputs(safeContainer);
+
+  safeContainer.markTransactionSafe(incomingTx->getTransactionHash());
+  ASSERT_TRUE(safeContainer.advanceHeight(TEST_BLOCK_HEIGHT + 2));
+  ASSERT_EQ(AMOUNT_1 + AMOUNT_2, safeContainer.balance(ITransfersContainer::IncludeAllUnlocked));
+  expectBalanceMatchesOutputs(safeContainer);
+
+  TestTransactionBuilder unconfirmed;
+  unconfirmed.addTestInput(AMOUNT_1 + 1);
+  auto unconfirmedOut = unconfirmed.addTestKeyOutput(AMOUNT_1, UNCONFIRMED_TRANSACTION_GLOBAL_OUTPUT_INDEX, account);
+  auto unconfirmedTx = unconfirmed.build();
+  ASSERT_TRUE(safeContainer.addTransaction(blockInfo(WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT), *unconfirmedTx, { unconfirmedOut }));
+  expectBalanceMatchesOutputs(safeContainer);
+
+  std::vector<TransactionOutputInformation> unlocked;
+  safeContainer.getOutputs(unlocked, ITransfersContainer::IncludeKeyUnlocked);
+  ASSERT_EQ(1, unlocked.size());
+  TestTransactionBuilder spending;
+  spending.addInput(account, unlocked[0]);
+  spending.addTestKeyOutput(AMOUNT_1, TEST_TRANSACTION_OUTPUT_GLOBAL_INDEX + 1);
+  auto spendingTx = spending.build();
+  ASSERT_TRUE(safeContainer.addTransaction(blockInfo(TEST_BLOCK_HEIGHT + 5), *spendingTx, {}));
+  ASSERT_EQ(AMOUNT_2, safeContainer.balance(ITransfersContainer::IncludeAllUnlocked));
+  expectBalanceMatchesOutputs(safeContainer);
+
+  ASSERT_TRUE(safeContainer.markTransactionConfirmed(blockInfo(TEST_BLOCK_HEIGHT + 6), unconfirmedTx->getTransactionHash(), { TEST_TRANSACTION_OUTPUT_GLOBAL_INDEX + 2 }));
+  expectBalanceMatchesOutputs(safeContainer);
+
+  ASSERT_TRUE(safeContainer.advanceHeight(TEST_BLOCK_HEIGHT + 20));
+  ASSERT_EQ(AMOUNT_1 + AMOUNT_2, safeContainer.balance(ITransfersContainer::IncludeAllUnlocked));
+  expectBalanceMatchesOutputs(safeContainer);
+
+  safeContainer.detach(TEST_BLOCK_HEIGHT + 5);
+  ASSERT_EQ(AMOUNT_1 + AMOUNT_2, safeContainer.balance(ITransfersContainer::IncludeAll));
+  expectBalanceMatchesOutputs(safeContainer);
+
+  std::stringstream stream;
+  safeContainer.save(stream);
+  TransfersContainer restored(currency, logger, 10, 3);
+  restored.load(stream);
+  expectBalanceMatchesOutputs(restored);
+  ASSERT_EQ(safeContainer.balance(ITransfersContainer::IncludeAll), restored.balance(ITransfersContainer::IncludeAll));
+}
+
 
 //---------------------------------------------------------------------------
 // TransfersContainer_getOutputs
@@ -1133,3 +1237,89 @@ TEST_F(TransfersContainer_getOutputs, filtersByStateAndKeySimultaneously) {
   ASSERT_EQ(AMOUNT_1 + AMOUNT_2, transfers.front().amount);
 }
 
+//---------------------------------------------------------------------------
+// TransfersContainer_getRandomOutputs
+//---------------------------------------------------------------------------
+class TransfersContainer_getRandomOutputs : public TransfersContainerTest {
+public:
+  std::set<uint64_t> amountsOf(const std::vector<TransactionOutputInformation>& outputs) {
+    std::set<uint64_t> amounts;
+    for (const auto& output : outputs) {
+      amounts.insert(output.amount);
+    }
+
+    return amounts;
+  }
+};
+
+TEST_F(TransfersContainer_getRandomOutputs, picksOnlyUnlockedKeyOutputsInAmountRange) {
+  addTransaction(TEST_BLOCK_HEIGHT, 5);
+  addTransaction(TEST_BLOCK_HEIGHT, 50);
+  addTransaction(TEST_BLOCK_HEIGHT, 500);
+  addTransaction(TEST_BLOCK_HEIGHT, 5000);
+
+  TestTransactionBuilder tx;
+  tx.addTestInput(81);
+  auto outInfo = tx.addTestMultisignatureOutput(80, TEST_TRANSACTION_OUTPUT_GLOBAL_INDEX);
+  ASSERT_TRUE(container.addTransaction(blockInfo(TEST_BLOCK_HEIGHT), *tx.build(), { outInfo }));
+
+  addTransaction(TEST_CONTAINER_CURRENT_HEIGHT, 60);
+  addTransaction(WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT, 70);
+
+  container.advanceHeight(TEST_CONTAINER_CURRENT_HEIGHT);
+
+  // 60 is soft locked: counted in the pool, never picked
+  EXPECT_EQ(3, container.getRandomOutputsPoolSize(10, 999));
+
+  std::vector<TransactionOutputInformation> outputs;
+  ASSERT_EQ(2, container.getRandomOutputs(10, 10, 999, outputs));
+  EXPECT_EQ(std::set<uint64_t>({ 50, 500 }), amountsOf(outputs));
+
+  outputs.clear();
+  ASSERT_EQ(4, container.getRandomOutputs(10, 0, std::numeric_limits<uint64_t>::max(), outputs));
+  EXPECT_EQ(std::set<uint64_t>({ 5, 50, 500, 5000 }), amountsOf(outputs));
+
+  EXPECT_EQ(0, container.getRandomOutputsPoolSize(10, 9));
+}
+
+TEST_F(TransfersContainer_getRandomOutputs, skipsOutputsAlreadyPicked) {
+  const uint64_t OUTPUTS_COUNT = 40;
+  for (uint64_t amount = 1; amount <= OUTPUTS_COUNT; ++amount) {
+    addTransaction(TEST_BLOCK_HEIGHT, amount);
+  }
+
+  container.advanceHeight(TEST_CONTAINER_CURRENT_HEIGHT);
+
+  std::vector<TransactionOutputInformation> outputs;
+  for (size_t i = 0; i < OUTPUTS_COUNT / 8; ++i) {
+    ASSERT_EQ(8, container.getRandomOutputs(8, 0, OUTPUTS_COUNT, outputs));
+  }
+
+  ASSERT_EQ(0, container.getRandomOutputs(8, 0, OUTPUTS_COUNT, outputs));
+  EXPECT_EQ(OUTPUTS_COUNT, outputs.size());
+  EXPECT_EQ(OUTPUTS_COUNT, amountsOf(outputs).size());
+}
+
+TEST_F(TransfersContainer_getRandomOutputs, followsSpendsAndDetach) {
+  auto tx1 = addTransaction(TEST_BLOCK_HEIGHT, 300);
+  auto tx2 = addTransaction(TEST_BLOCK_HEIGHT, 400);
+  container.advanceHeight(TEST_CONTAINER_CURRENT_HEIGHT);
+  ASSERT_EQ(2, container.getRandomOutputsPoolSize(0, 1000));
+
+  addSpendingTransaction(tx1->getTransactionHash(), TEST_CONTAINER_CURRENT_HEIGHT, 0, 300);
+  EXPECT_EQ(1, container.getRandomOutputsPoolSize(0, 1000));
+
+  std::vector<TransactionOutputInformation> outputs;
+  ASSERT_EQ(1, container.getRandomOutputs(2, 0, 1000, outputs));
+  EXPECT_EQ(400, outputs[0].amount);
+
+  container.detach(TEST_CONTAINER_CURRENT_HEIGHT);
+  EXPECT_EQ(2, container.getRandomOutputsPoolSize(0, 1000));
+
+  outputs.clear();
+  ASSERT_EQ(2, container.getRandomOutputs(2, 0, 1000, outputs));
+  EXPECT_EQ(std::set<uint64_t>({ 300, 400 }), amountsOf(outputs));
+
+  container.detach(TEST_BLOCK_HEIGHT);
+  EXPECT_EQ(0, container.getRandomOutputsPoolSize(0, 1000));
+}
@@ -19,9 +19,12 @@
 #include "gtest/gtest.h"
 
 #include <chrono>
+#include <condition_variable>
 #include <fstream>
+#include <mutex>
 #include <numeric>
 #include <system_error>
+#include <thread>
 #include <tuple>
 
 #include "Common/StringTools.h"
@@ -31,6 +34,7 @@
 #include "INodeStubs.h"
 #include "TestBlockchainGenerator.h"
 #include "TransactionApiHelpers.h"
+#include "Transfers/ScanningPool.h"
 #include <Logging/ConsoleLogger.h>
 #include "Wallet/WalletErrors.h"
 #include "Wallet/WalletGreen.h"
@@ -864,6 +868,45 @@ TEST_F(WalletApi, transferTooBigMixin) {
   ASSERT_ANY_THROW(sendMoney(RANDOM_ADDRESS, SENT, FEE, 15));
 }
 
+TEST_F(WalletApi, transferDoesNotWaitForBlockedScanJob) {
+  // two rewards, so the transfer below has several inputs to sign in parallel
+  generateBlockReward();
+  generateAndUnlockMoney();
+
+  // holds the scanning pool the way a scan job waiting for the node does
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool scanning = false;
+  bool released = false;
+  bool timedOut = false;
+  std::thread scan([&] {
+    ScanningPool::instance().run(2, [&](size_t) {
+      std::unique_lock<std::mutex> lk(mutex);
+      scanning = true;
+      condition.notify_all();
+      if (!condition.wait_for(lk, std::chrono::seconds(10), [&] { return released; })) {
+        timedOut = true;
+      }
+    });
+  });
+
+  {
+    std::unique_lock<std::mutex> lk(mutex);
+    condition.wait(lk, [&] { return scanning; });
+  }
+
+  EXPECT_NO_THROW(sendMoney(RANDOM_ADDRESS, alice.getActualBalance() - FEE, FEE));
+
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    released = true;
+  }
+
+  condition.notify_all();
+  scan.join();
+  EXPECT_FALSE(timedOut);
+}
+
 TEST_F(WalletApi, transferNegativeAmount) {
   generateAndUnlockMoney();
   ASSERT_ANY_THROW(sendMoney(RANDOM_ADDRESS, -static_cast<int64_t>(SENT), FEE));
@@ -20,10 +20,12 @@
 
 #include <numeric>
 #include <random>
+#include <thread>
 
 #include "CryptoNoteCore/TransactionApi.h"
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h" // TODO: delete
 #include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
 #include "crypto/Crypto.h"
 #include "TransactionApiHelpers.h"
 
@@ -154,6 +156,55 @@ TEST_F(TransactionApi, addAndSignInput) {
   EXPECT_NO_FATAL_FAILURE(checkHashChanged());
 }
 
+TEST_F(TransactionApi, signInputKeysSignsEveryInputFromSeveralThreads) {
+  const size_t INPUTS_COUNT = 8;
+  const size_t MIXIN = 3;
+
+  std::vector<TransactionTypes::InputKeyInfo> infos;
+  std::vector<KeyPair> ephKeys(INPUTS_COUNT);
+  for (size_t i = 0; i < INPUTS_COUNT; ++i) {
+    TransactionTypes::InputKeyInfo info = createInputInfo(1000);
+    // decoys around the real output
+    for (uint32_t j = 1; j <= MIXIN; ++j) {
+      KeyPair decoy = generateKeyPair();
+      info.outputs.push_back(TransactionTypes::GlobalOutput{ decoy.publicKey, j });
+    }
+    info.realOutput.transactionIndex = 0;
+
+    tx->addInput(sender, info, ephKeys[i]);
+    infos.push_back(info);
+  }
+
+  tx->signInputKeys(0, infos, ephKeys, [](size_t count, const std::function<void(size_t)>& task) {
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < count; ++i) {
+      threads.emplace_back(task, i);
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  });
+
+  ASSERT_TRUE(tx->validateSignatures());
+
+  Transaction parsed;
+  ASSERT_TRUE(fromBinaryArray(parsed, tx->getTransactionData()));
+  Hash prefixHash = tx->getTransactionPrefixHash();
+  for (size_t i = 0; i < INPUTS_COUNT; ++i) {
+    KeyInput input;
+    tx->getInput(i, input);
+
+    std::vector<const Crypto::PublicKey*> keys;
+    for (const auto& output : infos[i].outputs) {
+      keys.push_back(&output.targetKey);
+    }
+
+    ASSERT_EQ(MIXIN + 1, parsed.signatures[i].size());
+    EXPECT_TRUE(Crypto::checkRingSignature(prefixHash, input.keyImage, keys, parsed.signatures[i].data())) << "input " << i;
+  }
+}
+
 TEST_F(TransactionApi, addAndSignInputMsig) {
 
     MultiSignatureInput inputMsig;
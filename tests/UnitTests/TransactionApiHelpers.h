@@ -23,6 +23,7 @@
 #include <CryptoNoteCore/CryptoNoteFormatUtils.h>
 #include <CryptoNoteCore/CryptoNoteTools.h>
 #include <CryptoNoteCore/ITransaction.h>
+#include <CryptoNoteCore/TransactionExtra.h>
 #include <Transfers/TransfersContainer.h>
 #include <CryptoTypes.h>
 
@@ -106,6 +107,24 @@ namespace {
     return outputInfo;
   }
 
+  // the view tags of the outputs, receivers[i] being the receiver of output i
+  std::vector<uint8_t> getTestViewTags(const ITransactionReader& transaction, const std::vector<AccountKeys>& receivers) {
+    std::vector<uint8_t> tags;
+    for (size_t i = 0; i < receivers.size(); ++i) {
+      KeyDerivation derivation;
+      generateKeyDerivation(transaction.getTransactionPublicKey(), receivers[i].viewSecretKey, derivation);
+      tags.push_back(deriveViewTag(derivation, i));
+    }
+
+    return tags;
+  }
+
+  void addTestViewTags(ITransaction& transaction, const std::vector<uint8_t>& tags) {
+    BinaryArray extra;
+    appendViewTagsToExtra(extra, TransactionExtraViewTags{ tags });
+    transaction.appendExtra(extra);
+  }
+
   inline Transaction convertTx(ITransactionReader& tx) {
     Transaction oldTx;
     fromBinaryArray(oldTx, tx.getTransactionData()); // ignore return code